@@ -62,6 +62,12 @@
 #include <PlayRho/Collision/Manifold.hpp>
 #include <PlayRho/Collision/WorldManifold.hpp>
 #include <PlayRho/Collision/ShapeSeparation.hpp>
+#include <PlayRho/Collision/Distance.hpp>
+#include <PlayRho/Collision/TimeOfImpact.hpp>
+#include <PlayRho/Collision/RayCastOutput.hpp>
+#include <PlayRho/Collision/DynamicTree.hpp>
+#include <PlayRho/Collision/CompactTree.hpp>
+#include <PlayRho/Collision/WideTree.hpp>
 #include <PlayRho/Collision/Shapes/PolygonShapeConf.hpp>
 #include <PlayRho/Collision/Shapes/DiskShapeConf.hpp>
 
@@ -1579,6 +1585,249 @@ static TransformationPairs GetTransformationPairs(unsigned count)
     return it->second;
 }
 
+static playrho::d2::AABB GetRandAABB(float lo, float hi, float size)
+{
+    const auto x = Rand(lo, hi);
+    const auto y = Rand(lo, hi);
+    return playrho::d2::AABB{
+        playrho::Length2{x * playrho::Meter, y * playrho::Meter},
+        playrho::Length2{(x + size) * playrho::Meter, (y + size) * playrho::Meter}
+    };
+}
+
+/// Makes a dynamic tree of the given number of 1m sized proxies at a constant density.
+static playrho::d2::DynamicTree MakeRandTree(unsigned count)
+{
+    const auto extent = std::sqrt(static_cast<float>(count)) * 2.0f;
+    auto tree = playrho::d2::DynamicTree{};
+    for (auto i = decltype(count){0}; i < count; ++i)
+    {
+        tree.CreateLeaf(GetRandAABB(0.0f, extent, 1.0f), playrho::d2::DynamicTree::LeafData{});
+    }
+    return tree;
+}
+
+static std::vector<playrho::d2::AABB> GetRandQueryAABBs(unsigned proxyCount, unsigned count)
+{
+    const auto extent = std::sqrt(static_cast<float>(proxyCount)) * 2.0f;
+    auto aabbs = std::vector<playrho::d2::AABB>{};
+    aabbs.reserve(count);
+    for (auto i = decltype(count){0}; i < count; ++i)
+    {
+        aabbs.push_back(GetRandAABB(0.0f, extent, 2.0f));
+    }
+    return aabbs;
+}
+
+static void DynamicTreeQuery(benchmark::State& state)
+{
+    const auto proxyCount = static_cast<unsigned>(state.range());
+    const auto tree = MakeRandTree(proxyCount);
+    const auto aabbs = GetRandQueryAABBs(proxyCount, 1000u);
+    for (auto _: state)
+    {
+        auto found = 0u;
+        for (const auto& aabb: aabbs)
+        {
+            playrho::d2::Query(tree, aabb, [&](playrho::d2::DynamicTree::Size) {
+                ++found;
+                return playrho::d2::DynamicTreeOpcode::Continue;
+            });
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(aabbs)));
+}
+
+/// Makes a dynamic tree of the given number of 1m sized proxies at a constant density
+/// whose collision categories are by which of 16 vertical stripes they're in.
+static playrho::d2::DynamicTree MakeRandLayeredTree(unsigned count)
+{
+    const auto extent = std::sqrt(static_cast<float>(count)) * 2.0f;
+    auto tree = playrho::d2::DynamicTree{};
+    for (auto i = decltype(count){0}; i < count; ++i)
+    {
+        const auto aabb = GetRandAABB(0.0f, extent, 1.0f);
+        const auto stripe = static_cast<unsigned>(aabb.ranges[0].GetMin() / playrho::Meter
+                                                  * 16.0f / extent) % 16u;
+        tree.CreateLeaf(aabb, playrho::d2::DynamicTree::LeafData{nullptr, nullptr, 0,
+            static_cast<playrho::Filter::bits_type>(1u << stripe)});
+    }
+    return tree;
+}
+
+static void DynamicTreeQueryByCategory(benchmark::State& state, bool masked)
+{
+    const auto proxyCount = static_cast<unsigned>(state.range());
+    const auto tree = MakeRandLayeredTree(proxyCount);
+    const auto aabbs = GetRandQueryAABBs(proxyCount, 1000u);
+    const auto maskBits = playrho::Filter::bits_type{0x0003};
+    for (auto _: state)
+    {
+        auto found = 0u;
+        for (const auto& aabb: aabbs)
+        {
+            if (masked)
+            {
+                playrho::d2::Query(tree, aabb, maskBits, [&](playrho::d2::DynamicTree::Size) {
+                    ++found;
+                    return playrho::d2::DynamicTreeOpcode::Continue;
+                });
+            }
+            else
+            {
+                playrho::d2::Query(tree, aabb, [&](playrho::d2::DynamicTree::Size index) {
+                    if ((tree.GetLeafData(index).categoryBits & maskBits) != 0)
+                    {
+                        ++found;
+                    }
+                    return playrho::d2::DynamicTreeOpcode::Continue;
+                });
+            }
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(aabbs)));
+}
+
+static void DynamicTreeQueryFilteredByCategory(benchmark::State& state)
+{
+    DynamicTreeQueryByCategory(state, false);
+}
+
+static void DynamicTreeQueryMaskedByCategory(benchmark::State& state)
+{
+    DynamicTreeQueryByCategory(state, true);
+}
+
+static void CompactTreeQuery(benchmark::State& state, playrho::d2::CompactTree::Bounds bounds)
+{
+    const auto proxyCount = static_cast<unsigned>(state.range());
+    const auto tree = playrho::d2::CompactTree{MakeRandTree(proxyCount), bounds};
+    const auto aabbs = GetRandQueryAABBs(proxyCount, 1000u);
+    for (auto _: state)
+    {
+        auto found = 0u;
+        for (const auto& aabb: aabbs)
+        {
+            playrho::d2::Query(tree, aabb, [&](playrho::d2::DynamicTree::Size) {
+                ++found;
+                return playrho::d2::DynamicTreeOpcode::Continue;
+            });
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(aabbs)));
+}
+
+static void CompactTreeQueryExact(benchmark::State& state)
+{
+    CompactTreeQuery(state, playrho::d2::CompactTree::Bounds::Exact);
+}
+
+static void CompactTreeQueryQuantized(benchmark::State& state)
+{
+    CompactTreeQuery(state, playrho::d2::CompactTree::Bounds::Quantized);
+}
+
+static void DynamicTreeBatchedQuery(benchmark::State& state)
+{
+    const auto proxyCount = static_cast<unsigned>(state.range(0));
+    const auto maxThreads = static_cast<unsigned>(state.range(1));
+    const auto tree = MakeRandTree(proxyCount);
+    const auto aabbs = GetRandQueryAABBs(proxyCount, 1000u);
+    auto hits = std::vector<playrho::d2::DynamicTreeQueryHit>{};
+    auto scratch = playrho::d2::DynamicTreeQueryScratch{};
+    for (auto _: state)
+    {
+        playrho::d2::Query(tree, aabbs, hits, scratch, maxThreads);
+        benchmark::DoNotOptimize(hits.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(aabbs)));
+}
+
+static void DynamicTreeRebuildTopDown(benchmark::State& state)
+{
+    const auto tree = MakeRandTree(static_cast<unsigned>(state.range(0)));
+    const auto maxThreads = static_cast<unsigned>(state.range(1));
+    for (auto _: state)
+    {
+        state.PauseTiming();
+        auto copy = tree;
+        state.ResumeTiming();
+        copy.RebuildTopDown(maxThreads);
+        benchmark::DoNotOptimize(copy.GetRootIndex());
+    }
+}
+
+static void WideTreeQuery(benchmark::State& state)
+{
+    const auto proxyCount = static_cast<unsigned>(state.range());
+    const auto tree = playrho::d2::WideTree{MakeRandTree(proxyCount)};
+    const auto aabbs = GetRandQueryAABBs(proxyCount, 1000u);
+    for (auto _: state)
+    {
+        auto found = 0u;
+        for (const auto& aabb: aabbs)
+        {
+            playrho::d2::Query(tree, aabb, [&](playrho::d2::DynamicTree::Size) {
+                ++found;
+                return playrho::d2::DynamicTreeOpcode::Continue;
+            });
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(aabbs)));
+}
+
+/// Gets random line-of-sight rays of up to 20m within the extent used by MakeRandTree.
+static std::vector<playrho::d2::RayCastInput> GetRandRays(unsigned proxyCount, unsigned count)
+{
+    const auto extent = std::sqrt(static_cast<float>(proxyCount)) * 2.0f;
+    auto rays = std::vector<playrho::d2::RayCastInput>{};
+    rays.reserve(count);
+    for (auto i = decltype(count){0}; i < count; ++i)
+    {
+        const auto x = Rand(0.0f, extent);
+        const auto y = Rand(0.0f, extent);
+        const auto p1 = playrho::Length2{x * playrho::Meter, y * playrho::Meter};
+        const auto p2 = playrho::Length2{(x + Rand(-20.0f, 20.0f)) * playrho::Meter,
+                                         (y + Rand(-20.0f, 20.0f)) * playrho::Meter};
+        rays.push_back(playrho::d2::RayCastInput{p1, p2, playrho::Real(1)});
+    }
+    return rays;
+}
+
+template <class T>
+static void TreeRayCast(benchmark::State& state, const T& tree)
+{
+    const auto rays = GetRandRays(static_cast<unsigned>(state.range()), 1000u);
+    for (auto _: state)
+    {
+        auto found = 0u;
+        for (const auto& ray: rays)
+        {
+            playrho::d2::RayCast(tree, ray, [&](playrho::d2::Fixture*, playrho::ChildCounter,
+                                                const playrho::d2::RayCastInput& input) {
+                ++found;
+                return playrho::Real{input.maxFraction};
+            });
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(rays)));
+}
+
+static void DynamicTreeRayCast(benchmark::State& state)
+{
+    TreeRayCast(state, MakeRandTree(static_cast<unsigned>(state.range())));
+}
+
+static void WideTreeRayCast(benchmark::State& state)
+{
+    TreeRayCast(state, playrho::d2::WideTree{MakeRandTree(static_cast<unsigned>(state.range()))});
+}
+
 static void MaxSepBetweenRelSquaresNoStop(benchmark::State& state)
 {
     const auto dim = playrho::Real(2) * playrho::Meter;
@@ -1952,7 +2201,623 @@ static void DropDisks(benchmark::State& state)
     }
 }
 
-static void AddPairStressTestPlayRho(benchmark::State& state, int count)
+static void DiskCrowd(benchmark::State& state, playrho::d2::BroadPhaseType broadPhase)
+{
+    const auto diskRadius = 0.5f * playrho::Meter;
+    auto world = playrho::d2::World{
+        playrho::d2::WorldConf{}.UseBroadPhase(broadPhase).UseGridCellSize(diskRadius * 2.5f)
+    };
+
+    const auto diskConf = playrho::d2::DiskShapeConf{}.UseRadius(diskRadius);
+    const auto shape = playrho::d2::Shape{diskConf};
+    const auto numDisks = state.range();
+    const auto columns = static_cast<decltype(numDisks)>(std::sqrt(static_cast<double>(numDisks)));
+    for (auto i = decltype(numDisks){0}; i < numDisks; ++i)
+    {
+        const auto location = playrho::Length2{
+            static_cast<float>(i % columns) * diskRadius * 3,
+            static_cast<float>(i / columns) * diskRadius * 3
+        };
+        const auto velocity = playrho::LinearVelocity2{
+            Rand(-5.0f, 5.0f) * playrho::MeterPerSecond,
+            Rand(-5.0f, 5.0f) * playrho::MeterPerSecond
+        };
+        const auto body = world.CreateBody(playrho::d2::BodyConf{}
+                                           .UseType(playrho::BodyType::Dynamic)
+                                           .UseLocation(location)
+                                           .UseLinearVelocity(velocity));
+        body->CreateFixture(shape);
+    }
+
+    const auto stepConf = playrho::StepConf{};
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(world.Step(stepConf));
+    }
+}
+
+/// Steps a world of a pile of overlapping disks and boxes, a quarter of which are boxes,
+/// where every body is in contact with its neighbors and every contact needs updating every
+/// step. The second range argument is the maximum number of threads to step with.
+static void ContactPile(benchmark::State& state)
+{
+    const auto halfSize = 0.5f * playrho::Meter;
+    auto world = playrho::d2::World{};
+    const auto disk = playrho::d2::Shape{playrho::d2::DiskShapeConf{}.UseRadius(halfSize)};
+    const auto box = playrho::d2::Shape{playrho::d2::PolygonShapeConf{}.SetAsBox(halfSize, halfSize)};
+    const auto numBodies = state.range(0);
+    const auto columns = static_cast<decltype(numBodies)>(std::sqrt(static_cast<double>(numBodies)));
+    for (auto i = decltype(numBodies){0}; i < numBodies; ++i)
+    {
+        const auto location = playrho::Length2{
+            static_cast<float>(i % columns) * halfSize * 1.9f,
+            static_cast<float>(i / columns) * halfSize * 1.9f
+        };
+        world.CreateBody(playrho::d2::BodyConf{}
+                         .UseType(playrho::BodyType::Dynamic)
+                         .UseLocation(location)
+                         .UseAllowSleep(false))
+            ->CreateFixture((i % 4 == 0)? box: disk);
+    }
+    auto stepConf = playrho::StepConf{};
+    stepConf.regVelocityIterations = 1;
+    stepConf.regPositionIterations = 1;
+    stepConf.doToi = false;
+    stepConf.maxThreads = static_cast<playrho::StepConf::thread_count_type>(state.range(1));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(world.Step(stepConf));
+    }
+}
+
+/// Steps a world of slowly drifting octagons spaced closely enough for their fattened AABBs
+/// to overlap while the octagons themselves mostly don't touch.
+static void OctagonDrift(benchmark::State& state)
+{
+    const auto radius = 0.5f * playrho::Meter;
+    auto world = playrho::d2::World{};
+    const auto vertices = playrho::GetCircleVertices(radius, 8);
+    const auto shape = playrho::d2::Shape{playrho::d2::PolygonShapeConf{}.Set(vertices)};
+    const auto numBodies = state.range();
+    const auto columns = static_cast<decltype(numBodies)>(std::sqrt(static_cast<double>(numBodies)));
+    for (auto i = decltype(numBodies){0}; i < numBodies; ++i)
+    {
+        const auto location = playrho::Length2{
+            static_cast<float>(i % columns) * radius * 2.15f,
+            static_cast<float>(i / columns) * radius * 2.15f
+        };
+        const auto velocity = playrho::LinearVelocity2{
+            Rand(-0.2f, 0.2f) * playrho::MeterPerSecond,
+            Rand(-0.2f, 0.2f) * playrho::MeterPerSecond
+        };
+        world.CreateBody(playrho::d2::BodyConf{}
+                         .UseType(playrho::BodyType::Dynamic)
+                         .UseLocation(location)
+                         .UseLinearVelocity(velocity)
+                         .UseAllowSleep(false))
+            ->CreateFixture(shape);
+    }
+    auto stepConf = playrho::StepConf{};
+    stepConf.doToi = false;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(world.Step(stepConf));
+    }
+}
+
+static void DiskCrowdTree(benchmark::State& state)
+{
+    DiskCrowd(state, playrho::d2::BroadPhaseType::DynamicTree);
+}
+
+static void DiskCrowdGrid(benchmark::State& state)
+{
+    DiskCrowd(state, playrho::d2::BroadPhaseType::UniformGrid);
+}
+
+/// Finds the fixtures nearest to random points among a grid of disks either through the
+/// world's dynamic tree or by checking the distance to every fixture.
+static void FindClosestFixtures(benchmark::State& state, bool bruteForce)
+{
+    const auto diskRadius = 0.5f * playrho::Meter;
+    auto world = playrho::d2::World{};
+    const auto shape = playrho::d2::Shape{playrho::d2::DiskShapeConf{}.UseRadius(diskRadius)};
+    const auto numDisks = state.range(0);
+    const auto count = static_cast<std::size_t>(state.range(1));
+    const auto columns = static_cast<decltype(numDisks)>(std::sqrt(static_cast<double>(numDisks)));
+    auto fixtures = std::vector<playrho::d2::Fixture*>{};
+    for (auto i = decltype(numDisks){0}; i < numDisks; ++i)
+    {
+        const auto location = playrho::Length2{
+            static_cast<float>(i % columns) * diskRadius * 3,
+            static_cast<float>(i / columns) * diskRadius * 3
+        };
+        const auto body = world.CreateBody(playrho::d2::BodyConf{}.UseLocation(location));
+        fixtures.push_back(body->CreateFixture(shape));
+    }
+    world.Step(playrho::StepConf{});
+    
+    const auto extent = static_cast<float>(columns) * 1.5f;
+    auto points = std::vector<playrho::Length2>{};
+    for (auto i = 0; i < 1000; ++i)
+    {
+        points.push_back(playrho::Length2{Rand(0.0f, extent) * playrho::Meter,
+                                          Rand(0.0f, extent) * playrho::Meter});
+    }
+    auto found = std::vector<playrho::d2::FixtureChildDistance>{};
+    const auto byDistance = [](const playrho::d2::FixtureChildDistance& lhs,
+                               const playrho::d2::FixtureChildDistance& rhs) {
+        return lhs.distance < rhs.distance;
+    };
+    for (auto _: state)
+    {
+        for (const auto& point: points)
+        {
+            if (bruteForce)
+            {
+                found.clear();
+                for (const auto& fixture: fixtures)
+                {
+                    found.push_back(playrho::d2::FixtureChildDistance{
+                        fixture, 0, playrho::d2::GetDistance(*fixture, 0, point)
+                    });
+                }
+                std::partial_sort(begin(found), begin(found) + static_cast<std::ptrdiff_t>(count),
+                                  end(found), byDistance);
+                found.resize(count);
+            }
+            else
+            {
+                playrho::d2::FindClosestFixtures(world, point, count, found);
+            }
+            benchmark::DoNotOptimize(found.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(points)));
+}
+
+static void FindClosestFixturesBruteForce(benchmark::State& state)
+{
+    FindClosestFixtures(state, true);
+}
+
+static void FindClosestFixturesViaTree(benchmark::State& state)
+{
+    FindClosestFixtures(state, false);
+}
+
+/// Casts random rays across a grid of disks for the closest hit either through the
+/// callback based world ray-cast or through the dedicated closest hit ray-cast.
+static void RayCastClosest(benchmark::State& state, bool viaCallback)
+{
+    const auto diskRadius = 0.5f * playrho::Meter;
+    auto world = playrho::d2::World{};
+    const auto shape = playrho::d2::Shape{playrho::d2::DiskShapeConf{}.UseRadius(diskRadius)};
+    const auto numDisks = state.range(0);
+    const auto columns = static_cast<decltype(numDisks)>(std::sqrt(static_cast<double>(numDisks)));
+    for (auto i = decltype(numDisks){0}; i < numDisks; ++i)
+    {
+        const auto location = playrho::Length2{
+            static_cast<float>(i % columns) * diskRadius * 3,
+            static_cast<float>(i / columns) * diskRadius * 3
+        };
+        world.CreateBody(playrho::d2::BodyConf{}.UseLocation(location))->CreateFixture(shape);
+    }
+    world.Step(playrho::StepConf{});
+    
+    const auto extent = static_cast<float>(columns) * 1.5f;
+    auto inputs = std::vector<playrho::d2::RayCastInput>{};
+    for (auto i = 0; i < 1000; ++i)
+    {
+        inputs.push_back(playrho::d2::RayCastInput{
+            playrho::Length2{Rand(0.0f, extent) * playrho::Meter, Rand(0.0f, extent) * playrho::Meter},
+            playrho::Length2{Rand(0.0f, extent) * playrho::Meter, Rand(0.0f, extent) * playrho::Meter},
+            playrho::UnitInterval<playrho::Real>{1}
+        });
+    }
+    for (auto _: state)
+    {
+        for (const auto& input: inputs)
+        {
+            if (viaCallback)
+            {
+                auto closest = static_cast<playrho::d2::Fixture*>(nullptr);
+                playrho::d2::RayCast(world, input, [&](playrho::d2::Fixture* fixture,
+                                                       playrho::ChildCounter,
+                                                       playrho::Length2, playrho::d2::UnitVec) {
+                    closest = fixture;
+                    return playrho::RayCastOpcode::ClipRay;
+                });
+                benchmark::DoNotOptimize(closest);
+            }
+            else
+            {
+                const auto closest = playrho::d2::RayCastClosest(world, input);
+                benchmark::DoNotOptimize(closest);
+            }
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(inputs)));
+}
+
+static void RayCastClosestViaCallback(benchmark::State& state)
+{
+    RayCastClosest(state, true);
+}
+
+static void RayCastClosestFrontToBack(benchmark::State& state)
+{
+    RayCastClosest(state, false);
+}
+
+/// Casts fans of rays from random origins within a grid of 10000 disks for the closest hits
+/// either one ray at a time or as a packet of rays.
+static void RayCastFan(benchmark::State& state, bool asPacket)
+{
+    const auto diskRadius = 0.5f * playrho::Meter;
+    auto world = playrho::d2::World{};
+    const auto shape = playrho::d2::Shape{playrho::d2::DiskShapeConf{}.UseRadius(diskRadius)};
+    const auto columns = 100;
+    for (auto i = 0; i < columns * columns; ++i)
+    {
+        const auto location = playrho::Length2{
+            static_cast<float>(i % columns) * diskRadius * 3,
+            static_cast<float>(i / columns) * diskRadius * 3
+        };
+        world.CreateBody(playrho::d2::BodyConf{}.UseLocation(location))->CreateFixture(shape);
+    }
+    world.Step(playrho::StepConf{});
+    
+    const auto numRays = static_cast<std::size_t>(state.range(0));
+    const auto extent = static_cast<float>(columns) * 1.5f;
+    auto fans = std::vector<std::vector<playrho::d2::RayCastInput>>{};
+    for (auto i = 0; i < 16; ++i)
+    {
+        const auto origin = playrho::Length2{Rand(0.0f, extent) * playrho::Meter,
+                                             Rand(0.0f, extent) * playrho::Meter};
+        auto fan = std::vector<playrho::d2::RayCastInput>{};
+        for (auto j = std::size_t{0}; j < numRays; ++j)
+        {
+            const auto angle = static_cast<float>(j) * 2 * playrho::Pi / static_cast<float>(numRays);
+            const auto delta = playrho::Length2{std::cos(angle) * 10.0f * playrho::Meter,
+                                                std::sin(angle) * 10.0f * playrho::Meter};
+            fan.push_back(playrho::d2::RayCastInput{origin, origin + delta,
+                playrho::UnitInterval<playrho::Real>{1}});
+        }
+        fans.push_back(fan);
+    }
+    auto outputs = std::vector<playrho::d2::FixtureRayCastOutput>(numRays);
+    for (auto _: state)
+    {
+        for (const auto& fan: fans)
+        {
+            if (asPacket)
+            {
+                playrho::d2::RayCastClosest(world, fan, outputs);
+            }
+            else
+            {
+                for (auto j = std::size_t{0}; j < numRays; ++j)
+                {
+                    outputs[j] = playrho::d2::RayCastClosest(world, fan[j]);
+                }
+            }
+            benchmark::DoNotOptimize(outputs.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(fans) * numRays));
+}
+
+static void RayCastFanPerRay(benchmark::State& state)
+{
+    RayCastFan(state, false);
+}
+
+static void RayCastFanAsPacket(benchmark::State& state)
+{
+    RayCastFan(state, true);
+}
+
+/// Sweeps a disk across a grid of 10000 disks along random paths either through the world's
+/// shape-cast or by stepping along the sweep with overlap tests and bisecting the first overlap.
+static void ShapeCast(benchmark::State& state, bool viaOverlaps)
+{
+    const auto diskRadius = 0.5f * playrho::Meter;
+    auto world = playrho::d2::World{};
+    const auto shape = playrho::d2::Shape{playrho::d2::DiskShapeConf{}.UseRadius(diskRadius)};
+    const auto columns = 100;
+    for (auto i = 0; i < columns * columns; ++i)
+    {
+        const auto location = playrho::Length2{
+            static_cast<float>(i % columns) * diskRadius * 4,
+            static_cast<float>(i / columns) * diskRadius * 4
+        };
+        world.CreateBody(playrho::d2::BodyConf{}.UseLocation(location))->CreateFixture(shape);
+    }
+    world.Step(playrho::StepConf{});
+    
+    const auto proxy = playrho::d2::GetChild(playrho::d2::DiskShapeConf{}.UseRadius(0.25f * playrho::Meter), 0);
+    const auto extent = static_cast<float>(columns) * 2.0f;
+    auto sweeps = std::vector<playrho::d2::Sweep>{};
+    for (auto i = 0; i < 100; ++i)
+    {
+        // Starts between the disks and moves up to 4m in any direction.
+        const auto p0 = playrho::Length2{
+            (std::floor(Rand(0.0f, extent) / 2) * 2 + 1) * playrho::Meter,
+            (std::floor(Rand(0.0f, extent) / 2) * 2 + 1) * playrho::Meter
+        };
+        const auto p1 = p0 + playrho::Length2{Rand(-4.0f, 4.0f) * playrho::Meter,
+                                              Rand(-4.0f, 4.0f) * playrho::Meter};
+        sweeps.push_back(playrho::d2::Sweep{playrho::d2::Position{p0, 0 * playrho::Degree},
+                                            playrho::d2::Position{p1, 0 * playrho::Degree}});
+    }
+    const auto overlaps = [&](const playrho::d2::Sweep& sweep, playrho::Real time) {
+        const auto xf = playrho::d2::GetTransformation(sweep, time);
+        auto found = false;
+        playrho::d2::Query(world, playrho::d2::ComputeAABB(proxy, xf),
+                           [&](playrho::d2::Fixture* fixture, playrho::ChildCounter child) {
+            const auto other = playrho::d2::GetChild(fixture->GetShape(), child);
+            found = playrho::d2::TestOverlap(proxy, xf, other,
+                                             fixture->GetBody()->GetTransformation()) >= 0 * playrho::SquareMeter;
+            return !found;
+        });
+        return found;
+    };
+    for (auto _: state)
+    {
+        for (const auto& sweep: sweeps)
+        {
+            if (viaOverlaps)
+            {
+                auto time = playrho::Real{1};
+                for (auto i = 1; i <= 32; ++i)
+                {
+                    const auto t = static_cast<playrho::Real>(i) / 32;
+                    if (overlaps(sweep, t))
+                    {
+                        auto lo = static_cast<playrho::Real>(i - 1) / 32;
+                        auto hi = t;
+                        for (auto j = 0; j < 12; ++j)
+                        {
+                            const auto mid = (lo + hi) / 2;
+                            (overlaps(sweep, mid)? hi: lo) = mid;
+                        }
+                        time = hi;
+                        break;
+                    }
+                }
+                benchmark::DoNotOptimize(time);
+            }
+            else
+            {
+                const auto hit = playrho::d2::ShapeCast(world, proxy, sweep);
+                benchmark::DoNotOptimize(hit);
+            }
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(sweeps)));
+}
+
+static void ShapeCastViaOverlapBisection(benchmark::State& state)
+{
+    ShapeCast(state, true);
+}
+
+static void ShapeCastViaToi(benchmark::State& state)
+{
+    ShapeCast(state, false);
+}
+
+/// @brief Kind of query on convex polygons of many vertices.
+enum class ManyVerticesQuery
+{
+    Distance,
+    Toi,
+    RayCast,
+};
+
+/// Calculates distances or times of impact of two regular polygons having the given number
+/// of vertices at random places and angles near each other, or casts rays at one of them.
+static void ManyVertices(benchmark::State& state, ManyVerticesQuery query)
+{
+    const auto count = static_cast<unsigned>(state.range());
+    const auto vertices = playrho::GetCircleVertices(1.0f * playrho::Meter, count);
+    const auto conf = playrho::d2::PolygonShapeConf{}.Set(playrho::Span<const playrho::Length2>(
+        vertices.data(), size(vertices)));
+    const auto proxy = playrho::d2::GetChild(conf, 0);
+    const auto getPosition = [](float lo, float hi) {
+        return playrho::d2::Position{
+            playrho::Length2{Rand(lo, hi) * playrho::Meter, Rand(lo, hi) * playrho::Meter},
+            Rand(0.0f, 6.0f) * playrho::Radian
+        };
+    };
+    auto sweeps = std::vector<playrho::d2::Sweep>{};
+    for (auto i = 0; i < 100; ++i)
+    {
+        sweeps.push_back(playrho::d2::Sweep{getPosition(-4.0f, -2.0f), getPosition(-1.0f, 1.0f)});
+    }
+    const auto xfB = playrho::d2::Transformation{};
+    const auto sweepB = playrho::d2::Sweep{playrho::d2::Position{}};
+    for (auto _: state)
+    {
+        for (const auto& sweep: sweeps)
+        {
+            switch (query)
+            {
+                case ManyVerticesQuery::Distance:
+                {
+                    const auto output = playrho::d2::Distance(proxy, playrho::d2::GetTransformation(sweep, 1),
+                                                              proxy, xfB);
+                    benchmark::DoNotOptimize(output);
+                    break;
+                }
+                case ManyVerticesQuery::Toi:
+                {
+                    const auto output = playrho::d2::GetToiViaSat(proxy, sweep, proxy, sweepB);
+                    benchmark::DoNotOptimize(output);
+                    break;
+                }
+                case ManyVerticesQuery::RayCast:
+                {
+                    const auto output = playrho::d2::RayCast(proxy, playrho::d2::RayCastInput{
+                        sweep.pos0.linear, sweep.pos1.linear, playrho::Real{1}
+                    }, xfB);
+                    benchmark::DoNotOptimize(output);
+                    break;
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(sweeps)));
+}
+
+static void ManyVerticesDistance(benchmark::State& state)
+{
+    ManyVertices(state, ManyVerticesQuery::Distance);
+}
+
+static void ManyVerticesToi(benchmark::State& state)
+{
+    ManyVertices(state, ManyVerticesQuery::Toi);
+}
+
+static void ManyVerticesRayCast(benchmark::State& state)
+{
+    ManyVertices(state, ManyVerticesQuery::RayCast);
+}
+
+/// Finds the fixtures overlapping disks or boxes at random places within a grid of 10000
+/// disks and boxes either through querying by AABB and testing the overlap of every candidate
+/// with GJK or through the world's overlap query.
+static void QueryOverlap(benchmark::State& state, bool viaTestOverlap)
+{
+    const auto halfSize = 0.5f * playrho::Meter;
+    auto world = playrho::d2::World{};
+    const auto disk = playrho::d2::Shape{playrho::d2::DiskShapeConf{}.UseRadius(halfSize)};
+    const auto box = playrho::d2::Shape{playrho::d2::PolygonShapeConf{}.SetAsBox(halfSize, halfSize)};
+    const auto columns = 100;
+    for (auto i = 0; i < columns * columns; ++i)
+    {
+        const auto location = playrho::Length2{
+            static_cast<float>(i % columns) * halfSize * 3,
+            static_cast<float>(i / columns) * halfSize * 3
+        };
+        world.CreateBody(playrho::d2::BodyConf{}.UseLocation(location).UseAngle(Rand(0.0f, 1.0f) * playrho::Radian))
+            ->CreateFixture((i % 2 == 0)? disk: box);
+    }
+    world.Step(playrho::StepConf{});
+    
+    const auto queryDisk = playrho::d2::DiskShapeConf{}.UseRadius(3 * playrho::Meter);
+    const auto queryBox = playrho::d2::PolygonShapeConf{}.SetAsBox(3 * playrho::Meter, 1 * playrho::Meter);
+    const auto proxies = std::array<playrho::d2::DistanceProxy, 2>{{
+        playrho::d2::GetChild(queryDisk, 0), playrho::d2::GetChild(queryBox, 0)
+    }};
+    const auto extent = static_cast<float>(columns) * 1.5f;
+    auto xfs = std::vector<playrho::d2::Transformation>{};
+    for (auto i = 0; i < 100; ++i)
+    {
+        xfs.push_back(playrho::d2::Transformation{
+            playrho::Length2{Rand(0.0f, extent) * playrho::Meter, Rand(0.0f, extent) * playrho::Meter},
+            playrho::d2::UnitVec::Get(Rand(0.0f, 6.0f) * playrho::Radian)
+        });
+    }
+    auto found = std::vector<playrho::d2::Fixture*>{};
+    const auto collect = [&](playrho::d2::Fixture* fixture, playrho::ChildCounter) {
+        found.push_back(fixture);
+        return true;
+    };
+    for (auto _: state)
+    {
+        for (auto i = std::size_t{0}; i < size(xfs); ++i)
+        {
+            const auto& proxy = proxies[i % size(proxies)];
+            const auto& xf = xfs[i];
+            found.clear();
+            if (viaTestOverlap)
+            {
+                playrho::d2::Query(world, playrho::d2::ComputeAABB(proxy, xf),
+                                   [&](playrho::d2::Fixture* fixture, playrho::ChildCounter child) {
+                    const auto other = playrho::d2::GetChild(fixture->GetShape(), child);
+                    if (playrho::d2::TestOverlap(proxy, xf, other, playrho::d2::GetTransformation(*fixture))
+                        >= 0 * playrho::SquareMeter)
+                    {
+                        found.push_back(fixture);
+                    }
+                    return true;
+                });
+            }
+            else
+            {
+                playrho::d2::QueryOverlap(world, proxy, xf, collect);
+            }
+            benchmark::DoNotOptimize(found.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(xfs)));
+}
+
+static void QueryOverlapViaTestOverlap(benchmark::State& state)
+{
+    QueryOverlap(state, true);
+}
+
+static void QueryOverlapDirect(benchmark::State& state)
+{
+    QueryOverlap(state, false);
+}
+
+/// Calculates the manifolds of two disks at 100 random nearby positions either through the
+/// children of the shapes or through the dispatch table of the kinds of the shapes.
+/// @note Disk-disk is the only pair the dispatch table has a calculation of its own for.
+static void CollideShapePair(benchmark::State& state, bool viaDispatch)
+{
+    const auto radius = 0.5f * playrho::Meter;
+    const auto shapeA = playrho::d2::Shape{playrho::d2::DiskShapeConf{}.UseRadius(radius)};
+    const auto shapeB = shapeA;
+    const auto xfA = playrho::d2::Transformation{};
+    auto xfs = std::vector<playrho::d2::Transformation>{};
+    for (auto i = 0; i < 100; ++i)
+    {
+        xfs.push_back(playrho::d2::Transformation{
+            playrho::Length2{Rand(-1.5f, 1.5f) * playrho::Meter, Rand(-1.0f, 1.0f) * playrho::Meter},
+            playrho::d2::UnitVec::Get(Rand(0.0f, 6.0f) * playrho::Radian)
+        });
+    }
+    const auto collide = playrho::d2::GetCollideShapesFunction(playrho::d2::GetShapeKind(shapeA),
+                                                               playrho::d2::GetShapeKind(shapeB));
+    const auto conf = playrho::d2::GetDefaultManifoldConf();
+    for (auto _: state)
+    {
+        for (auto i = std::size_t{0}; i < size(xfs); ++i)
+        {
+            if (viaDispatch)
+            {
+                benchmark::DoNotOptimize(collide(shapeA, 0, xfA, shapeB, 0, xfs[i], conf));
+            }
+            else
+            {
+                benchmark::DoNotOptimize(playrho::d2::CollideShapes(
+                    playrho::d2::GetChild(shapeA, 0), xfA,
+                    playrho::d2::GetChild(shapeB, 0), xfs[i], conf));
+            }
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size(xfs)));
+}
+
+static void CollideShapePairViaChildren(benchmark::State& state)
+{
+    CollideShapePair(state, false);
+}
+
+static void CollideShapePairViaDispatch(benchmark::State& state)
+{
+    CollideShapePair(state, true);
+}
+
+static void AddPairStressTestPlayRho(benchmark::State& state, int count,
+                                     playrho::d2::BroadPhaseType broadPhase =
+                                         playrho::d2::BroadPhaseType::DynamicTree)
 {
     const auto diskConf = playrho::d2::DiskShapeConf{}
         .UseRadius(playrho::Meter / 10)
@@ -1973,7 +2838,8 @@ static void AddPairStressTestPlayRho(benchmark::State& state, int count)
     constexpr auto linearSlop = 0.005f * playrho::Meter;
     constexpr auto angularSlop = (2.0f / 180.0f * playrho::Pi) * playrho::Radian;
 
-    const auto worldConf = playrho::d2::WorldConf{/* zero G */}.UseInitialTreeSize(8192);
+    const auto worldConf = playrho::d2::WorldConf{/* zero G */}.UseInitialTreeSize(8192)
+        .UseBroadPhase(broadPhase);
     auto stepConf = playrho::StepConf{};
     stepConf.SetTime(playrho::Second / 60);
     stepConf.linearSlop = linearSlop;
@@ -2023,6 +2889,11 @@ static void AddPairStressTestPlayRho400(benchmark::State& state)
     AddPairStressTestPlayRho(state, 400);
 }
 
+static void AddPairStressTestPlayRhoSAP400(benchmark::State& state)
+{
+    AddPairStressTestPlayRho(state, 400, playrho::d2::BroadPhaseType::SweepAndPrune);
+}
+
 #ifdef BENCHMARK_BOX2D
 static void AddPairStressTestBox2D(benchmark::State& state, int count)
 {
@@ -2074,7 +2945,9 @@ static void AddPairStressTestBox2D400(benchmark::State& state)
 }
 #endif // BENCHMARK_BOX2D
 
-static void DropTilesPlayRho(int count)
+static void DropTilesPlayRho(int count, playrho::d2::BroadPhaseType broadPhase =
+                                 playrho::d2::BroadPhaseType::DynamicTree,
+                             bool doSepAxisCaching = true)
 {
     constexpr auto linearSlop = 0.005f * playrho::Meter;
     constexpr auto angularSlop = (2.0f / 180.0f * playrho::Pi) * playrho::Radian;
@@ -2085,6 +2958,7 @@ static void DropTilesPlayRho(int count)
     auto conf = playrho::d2::PolygonShapeConf{}.UseVertexRadius(vertexRadius);
     auto world = playrho::d2::World{
         playrho::d2::WorldConf{}.UseMinVertexRadius(vertexRadius).UseInitialTreeSize(8192)
+            .UseBroadPhase(broadPhase)
     };
     
     {
@@ -2152,6 +3026,7 @@ static void DropTilesPlayRho(int count)
     step.maxTranslation = 2.0f * playrho::Meter;
     step.velocityThreshold = 1.0f * playrho::MeterPerSecond;
     step.maxSubSteps = std::uint8_t{8};
+    step.doSepAxisCaching = doSepAxisCaching;
 
     while (GetAwakeCount(world) > 0)
     {
@@ -2245,6 +3120,24 @@ static void TilesRestPlayRho(benchmark::State& state)
     }
 }
 
+static void TilesRestPlayRhoSAP(benchmark::State& state)
+{
+    const auto range = state.range();
+    for (auto _: state)
+    {
+        DropTilesPlayRho(range, playrho::d2::BroadPhaseType::SweepAndPrune);
+    }
+}
+
+static void TilesRestPlayRhoNoSepAxisCache(benchmark::State& state)
+{
+    const auto range = state.range();
+    for (auto _: state)
+    {
+        DropTilesPlayRho(range, playrho::d2::BroadPhaseType::DynamicTree, false);
+    }
+}
+
 #ifdef BENCHMARK_BOX2D
 static void TilesRestBox2D(benchmark::State& state)
 {
@@ -2453,6 +3346,17 @@ BENCHMARK(LengthIntervalIsIntersecting)->Arg(1000);
 BENCHMARK(AabbTestOverlap)->Arg(1000);
 BENCHMARK(AabbContains)->Arg(1000);
 BENCHMARK(AABB)->Arg(1000);
+
+BENCHMARK(DynamicTreeQuery)->Arg(1000)->Arg(100000);
+BENCHMARK(DynamicTreeQueryFilteredByCategory)->Arg(1000)->Arg(100000);
+BENCHMARK(DynamicTreeQueryMaskedByCategory)->Arg(1000)->Arg(100000);
+BENCHMARK(DynamicTreeBatchedQuery)->Args({1000, 1})->Args({100000, 1})->Args({100000, 4})->UseRealTime();
+BENCHMARK(CompactTreeQueryExact)->Arg(1000)->Arg(100000);
+BENCHMARK(CompactTreeQueryQuantized)->Arg(1000)->Arg(100000);
+BENCHMARK(WideTreeQuery)->Arg(1000)->Arg(100000);
+BENCHMARK(DynamicTreeRebuildTopDown)->Args({100000, 1})->Args({100000, 4})->UseRealTime();
+BENCHMARK(DynamicTreeRayCast)->Arg(1000)->Arg(100000);
+BENCHMARK(WideTreeRayCast)->Arg(1000)->Arg(100000);
 // BENCHMARK(malloc_free_random_size);
 
 // BENCHMARK(MaxSepBetweenAbsSquares);
@@ -2484,6 +3388,25 @@ BENCHMARK(WorldStepWithStatsStatic)->Arg(0)->Arg(1)->Arg(10)->Arg(100)->Arg(1000
 //BENCHMARK(WorldStepWithStatsDynamicBodies)->Arg(0)->Arg(1)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000)->Repetitions(4);
 
 BENCHMARK(DropDisks)->Arg(0)->Arg(1)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK(ContactPile)->Args({1000, 1})->Args({10000, 1})->Args({10000, 2})->Args({10000, 4});
+BENCHMARK(OctagonDrift)->Arg(1000)->Arg(10000);
+BENCHMARK(DiskCrowdTree)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK(DiskCrowdGrid)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK(FindClosestFixturesBruteForce)->Args({1000, 1})->Args({1000, 8});
+BENCHMARK(FindClosestFixturesViaTree)->Args({1000, 1})->Args({1000, 8})->Args({10000, 1})->Args({10000, 8});
+BENCHMARK(RayCastClosestViaCallback)->Arg(1000)->Arg(10000);
+BENCHMARK(RayCastClosestFrontToBack)->Arg(1000)->Arg(10000);
+BENCHMARK(RayCastFanPerRay)->Arg(64)->Arg(256);
+BENCHMARK(RayCastFanAsPacket)->Arg(64)->Arg(256);
+BENCHMARK(ShapeCastViaOverlapBisection);
+BENCHMARK(ShapeCastViaToi);
+BENCHMARK(ManyVerticesDistance)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(128);
+BENCHMARK(ManyVerticesToi)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(128);
+BENCHMARK(ManyVerticesRayCast)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(128);
+BENCHMARK(QueryOverlapViaTestOverlap);
+BENCHMARK(QueryOverlapDirect);
+BENCHMARK(CollideShapePairViaChildren);
+BENCHMARK(CollideShapePairViaDispatch);
 
 // BENCHMARK(random_malloc_free_100);
 
@@ -2491,11 +3414,14 @@ BENCHMARK(TumblerAdd100SquaresPlus100Steps);
 BENCHMARK(TumblerAdd200SquaresPlus200Steps);
 
 BENCHMARK(AddPairStressTestPlayRho400)->Arg(0)->Arg(10)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19)->Arg(20)->Arg(30);
+BENCHMARK(AddPairStressTestPlayRhoSAP400)->Arg(0)->Arg(10)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19)->Arg(20)->Arg(30);
 #ifdef BENCHMARK_BOX2D
 BENCHMARK(AddPairStressTestBox2D400)->Arg(0)->Arg(10)->Arg(15)->Arg(16)->Arg(17)->Arg(18)->Arg(19)->Arg(20)->Arg(30);
 #endif // BENCHMARK_BOX2D
 
 BENCHMARK(TilesRestPlayRho)->Arg(12)->Arg(20)->Arg(36);
+BENCHMARK(TilesRestPlayRhoSAP)->Arg(12)->Arg(20)->Arg(36);
+BENCHMARK(TilesRestPlayRhoNoSepAxisCache)->Arg(12)->Arg(20)->Arg(36);
 #ifdef BENCHMARK_BOX2D
 BENCHMARK(TilesRestBox2D)->Arg(12)->Arg(20)->Arg(36);
 #endif // BENCHMARK_BOX2D
@@ -240,6 +240,24 @@ PLAYRHO_CONSTEXPR inline Vector<Length, N> GetExtents(const AABB<N>& aabb) noexc
     return GetDimensions(aabb) * RealInverseOfTwo;
 }
 
+/// @brief Gets the square of the distance from the given point to the given AABB.
+/// @note This is zero for points within the AABB.
+/// @relatedalso AABB
+template <std::size_t N>
+PLAYRHO_CONSTEXPR inline Area GetDistanceSquared(const AABB<N>& aabb,
+                                                 const Vector<Length, N>& point) noexcept
+{
+    auto result = Area{0};
+    for (auto i = decltype(N){0}; i < N; ++i)
+    {
+        const auto& range = aabb.ranges[i];
+        const auto delta = (point[i] < range.GetMin())? range.GetMin() - point[i]:
+            (point[i] > range.GetMax())? point[i] - range.GetMax(): Length{0};
+        result += delta * delta;
+    }
+    return result;
+}
+
 /// @brief Checks whether the first AABB fully contains the second AABB.
 /// @details Whether the first AABB contains the entirety of the second AABB where
 ///   containment is defined as being equal-to or within an AABB.
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <PlayRho/Collision/CompactTree.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace playrho {
+namespace d2 {
+
+namespace {
+
+/// @brief Maximum quantized coordinate value.
+PLAYRHO_CONSTEXPR const auto MaxQuantizedCoord = std::numeric_limits<CompactTree::QuantizedCoord>::max();
+
+/// @brief Quantizes the given value rounding down.
+inline CompactTree::QuantizedCoord QuantizeDown(double value) noexcept
+{
+    return static_cast<CompactTree::QuantizedCoord>(std::floor(std::min(std::max(value, 0.0),
+                                                                        double{MaxQuantizedCoord})));
+}
+
+/// @brief Quantizes the given value rounding up.
+inline CompactTree::QuantizedCoord QuantizeUp(double value) noexcept
+{
+    return static_cast<CompactTree::QuantizedCoord>(std::ceil(std::min(std::max(value, 0.0),
+                                                                       double{MaxQuantizedCoord})));
+}
+
+} // anonymous namespace
+
+CompactTree::CompactTree(const DynamicTree& tree, Bounds bounds):
+    m_boundsOption{bounds}
+{
+    const auto root = tree.GetRootIndex();
+    if (root == DynamicTree::GetInvalidSize())
+    {
+        return;
+    }
+
+    const auto nodeCount = tree.GetNodeCount();
+    m_aabbs.reserve(nodeCount);
+    m_escapes.reserve(nodeCount);
+    m_leaves.reserve(nodeCount);
+    m_rootAABB = tree.GetAABB(root);
+    for (auto i = 0u; i < 2u; ++i)
+    {
+        const auto extent = static_cast<double>(StripUnit(GetSize(m_rootAABB.ranges[i])));
+        m_scales[i] = (extent > 0)? double{MaxQuantizedCoord} / extent: 0.0;
+    }
+
+    Append(tree, root);
+
+    if (bounds == Bounds::Quantized)
+    {
+        m_quantizedAABBs.reserve(size(m_aabbs));
+        for (const auto& aabb: m_aabbs)
+        {
+            // Every node's AABB is within the root AABB so always quantizes.
+            m_quantizedAABBs.push_back(*Quantize(aabb));
+        }
+    }
+}
+
+void CompactTree::Append(const DynamicTree& tree, DynamicTree::Size index)
+{
+    const auto position = size(m_escapes);
+    m_aabbs.push_back(tree.GetAABB(index));
+    m_escapes.push_back(static_cast<Size>(position + 1));
+    if (DynamicTree::IsBranch(tree.GetHeight(index)))
+    {
+        m_leaves.push_back(DynamicTree::GetInvalidSize());
+        
+        // Appends the second child first so traversal visits leaves in the same order as
+        // the dynamic tree's stack based traversal does.
+        const auto branchData = tree.GetBranchData(index);
+        Append(tree, branchData.child2);
+        Append(tree, branchData.child1);
+        m_escapes[position] = static_cast<Size>(size(m_escapes));
+    }
+    else
+    {
+        assert(DynamicTree::IsLeaf(tree.GetHeight(index)));
+        m_leaves.push_back(index);
+        ++m_leafCount;
+    }
+}
+
+Optional<CompactTree::QuantizedAABB> CompactTree::Quantize(const AABB& aabb) const noexcept
+{
+    if (m_escapes.empty() || !TestOverlap(m_rootAABB, aabb))
+    {
+        return Optional<QuantizedAABB>{};
+    }
+    auto result = QuantizedAABB{};
+    for (auto i = 0u; i < 2u; ++i)
+    {
+        // Quantizing is monotonic so overlapping AABBs always quantize to overlapping AABBs.
+        const auto base = m_rootAABB.ranges[i].GetMin();
+        const auto lower = static_cast<double>(StripUnit(aabb.ranges[i].GetMin() - base));
+        const auto upper = static_cast<double>(StripUnit(aabb.ranges[i].GetMax() - base));
+        result[i] = QuantizeDown(lower * m_scales[i]);
+        result[i + 2] = QuantizeUp(upper * m_scales[i]);
+    }
+    return Optional<QuantizedAABB>{result};
+}
+
+void Query(const CompactTree& tree, const AABB& aabb, const DynamicTreeSizeCB& callback)
+{
+    const auto nodeCount = tree.GetNodeCount();
+    if (tree.GetBounds() == CompactTree::Bounds::Quantized)
+    {
+        const auto quantizedAABB = tree.Quantize(aabb);
+        if (!quantizedAABB.has_value())
+        {
+            return;
+        }
+        auto index = CompactTree::Size{0};
+        while (index < nodeCount)
+        {
+            if (TestOverlap(tree.GetQuantizedAABB(index), *quantizedAABB))
+            {
+                if (IsLeaf(tree, index) && TestOverlap(tree.GetAABB(index), aabb))
+                {
+                    if (callback(tree.GetLeaf(index)) == DynamicTreeOpcode::End)
+                    {
+                        return;
+                    }
+                }
+                ++index;
+            }
+            else
+            {
+                index = tree.GetEscapeIndex(index);
+            }
+        }
+        return;
+    }
+
+    auto index = CompactTree::Size{0};
+    while (index < nodeCount)
+    {
+        if (TestOverlap(tree.GetAABB(index), aabb))
+        {
+            if (IsLeaf(tree, index))
+            {
+                if (callback(tree.GetLeaf(index)) == DynamicTreeOpcode::End)
+                {
+                    return;
+                }
+            }
+            ++index;
+        }
+        else
+        {
+            index = tree.GetEscapeIndex(index);
+        }
+    }
+}
+
+} // namespace d2
+} // namespace playrho
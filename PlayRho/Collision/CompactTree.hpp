@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PLAYRHO_COLLISION_COMPACTTREE_HPP
+#define PLAYRHO_COLLISION_COMPACTTREE_HPP
+
+/// @file
+/// Declaration of the <code>CompactTree</code> class.
+
+#include <PlayRho/Collision/DynamicTree.hpp>
+#include <PlayRho/Common/OptionalValue.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace playrho {
+namespace d2 {
+
+/// @brief A compact copy of a dynamic tree's hierarchy laid out for fast traversal.
+///
+/// @details This stores the nodes of a <code>DynamicTree</code> in depth-first order in
+///   separate arrays for bounds and for topology. Since a branch's first child then always
+///   immediately follows it, the only topology each node needs is the index of the node
+///   following its sub-tree (its "escape" index). Queries walk these arrays from front to
+///   back without needing a stack, and they touch far fewer cache lines than traversing the
+///   node pool of a <code>DynamicTree</code> does. The leaf data is kept in the dynamic
+///   tree that this was made from and is only identified here by that tree's leaf indices.
+///
+/// @note The bounds can optionally also be stored quantized to 16-bits per coordinate
+///   relative to the AABB of the whole tree. This halves the bounds data for 4-byte
+///   <code>Real</code> and quarters it for 8-byte <code>Real</code>. Quantized bounds are
+///   rounded outward so traversal stays conservative, and leaves are confirmed against
+///   their exact bounds before being reported, so results are the same either way.
+/// @note This is a snapshot. It doesn't reflect changes made to the dynamic tree it was
+///   made from after it was made.
+///
+/// @sa DynamicTree.
+///
+class CompactTree
+{
+public:
+    /// @brief Size type.
+    using Size = DynamicTree::Size;
+
+    /// @brief Quantized coordinate type.
+    using QuantizedCoord = std::uint16_t;
+
+    /// @brief Quantized AABB type.
+    /// @details Quantized lower X, lower Y, upper X, and upper Y values, in that order.
+    using QuantizedAABB = std::array<QuantizedCoord, 4>;
+
+    /// @brief Bounds storage options.
+    enum class Bounds: std::uint8_t
+    {
+        Exact, ///< Traverses the full precision AABBs.
+        Quantized, ///< Traverses the quantized AABBs.
+    };
+
+    /// @brief Default constructor.
+    /// @details Constructs an empty tree.
+    CompactTree() = default;
+
+    /// @brief Initializing constructor.
+    /// @details Constructs a compact copy of the given dynamic tree's hierarchy.
+    explicit CompactTree(const DynamicTree& tree, Bounds bounds = Bounds::Exact);
+
+    /// @brief Gets the bounds storage option this tree was constructed with.
+    Bounds GetBounds() const noexcept
+    {
+        return m_boundsOption;
+    }
+
+    /// @brief Gets the count of nodes (branches and leaves) in this tree.
+    Size GetNodeCount() const noexcept
+    {
+        return static_cast<Size>(m_escapes.size());
+    }
+
+    /// @brief Gets the count of leaves in this tree.
+    Size GetLeafCount() const noexcept
+    {
+        return m_leafCount;
+    }
+
+    /// @brief Gets the full precision AABB of the node at the given index.
+    /// @warning Behavior is undefined if the given index is not less than the node count.
+    AABB GetAABB(Size index) const noexcept
+    {
+        assert(index < GetNodeCount());
+        return m_aabbs[index];
+    }
+
+    /// @brief Gets the quantized AABB of the node at the given index.
+    /// @warning Behavior is undefined if this tree wasn't constructed with quantized bounds
+    ///   or if the given index is not less than the node count.
+    QuantizedAABB GetQuantizedAABB(Size index) const noexcept
+    {
+        assert(index < m_quantizedAABBs.size());
+        return m_quantizedAABBs[index];
+    }
+
+    /// @brief Gets the index of the node following the sub-tree of the node at the given index.
+    /// @note This is one more than the given index for leaf nodes.
+    /// @warning Behavior is undefined if the given index is not less than the node count.
+    Size GetEscapeIndex(Size index) const noexcept
+    {
+        assert(index < GetNodeCount());
+        return m_escapes[index];
+    }
+
+    /// @brief Gets the dynamic tree leaf index of the node at the given index.
+    /// @return Index of the leaf in the dynamic tree this was made from, or
+    ///   <code>DynamicTree::GetInvalidSize()</code> if the node is a branch.
+    /// @warning Behavior is undefined if the given index is not less than the node count.
+    Size GetLeaf(Size index) const noexcept
+    {
+        assert(index < GetNodeCount());
+        return m_leaves[index];
+    }
+
+    /// @brief Quantizes the given AABB into this tree's quantized space.
+    /// @details Rounds outward so the result covers at least the given AABB.
+    /// @return Quantized AABB or an empty value if the given AABB doesn't overlap this tree.
+    Optional<QuantizedAABB> Quantize(const AABB& aabb) const noexcept;
+
+private:
+    /// @brief Adds the sub-tree of the given tree at the given index to this tree.
+    void Append(const DynamicTree& tree, DynamicTree::Size index);
+
+    std::vector<AABB> m_aabbs; ///< Full precision AABBs in depth-first order.
+    std::vector<QuantizedAABB> m_quantizedAABBs; ///< Quantized AABBs in depth-first order.
+    std::vector<Size> m_escapes; ///< Escape indices in depth-first order.
+    std::vector<Size> m_leaves; ///< Dynamic tree leaf indices in depth-first order.
+    AABB m_rootAABB; ///< AABB of the whole tree.
+    std::array<double, 2> m_scales{{0, 0}}; ///< Scales for quantizing X and Y coordinates.
+    Size m_leafCount = 0; ///< Count of leaf nodes.
+    Bounds m_boundsOption = Bounds::Exact; ///< Bounds storage option.
+};
+
+/// @brief Whether the given node of the given compact tree is a leaf.
+/// @relatedalso CompactTree
+inline bool IsLeaf(const CompactTree& tree, CompactTree::Size index) noexcept
+{
+    return tree.GetEscapeIndex(index) == (index + 1);
+}
+
+/// @brief Tests the given quantized AABBs for overlap.
+/// @relatedalso CompactTree
+PLAYRHO_CONSTEXPR inline bool TestOverlap(const CompactTree::QuantizedAABB& a,
+                                          const CompactTree::QuantizedAABB& b) noexcept
+{
+    return (a[0] <= b[2]) && (b[0] <= a[2]) && (a[1] <= b[3]) && (b[1] <= a[3]);
+}
+
+/// @brief Queries the given compact tree for leaves overlapping the given AABB.
+/// @note The callback is called with the same dynamic tree leaf indices, and in the same
+///   order, regardless of the bounds storage option the compact tree was made with.
+/// @relatedalso CompactTree
+void Query(const CompactTree& tree, const AABB& aabb, const DynamicTreeSizeCB& callback);
+
+/// @brief Gets the "size" of the given tree.
+/// @note Size in this context is defined as the leaf count.
+/// @relatedalso CompactTree
+inline std::size_t size(const CompactTree& tree) noexcept
+{
+    return tree.GetLeafCount();
+}
+
+} // namespace d2
+} // namespace playrho
+
+#endif // PLAYRHO_COLLISION_COMPACTTREE_HPP
@@ -20,6 +20,7 @@
 #include <PlayRho/Collision/Distance.hpp>
 #include <PlayRho/Collision/DistanceProxy.hpp>
 #include <PlayRho/Collision/Simplex.hpp>
+#include <PlayRho/Collision/ShapeSeparation.hpp>
 #include <PlayRho/Collision/TimeOfImpact.hpp>
 
 namespace playrho {
@@ -214,12 +215,31 @@ DistanceOutput Distance(const DistanceProxy& proxyA, const Transformation& trans
     return DistanceOutput{simplex, iter, state};
 }
 
+Length GetDistance(const DistanceProxy& proxy, const Transformation& transform, Length2 point,
+                   DistanceConf conf)
+{
+    const auto pointProxy = DistanceProxy{0_m, 1, &point, nullptr};
+    const auto distanceInfo = Distance(proxy, transform, pointProxy, Transform_identity, conf);
+    const auto witnessPoints = GetWitnessPoints(distanceInfo.simplex);
+    const auto distance = GetMagnitude(GetDelta(witnessPoints)) - proxy.GetVertexRadius();
+    return std::max(distance, 0_m);
+}
+
 Area TestOverlap(const DistanceProxy& proxyA, const Transformation& xfA,
                  const DistanceProxy& proxyB, const Transformation& xfB,
                  DistanceConf conf)
 {
+    return TestOverlap(proxyA, xfA, proxyB, xfB, conf.cache, conf);
+}
+
+Area TestOverlap(const DistanceProxy& proxyA, const Transformation& xfA,
+                 const DistanceProxy& proxyB, const Transformation& xfB,
+                 Simplex::Cache& cache, DistanceConf conf)
+{
+    conf.cache = cache;
     const auto distanceInfo = Distance(proxyA, xfA, proxyB, xfB, conf);
     assert(distanceInfo.state != DistanceOutput::Unknown && distanceInfo.state != DistanceOutput::HitMaxIters);
+    cache = Simplex::GetCache(distanceInfo.simplex.GetEdges());
     
     const auto witnessPoints = GetWitnessPoints(distanceInfo.simplex);
     const auto distanceSquared = GetMagnitudeSquared(GetDelta(witnessPoints));
@@ -227,5 +247,100 @@ Area TestOverlap(const DistanceProxy& proxyA, const Transformation& xfA,
     return totalRadiusSquared - distanceSquared;
 }
 
+Length GetSeparation(Area overlap, Length totalRadius) noexcept
+{
+    return sqrt(std::max(Square(totalRadius) - overlap, 0_m2)) - totalRadius;
+}
+
+namespace {
+
+/// @brief Determines whether a disk of the given radius at the given location touches or
+///   overlaps the given polygon.
+bool IsOverlapping(const DistanceProxy& polygon, const Transformation& xf,
+                   Length2 location, Length radius)
+{
+    const auto center = InverseTransform(location, xf);
+    const auto totalRadius = polygon.GetVertexRadius() + radius;
+    const auto count = polygon.GetVertexCount();
+    
+    // Finds the edge having the max separation from the center.
+    auto separation = -std::numeric_limits<Length>::infinity();
+    auto index = VertexCounter{0};
+    for (auto i = VertexCounter{0}; i < count; ++i)
+    {
+        const auto s = Dot(polygon.GetNormal(i), center - polygon.GetVertex(i));
+        if (s > totalRadius)
+        {
+            return false;
+        }
+        if (separation < s)
+        {
+            separation = s;
+            index = i;
+        }
+    }
+    if (separation <= 0_m)
+    {
+        return true; // Center is within the core polygon.
+    }
+    
+    // Center is outside the core polygon so the closest point is on the edge found.
+    const auto v1 = polygon.GetVertex(index);
+    const auto edge = polygon.GetVertex(GetModuloNext(index, count)) - v1;
+    const auto edgeLengthSquared = GetMagnitudeSquared(edge);
+    auto closest = v1;
+    if (edgeLengthSquared > 0_m2)
+    {
+        const auto t = std::max(Real{0}, std::min(Real{1},
+                                Real{Dot(center - v1, edge) / edgeLengthSquared}));
+        closest = v1 + edge * t;
+    }
+    return GetMagnitudeSquared(center - closest) <= Square(totalRadius);
+}
+
+} // anonymous namespace
+
+bool IsOverlapping(const DistanceProxy& proxyA, const Transformation& xfA,
+                   const DistanceProxy& proxyB, const Transformation& xfB)
+{
+    const auto countA = proxyA.GetVertexCount();
+    const auto countB = proxyB.GetVertexCount();
+    if (countA == 1)
+    {
+        const auto locationA = Transform(proxyA.GetVertex(0), xfA);
+        if (countB == 1)
+        {
+            const auto totalRadius = proxyA.GetVertexRadius() + proxyB.GetVertexRadius();
+            const auto locationB = Transform(proxyB.GetVertex(0), xfB);
+            return GetMagnitudeSquared(locationA - locationB) <= Square(totalRadius);
+        }
+        return IsOverlapping(proxyB, xfB, locationA, proxyA.GetVertexRadius());
+    }
+    if (countB == 1)
+    {
+        return IsOverlapping(proxyA, xfA, Transform(proxyB.GetVertex(0), xfB),
+                             proxyB.GetVertexRadius());
+    }
+    
+    const auto totalRadius = proxyA.GetVertexRadius() + proxyB.GetVertexRadius();
+    const auto separationA = GetMaxSeparation(proxyA, xfA, proxyB, xfB, totalRadius).distance;
+    if (separationA > totalRadius)
+    {
+        return false;
+    }
+    const auto separationB = GetMaxSeparation(proxyB, xfB, proxyA, xfA, totalRadius).distance;
+    if (separationB > totalRadius)
+    {
+        return false;
+    }
+    if (std::max(separationA, separationB) <= 0_m)
+    {
+        return true; // Core polygons overlap.
+    }
+    
+    // Separation along the normals only bounds the distance between rounded corners.
+    return TestOverlap(proxyA, xfA, proxyB, xfB) >= 0_m2;
+}
+
 } // namespace d2
 } // namespace playrho
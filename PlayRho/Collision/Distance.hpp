@@ -97,6 +97,17 @@ DistanceOutput Distance(const DistanceProxy& proxyA, const Transformation& trans
                         const DistanceProxy& proxyB, const Transformation& transformB,
                         DistanceConf conf = DistanceConf{});
 
+/// @brief Gets the distance from the given point to the given shape child.
+/// @param proxy Proxy of the shape child.
+/// @param transform Transform of the shape child.
+/// @param point Point in the same coordinate space as the transformed shape child.
+/// @param conf Configuration to use for determining the distance.
+/// @return Zero if the point is within the shape child, else the distance from the point
+///   to the closest point of the shape child including its vertex radius.
+/// @relatedalso DistanceProxy
+Length GetDistance(const DistanceProxy& proxy, const Transformation& transform, Length2 point,
+                   DistanceConf conf = DistanceConf{});
+
 /// @brief Determine if two generic shapes overlap.
 ///
 /// @note The returned touching state information typically agrees with that returned from
@@ -107,6 +118,38 @@ Area TestOverlap(const DistanceProxy& proxyA, const Transformation& xfA,
                  const DistanceProxy& proxyB, const Transformation& xfB,
                  DistanceConf conf = DistanceConf{});
 
+/// @brief Determine if two generic shapes overlap warm starting from the given simplex cache.
+/// @details Same as the other <code>TestOverlap</code> function except that it starts from
+///   the given cache instead of the configuration's cache and sets the given cache to that
+///   of the resulting simplex. For shapes whose cache is kept from one call to the next,
+///   the distance calculation usually takes just one or two iterations.
+/// @sa Distance.
+Area TestOverlap(const DistanceProxy& proxyA, const Transformation& xfA,
+                 const DistanceProxy& proxyB, const Transformation& xfB,
+                 Simplex::Cache& cache, DistanceConf conf = DistanceConf{});
+
+/// @brief Gets the separation of two shapes from the value returned for them from
+///   <code>TestOverlap</code>.
+/// @param overlap Value returned from <code>TestOverlap</code> for the two shapes.
+/// @param totalRadius Sum of the vertex radii of the two shapes.
+/// @return Distance between the two shapes beyond their total vertex radius. This is
+///   negative if the shapes overlap.
+/// @sa TestOverlap.
+Length GetSeparation(Area overlap, Length totalRadius) noexcept;
+
+/// @brief Determines whether the two given convex shapes touch or overlap.
+/// @details Directly compares the distance between the centers of two disks and between
+///   a disk's center and the closest edge of a polygon. Uses the separating axis theorem
+///   for two polygons and only calls <code>TestOverlap</code> when neither their cores
+///   overlap nor are they separated by more than their total vertex radius along any
+///   of their normals.
+/// @note This is faster than calling <code>TestOverlap</code> for disks and boxes.
+/// @return Whether <code>TestOverlap</code> of the shapes is not less than zero, except
+///   when the shapes are touching or close to it to within numerical precision.
+/// @sa TestOverlap.
+bool IsOverlapping(const DistanceProxy& proxyA, const Transformation& xfA,
+                   const DistanceProxy& proxyB, const Transformation& xfB);
+
 } // namespace d2
 } // namespace playrho
 
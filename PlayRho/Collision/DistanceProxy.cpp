@@ -38,6 +38,82 @@ bool operator== (const DistanceProxy& lhs, const DistanceProxy& rhs) noexcept
     return std::equal(cbegin(lhr), cend(lhr), cbegin(rhr), cend(rhr));
 }
 
+namespace {
+
+/// @brief Gets whether the angle of the given vector is less than that of the other given
+///   vector where the angles are counter-clockwise from the given reference direction.
+/// @note The reference direction has the least angle. The zero vector has the same.
+inline bool IsAngleLess(Vec2 ref, Vec2 lhs, Vec2 rhs) noexcept
+{
+    const auto getHalf = [ref](Vec2 v) {
+        const auto c = Cross(ref, v);
+        return ((c > 0) || ((c == 0) && (Dot(ref, v) >= 0)))? 0: 1;
+    };
+    const auto lhsHalf = getHalf(lhs);
+    const auto rhsHalf = getHalf(rhs);
+    return (lhsHalf != rhsHalf)? (lhsHalf < rhsHalf): (Cross(lhs, rhs) > 0);
+}
+
+} // anonymous namespace
+
+VertexCounter GetSupportIndexBySearch(const DistanceProxy& proxy, Vec2 dir) noexcept
+{
+    const auto count = proxy.GetVertexCount();
+    assert(count > 1);
+    if (!IsValid(dir))
+    {
+        return InvalidVertex;
+    }
+
+    // Vertex i is between normals i - 1 and i so finds the first normal whose angle
+    // isn't less than that of the direction. Vertex 0 is supporting if there's none.
+    const auto ref = GetVec2(proxy.GetNormal(0));
+    auto first = VertexCounter{0};
+    auto last = count;
+    while (first < last)
+    {
+        const auto mid = static_cast<VertexCounter>((first + last) / 2);
+        if (IsAngleLess(ref, GetVec2(proxy.GetNormal(mid)), dir))
+        {
+            first = static_cast<VertexCounter>(mid + 1);
+        }
+        else
+        {
+            last = mid;
+        }
+    }
+    auto index = (first < count)? first: VertexCounter{0};
+
+    // Climbs past any vertex that rounding of the normals or direction misplaced the search by.
+    const auto getValue = [&](VertexCounter i) { return Dot(proxy.GetVertex(i), dir); };
+    auto value = getValue(index);
+    for (auto next = GetModuloNext(index, count); getValue(next) > value;
+         next = GetModuloNext(index, count))
+    {
+        index = next;
+        value = getValue(index);
+    }
+    for (auto prev = GetModuloPrev(index, count); getValue(prev) > value;
+         prev = GetModuloPrev(index, count))
+    {
+        index = prev;
+        value = getValue(index);
+    }
+
+    // Like checking every vertex, gets the lowest index of any other vertex that's as supporting.
+    const auto next = GetModuloNext(index, count);
+    if ((next < index) && (getValue(next) == value))
+    {
+        index = next;
+    }
+    const auto prev = GetModuloPrev(index, count);
+    if ((prev < index) && (getValue(prev) == value))
+    {
+        index = prev;
+    }
+    return index;
+}
+
 std::size_t FindLowestRightMostVertex(Span<const Length2> vertices)
 {
     if (const auto numVertices = size(vertices); numVertices > 0)
@@ -207,9 +207,28 @@ namespace d2 {
         return arg.GetVertexRadius();
     }
     
+    /// @brief Least count of vertices of distance proxies whose supporting vertices get found
+    ///   by searching their normals instead of by checking every vertex.
+    /// @note Searching takes about as long as checking every vertex for 16 vertices.
+    /// @sa GetSupportIndex.
+    PLAYRHO_CONSTEXPR const auto MinSupportSearchVertices = VertexCounter{24};
+
+    /// @brief Gets the supporting vertex index in the given direction for the given distance
+    ///   proxy by searching its normals.
+    /// @details Binary searches the normals for the two that the given direction is between.
+    ///   These are ordered by angle since the vertices are those of a convex polygon in
+    ///   counter-clockwise order. Then climbs to whichever adjacent vertex is more in the given
+    ///   direction until neither is. This takes logarithmic time in the count of vertices.
+    /// @note This returns the same index that checking every vertex does.
+    /// @warning Behavior is undefined if the proxy has less than two vertices.
+    /// @sa GetSupportIndex.
+    /// @relatedalso DistanceProxy
+    VertexCounter GetSupportIndexBySearch(const DistanceProxy& proxy, Vec2 dir) noexcept;
+
     /// @brief Gets the supporting vertex index in the given direction for the given distance proxy.
     /// @details This finds the vertex that's most significantly in the direction of the given
-    ///   vector and returns its index.
+    ///   vector and returns its index. Proxies having at least
+    ///   <code>MinSupportSearchVertices</code> vertices get this by searching their normals.
     /// @note 0 is returned for a given zero length direction vector.
     /// @param proxy Distance proxy object to find index in if a valid index exists for it.
     /// @param dir Direction vector to find index for.
@@ -223,6 +242,11 @@ namespace d2 {
         using VT = typename T::value_type;
         using OT = decltype(VT{} * 0_m);
 
+        if (proxy.GetVertexCount() >= MinSupportSearchVertices)
+        {
+            return GetSupportIndexBySearch(proxy, GetVec2(dir));
+        }
+
         auto index = InvalidVertex; // Index of vertex that when dotted with dir has the max value.
         auto maxValue = -std::numeric_limits<OT>::infinity(); // Max dot value.
         auto i = VertexCounter{0};
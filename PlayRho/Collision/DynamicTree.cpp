@@ -27,24 +27,50 @@
 
 #include <cstring>
 #include <algorithm>
+#include <array>
+#include <future>
 #include <numeric>
 #include <utility>
+#include <vector>
 
 namespace playrho {
 namespace d2 {
 
 namespace {
 
+/// @brief Makes the branch data for a branch of the given children.
+inline DynamicTree::BranchData
+MakeBranchData(DynamicTree::Size c1, const DynamicTree::TreeNode& node1,
+               DynamicTree::Size c2, const DynamicTree::TreeNode& node2) noexcept
+{
+    return DynamicTree::BranchData{c1, c2, static_cast<Filter::bits_type>(
+        node1.GetCategoryBits() | node2.GetCategoryBits())};
+}
+
 inline DynamicTree::TreeNode
-MakeNode(DynamicTree::Size c1, const AABB& aabb1, DynamicTree::Height h1,
-         DynamicTree::Size c2, const AABB& aabb2, DynamicTree::Height h2,
+MakeNode(DynamicTree::Size c1, const DynamicTree::TreeNode& node1,
+         DynamicTree::Size c2, const DynamicTree::TreeNode& node2,
          DynamicTree::Size parent) noexcept
 {
     return DynamicTree::TreeNode{
-        DynamicTree::BranchData{c1, c2}, GetEnclosingAABB(aabb1, aabb2), 1 + std::max(h1, h2), parent
+        MakeBranchData(c1, node1, c2, node2),
+        GetEnclosingAABB(node1.GetAABB(), node2.GetAABB()),
+        1 + std::max(node1.GetHeight(), node2.GetHeight()), parent
     };
 }
 
+/// @brief Reassigns the identified node to be a branch of the given children.
+/// @details Sets the AABB, height, and category bits of the node from those of the children.
+inline void ReassignBranch(DynamicTree::TreeNode nodes[], DynamicTree::Size index,
+                           DynamicTree::Size c1, DynamicTree::Size c2) noexcept
+{
+    const auto& node1 = nodes[c1];
+    const auto& node2 = nodes[c2];
+    nodes[index].Assign(MakeBranchData(c1, node1, c2, node2),
+                        GetEnclosingAABB(node1.GetAABB(), node2.GetAABB()),
+                        1 + std::max(node1.GetHeight(), node2.GetHeight()));
+}
+
 std::pair<DynamicTree::Size, DynamicTree::Size>
 MakeMoveStay(const DynamicTree::TreeNode& nodeA, DynamicTree::Size indexA,
              const DynamicTree::TreeNode& nodeB, DynamicTree::Size indexB,
@@ -117,12 +143,8 @@ DynamicTree::Size RebalanceAt(DynamicTree::TreeNode nodes[], DynamicTree::Size i
         //
         // Rotate left and pick the taller of c2c1 or c2c2 or the better fitting to move to the new i node.
         const auto ms = MakeMoveStay(c2c1Node, c2c1, c2c2Node, c2c2, c1Node.GetAABB());
-        const auto newNodeI = MakeNode(c1, c1Node.GetAABB(), c1Height,
-                                       ms.first, nodes[ms.first].GetAABB(), nodes[ms.first].GetHeight(),
-                                       c2);
-        c2Node = MakeNode(i, newNodeI.GetAABB(), newNodeI.GetHeight(),
-                          ms.second, nodes[ms.second].GetAABB(), nodes[ms.second].GetHeight(),
-                          o);
+        const auto newNodeI = MakeNode(c1, c1Node, ms.first, nodes[ms.first], c2);
+        c2Node = MakeNode(i, newNodeI, ms.second, nodes[ms.second], o);
         nodes[ms.first].SetOther(i);
         nodes[i] = newNodeI;
         nodes[c2] = c2Node;
@@ -132,12 +154,8 @@ DynamicTree::Size RebalanceAt(DynamicTree::TreeNode nodes[], DynamicTree::Size i
             const auto oNodeBD = oNode.AsBranch();
             assert(oNodeBD.child1 == i || oNodeBD.child2 == i);
             nodes[o] = (oNodeBD.child1 == i)?
-                MakeNode(c2, c2Node.GetAABB(), c2Node.GetHeight(),
-                         oNodeBD.child2, nodes[oNodeBD.child2].GetAABB(), nodes[oNodeBD.child2].GetHeight(),
-                         oNode.GetOther()):
-                MakeNode(oNodeBD.child1, nodes[oNodeBD.child1].GetAABB(), nodes[oNodeBD.child1].GetHeight(),
-                         c2, c2Node.GetAABB(), c2Node.GetHeight(),
-                         oNode.GetOther());
+                MakeNode(c2, c2Node, oNodeBD.child2, nodes[oNodeBD.child2], oNode.GetOther()):
+                MakeNode(oNodeBD.child1, nodes[oNodeBD.child1], c2, c2Node, oNode.GetOther());
         }
         return c2;
     }
@@ -167,12 +185,8 @@ DynamicTree::Size RebalanceAt(DynamicTree::TreeNode nodes[], DynamicTree::Size i
         //
         // Rotate right and pick the taller of c1c1 or c1c2 or the better fitting to move to the new i node.
         const auto ms = MakeMoveStay(c1c1Node, c1c1, c1c2Node, c1c2, c2Node.GetAABB());
-        const auto newNodeI = MakeNode(ms.first, nodes[ms.first].GetAABB(), nodes[ms.first].GetHeight(),
-                                       c2, c2Node.GetAABB(), c2Height,
-                                       c1);
-        c1Node = MakeNode(ms.second, nodes[ms.second].GetAABB(), nodes[ms.second].GetHeight(),
-                          i, newNodeI.GetAABB(), newNodeI.GetHeight(),
-                          o);
+        const auto newNodeI = MakeNode(ms.first, nodes[ms.first], c2, c2Node, c1);
+        c1Node = MakeNode(ms.second, nodes[ms.second], i, newNodeI, o);
         nodes[ms.first].SetOther(i);
         nodes[i] = newNodeI;
         nodes[c1] = c1Node;
@@ -182,17 +196,13 @@ DynamicTree::Size RebalanceAt(DynamicTree::TreeNode nodes[], DynamicTree::Size i
             const auto oNodeBD = oNode.AsBranch();
             assert(oNodeBD.child1 == i || oNodeBD.child2 == i);
             nodes[o] = (oNodeBD.child1 == i)?
-                MakeNode(c1, c1Node.GetAABB(), c1Node.GetHeight(),
-                         oNodeBD.child2, nodes[oNodeBD.child2].GetAABB(), nodes[oNodeBD.child2].GetHeight(),
-                         oNode.GetOther()):
-                MakeNode(oNodeBD.child1, nodes[oNodeBD.child1].GetAABB(), nodes[oNodeBD.child1].GetHeight(),
-                         c1, c1Node.GetAABB(), c1Node.GetHeight(),
-                         oNode.GetOther());
+                MakeNode(c1, c1Node, oNodeBD.child2, nodes[oNodeBD.child2], oNode.GetOther()):
+                MakeNode(oNodeBD.child1, nodes[oNodeBD.child1], c1, c1Node, oNode.GetOther());
         }
         return c1;
     }
     
-    nodes[i] = MakeNode(c1, c1Node.GetAABB(), c1Node.GetHeight(), c2, c2Node.GetAABB(), c2Height, o);
+    nodes[i] = MakeNode(c1, c1Node, c2, c2Node, o);
     return i;
 }
 
@@ -287,9 +297,7 @@ RemoveParent(DynamicTree::TreeNode nodes[], DynamicTree::Size index) noexcept
     if (grandParent != DynamicTree::GetInvalidSize())
     {
         const auto newBD = ReplaceChild(nodes[grandParent].AsBranch(), parent, sibling);
-        const auto newAabb = GetEnclosingAABB(nodes[newBD.child1].GetAABB(), nodes[newBD.child2].GetAABB());
-        const auto newHeight = 1 + std::max(nodes[newBD.child1].GetHeight(), nodes[newBD.child2].GetHeight());
-        nodes[grandParent].Assign(newBD, newAabb, newHeight);
+        ReassignBranch(nodes, grandParent, newBD.child1, newBD.child2);
         nodes[parent].SetOther(DynamicTree::GetInvalidSize());
         return std::make_pair(UpdateUpwardFrom(nodes, grandParent), parent);
     }
@@ -306,16 +314,13 @@ DynamicTree::Size InsertParent(DynamicTree::TreeNode nodes[],
     const auto oldParent = nodes[sibling].GetOther();
     
     // std::max of leaf height and sibling height + 1 = sibling height + 1
-    nodes[newParent] = DynamicTree::TreeNode{DynamicTree::BranchData{sibling, index},
-        GetEnclosingAABB(aabb, nodes[sibling].GetAABB()), 1 + nodes[sibling].GetHeight(), oldParent};
+    nodes[newParent] = MakeNode(sibling, nodes[sibling], index, nodes[index], oldParent);
     nodes[sibling].SetOther(newParent);
     nodes[index].SetOther(newParent);
     if (oldParent != DynamicTree::GetInvalidSize())
     {
         const auto newBD = ReplaceChild(nodes[oldParent].AsBranch(), sibling, newParent);
-        const auto newAabb = GetEnclosingAABB(nodes[newBD.child1].GetAABB(), nodes[newBD.child2].GetAABB());
-        const auto newHeight = 1 + std::max(nodes[newBD.child1].GetHeight(), nodes[newBD.child2].GetHeight());
-        nodes[oldParent].Assign(newBD, newAabb, newHeight);
+        ReassignBranch(nodes, oldParent, newBD.child1, newBD.child2);
         assert(nodes[nodes[oldParent].AsBranch().child1].GetOther() == oldParent);
         assert(nodes[nodes[oldParent].AsBranch().child2].GetOther() == oldParent);
         return UpdateUpwardFrom(nodes, oldParent);
@@ -341,9 +346,7 @@ DynamicTree::Size UpdateNonRoot(DynamicTree::TreeNode nodes[],
     {
         assert(nodes[grandParent].AsBranch().child1 == parent || nodes[grandParent].AsBranch().child2 == parent);
         const auto newBD = ReplaceChild(nodes[grandParent].AsBranch(), parent, sibling);
-        const auto newAabb = GetEnclosingAABB(nodes[newBD.child1].GetAABB(), nodes[newBD.child2].GetAABB());
-        const auto newHeight = 1 + std::max(nodes[newBD.child1].GetHeight(), nodes[newBD.child2].GetHeight());
-        nodes[grandParent].Assign(newBD, newAabb, newHeight);
+        ReassignBranch(nodes, grandParent, newBD.child1, newBD.child2);
         nodes[parent].SetOther(DynamicTree::GetInvalidSize());
         assert(nodes[nodes[grandParent].AsBranch().child1].GetOther() == grandParent);
         assert(nodes[nodes[grandParent].AsBranch().child2].GetOther() == grandParent);
@@ -358,22 +361,199 @@ DynamicTree::Size UpdateNonRoot(DynamicTree::TreeNode nodes[],
     const auto cheapestParent = nodes[cheapest].GetOther();
     
     // std::max of leaf height and cheapest height + 1 = cheapest height + 1
-    nodes[parent] = DynamicTree::TreeNode{
-        DynamicTree::BranchData{cheapest, index},
-        GetEnclosingAABB(aabb, nodes[cheapest].GetAABB()),
-        1 + nodes[cheapest].GetHeight(), cheapestParent
-    };
+    nodes[parent] = MakeNode(cheapest, nodes[cheapest], index, nodes[index], cheapestParent);
     if (cheapestParent != DynamicTree::GetInvalidSize())
     {
         const auto newBD = ReplaceChild(nodes[cheapestParent].AsBranch(), cheapest, parent);
-        const auto newAabb = GetEnclosingAABB(nodes[newBD.child1].GetAABB(), nodes[newBD.child2].GetAABB());
-        const auto newHeight = 1 + std::max(nodes[newBD.child1].GetHeight(), nodes[newBD.child2].GetHeight());
-        nodes[cheapestParent].Assign(newBD, newAabb, newHeight);
+        ReassignBranch(nodes, cheapestParent, newBD.child1, newBD.child2);
     }
     nodes[cheapest].SetOther(parent);
     return UpdateUpwardFrom(nodes, parent);
 }
 
+/// @brief Number of bins the top-down builder sorts leaves into for choosing a split.
+PLAYRHO_CONSTEXPR const auto BuildBinCount = std::size_t{16};
+
+/// @brief Minimum number of leaves for which the top-down builder uses another thread.
+PLAYRHO_CONSTEXPR const auto MinLeavesPerBuildThread = DynamicTree::Size{2048};
+
+/// @brief Gets the coordinate of the center of the given AABB along the given axis.
+inline Real GetCentroid(const AABB& aabb, std::size_t axis) noexcept
+{
+    return StripUnit(GetCenter(aabb.ranges[axis]));
+}
+
+/// @brief Partitions the given leaves for the top-down builder.
+/// @details Finds the split of least perimeter cost among the bin boundaries along the
+///   axis of largest centroid extent and partitions the leaves accordingly.
+/// @return Number of leaves in the first partition. This is always more than zero and
+///   less than the given count.
+DynamicTree::Size PartitionLeaves(const DynamicTree::TreeNode nodes[],
+                                  DynamicTree::Size leaves[], DynamicTree::Size count)
+{
+    auto centers = AABB{};
+    for (auto i = decltype(count){0}; i < count; ++i)
+    {
+        Include(centers, GetCenter(nodes[leaves[i]].GetAABB()));
+    }
+    const auto extentX = StripUnit(GetSize(centers.ranges[0]));
+    const auto extentY = StripUnit(GetSize(centers.ranges[1]));
+    const auto axis = (extentX >= extentY)? std::size_t{0}: std::size_t{1};
+    const auto extent = std::max(extentX, extentY);
+    const auto base = StripUnit(centers.ranges[axis].GetMin());
+    const auto middle = count / 2;
+    if (!(extent > 0))
+    {
+        // All centers are the same so any split is as good as any other.
+        return middle;
+    }
+
+    const auto scale = Real(BuildBinCount) / extent;
+    const auto getBin = [&](DynamicTree::Size leaf) {
+        const auto offset = (GetCentroid(nodes[leaf].GetAABB(), axis) - base) * scale;
+        return (offset > 0)? static_cast<std::size_t>(std::min(offset, Real(BuildBinCount - 1))):
+            std::size_t{0};
+    };
+
+    auto binCounts = std::array<DynamicTree::Size, BuildBinCount>{};
+    auto binAABBs = std::array<AABB, BuildBinCount>{};
+    for (auto i = decltype(count){0}; i < count; ++i)
+    {
+        const auto bin = getBin(leaves[i]);
+        ++binCounts[bin];
+        Include(binAABBs[bin], nodes[leaves[i]].GetAABB());
+    }
+
+    // Sweeps from the right to get the cost of each right side then from the left to
+    // find the split of least total cost.
+    auto rightCosts = std::array<Real, BuildBinCount>{};
+    {
+        auto aabb = AABB{};
+        auto n = DynamicTree::Size{0};
+        for (auto bin = BuildBinCount - 1; bin > 0; --bin)
+        {
+            Include(aabb, binAABBs[bin]);
+            n += binCounts[bin];
+            rightCosts[bin] = n? StripUnit(GetPerimeter(aabb)) * Real(n): Real(0);
+        }
+    }
+    auto bestSplit = std::size_t{0};
+    auto bestCost = std::numeric_limits<Real>::infinity();
+    {
+        auto aabb = AABB{};
+        auto n = DynamicTree::Size{0};
+        for (auto bin = std::size_t{0}; bin < BuildBinCount - 1; ++bin)
+        {
+            Include(aabb, binAABBs[bin]);
+            n += binCounts[bin];
+            if ((n == 0) || (n == count))
+            {
+                continue;
+            }
+            const auto cost = StripUnit(GetPerimeter(aabb)) * Real(n) + rightCosts[bin + 1];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = bin;
+            }
+        }
+    }
+
+    const auto last = std::partition(leaves, leaves + count, [&](DynamicTree::Size leaf) {
+        return getBin(leaf) <= bestSplit;
+    });
+    const auto split = static_cast<DynamicTree::Size>(last - leaves);
+    if ((split == 0) || (split == count))
+    {
+        // Centers are too close to be told apart by binning so splits at the median.
+        std::nth_element(leaves, leaves + middle, leaves + count,
+                         [&](DynamicTree::Size lhs, DynamicTree::Size rhs) {
+            return GetCentroid(nodes[lhs].GetAABB(), axis) < GetCentroid(nodes[rhs].GetAABB(), axis);
+        });
+        return middle;
+    }
+    return split;
+}
+
+/// @brief Builds a sub-tree top-down over the given leaves.
+/// @details Uses the given branch nodes for the sub-tree's branches. Sub-trees of the
+///   first and second partitions use the branches at the same offsets as their leaves,
+///   leaving the last branch of the first partition for the sub-tree's root. So the
+///   resulting tree doesn't depend on how many threads are used.
+/// @param nodes Nodes of the tree being built.
+/// @param leaves Leaves to build the sub-tree over.
+/// @param branches Branches to use. There must be one less of these than leaves.
+/// @param count Count of leaves. Must be more than zero.
+/// @param maxThreads Maximum number of threads to use.
+/// @return Index of the root of the sub-tree.
+DynamicTree::Size BuildTopDown(DynamicTree::TreeNode nodes[],
+                               DynamicTree::Size leaves[], const DynamicTree::Size branches[],
+                               DynamicTree::Size count, unsigned maxThreads)
+{
+    assert(count > 0);
+    if (count == 1)
+    {
+        return leaves[0];
+    }
+
+    const auto split = PartitionLeaves(nodes, leaves, count);
+    auto child1 = DynamicTree::GetInvalidSize();
+    auto child2 = DynamicTree::GetInvalidSize();
+    if ((maxThreads > 1) && (count >= MinLeavesPerBuildThread))
+    {
+        // Sub-trees use disjoint nodes so can be built concurrently.
+        const auto threads1 = maxThreads / 2;
+        auto future = std::async(std::launch::async, [=]() {
+            return BuildTopDown(nodes, leaves, branches, split, threads1);
+        });
+        child2 = BuildTopDown(nodes, leaves + split, branches + split, count - split,
+                              maxThreads - threads1);
+        child1 = future.get();
+    }
+    else
+    {
+        child1 = BuildTopDown(nodes, leaves, branches, split, 1);
+        child2 = BuildTopDown(nodes, leaves + split, branches + split, count - split, 1);
+    }
+
+    const auto index = branches[split - 1];
+    nodes[index] = MakeNode(child1, nodes[child1], child2, nodes[child2],
+                            DynamicTree::GetInvalidSize());
+    nodes[child1].SetOther(index);
+    nodes[child2].SetOther(index);
+    return index;
+}
+
+/// @brief Minimum number of query AABBs for which a batched query uses another thread.
+PLAYRHO_CONSTEXPR const auto MinQueriesPerThread = std::size_t{256};
+
+/// @brief Spreads the low 16-bits of the given value out to the even bits.
+PLAYRHO_CONSTEXPR inline std::uint32_t SpreadBits(std::uint32_t value) noexcept
+{
+    value &= 0x0000FFFFu;
+    value = (value | (value << 8u)) & 0x00FF00FFu;
+    value = (value | (value << 4u)) & 0x0F0F0F0Fu;
+    value = (value | (value << 2u)) & 0x33333333u;
+    value = (value | (value << 1u)) & 0x55555555u;
+    return value;
+}
+
+/// @brief Gets the Morton code of the center of the given AABB within the given bounds.
+inline std::uint32_t GetMortonCode(const AABB& aabb, const AABB& bounds) noexcept
+{
+    auto code = std::uint32_t{0};
+    const auto center = GetCenter(aabb);
+    for (auto i = std::size_t{0}; i < 2; ++i)
+    {
+        const auto extent = StripUnit(GetSize(bounds.ranges[i]));
+        const auto offset = StripUnit(center[i] - bounds.ranges[i].GetMin());
+        const auto scaled = (extent > 0)? (offset / extent) * Real(0xFFFF): Real(0);
+        const auto clamped = std::min(std::max(scaled, Real(0)), Real(0xFFFF));
+        code |= SpreadBits(static_cast<std::uint32_t>(clamped)) << i;
+    }
+    return code;
+}
+
 } // anonymous namespace
 
 DynamicTree::DynamicTree() noexcept = default;
@@ -580,6 +760,32 @@ void DynamicTree::UpdateLeaf(Size index, const AABB& aabb)
     }
 }
 
+void DynamicTree::SetLeafData(Size index, LeafData value) noexcept
+{
+    assert(index != GetInvalidSize());
+    assert(index < m_nodeCapacity);
+    assert(IsLeaf(m_nodes[index].GetHeight()));
+
+    const auto oldBits = m_nodes[index].GetCategoryBits();
+    m_nodes[index].Assign(value);
+    if (oldBits == value.categoryBits)
+    {
+        return;
+    }
+
+    // Update the ancestors' category bits til reaching one whose bits don't change.
+    for (auto i = m_nodes[index].GetOther(); i != GetInvalidSize(); i = m_nodes[i].GetOther())
+    {
+        const auto bd = m_nodes[i].AsBranch();
+        const auto newBD = MakeBranchData(bd.child1, m_nodes[bd.child1], bd.child2, m_nodes[bd.child2]);
+        if (newBD.categoryBits == bd.categoryBits)
+        {
+            break;
+        }
+        m_nodes[i].Assign(newBD, m_nodes[i].GetAABB(), m_nodes[i].GetHeight());
+    }
+}
+
 void DynamicTree::RebuildBottomUp()
 {
     const auto nodes = Alloc<Size>(m_nodeCount);
@@ -636,7 +842,9 @@ void DynamicTree::RebuildBottomUp()
         const auto height = 1 + std::max(m_nodes[index1].GetHeight(), m_nodes[index2].GetHeight());
         
         // Warning: the following may change value of m_nodes!
-        const auto parent = AllocateNode(BranchData{index1, index2}, aabb, height);
+        const auto bits = m_nodes[index1].GetCategoryBits() | m_nodes[index2].GetCategoryBits();
+        const auto parent = AllocateNode(BranchData{index1, index2,
+            static_cast<Filter::bits_type>(bits)}, aabb, height);
         m_nodes[index1].SetOther(parent);
         m_nodes[index2].SetOther(parent);
 
@@ -649,6 +857,44 @@ void DynamicTree::RebuildBottomUp()
     Free(nodes);
 }
 
+void DynamicTree::RebuildTopDown(unsigned maxThreads)
+{
+    auto leaves = std::vector<Size>{};
+    leaves.reserve(m_leafCount);
+
+    // Build array of leaves. Free the rest.
+    for (auto i = decltype(m_nodeCapacity){0}; i < m_nodeCapacity; ++i)
+    {
+        const auto height = m_nodes[i].GetHeight();
+        if (IsLeaf(height))
+        {
+            m_nodes[i].SetOther(GetInvalidSize());
+            leaves.push_back(i);
+        }
+        else if (IsBranch(height))
+        {
+            m_nodes[i].SetOther(GetInvalidSize());
+            FreeNode(i);
+        }
+    }
+    if (leaves.empty())
+    {
+        m_rootIndex = GetInvalidSize();
+        return;
+    }
+
+    // Allocates all the branches up front so building doesn't change the nodes buffer.
+    auto branches = std::vector<Size>(size(leaves) - 1);
+    for (auto& branch: branches)
+    {
+        branch = AllocateNode();
+    }
+
+    m_rootIndex = BuildTopDown(m_nodes, leaves.data(), branches.data(),
+                               static_cast<Size>(size(leaves)), maxThreads);
+    m_nodes[m_rootIndex].SetOther(GetInvalidSize());
+}
+
 void DynamicTree::ShiftOrigin(Length2 newOrigin)
 {
     // Build array of leaves. Free the rest.
@@ -675,46 +921,100 @@ void swap(DynamicTree& lhs, DynamicTree& rhs) noexcept
 }
 
 void Query(const DynamicTree& tree, const AABB& aabb, const DynamicTreeSizeCB& callback)
-{    
-    GrowableStack<DynamicTree::Size, 256> stack;
-    stack.push(tree.GetRootIndex());
-    
-    while (!empty(stack))
+{
+    Query<const DynamicTreeSizeCB&>(tree, aabb, callback);
+}
+
+void Query(const DynamicTree& tree, const AABB& aabb, QueryFixtureCallback callback)
+{
+    Query<QueryFixtureCallback&>(tree, aabb, callback);
+}
+
+void Query(const DynamicTree& tree, Span<const AABB> aabbs,
+           std::vector<DynamicTreeQueryHit>& hits, DynamicTreeQueryScratch& scratch,
+           unsigned maxThreads)
+{
+    hits.clear();
+    const auto root = tree.GetRootIndex();
+    const auto numQueries = size(aabbs);
+    if ((root == DynamicTree::GetInvalidSize()) || (numQueries == 0))
+    {
+        return;
+    }
+
+    // Orders the queries along a Z-order curve over the tree's bounds.
+    const auto bounds = tree.GetAABB(root);
+    auto& order = scratch.order;
+    order.clear();
+    for (auto i = decltype(numQueries){0}; i < numQueries; ++i)
     {
-        const auto index = stack.top();
-        stack.pop();
-        if (index != DynamicTree::GetInvalidSize())
+        order.emplace_back(GetMortonCode(aabbs[i], bounds), i);
+    }
+    std::sort(begin(order), end(order));
+
+    const auto queryRange = [&](std::size_t first, std::size_t last,
+                                std::vector<DynamicTreeQueryHit>& buffer) {
+        for (auto i = first; i < last; ++i)
         {
-            if (TestOverlap(tree.GetAABB(index), aabb))
-            {
-                const auto height = tree.GetHeight(index);
-                if (DynamicTree::IsBranch(height))
-                {
-                    const auto branchData = tree.GetBranchData(index);
-                    stack.push(branchData.child1);
-                    stack.push(branchData.child2);
-                }
-                else
-                {
-                    assert(DynamicTree::IsLeaf(height));
-                    const auto sc = callback(index);
-                    if (sc == DynamicTreeOpcode::End)
-                    {
-                        return;
-                    }
-                }
-            }
+            const auto queryIndex = order[i].second;
+            Query(tree, aabbs[queryIndex], [&](DynamicTree::Size leafIndex) {
+                buffer.push_back(DynamicTreeQueryHit{queryIndex, leafIndex});
+                return DynamicTreeOpcode::Continue;
+            });
         }
+    };
+
+    const auto numThreads = std::max(std::min(std::size_t{maxThreads},
+                                              numQueries / MinQueriesPerThread), std::size_t{1});
+    auto& buffers = scratch.buffers;
+    if (size(buffers) < numThreads)
+    {
+        buffers.resize(numThreads);
     }
+    for_each(begin(buffers), end(buffers), [](std::vector<DynamicTreeQueryHit>& buffer) {
+        buffer.clear();
+    });
+    auto futures = std::vector<std::future<void>>{};
+    futures.reserve(numThreads - 1);
+    const auto queriesPerThread = numQueries / numThreads;
+    for (auto i = decltype(numThreads){0}; i < (numThreads - 1); ++i)
+    {
+        const auto first = i * queriesPerThread;
+        auto& buffer = buffers[i];
+        futures.push_back(std::async(std::launch::async, [&queryRange,first,queriesPerThread,&buffer]() {
+            queryRange(first, first + queriesPerThread, buffer);
+        }));
+    }
+    queryRange((numThreads - 1) * queriesPerThread, numQueries, buffers[numThreads - 1]);
+    for (auto& future: futures)
+    {
+        future.get();
+    }
+
+    // Places the hits in order of query index with a counting sort.
+    auto& offsets = scratch.offsets;
+    offsets.assign(numQueries + 1, std::size_t{0});
+    for_each(cbegin(buffers), cend(buffers), [&](const std::vector<DynamicTreeQueryHit>& buffer) {
+        for (const auto& hit: buffer)
+        {
+            ++offsets[hit.queryIndex + 1];
+        }
+    });
+    std::partial_sum(begin(offsets), end(offsets), begin(offsets));
+    hits.resize(offsets[numQueries]);
+    for_each(cbegin(buffers), cend(buffers), [&](const std::vector<DynamicTreeQueryHit>& buffer) {
+        for (const auto& hit: buffer)
+        {
+            hits[offsets[hit.queryIndex]++] = hit;
+        }
+    });
 }
 
-void Query(const DynamicTree& tree, const AABB& aabb, QueryFixtureCallback callback)
+void Query(const DynamicTree& tree, Span<const AABB> aabbs,
+           std::vector<DynamicTreeQueryHit>& hits, unsigned maxThreads)
 {
-    Query(tree, aabb, [&](DynamicTree::Size treeId) {
-        const auto leafData = tree.GetLeafData(treeId);
-        return callback(leafData.fixture, leafData.childIndex)?
-        DynamicTreeOpcode::Continue: DynamicTreeOpcode::End;
-    });
+    auto scratch = DynamicTreeQueryScratch{};
+    Query(tree, aabbs, hits, scratch, maxThreads);
 }
 
 Length ComputeTotalPerimeter(const DynamicTree& tree) noexcept
@@ -839,6 +1139,8 @@ bool ValidateMetrics(const DynamicTree& tree, DynamicTree::Size index) noexcept
     assert(tree.GetOther(child2) == index);
     assert(height == (1 + std::max(tree.GetHeight(child1), tree.GetHeight(child2))));
     assert(tree.GetAABB(index) == GetEnclosingAABB(tree.GetAABB(child1), tree.GetAABB(child2)));
+    assert(tree.GetCategoryBits(index) ==
+           (tree.GetCategoryBits(child1) | tree.GetCategoryBits(child2)));
 
     return ValidateMetrics(tree, child1) && ValidateMetrics(tree, child2);
 }
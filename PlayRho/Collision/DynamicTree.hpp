@@ -26,11 +26,17 @@
 /// Declaration of the <code>DynamicTree</code> class.
 
 #include <PlayRho/Collision/AABB.hpp>
+#include <PlayRho/Common/Math.hpp>
 #include <PlayRho/Common/Settings.hpp>
+#include <PlayRho/Common/Span.hpp>
+#include <PlayRho/Common/GrowableStack.hpp>
+#include <PlayRho/Dynamics/Filter.hpp>
 
+#include <algorithm>
 #include <functional>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace playrho {
 namespace d2 {
@@ -171,6 +177,9 @@ public:
     LeafData GetLeafData(Size index) const noexcept;
 
     /// @brief Sets the leaf data for the element at the given index to the given value.
+    /// @note This updates the category bits of the leaf's ancestors if the category bits
+    ///   of the leaf data changed.
+    /// @warning Behavior is undefined if the given index is not a valid leaf node.
     void SetLeafData(Size index, LeafData value) noexcept;
 
     /// @brief Gets the AABB for a leaf or branch (a non-unused node).
@@ -194,6 +203,12 @@ public:
     /// @warning Behavior is undefined if the given index in not a valid branch node.
     BranchData GetBranchData(Size index) const noexcept;
 
+    /// @brief Gets the category bits of the identified leaf or branch node.
+    /// @details For leaves these are the category bits of their leaf data. For branches
+    ///   these are the bitwise-or of the category bits of all the leaves under them.
+    /// @warning Behavior is undefined if the given index is not valid.
+    Filter::bits_type GetCategoryBits(Size index) const noexcept;
+
     /// @brief Gets the index of the "root" node if this tree has one.
     /// @note If the tree has a root node, then the "other" property of this node will be
     ///   the invalid size.
@@ -208,6 +223,18 @@ public:
     /// @note Meant for testing.
     void RebuildBottomUp();
 
+    /// @brief Rebuilds this tree top-down.
+    /// @details Rebuilds the hierarchy of branches over the existing leaves by recursively
+    ///   splitting the leaves along the axis of largest centroid extent at the position
+    ///   the binned surface area heuristic (perimeter in 2-D) finds cheapest.
+    /// @note This takes O(n log n) time for n leaves so it's usable on large trees unlike
+    ///   <code>RebuildBottomUp</code> which takes O(n^3) time.
+    /// @note Leaf indices are unchanged but branch indices may change.
+    /// @note The resulting tree is the same regardless of the number of threads used.
+    /// @param maxThreads Maximum number of threads to use. Values of 0 or 1 result in the
+    ///   rebuild being done serially in the calling thread.
+    void RebuildTopDown(unsigned maxThreads = 1);
+
     /// @brief Shifts the world origin.
     /// @note Useful for large worlds.
     /// @note The shift formula is: <code>position -= newOrigin</code>.
@@ -287,6 +314,11 @@ struct DynamicTree::BranchData
 {
     Size child1; ///< @brief Child 1.
     Size child2; ///< @brief Child 2.
+
+    /// @brief Category bits.
+    /// @details Bitwise-or of the category bits of all the leaves under this branch. This
+    ///   lets masked traversals skip whole sub-trees that can't have any matching leaves.
+    Filter::bits_type categoryBits;
 };
 
 /// @brief Leaf data of a tree node.
@@ -324,6 +356,12 @@ struct DynamicTree::LeafData
 
     /// @brief Child index of related Shape.
     ChildCounter childIndex;
+
+    /// @brief Collision category bits of the associated fixture.
+    /// @note This fits in what's otherwise padding on 64-bit architectures.
+    /// @note Leaves whose data doesn't set this have no category bits so are skipped by
+    ///   all masked traversals.
+    Filter::bits_type categoryBits = 0;
 };
 
 /// @brief Equality operator.
@@ -356,7 +394,8 @@ union DynamicTree::VariantData
     BranchData branch;
     
     /// @brief Default constructor.
-    VariantData() noexcept = default;
+    /// @note This is user-provided since the leaf data has a default member initializer.
+    PLAYRHO_CONSTEXPR inline VariantData() noexcept: unused{} {}
     
     /// @brief Initializing constructor.
     PLAYRHO_CONSTEXPR inline VariantData(UnusedData value) noexcept: unused{value} {}
@@ -489,6 +528,14 @@ public:
         return m_variant.branch;
     }
 
+    /// @brief Gets the category bits of the leaf or branch node.
+    /// @warning Behavior is undefined if called on a free/unused node!
+    PLAYRHO_CONSTEXPR inline Filter::bits_type GetCategoryBits() const noexcept
+    {
+        assert(!IsUnused(m_height));
+        return IsLeaf(m_height)? m_variant.leaf.categoryBits: m_variant.branch.categoryBits;
+    }
+
     /// @brief Gets the node as an "unused" value.
     PLAYRHO_CONSTEXPR inline void Assign(const UnusedData& v) noexcept
     {
@@ -607,12 +654,11 @@ inline DynamicTree::LeafData DynamicTree::GetLeafData(Size index) const noexcept
     return m_nodes[index].AsLeaf();
 }
 
-inline void DynamicTree::SetLeafData(Size index, LeafData value) noexcept
+inline Filter::bits_type DynamicTree::GetCategoryBits(Size index) const noexcept
 {
     assert(index != GetInvalidSize());
     assert(index < m_nodeCapacity);
-    assert(IsLeaf(m_nodes[index].GetHeight()));
-    m_nodes[index].AsLeaf() = value;
+    return m_nodes[index].GetCategoryBits();
 }
 
 // Free functions...
@@ -623,7 +669,8 @@ ReplaceChild(DynamicTree::BranchData bd, DynamicTree::Size oldChild, DynamicTree
 {
     assert(bd.child1 == oldChild || bd.child2 == oldChild);
     return (bd.child1 == oldChild)?
-        DynamicTree::BranchData{newChild, bd.child2}: DynamicTree::BranchData{bd.child1, newChild};
+        DynamicTree::BranchData{newChild, bd.child2, bd.categoryBits}:
+        DynamicTree::BranchData{bd.child1, newChild, bd.categoryBits};
 }
 
 /// @brief Whether this node is free (or allocated).
@@ -758,6 +805,291 @@ using QueryFixtureCallback = std::function<bool(Fixture* fixture, ChildCounter c
 /// @param callback User implemented callback function.
 void Query(const DynamicTree& tree, const AABB& aabb, QueryFixtureCallback callback);
 
+/// @brief Query the given dynamic tree and find nodes overlapping the given AABB.
+/// @details This is the callable type templated equivalent of the
+///   <code>DynamicTreeSizeCB</code> taking query that lets the callback get inlined
+///   into the tree traversal instead of being called through a <code>std::function</code>.
+/// @note The callback is called for each leaf node that overlaps the supplied AABB.
+/// @param tree Dynamic tree to do the query over.
+/// @param aabb The query box.
+/// @param callback Callable object that's called with the leaf index of each overlapping
+///   leaf and that returns <code>DynamicTreeOpcode::End</code> to terminate the query.
+template <typename F>
+std::enable_if_t<std::is_invocable_r<DynamicTreeOpcode, F, DynamicTree::Size>::value>
+Query(const DynamicTree& tree, const AABB& aabb, F&& callback)
+{
+    GrowableStack<DynamicTree::Size, 256> stack;
+    stack.push(tree.GetRootIndex());
+    
+    while (!empty(stack))
+    {
+        const auto index = stack.top();
+        stack.pop();
+        if (index != DynamicTree::GetInvalidSize())
+        {
+            if (TestOverlap(tree.GetAABB(index), aabb))
+            {
+                const auto height = tree.GetHeight(index);
+                if (DynamicTree::IsBranch(height))
+                {
+                    const auto branchData = tree.GetBranchData(index);
+                    stack.push(branchData.child1);
+                    stack.push(branchData.child2);
+                }
+                else
+                {
+                    assert(DynamicTree::IsLeaf(height));
+                    const auto sc = callback(index);
+                    if (sc == DynamicTreeOpcode::End)
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// @brief Queries the given dynamic tree for all fixtures that potentially overlap the
+///   provided AABB.
+/// @details This is the callable type templated equivalent of the
+///   <code>QueryFixtureCallback</code> taking query.
+/// @param tree Dynamic tree to do the query over.
+/// @param aabb The query box.
+/// @param callback Callable object that's called with the fixture and child index of each
+///   potentially overlapping leaf and that returns <code>false</code> to terminate the query.
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const DynamicTree& tree, const AABB& aabb, F&& callback)
+{
+    Query(tree, aabb, [&](DynamicTree::Size treeId) {
+        const auto leafData = tree.GetLeafData(treeId);
+        return callback(leafData.fixture, leafData.childIndex)?
+            DynamicTreeOpcode::Continue: DynamicTreeOpcode::End;
+    });
+}
+
+/// @brief Queries the given dynamic tree for leaves overlapping the given AABB that have
+///   any of the given category bits.
+/// @details Skips whole sub-trees whose branch category bits don't have any of the mask
+///   bits in common since none of the leaves under them can then match.
+/// @note Leaves without any category bits are never called back for.
+/// @param tree Dynamic tree to do the query over.
+/// @param aabb The query box.
+/// @param maskBits Mask of the category bits to call back for leaves having any of.
+/// @param callback Callable object that's called with the leaf index of each overlapping
+///   leaf and that returns <code>DynamicTreeOpcode::End</code> to terminate the query.
+/// @see Filter
+template <typename F>
+std::enable_if_t<std::is_invocable_r<DynamicTreeOpcode, F, DynamicTree::Size>::value>
+Query(const DynamicTree& tree, const AABB& aabb, Filter::bits_type maskBits, F&& callback)
+{
+    GrowableStack<DynamicTree::Size, 256> stack;
+    stack.push(tree.GetRootIndex());
+    
+    while (!empty(stack))
+    {
+        const auto index = stack.top();
+        stack.pop();
+        if (index != DynamicTree::GetInvalidSize())
+        {
+            if (((tree.GetCategoryBits(index) & maskBits) != 0) &&
+                TestOverlap(tree.GetAABB(index), aabb))
+            {
+                const auto height = tree.GetHeight(index);
+                if (DynamicTree::IsBranch(height))
+                {
+                    const auto branchData = tree.GetBranchData(index);
+                    stack.push(branchData.child1);
+                    stack.push(branchData.child2);
+                }
+                else
+                {
+                    assert(DynamicTree::IsLeaf(height));
+                    const auto sc = callback(index);
+                    if (sc == DynamicTreeOpcode::End)
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// @brief Queries the given dynamic tree for all fixtures that potentially overlap the
+///   provided AABB and that have any of the given category bits.
+/// @param tree Dynamic tree to do the query over.
+/// @param aabb The query box.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object that's called with the fixture and child index of each
+///   potentially overlapping leaf and that returns <code>false</code> to terminate the query.
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const DynamicTree& tree, const AABB& aabb, Filter::bits_type maskBits, F&& callback)
+{
+    Query(tree, aabb, maskBits, [&](DynamicTree::Size treeId) {
+        const auto leafData = tree.GetLeafData(treeId);
+        return callback(leafData.fixture, leafData.childIndex)?
+            DynamicTreeOpcode::Continue: DynamicTreeOpcode::End;
+    });
+}
+
+/// @brief Queries the given dynamic tree for leaves in order of increasing distance from
+///   the given point.
+/// @details Traverses the tree best-first using a priority queue of nodes ordered by the
+///   distance from the point to their AABBs. Since no leaf can be closer to the point than
+///   the AABBs it's within, every leaf closer than a node gets called back for before that
+///   node's sub-tree is even visited.
+/// @note Leaves that are the same distance away get called back for in no particular order.
+/// @param tree Dynamic tree to do the query over.
+/// @param point Point to find the leaves nearest to.
+/// @param maxDistance Maximum distance of leaves to call back for.
+/// @param distance Callable object that's called with a leaf index and that returns the
+///   distance from the point to what the leaf is for. Behavior is undefined if this is less
+///   than the distance from the point to the leaf's AABB. Infinite distances are never
+///   called back for.
+/// @param callback Callable object that's called with the leaf index and the distance of
+///   each leaf not further than the maximum distance away and that returns
+///   <code>DynamicTreeOpcode::End</code> to terminate the query.
+template <typename D, typename F>
+std::enable_if_t<std::is_invocable_r<Length, D, DynamicTree::Size>::value &&
+                 std::is_invocable_r<DynamicTreeOpcode, F, DynamicTree::Size, Length>::value>
+QueryNearest(const DynamicTree& tree, Length2 point, Length maxDistance,
+             D&& distance, F&& callback)
+{
+    struct Entry
+    {
+        Length distance; ///< Distance to the leaf or least distance to the node's leaves.
+        DynamicTree::Size index; ///< Index of the node.
+        bool isLeafDistance; ///< Whether the distance is the leaf's own distance.
+    };
+    
+    // Orders the heap for the least distance first and for leaf distances before
+    // AABB distances that are the same.
+    const auto greater = [](const Entry& lhs, const Entry& rhs) {
+        return (lhs.distance != rhs.distance)? (lhs.distance > rhs.distance):
+            (!lhs.isLeafDistance && rhs.isLeafDistance);
+    };
+    const auto push = [&](std::vector<Entry>& heap, Entry entry) {
+        if (entry.distance <= maxDistance)
+        {
+            heap.push_back(entry);
+            std::push_heap(begin(heap), end(heap), greater);
+        }
+    };
+    const auto getAabbDistance = [&](DynamicTree::Size index) {
+        return Length{sqrt(GetDistanceSquared(tree.GetAABB(index), point))};
+    };
+    
+    const auto root = tree.GetRootIndex();
+    if (root == DynamicTree::GetInvalidSize())
+    {
+        return;
+    }
+    auto heap = std::vector<Entry>{};
+    heap.reserve(64);
+    push(heap, Entry{getAabbDistance(root), root, false});
+    while (!empty(heap))
+    {
+        std::pop_heap(begin(heap), end(heap), greater);
+        const auto entry = heap.back();
+        heap.pop_back();
+        if (entry.isLeafDistance)
+        {
+            if (callback(entry.index, entry.distance) == DynamicTreeOpcode::End)
+            {
+                return;
+            }
+            continue;
+        }
+        const auto height = tree.GetHeight(entry.index);
+        if (DynamicTree::IsBranch(height))
+        {
+            const auto branchData = tree.GetBranchData(entry.index);
+            push(heap, Entry{getAabbDistance(branchData.child1), branchData.child1, false});
+            push(heap, Entry{getAabbDistance(branchData.child2), branchData.child2, false});
+        }
+        else
+        {
+            assert(DynamicTree::IsLeaf(height));
+            const auto leafDistance = Length{distance(entry.index)};
+            if (leafDistance < std::numeric_limits<Length>::infinity())
+            {
+                push(heap, Entry{leafDistance, entry.index, true});
+            }
+        }
+    }
+}
+
+/// @brief Hit of a batched query.
+struct DynamicTreeQueryHit
+{
+    std::size_t queryIndex; ///< Index of the query AABB.
+    DynamicTree::Size leafIndex; ///< Index of a leaf overlapping the query AABB.
+};
+
+/// @brief Equality operator.
+/// @relatedalso DynamicTreeQueryHit
+PLAYRHO_CONSTEXPR inline bool operator== (const DynamicTreeQueryHit& lhs,
+                                          const DynamicTreeQueryHit& rhs) noexcept
+{
+    return (lhs.queryIndex == rhs.queryIndex) && (lhs.leafIndex == rhs.leafIndex);
+}
+
+/// @brief Inequality operator.
+/// @relatedalso DynamicTreeQueryHit
+PLAYRHO_CONSTEXPR inline bool operator!= (const DynamicTreeQueryHit& lhs,
+                                          const DynamicTreeQueryHit& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+/// @brief Working storage of batched queries.
+/// @details Holds what batched queries need besides the buffer of hits. Passing the same
+///   instance to similar batches of queries reuses the capacity of its buffers instead of
+///   reallocating them.
+/// @sa Query(const DynamicTree&, Span<const AABB>, std::vector<DynamicTreeQueryHit>&,
+///   DynamicTreeQueryScratch&, unsigned).
+struct DynamicTreeQueryScratch
+{
+    /// @brief Morton codes and indices of the queries in the order they're done in.
+    std::vector<std::pair<std::uint32_t, std::size_t>> order;
+
+    /// @brief Per-thread buffers of the hits in the order they're found in.
+    std::vector<std::vector<DynamicTreeQueryHit>> buffers;
+
+    /// @brief Offsets of the hits of each query in the ordered hits.
+    std::vector<std::size_t> offsets;
+};
+
+/// @brief Queries the given dynamic tree for the leaves overlapping each of the given AABBs.
+/// @details Traverses the tree for the AABBs in the order of the Morton codes of their
+///   centers so that consecutive traversals visit mostly the same nodes. Sequences of
+///   the AABBs in that order are queried concurrently when more than one thread is allowed.
+/// @note This doesn't call back per leaf so avoids the overhead of doing so. It's meant
+///   for making large numbers of independent queries at once.
+/// @param tree Dynamic tree to do the queries over.
+/// @param aabbs Query AABBs.
+/// @param hits Buffer the hits are written to. This is cleared first. Its capacity is
+///   reused so it doesn't need reallocating when used for similar batches of queries.
+///   The hits are ordered by query index, then in the order that <code>Query</code>
+///   would call back with the leaves. They're the same regardless of the number of threads.
+/// @param scratch Working storage whose capacity is reused like that of the hits buffer.
+/// @param maxThreads Maximum number of threads to use. Values of 0 or 1 result in the
+///   queries being done serially in the calling thread.
+void Query(const DynamicTree& tree, Span<const AABB> aabbs,
+           std::vector<DynamicTreeQueryHit>& hits, DynamicTreeQueryScratch& scratch,
+           unsigned maxThreads = 1);
+
+/// @brief Queries the given dynamic tree for the leaves overlapping each of the given AABBs.
+/// @details This is the equivalent of the query taking working storage that allocates
+///   the working storage for just this call.
+/// @sa Query(const DynamicTree&, Span<const AABB>, std::vector<DynamicTreeQueryHit>&,
+///   DynamicTreeQueryScratch&, unsigned).
+void Query(const DynamicTree& tree, Span<const AABB> aabbs,
+           std::vector<DynamicTreeQueryHit>& hits, unsigned maxThreads = 1);
+
 /// @brief Gets the "size" of the given tree.
 /// @note Size in this context is defined as the leaf count.
 /// @note This provides ancillary support for the container concept's size method.
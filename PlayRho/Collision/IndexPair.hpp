@@ -140,6 +140,26 @@ struct LengthIndexPair
 
 namespace d2 {
 
+/// @brief Separating axis.
+/// @details Identifies an edge normal of one of two convex shapes by which of the shapes
+///   it's from and by its index. Used for caching the axis that last separated the shapes
+///   or that was last the reference face of their manifold.
+/// @note This is by design a 2-byte sized type.
+/// @sa CollideShapes.
+struct SeparatingAxis
+{
+    /// @brief Type of the axis.
+    enum Type: std::uint8_t
+    {
+        e_unset, ///< Unset type. Axis identifies no edge normal.
+        e_faceA, ///< Face-A type. Axis is the edge normal of shape A at the index.
+        e_faceB, ///< Face-B type. Axis is the edge normal of shape B at the index.
+    };
+
+    Type type = e_unset; ///< Type of the axis.
+    VertexCounter index = InvalidVertex; ///< Index of the edge normal.
+};
+
 /// @brief Length and vertex counter array of indices for 2-D space.
 using LengthIndices = detail::LengthIndices<2>;
 
@@ -20,17 +20,28 @@
  */
 
 #include <PlayRho/Collision/Manifold.hpp>
+#include <PlayRho/Common/InvalidArgument.hpp>
 #include <PlayRho/Collision/Simplex.hpp>
 #include <PlayRho/Collision/Distance.hpp>
 #include <PlayRho/Collision/DistanceProxy.hpp>
 #include <PlayRho/Collision/Collision.hpp>
 #include <PlayRho/Collision/ShapeSeparation.hpp>
+#include <PlayRho/Collision/Shapes/Shape.hpp>
+#include <PlayRho/Collision/Shapes/DiskShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/PolygonShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/EdgeShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/ChainShapeConf.hpp>
 #include <PlayRho/Defines.hpp>
 
 #include <array>
 #include <bitset>
 #include <algorithm>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#define PLAYRHO_MANIFOLD_SSE
+#include <xmmintrin.h>
+#endif
+
 #define PLAYRHO_MAGIC(x) (x)
 
 namespace playrho {
@@ -388,6 +399,14 @@ Manifold GetManifold(Length2 locationA, const Transformation& xfA,
 Manifold CollideShapes(const DistanceProxy& shapeA, const Transformation& xfA,
                        const DistanceProxy& shapeB, const Transformation& xfB,
                        Manifold::Conf conf)
+{
+    auto axis = SeparatingAxis{};
+    return CollideShapes(shapeA, xfA, shapeB, xfB, axis, conf);
+}
+
+Manifold CollideShapes(const DistanceProxy& shapeA, const Transformation& xfA,
+                       const DistanceProxy& shapeB, const Transformation& xfB,
+                       SeparatingAxis& axis, Manifold::Conf conf)
 {
     // Assumes called after detecting AABB overlap.
     // Find edge normal of max separation on A - return if separating axis is found
@@ -413,11 +432,33 @@ Manifold CollideShapes(const DistanceProxy& shapeA, const Transformation& xfA,
     
     const auto do4x4 = (countA == 4) && (countB == 4);
     
+    // Tests the cached axis first. If it still separates the shapes, so would the max
+    // separation axis found below and there's no need to look for that.
+    if (axis.type != SeparatingAxis::e_unset)
+    {
+        const auto faceA = (axis.type == SeparatingAxis::e_faceA);
+        const auto& shape1 = faceA? shapeA: shapeB;
+        const auto& xf1 = faceA? xfA: xfB;
+        const auto& shape2 = faceA? shapeB: shapeA;
+        const auto& xf2 = faceA? xfB: xfA;
+        if (axis.index < shape1.GetVertexCount())
+        {
+            const auto separation = do4x4?
+                GetSeparation4x4(shape1, xf1, axis.index, shape2, xf2):
+                GetSeparation(shape1, xf1, axis.index, shape2, xf2);
+            if (separation > totalRadius)
+            {
+                return Manifold{};
+            }
+        }
+    }
+    
     const auto edgeSepA = do4x4?
         GetMaxSeparation4x4(shapeA, xfA, shapeB, xfB):
         GetMaxSeparation(shapeA, xfA, shapeB, xfB);
     if (edgeSepA.distance > totalRadius)
     {
+        axis = SeparatingAxis{SeparatingAxis::e_faceA, edgeSepA.firstShape};
         return Manifold{};
     }
     
@@ -426,11 +467,16 @@ Manifold CollideShapes(const DistanceProxy& shapeA, const Transformation& xfA,
         GetMaxSeparation(shapeB, xfB, shapeA, xfA);
     if (edgeSepB.distance > totalRadius)
     {
+        axis = SeparatingAxis{SeparatingAxis::e_faceB, edgeSepB.firstShape};
         return Manifold{};
     }
     
     const auto k_tol = PLAYRHO_MAGIC(conf.linearSlop / 10);
-    return (edgeSepB.distance > (edgeSepA.distance + k_tol))?
+    const auto flipped = edgeSepB.distance > (edgeSepA.distance + k_tol);
+    axis = flipped?
+        SeparatingAxis{SeparatingAxis::e_faceB, edgeSepB.firstShape}:
+        SeparatingAxis{SeparatingAxis::e_faceA, edgeSepA.firstShape};
+    return flipped?
         GetManifold(true,
                         shapeB, xfB, edgeSepB.firstShape,
                         shapeA, xfA, edgeSepB.secondShape,
@@ -441,6 +487,261 @@ Manifold CollideShapes(const DistanceProxy& shapeA, const Transformation& xfA,
                         conf);
 }
 
+namespace {
+
+/// @brief Gets the configuration of the given shape as the given type.
+/// @warning Behavior is undefined if the shape's configuration isn't of the given type.
+template <typename T>
+inline const T& GetConf(const Shape& shape) noexcept
+{
+    assert(GetUseTypeInfo(shape) == typeid(T));
+    return *static_cast<const T*>(GetData(shape));
+}
+
+/// @brief Collides the children of shapes of the given configuration types.
+/// @details Disk pairs go straight to the point-to-point manifold calculation. All other
+///   pairs go to the general distance proxy based calculation.
+template <typename A, typename B>
+Manifold CollideConfs(const Shape& shapeA, ChildCounter indexA, const Transformation& xfA,
+                      const Shape& shapeB, ChildCounter indexB, const Transformation& xfB,
+                      Manifold::Conf conf)
+{
+    const auto childA = GetChild(GetConf<A>(shapeA), indexA);
+    const auto childB = GetChild(GetConf<B>(shapeB), indexB);
+    if constexpr (std::is_same<A, DiskShapeConf>::value && std::is_same<B, DiskShapeConf>::value)
+    {
+        const auto totalRadius = childA.GetVertexRadius() + childB.GetVertexRadius();
+        return GetManifold(childA.GetVertex(0), xfA, childB.GetVertex(0), xfB, totalRadius);
+    }
+    else
+    {
+        return CollideShapes(childA, xfA, childB, xfB, conf);
+    }
+}
+
+/// @brief Collides the children of shapes of any configuration types.
+Manifold CollideOthers(const Shape& shapeA, ChildCounter indexA, const Transformation& xfA,
+                       const Shape& shapeB, ChildCounter indexB, const Transformation& xfB,
+                       Manifold::Conf conf)
+{
+    return CollideShapes(GetChild(shapeA, indexA), xfA, GetChild(shapeB, indexB), xfB, conf);
+}
+
+/// @brief Dispatch table of collide shapes functions indexed by shape kinds A then B.
+PLAYRHO_CONSTEXPR const CollideShapesFunction CollideFunctions[ShapeKindCount][ShapeKindCount] = {
+    {
+        CollideConfs<DiskShapeConf, DiskShapeConf>,
+        CollideConfs<DiskShapeConf, PolygonShapeConf>,
+        CollideConfs<DiskShapeConf, EdgeShapeConf>,
+        CollideConfs<DiskShapeConf, ChainShapeConf>,
+        CollideOthers,
+    },
+    {
+        CollideConfs<PolygonShapeConf, DiskShapeConf>,
+        CollideConfs<PolygonShapeConf, PolygonShapeConf>,
+        CollideConfs<PolygonShapeConf, EdgeShapeConf>,
+        CollideConfs<PolygonShapeConf, ChainShapeConf>,
+        CollideOthers,
+    },
+    {
+        CollideConfs<EdgeShapeConf, DiskShapeConf>,
+        CollideConfs<EdgeShapeConf, PolygonShapeConf>,
+        CollideConfs<EdgeShapeConf, EdgeShapeConf>,
+        CollideConfs<EdgeShapeConf, ChainShapeConf>,
+        CollideOthers,
+    },
+    {
+        CollideConfs<ChainShapeConf, DiskShapeConf>,
+        CollideConfs<ChainShapeConf, PolygonShapeConf>,
+        CollideConfs<ChainShapeConf, EdgeShapeConf>,
+        CollideConfs<ChainShapeConf, ChainShapeConf>,
+        CollideOthers,
+    },
+    {
+        CollideOthers,
+        CollideOthers,
+        CollideOthers,
+        CollideOthers,
+        CollideOthers,
+    },
+};
+
+/// @brief Count of point-to-point based manifold inputs that get tested at once.
+PLAYRHO_CONSTEXPR const auto PointGroupWidth = std::size_t{4};
+
+/// @brief Point-to-point based manifold inputs in a structure of arrays layout.
+template <typename T>
+struct PointGroup
+{
+    /// @brief Array of group values.
+    using Array = std::array<T, PointGroupWidth>;
+
+    alignas(16) Array locAx; ///< X-coordinates of the local locations of A.
+    alignas(16) Array locAy; ///< Y-coordinates of the local locations of A.
+    alignas(16) Array cosA; ///< Cosines of the rotations of A.
+    alignas(16) Array sinA; ///< Sines of the rotations of A.
+    alignas(16) Array posAx; ///< X-coordinates of the translations of A.
+    alignas(16) Array posAy; ///< Y-coordinates of the translations of A.
+    alignas(16) Array locBx; ///< X-coordinates of the local locations of B.
+    alignas(16) Array locBy; ///< Y-coordinates of the local locations of B.
+    alignas(16) Array cosB; ///< Cosines of the rotations of B.
+    alignas(16) Array sinB; ///< Sines of the rotations of B.
+    alignas(16) Array posBx; ///< X-coordinates of the translations of B.
+    alignas(16) Array posBy; ///< Y-coordinates of the translations of B.
+    alignas(16) Array radius; ///< Total radii.
+};
+
+/// @brief Sets the given lane of the given group to the given input.
+template <typename T>
+inline void SetLane(PointGroup<T>& group, std::size_t i, const PointManifoldInput& input) noexcept
+{
+    group.locAx[i] = static_cast<T>(StripUnit(GetX(input.locationA)));
+    group.locAy[i] = static_cast<T>(StripUnit(GetY(input.locationA)));
+    group.cosA[i] = static_cast<T>(GetX(input.xfA.q));
+    group.sinA[i] = static_cast<T>(GetY(input.xfA.q));
+    group.posAx[i] = static_cast<T>(StripUnit(GetX(input.xfA.p)));
+    group.posAy[i] = static_cast<T>(StripUnit(GetY(input.xfA.p)));
+    group.locBx[i] = static_cast<T>(StripUnit(GetX(input.locationB)));
+    group.locBy[i] = static_cast<T>(StripUnit(GetY(input.locationB)));
+    group.cosB[i] = static_cast<T>(GetX(input.xfB.q));
+    group.sinB[i] = static_cast<T>(GetY(input.xfB.q));
+    group.posBx[i] = static_cast<T>(StripUnit(GetX(input.xfB.p)));
+    group.posBy[i] = static_cast<T>(StripUnit(GetY(input.xfB.p)));
+    group.radius[i] = static_cast<T>(StripUnit(input.totalRadius));
+}
+
+/// @brief Gets the bit mask of the lanes of the given group whose points are further apart
+///   than their total radius.
+/// @details Does the same operations in the same order as <code>GetManifold</code> does.
+template <typename T>
+inline unsigned GetSeparatedMask(const PointGroup<T>& group) noexcept
+{
+    auto mask = 0u;
+    for (auto i = std::size_t{0}; i < PointGroupWidth; ++i)
+    {
+        const auto pAx = ((group.cosA[i] * group.locAx[i]) - (group.sinA[i] * group.locAy[i]))
+            + group.posAx[i];
+        const auto pAy = ((group.sinA[i] * group.locAx[i]) + (group.cosA[i] * group.locAy[i]))
+            + group.posAy[i];
+        const auto pBx = ((group.cosB[i] * group.locBx[i]) - (group.sinB[i] * group.locBy[i]))
+            + group.posBx[i];
+        const auto pBy = ((group.sinB[i] * group.locBx[i]) + (group.cosB[i] * group.locBy[i]))
+            + group.posBy[i];
+        const auto dx = pBx - pAx;
+        const auto dy = pBy - pAy;
+        if (((dx * dx) + (dy * dy)) > (group.radius[i] * group.radius[i]))
+        {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+#if defined(PLAYRHO_MANIFOLD_SSE)
+
+/// @brief Gets the bit mask of the lanes of the given group whose points are further apart
+///   than their total radius.
+/// @details Tests all of the lanes at once.
+inline unsigned GetSeparatedMask(const PointGroup<float>& group) noexcept
+{
+    const auto locAx = _mm_load_ps(group.locAx.data());
+    const auto locAy = _mm_load_ps(group.locAy.data());
+    const auto cosA = _mm_load_ps(group.cosA.data());
+    const auto sinA = _mm_load_ps(group.sinA.data());
+    const auto locBx = _mm_load_ps(group.locBx.data());
+    const auto locBy = _mm_load_ps(group.locBy.data());
+    const auto cosB = _mm_load_ps(group.cosB.data());
+    const auto sinB = _mm_load_ps(group.sinB.data());
+    const auto pAx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(cosA, locAx), _mm_mul_ps(sinA, locAy)),
+                                _mm_load_ps(group.posAx.data()));
+    const auto pAy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sinA, locAx), _mm_mul_ps(cosA, locAy)),
+                                _mm_load_ps(group.posAy.data()));
+    const auto pBx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(cosB, locBx), _mm_mul_ps(sinB, locBy)),
+                                _mm_load_ps(group.posBx.data()));
+    const auto pBy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sinB, locBx), _mm_mul_ps(cosB, locBy)),
+                                _mm_load_ps(group.posBy.data()));
+    const auto dx = _mm_sub_ps(pBx, pAx);
+    const auto dy = _mm_sub_ps(pBy, pAy);
+    const auto radius = _mm_load_ps(group.radius.data());
+    const auto separated = _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                        _mm_mul_ps(radius, radius));
+    return static_cast<unsigned>(_mm_movemask_ps(separated));
+}
+
+#endif
+
+} // anonymous namespace
+
+PointManifoldInput GetPointManifoldInput(const Shape& diskA, const Transformation& xfA,
+                                         const Shape& diskB, const Transformation& xfB) noexcept
+{
+    const auto& confA = GetConf<DiskShapeConf>(diskA);
+    const auto& confB = GetConf<DiskShapeConf>(diskB);
+    return PointManifoldInput{
+        confA.location, xfA, confB.location, xfB,
+        Length{confA.vertexRadius} + Length{confB.vertexRadius}
+    };
+}
+
+void GetManifolds(Span<const PointManifoldInput> inputs, Span<Manifold> manifolds)
+{
+    if (size(manifolds) < size(inputs))
+    {
+        throw InvalidArgument("too few manifolds");
+    }
+    auto group = PointGroup<Real>{};
+    for (auto first = std::size_t{0}; first < size(inputs); first += PointGroupWidth)
+    {
+        const auto count = std::min(PointGroupWidth, size(inputs) - first);
+        for (auto i = std::size_t{0}; i < count; ++i)
+        {
+            SetLane(group, i, inputs[first + i]);
+        }
+        const auto separated = GetSeparatedMask(group);
+        for (auto i = std::size_t{0}; i < count; ++i)
+        {
+            const auto& input = inputs[first + i];
+            manifolds[first + i] = ((separated & (1u << i)) != 0u)? Manifold{}:
+                Manifold::GetForCircles(input.locationA, 0, input.locationB, 0);
+        }
+    }
+}
+
+ShapeKind GetShapeKind(const Shape& shape) noexcept
+{
+    const auto& type = GetUseTypeInfo(shape);
+    if (type == typeid(DiskShapeConf))
+    {
+        return ShapeKind::Disk;
+    }
+    if (type == typeid(PolygonShapeConf))
+    {
+        return ShapeKind::Polygon;
+    }
+    if (type == typeid(EdgeShapeConf))
+    {
+        return ShapeKind::Edge;
+    }
+    if (type == typeid(ChainShapeConf))
+    {
+        return ShapeKind::Chain;
+    }
+    return ShapeKind::Other;
+}
+
+CollideShapesFunction GetCollideShapesFunction(ShapeKind kindA, ShapeKind kindB) noexcept
+{
+    return CollideFunctions[static_cast<std::size_t>(kindA)][static_cast<std::size_t>(kindB)];
+}
+
+Manifold CollideShapes(const Shape& shapeA, ChildCounter indexA, const Transformation& xfA,
+                       const Shape& shapeB, ChildCounter indexB, const Transformation& xfB,
+                       Manifold::Conf conf)
+{
+    const auto collide = GetCollideShapesFunction(GetShapeKind(shapeA), GetShapeKind(shapeB));
+    return collide(shapeA, indexA, xfA, shapeB, indexB, xfB, conf);
+}
+
 #if 0
 Manifold CollideCached(const DistanceProxy& shapeA, const Transformation& xfA,
                               const DistanceProxy& shapeB, const Transformation& xfB,
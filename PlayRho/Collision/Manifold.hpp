@@ -28,6 +28,7 @@ namespace playrho {
 namespace d2 {
 
 class DistanceProxy;
+class Shape;
 struct Transformation;
 
 /// @brief A collision response oriented description of the intersection of two convex shapes.
@@ -593,6 +594,98 @@ Manifold GetManifold(Length2 locationA, const Transformation& xfA,
 Manifold CollideShapes(const DistanceProxy& shapeA, const Transformation& xfA,
                        const DistanceProxy& shapeB, const Transformation& xfB,
                        Manifold::Conf conf = GetDefaultManifoldConf());
+
+/// @brief Calculates the relevant collision manifold starting from the given separating axis.
+/// @details Tests the given axis first and returns an empty manifold without looking
+///   for the axis of maximum separation if it separates the shapes. Otherwise calculates
+///   the same manifold as the other distance-proxy-based <code>CollideShapes</code> function.
+///   The given axis is then set to the axis found to separate the shapes or to the
+///   reference face of the returned manifold.
+/// @note The axis isn't used nor changed for shapes having only one vertex.
+/// @relatedalso Manifold
+Manifold CollideShapes(const DistanceProxy& shapeA, const Transformation& xfA,
+                       const DistanceProxy& shapeB, const Transformation& xfB,
+                       SeparatingAxis& axis, Manifold::Conf conf = GetDefaultManifoldConf());
+
+/// @brief Kind of shape configuration that the collision of shapes gets dispatched on.
+/// @sa GetShapeKind, GetCollideShapesFunction.
+enum class ShapeKind: std::uint8_t
+{
+    Disk, ///< Shape whose configuration is a <code>DiskShapeConf</code>.
+    Polygon, ///< Shape whose configuration is a <code>PolygonShapeConf</code>.
+    Edge, ///< Shape whose configuration is an <code>EdgeShapeConf</code>.
+    Chain, ///< Shape whose configuration is a <code>ChainShapeConf</code>.
+    Other ///< Shape whose configuration is of any other type.
+};
+
+/// @brief Count of shape kinds.
+PLAYRHO_CONSTEXPR const auto ShapeKindCount = static_cast<std::size_t>(ShapeKind::Other) + 1u;
+
+/// @brief Gets the kind of the given shape.
+/// @relatedalso Shape
+ShapeKind GetShapeKind(const Shape& shape) noexcept;
+
+/// @brief Whether the manifolds for children of shapes of the given kinds can get calculated
+///   from a separating axis.
+/// @details Pairs involving disks have point based manifolds instead.
+/// @sa SeparatingAxis.
+PLAYRHO_CONSTEXPR inline bool HasSeparatingAxis(ShapeKind kindA, ShapeKind kindB) noexcept
+{
+    return (kindA != ShapeKind::Disk) && (kindB != ShapeKind::Disk);
+}
+
+/// @brief Function type for calculating the collision manifold of children of two shapes.
+using CollideShapesFunction = Manifold (*)(const Shape& shapeA, ChildCounter indexA,
+                                           const Transformation& xfA,
+                                           const Shape& shapeB, ChildCounter indexB,
+                                           const Transformation& xfB,
+                                           Manifold::Conf conf);
+
+/// @brief Gets the collide shapes function for shapes of the given kinds.
+/// @details Gets the entry of a dispatch table whose functions are specialized for their
+///   pair of shape kinds. These get the children of the shapes without virtual dispatch.
+///   Only the disk-disk entry has a calculation of its own, the point-to-point one. The
+///   others use the same general calculation that <code>CollideShapes</code> does.
+/// @warning Behavior is undefined if the kinds don't match those of the shapes the
+///   returned function gets called with.
+/// @sa GetShapeKind.
+CollideShapesFunction GetCollideShapesFunction(ShapeKind kindA, ShapeKind kindB) noexcept;
+
+/// @brief Calculates the relevant collision manifold for the identified children of the
+///   given shapes.
+/// @details This dispatches on the kinds of the shapes and gets the same result as calling
+///   <code>CollideShapes</code> with the children of the shapes.
+/// @throws InvalidArgument if either child index is not less than the child count of its shape.
+/// @relatedalso Manifold
+Manifold CollideShapes(const Shape& shapeA, ChildCounter indexA, const Transformation& xfA,
+                       const Shape& shapeB, ChildCounter indexB, const Transformation& xfB,
+                       Manifold::Conf conf = GetDefaultManifoldConf());
+
+/// @brief Input of a point-to-point based manifold calculation.
+/// @sa GetManifolds.
+struct PointManifoldInput
+{
+    Length2 locationA; ///< Location of point A in the local coordinates of A.
+    Transformation xfA; ///< Transformation of A.
+    Length2 locationB; ///< Location of point B in the local coordinates of B.
+    Transformation xfB; ///< Transformation of B.
+    Length totalRadius; ///< Sum of the radii of A and B.
+};
+
+/// @brief Gets the point-to-point based manifold input for the given disk shapes.
+/// @warning Behavior is undefined if the kind of either shape isn't
+///   <code>ShapeKind::Disk</code>.
+/// @sa GetShapeKind.
+PointManifoldInput GetPointManifoldInput(const Shape& diskA, const Transformation& xfA,
+                                         const Shape& diskB, const Transformation& xfB) noexcept;
+
+/// @brief Gets the point-to-point based manifolds for the given inputs.
+/// @details Gets the same manifolds as calling <code>GetManifold</code> with each of the
+///   inputs but tests four inputs at once using SIMD instructions where available.
+/// @throws InvalidArgument if there are fewer manifolds than inputs.
+/// @relatedalso Manifold
+void GetManifolds(Span<const PointManifoldInput> inputs, Span<Manifold> manifolds);
+
 #if 0
 Manifold CollideCached(const DistanceProxy& shapeA, const Transformation& xfA,
                        const DistanceProxy& shapeB, const Transformation& xfB,
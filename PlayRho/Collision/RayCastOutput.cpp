@@ -19,6 +19,7 @@
 
 #include <PlayRho/Common/Math.hpp>
 #include <PlayRho/Common/GrowableStack.hpp>
+#include <PlayRho/Common/InvalidArgument.hpp>
 #include <PlayRho/Collision/RayCastOutput.hpp>
 #include <PlayRho/Collision/RayCastInput.hpp>
 #include <PlayRho/Collision/AABB.hpp>
@@ -26,11 +27,188 @@
 #include <PlayRho/Collision/DynamicTree.hpp>
 #include <PlayRho/Dynamics/Fixture.hpp>
 #include <PlayRho/Dynamics/Body.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <utility>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#define PLAYRHO_RAYCAST_SSE
+#include <xmmintrin.h>
+#endif
 
 namespace playrho {
 namespace d2 {
 
+namespace {
+
+/// @brief Ray that's tested against many AABBs.
+struct SlabRay
+{
+    /// @brief Reciprocal of a length.
+    using Reciprocal = decltype(Real{1} / Length{1});
+    
+    /// @brief Initializing constructor.
+    explicit SlabRay(const RayCastInput& input) noexcept:
+        p1{input.p1}, delta{input.p2 - input.p1}
+    {
+        for (auto i = decltype(delta.max_size()){0}; i < delta.max_size(); ++i)
+        {
+            isParallel[i] = AlmostZero(StripUnit(delta[i]));
+            reciprocal[i] = isParallel[i]? Reciprocal{0}: Real{1} / delta[i];
+        }
+    }
+    
+    Length2 p1; ///< Start of the ray.
+    Length2 delta; ///< Ray delta (p2 - p1).
+    std::array<Reciprocal, 2> reciprocal; ///< Reciprocals of the delta's elements.
+    std::array<bool, 2> isParallel; ///< Whether the ray is parallel to the axes.
+};
+
+/// @brief Gets the fraction at which the given ray enters the given AABB.
+/// @details Uses the slab test from Real-time Collision Detection, p179.
+/// @return Zero if the ray starts within the AABB, the fraction at which the ray enters
+///   it if the ray does so within the given max fraction, or infinity otherwise.
+Real GetEntryFraction(const SlabRay& ray, const AABB& aabb, Real maxFraction) noexcept
+{
+    auto tmin = Real{0};
+    auto tmax = maxFraction;
+    for (auto i = decltype(ray.delta.max_size()){0}; i < ray.delta.max_size(); ++i)
+    {
+        const auto range = aabb.ranges[i];
+        if (ray.isParallel[i])
+        {
+            if ((ray.p1[i] < range.GetMin()) || (ray.p1[i] > range.GetMax()))
+            {
+                return std::numeric_limits<Real>::infinity();
+            }
+        }
+        else
+        {
+            auto t1 = Real{(range.GetMin() - ray.p1[i]) * ray.reciprocal[i]};
+            auto t2 = Real{(range.GetMax() - ray.p1[i]) * ray.reciprocal[i]};
+            if (t1 > t2)
+            {
+                std::swap(t1, t2);
+            }
+            tmin = std::max(tmin, t1);
+            tmax = std::min(tmax, t2);
+            if (tmin > tmax)
+            {
+                return std::numeric_limits<Real>::infinity();
+            }
+        }
+    }
+    return tmin;
+}
+
+/// @brief Count of rays in a ray group.
+PLAYRHO_CONSTEXPR const auto RayGroupWidth = std::size_t{4};
+
+/// @brief Group of rays laid out for testing all of them against an AABB at once.
+/// @details Uses the greatest value instead of infinity for the reciprocals of deltas
+///   that are parallel to the axes so that none of the fractions are NaN.
+template <typename T>
+struct RayGroup
+{
+    alignas(16) std::array<T, RayGroupWidth> p1x; ///< X coordinates of the first points.
+    alignas(16) std::array<T, RayGroupWidth> p1y; ///< Y coordinates of the first points.
+    alignas(16) std::array<T, RayGroupWidth> reciprocalX; ///< Reciprocals of the X deltas.
+    alignas(16) std::array<T, RayGroupWidth> reciprocalY; ///< Reciprocals of the Y deltas.
+    alignas(16) std::array<T, RayGroupWidth> maxFraction; ///< Max fractions of the rays.
+};
+
+/// @brief Gets the ray group for the given rays.
+/// @details Pads the group with rays that don't hit anything if there are fewer rays
+///   than the group width.
+RayGroup<Real> GetRayGroup(const RayCastInput* inputs, std::size_t count) noexcept
+{
+    auto group = RayGroup<Real>{};
+    for (auto i = std::size_t{0}; i < RayGroupWidth; ++i)
+    {
+        if (i >= count)
+        {
+            group.p1x[i] = 0;
+            group.p1y[i] = 0;
+            group.reciprocalX[i] = 0;
+            group.reciprocalY[i] = 0;
+            group.maxFraction[i] = -1;
+            continue;
+        }
+        const auto ray = SlabRay{inputs[i]};
+        const auto greatest = std::numeric_limits<Real>::max();
+        group.p1x[i] = StripUnit(GetX(ray.p1));
+        group.p1y[i] = StripUnit(GetY(ray.p1));
+        group.reciprocalX[i] = ray.isParallel[0]? greatest: StripUnit(ray.reciprocal[0]);
+        group.reciprocalY[i] = ray.isParallel[1]? greatest: StripUnit(ray.reciprocal[1]);
+        group.maxFraction[i] = inputs[i].maxFraction;
+    }
+    return group;
+}
+
+/// @brief Gets the bit mask of the rays of the given group that enter the given AABB.
+/// @param entry Set to the least of the fractions at which the rays enter the AABB.
+template <typename T>
+unsigned GetHitMask(const RayGroup<T>& group, const AABB& aabb, T& entry) noexcept
+{
+    const auto minX = StripUnit(aabb.ranges[0].GetMin());
+    const auto maxX = StripUnit(aabb.ranges[0].GetMax());
+    const auto minY = StripUnit(aabb.ranges[1].GetMin());
+    const auto maxY = StripUnit(aabb.ranges[1].GetMax());
+    auto mask = 0u;
+    entry = std::numeric_limits<T>::infinity();
+    for (auto i = std::size_t{0}; i < RayGroupWidth; ++i)
+    {
+        const auto tx1 = (minX - group.p1x[i]) * group.reciprocalX[i];
+        const auto tx2 = (maxX - group.p1x[i]) * group.reciprocalX[i];
+        const auto ty1 = (minY - group.p1y[i]) * group.reciprocalY[i];
+        const auto ty2 = (maxY - group.p1y[i]) * group.reciprocalY[i];
+        const auto tmin = std::max(std::max(T{0}, std::min(tx1, tx2)), std::min(ty1, ty2));
+        const auto tmax = std::min(std::min(group.maxFraction[i], std::max(tx1, tx2)),
+                                   std::max(ty1, ty2));
+        if (tmin <= tmax)
+        {
+            mask |= 1u << i;
+            entry = std::min(entry, tmin);
+        }
+    }
+    return mask;
+}
+
+#if defined(PLAYRHO_RAYCAST_SSE)
+
+/// @brief Gets the bit mask of the rays of the given group that enter the given AABB.
+/// @details Tests all of the rays at once.
+/// @param entry Set to the least of the fractions at which the rays enter the AABB.
+inline unsigned GetHitMask(const RayGroup<float>& group, const AABB& aabb, float& entry) noexcept
+{
+    const auto p1x = _mm_load_ps(group.p1x.data());
+    const auto p1y = _mm_load_ps(group.p1y.data());
+    const auto rx = _mm_load_ps(group.reciprocalX.data());
+    const auto ry = _mm_load_ps(group.reciprocalY.data());
+    const auto tx1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(StripUnit(aabb.ranges[0].GetMin())), p1x), rx);
+    const auto tx2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(StripUnit(aabb.ranges[0].GetMax())), p1x), rx);
+    const auto ty1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(StripUnit(aabb.ranges[1].GetMin())), p1y), ry);
+    const auto ty2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(StripUnit(aabb.ranges[1].GetMax())), p1y), ry);
+    const auto tmin = _mm_max_ps(_mm_max_ps(_mm_setzero_ps(), _mm_min_ps(tx1, tx2)),
+                                 _mm_min_ps(ty1, ty2));
+    const auto tmax = _mm_min_ps(_mm_min_ps(_mm_load_ps(group.maxFraction.data()),
+                                            _mm_max_ps(tx1, tx2)), _mm_max_ps(ty1, ty2));
+    const auto hit = _mm_cmple_ps(tmin, tmax);
+    const auto mask = static_cast<unsigned>(_mm_movemask_ps(hit));
+    alignas(16) auto entries = std::array<float, RayGroupWidth>{};
+    _mm_store_ps(entries.data(), _mm_or_ps(_mm_and_ps(hit, tmin),
+        _mm_andnot_ps(hit, _mm_set1_ps(std::numeric_limits<float>::infinity()))));
+    entry = std::min(std::min(entries[0], entries[1]), std::min(entries[2], entries[3]));
+    return mask;
+}
+
+#endif
+
+} // anonymous namespace
+
 RayCastOutput RayCast(Length radius, Length2 location, const RayCastInput& input) noexcept
 {
     // Collision Detection in Interactive 3D Environments by Gino van den Bergen
@@ -165,6 +343,26 @@ RayCastOutput RayCast(const DistanceProxy& proxy, const RayCastInput& input,
     const auto ray0 = transformedInput.p1;
     const auto ray = transformedInput.p2 - transformedInput.p1; // Ray delta (p2 - p1)
     
+    // For proxies with many vertices, first rejects rays that miss the proxy's extents across
+    // or along the ray. Their supporting vertices take logarithmic time to find.
+    if (vertexCount >= MinSupportSearchVertices)
+    {
+        const auto along = GetUnitVector(ray);
+        if (IsValid(along))
+        {
+            const auto across = along.GetFwdPerpendicular();
+            const auto getOffset = [&](UnitVec dir, UnitVec axis) {
+                return Dot(proxy.GetVertex(GetSupportIndex(proxy, dir)) - ray0, axis);
+            };
+            const auto rayLength = GetMagnitude(ray) * Real{input.maxFraction};
+            if ((getOffset(across, across) < -radius) || (getOffset(-across, across) > radius) ||
+                (getOffset(along, along) < -radius) || (getOffset(-along, along) > rayLength + radius))
+            {
+                return RayCastOutput{};
+            }
+        }
+    }
+
     auto minT = nextafter(Real{input.maxFraction}, Real(2));
     auto normalFound = GetInvalid<UnitVec>();
     
@@ -231,100 +429,225 @@ RayCastOutput RayCast(const Shape& shape, ChildCounter childIndex,
     return RayCast(GetChild(shape, childIndex), input, transform);
 }
 
+RayCastOutput RayCast(const Fixture& fixture, ChildCounter childIndex,
+                      const RayCastInput& input)
+{
+    return RayCast(GetChild(fixture.GetShape(), childIndex), input,
+                   fixture.GetBody()->GetTransformation());
+}
+
 bool RayCast(const DynamicTree& tree, RayCastInput input, const DynamicTreeRayCastCB& callback)
-{    
-    const auto v = GetRevPerpendicular(GetUnitVector(input.p2 - input.p1, UnitVec::GetZero()));
-    const auto abs_v = abs(v);
-    auto segmentAABB = d2::GetAABB(input);
+{
+    return RayCast<const DynamicTreeRayCastCB&>(tree, input, callback);
+}
+
+bool RayCast(const DynamicTree& tree, const RayCastInput& input, FixtureRayCastCB callback)
+{
+    return RayCast<FixtureRayCastCB&>(tree, input, callback);
+}
+
+FixtureRayCastOutput RayCastClosest(const DynamicTree& tree, const RayCastInput& input)
+{
+    struct Entry
+    {
+        DynamicTree::Size index; ///< Index of the node.
+        Real fraction; ///< Fraction at which the ray enters the node's AABB.
+    };
     
-    GrowableStack<ContactCounter, 256> stack;
-    stack.push(tree.GetRootIndex());
+    auto result = FixtureRayCastOutput{};
+    const auto root = tree.GetRootIndex();
+    if (root == DynamicTree::GetInvalidSize())
+    {
+        return result;
+    }
+    
+    const auto ray = SlabRay{input};
+    auto clipped = input;
+    GrowableStack<Entry, 256> stack;
+    stack.push(Entry{root, GetEntryFraction(ray, tree.GetAABB(root), input.maxFraction)});
     while (!empty(stack))
     {
-        const auto index = stack.top();
+        const auto entry = stack.top();
         stack.pop();
-        if (index == DynamicTree::GetInvalidSize())
+        if (entry.fraction > clipped.maxFraction)
         {
-            continue;
-        }
-        
-        const auto aabb = tree.GetAABB(index);
-        if (!TestOverlap(aabb, segmentAABB))
-        {
-            continue;
-        }
-        
-        // Separating axis for segment (Gino, p80).
-        // |dot(v, p1 - ctr)| > dot(|v|, extents)
-        const auto center = GetCenter(aabb);
-        const auto extents = GetExtents(aabb);
-        const auto separation = abs(Dot(v, input.p1 - center)) - Dot(abs_v, extents);
-        if (separation > 0_m)
-        {
-            continue;
+            continue; // The ray got clipped to a hit before reaching the node.
         }
         
-        if (DynamicTree::IsBranch(tree.GetHeight(index)))
+        if (DynamicTree::IsBranch(tree.GetHeight(entry.index)))
         {
-            const auto branchData = tree.GetBranchData(index);
-            stack.push(branchData.child1);
-            stack.push(branchData.child2);
+            const auto branchData = tree.GetBranchData(entry.index);
+            const auto maxFraction = Real{clipped.maxFraction};
+            auto nearer = Entry{branchData.child1,
+                GetEntryFraction(ray, tree.GetAABB(branchData.child1), maxFraction)};
+            auto farther = Entry{branchData.child2,
+                GetEntryFraction(ray, tree.GetAABB(branchData.child2), maxFraction)};
+            if (nearer.fraction > farther.fraction)
+            {
+                std::swap(nearer, farther);
+            }
+            
+            // Push the farther child first so that the nearer one gets visited first.
+            if (farther.fraction <= maxFraction)
+            {
+                stack.push(farther);
+            }
+            if (nearer.fraction <= maxFraction)
+            {
+                stack.push(nearer);
+            }
         }
         else
         {
-            assert(DynamicTree::IsLeaf(tree.GetHeight(index)));
-            const auto leafData = tree.GetLeafData(index);
-            const auto value = callback(leafData.fixture, leafData.childIndex, input);
-            if (value == 0)
-            {
-                return true; // Callback has terminated the ray cast.
-            }
-            if (value > 0)
+            const auto leafData = tree.GetLeafData(entry.index);
+            const auto output = RayCast(*leafData.fixture, leafData.childIndex, clipped);
+            if (output.has_value() && (!result.has_value() || (output->fraction < result->fraction)))
             {
-                // Update segment bounding box.
-                input.maxFraction = value;
-                segmentAABB = d2::GetAABB(input);
+                const auto fraction = Real{output->fraction};
+                result = FixtureRayCastHit{
+                    leafData.fixture, leafData.childIndex, ray.p1 + ray.delta * fraction,
+                    output->normal, output->fraction
+                };
+                clipped.maxFraction = output->fraction;
             }
         }
     }
-    return false;
+    return result;
 }
 
-bool RayCast(const DynamicTree& tree, const RayCastInput& rci, FixtureRayCastCB callback)
+void RayCastClosest(const DynamicTree& tree, Span<const RayCastInput> inputs,
+                    Span<FixtureRayCastOutput> outputs)
 {
-    return RayCast(tree, rci, [callback](Fixture* fixture, ChildCounter index, const RayCastInput& input) {
-        const auto output = RayCast(GetChild(fixture->GetShape(), index), input,
-                                    fixture->GetBody()->GetTransformation());
-        if (output.has_value())
+    struct Entry
+    {
+        DynamicTree::Size index; ///< Index of the node.
+        Real fraction; ///< Least fraction at which the rays enter the node's AABB.
+        std::size_t begin; ///< Index of the first of the node's ray groups.
+        std::size_t end; ///< Index of one past the last of the node's ray groups.
+        std::size_t top; ///< Count of groups in use when the node was pushed.
+    };
+    
+    if (size(outputs) < size(inputs))
+    {
+        throw InvalidArgument("too few outputs");
+    }
+    for (auto& output: outputs)
+    {
+        output = FixtureRayCastOutput{};
+    }
+    const auto root = tree.GetRootIndex();
+    if ((root == DynamicTree::GetInvalidSize()) || empty(inputs))
+    {
+        return;
+    }
+    
+    auto groups = std::vector<RayGroup<Real>>{};
+    auto bounds = GetAABB(inputs[0]);
+    for (auto i = std::size_t{0}; i < size(inputs); i += RayGroupWidth)
+    {
+        groups.push_back(GetRayGroup(inputs.begin() + i, size(inputs) - i));
+    }
+    for (const auto& input: inputs)
+    {
+        Include(bounds, GetAABB(input));
+    }
+    
+    // Indices of the ray groups of the nodes on the stack. The groups of every node follow
+    // those of the nodes pushed before it so they're released in stack order too, going
+    // back to the count that was in use when the node got pushed.
+    auto active = std::vector<std::uint32_t>{};
+    active.reserve(size(groups) * 4);
+    for (auto i = std::size_t{0}; i < size(groups); ++i)
+    {
+        active.push_back(static_cast<std::uint32_t>(i));
+    }
+    
+    // Appends the groups of the given range having rays entering the given node's AABB.
+    const auto appendHits = [&](DynamicTree::Size index, std::size_t begin, std::size_t end) {
+        auto entry = Entry{index, std::numeric_limits<Real>::infinity(), size(active), 0, 0};
+        const auto aabb = tree.GetAABB(index);
+        if (TestOverlap(bounds, aabb))
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto groupIndex = active[i];
+                auto fraction = Real{0};
+                if (GetHitMask(groups[groupIndex], aabb, fraction) != 0)
+                {
+                    active.push_back(groupIndex);
+                    entry.fraction = std::min(entry.fraction, fraction);
+                }
+            }
+        }
+        entry.end = size(active);
+        entry.top = entry.end;
+        return entry;
+    };
+    
+    GrowableStack<Entry, 256> stack;
+    stack.push(appendHits(root, 0, size(groups)));
+    while (!empty(stack))
+    {
+        const auto entry = stack.top();
+        stack.pop();
+        active.resize(entry.top);
+        if (entry.begin == entry.end)
+        {
+            continue;
+        }
+        
+        if (DynamicTree::IsBranch(tree.GetHeight(entry.index)))
         {
-            const auto fraction = output->fraction;
-            assert(fraction >= 0 && fraction <= 1);
+            const auto branchData = tree.GetBranchData(entry.index);
+            auto nearer = appendHits(branchData.child1, entry.begin, entry.end);
+            auto farther = appendHits(branchData.child2, entry.begin, entry.end);
+            nearer.top = farther.top;
+            if (nearer.fraction > farther.fraction)
+            {
+                std::swap(nearer, farther);
+            }
             
-            // Here point can be calculated these two ways:
-            //   (1) point = p1 * (1 - fraction) + p2 * fraction
-            //   (2) point = p1 + (p2 - p1) * fraction.
-            //
-            // The first way however suffers from the fact that:
-            //     a * (1 - fraction) + a * fraction != a
-            // for all values of a and fraction between 0 and 1 when a and fraction are
-            // floating point types.
-            // This leads to the posibility that (p1 == p2) && (point != p1 || point != p2),
-            // which may be pretty surprising to the callback. So this way SHOULD NOT be used.
-            //
-            // The second way, does not have this problem.
-            //
-            const auto point = input.p1 + (input.p2 - input.p1) * fraction;
-            const auto opcode = callback(fixture, index, point, output->normal);
-            switch (opcode)
+            // Push the farther child first so that the nearer one gets visited first.
+            stack.push(farther);
+            stack.push(nearer);
+        }
+        else
+        {
+            const auto leafData = tree.GetLeafData(entry.index);
+            const auto aabb = tree.GetAABB(entry.index);
+            const auto proxy = GetChild(leafData.fixture->GetShape(), leafData.childIndex);
+            const auto xf = leafData.fixture->GetBody()->GetTransformation();
+            for (auto i = entry.begin; i < entry.end; ++i)
             {
-                case RayCastOpcode::Terminate: return Real{0};
-                case RayCastOpcode::IgnoreFixture: return Real{-1};
-                case RayCastOpcode::ClipRay: return Real{fraction};
-                case RayCastOpcode::ResetRay: return Real{input.maxFraction};
+                auto& group = groups[active[i]];
+                auto fraction = Real{0};
+                const auto mask = GetHitMask(group, aabb, fraction);
+                for (auto j = std::size_t{0}; j < RayGroupWidth; ++j)
+                {
+                    if ((mask & (1u << j)) == 0)
+                    {
+                        continue;
+                    }
+                    const auto rayIndex = active[i] * RayGroupWidth + j;
+                    auto input = inputs[rayIndex];
+                    input.maxFraction = UnitInterval<Real>{group.maxFraction[j]};
+                    const auto output = RayCast(proxy, input, xf);
+                    auto& result = outputs[rayIndex];
+                    if (output.has_value() &&
+                        (!result.has_value() || (output->fraction < result->fraction)))
+                    {
+                        const auto hitFraction = Real{output->fraction};
+                        result = FixtureRayCastHit{
+                            leafData.fixture, leafData.childIndex,
+                            input.p1 + (input.p2 - input.p1) * hitFraction,
+                            output->normal, output->fraction
+                        };
+                        group.maxFraction[j] = hitFraction;
+                    }
+                }
             }
         }
-        return Real{input.maxFraction};
-    });
+    }
 }
 
 } // namespace d2
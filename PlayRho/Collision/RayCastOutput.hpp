@@ -28,6 +28,11 @@
 #include <PlayRho/Common/BoundedValue.hpp>
 #include <PlayRho/Common/OptionalValue.hpp>
 #include <PlayRho/Collision/RayCastInput.hpp>
+#include <PlayRho/Collision/DynamicTree.hpp>
+#include <PlayRho/Common/GrowableStack.hpp>
+#include <PlayRho/Common/Span.hpp>
+
+#include <type_traits>
 
 namespace playrho {
 namespace detail {
@@ -65,7 +70,6 @@ namespace d2 {
 class Shape;
 class Fixture;
 class DistanceProxy;
-class DynamicTree;
 
 /// @brief Ray-cast hit data.
 /// @details The ray hits at <code>p1 + fraction * (p2 - p1)</code>, where
@@ -85,6 +89,25 @@ struct RayCastHit
 /// @sa RayCast, Optional, RayCastHit
 using RayCastOutput = Optional<RayCastHit>;
 
+/// @brief Fixture ray-cast hit data.
+/// @details Identifies the child of a fixture that a ray hit and where the ray hit it.
+struct FixtureRayCastHit
+{
+    Fixture* fixture = nullptr; ///< Fixture that was hit.
+    ChildCounter childIndex = 0; ///< Child index of the fixture's shape that was hit.
+    Length2 point; ///< Point in world coordinates at which the ray hit.
+    UnitVec normal; ///< Surface normal in world coordinates at the point.
+    
+    /// @brief Fraction.
+    /// @note The ray hits at <code>p1 + fraction * (p2 - p1)</code>.
+    UnitInterval<Real> fraction = UnitInterval<Real>{0};
+};
+
+/// @brief Fixture ray cast output.
+/// @details This is a type alias for an optional <code>FixtureRayCastHit</code> instance.
+/// @sa RayCastClosest, Optional, FixtureRayCastHit
+using FixtureRayCastOutput = Optional<FixtureRayCastHit>;
+
 /// @brief Ray cast callback function.
 /// @note Return 0 to terminate ray casting, or > 0 to update the segment bounding box.
 using DynamicTreeRayCastCB = std::function<Real(Fixture* fixture, ChildCounter child,
@@ -128,6 +151,244 @@ RayCastOutput RayCast(const DistanceProxy& proxy, const RayCastInput& input,
 RayCastOutput RayCast(const Shape& shape, ChildCounter childIndex,
                       const RayCastInput& input, const Transformation& transform) noexcept;
 
+/// @brief Cast a ray against the child of the given fixture.
+/// @note This is a convenience function for calling the ray cast against the child of
+///   the fixture's shape transformed by the fixture's body's transformation.
+/// @param fixture Fixture.
+/// @param childIndex Child index.
+/// @param input the ray-cast input parameters.
+/// @relatedalso Fixture
+RayCastOutput RayCast(const Fixture& fixture, ChildCounter childIndex,
+                      const RayCastInput& input);
+
+/// @brief Cast rays against the leafs in the given tree.
+/// @details This is the callable type templated equivalent of the
+///   <code>DynamicTreeRayCastCB</code> taking ray cast that lets the callback get inlined
+///   into the tree traversal instead of being called through a <code>std::function</code>.
+/// @param tree Dynamic tree to ray cast.
+/// @param input the ray-cast input data.
+/// @param callback Callable object that's called for each leaf that is hit by the ray.
+///   It should return 0 to terminate ray casting, or greater than 0 to update the
+///   segment bounding box. Values less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, Fixture*, ChildCounter, const RayCastInput&>::value, bool>
+RayCast(const DynamicTree& tree, RayCastInput input, F&& callback)
+{
+    const auto v = GetRevPerpendicular(GetUnitVector(input.p2 - input.p1, UnitVec::GetZero()));
+    const auto abs_v = abs(v);
+    auto segmentAABB = d2::GetAABB(input);
+    
+    GrowableStack<ContactCounter, 256> stack;
+    stack.push(tree.GetRootIndex());
+    while (!empty(stack))
+    {
+        const auto index = stack.top();
+        stack.pop();
+        if (index == DynamicTree::GetInvalidSize())
+        {
+            continue;
+        }
+        
+        const auto aabb = tree.GetAABB(index);
+        if (!TestOverlap(aabb, segmentAABB))
+        {
+            continue;
+        }
+        
+        // Separating axis for segment (Gino, p80).
+        // |dot(v, p1 - ctr)| > dot(|v|, extents)
+        const auto center = GetCenter(aabb);
+        const auto extents = GetExtents(aabb);
+        const auto separation = abs(Dot(v, input.p1 - center)) - Dot(abs_v, extents);
+        if (separation > 0_m)
+        {
+            continue;
+        }
+        
+        if (DynamicTree::IsBranch(tree.GetHeight(index)))
+        {
+            const auto branchData = tree.GetBranchData(index);
+            stack.push(branchData.child1);
+            stack.push(branchData.child2);
+        }
+        else
+        {
+            assert(DynamicTree::IsLeaf(tree.GetHeight(index)));
+            const auto leafData = tree.GetLeafData(index);
+            const auto value = static_cast<Real>(callback(leafData.fixture, leafData.childIndex, input));
+            if (value == 0)
+            {
+                return true; // Callback has terminated the ray cast.
+            }
+            if (value > 0)
+            {
+                // Update segment bounding box.
+                input.maxFraction = value;
+                segmentAABB = d2::GetAABB(input);
+            }
+        }
+    }
+    return false;
+}
+
+/// @brief Ray casts the given fixture child on behalf of the given fixture ray cast callback.
+/// @details Adapts a callable having the <code>FixtureRayCastCB</code> signature into the
+///   value that a leaf level ray cast callback returns.
+/// @return Value for the leaf level ray cast to continue with.
+/// @relatedalso Fixture
+template <typename F>
+Real RayCastFixtureChild(Fixture* fixture, ChildCounter child, const RayCastInput& input,
+                         F& callback)
+{
+    const auto output = RayCast(*fixture, child, input);
+    if (output.has_value())
+    {
+        const auto fraction = output->fraction;
+        assert(fraction >= 0 && fraction <= 1);
+        
+        // Here point can be calculated these two ways:
+        //   (1) point = p1 * (1 - fraction) + p2 * fraction
+        //   (2) point = p1 + (p2 - p1) * fraction.
+        //
+        // The first way however suffers from the fact that:
+        //     a * (1 - fraction) + a * fraction != a
+        // for all values of a and fraction between 0 and 1 when a and fraction are
+        // floating point types.
+        // This leads to the posibility that (p1 == p2) && (point != p1 || point != p2),
+        // which may be pretty surprising to the callback. So this way SHOULD NOT be used.
+        //
+        // The second way, does not have this problem.
+        //
+        const auto point = input.p1 + (input.p2 - input.p1) * fraction;
+        const auto opcode = RayCastOpcode{callback(fixture, child, point, output->normal)};
+        switch (opcode)
+        {
+            case RayCastOpcode::Terminate: return Real{0};
+            case RayCastOpcode::IgnoreFixture: return Real{-1};
+            case RayCastOpcode::ClipRay: return Real{fraction};
+            case RayCastOpcode::ResetRay: return Real{input.maxFraction};
+        }
+    }
+    return Real{input.maxFraction};
+}
+
+/// @brief Ray-cast the dynamic tree for all fixtures in the path of the ray.
+/// @details This is the callable type templated equivalent of the
+///   <code>FixtureRayCastCB</code> taking ray cast.
+/// @param tree Dynamic tree to ray cast.
+/// @param input Ray cast input data.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const DynamicTree& tree, const RayCastInput& input, F&& callback)
+{
+    return RayCast(tree, input, [&callback](Fixture* fixture, ChildCounter child,
+                                            const RayCastInput& in) {
+        return RayCastFixtureChild(fixture, child, in, callback);
+    });
+}
+
+/// @brief Cast rays against the leafs in the given tree that have any of the given
+///   category bits.
+/// @details Skips whole sub-trees whose branch category bits don't have any of the mask
+///   bits in common since none of the leaves under them can then match.
+/// @note Leaves without any category bits are never called back for.
+/// @param tree Dynamic tree to ray cast.
+/// @param input the ray-cast input data.
+/// @param maskBits Mask of the category bits to call back for leaves having any of.
+/// @param callback Callable object that's called for each matching leaf that is hit by
+///   the ray. It should return 0 to terminate ray casting, or greater than 0 to update the
+///   segment bounding box. Values less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @see Filter
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, Fixture*, ChildCounter, const RayCastInput&>::value, bool>
+RayCast(const DynamicTree& tree, RayCastInput input, Filter::bits_type maskBits, F&& callback)
+{
+    const auto v = GetRevPerpendicular(GetUnitVector(input.p2 - input.p1, UnitVec::GetZero()));
+    const auto abs_v = abs(v);
+    auto segmentAABB = d2::GetAABB(input);
+    
+    GrowableStack<ContactCounter, 256> stack;
+    stack.push(tree.GetRootIndex());
+    while (!empty(stack))
+    {
+        const auto index = stack.top();
+        stack.pop();
+        if (index == DynamicTree::GetInvalidSize())
+        {
+            continue;
+        }
+        
+        if ((tree.GetCategoryBits(index) & maskBits) == 0)
+        {
+            continue;
+        }
+        
+        const auto aabb = tree.GetAABB(index);
+        if (!TestOverlap(aabb, segmentAABB))
+        {
+            continue;
+        }
+        
+        // Separating axis for segment (Gino, p80).
+        // |dot(v, p1 - ctr)| > dot(|v|, extents)
+        const auto center = GetCenter(aabb);
+        const auto extents = GetExtents(aabb);
+        const auto separation = abs(Dot(v, input.p1 - center)) - Dot(abs_v, extents);
+        if (separation > 0_m)
+        {
+            continue;
+        }
+        
+        if (DynamicTree::IsBranch(tree.GetHeight(index)))
+        {
+            const auto branchData = tree.GetBranchData(index);
+            stack.push(branchData.child1);
+            stack.push(branchData.child2);
+        }
+        else
+        {
+            assert(DynamicTree::IsLeaf(tree.GetHeight(index)));
+            const auto leafData = tree.GetLeafData(index);
+            const auto value = static_cast<Real>(callback(leafData.fixture, leafData.childIndex, input));
+            if (value == 0)
+            {
+                return true; // Callback has terminated the ray cast.
+            }
+            if (value > 0)
+            {
+                // Update segment bounding box.
+                input.maxFraction = value;
+                segmentAABB = d2::GetAABB(input);
+            }
+        }
+    }
+    return false;
+}
+
+/// @brief Ray-cast the dynamic tree for all fixtures in the path of the ray that have
+///   any of the given category bits.
+/// @param tree Dynamic tree to ray cast.
+/// @param input Ray cast input data.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const DynamicTree& tree, const RayCastInput& input, Filter::bits_type maskBits,
+        F&& callback)
+{
+    return RayCast(tree, input, maskBits, [&callback](Fixture* fixture, ChildCounter child,
+                                                      const RayCastInput& in) {
+        return RayCastFixtureChild(fixture, child, in, callback);
+    });
+}
+
 /// @brief Cast rays against the leafs in the given tree.
 ///
 /// @note This relies on the callback to perform an exact ray-cast in the case where the
@@ -161,6 +422,38 @@ bool RayCast(const DynamicTree& tree, RayCastInput input, const DynamicTreeRayCa
 ///
 bool RayCast(const DynamicTree& tree, const RayCastInput& input, FixtureRayCastCB callback);
 
+/// @brief Ray-casts the dynamic tree for the closest fixture child in the path of the ray.
+/// @details Traverses the tree front-to-back by visiting the child of every branch that
+///   the ray enters first before the other one and clips the ray to every hit found. So
+///   sub-trees the ray enters beyond the closest hit found so far don't get visited.
+/// @note This is equivalent to ray-casting with a callback that returns
+///   <code>RayCastOpcode::ClipRay</code> for every hit and keeps the last hit but it doesn't
+///   have to call back for anything.
+/// @note The ray-cast ignores shapes that contain the starting point.
+/// @param tree Dynamic tree to ray cast.
+/// @param input Ray cast input data.
+/// @return Closest hit if the ray hit anything, or an empty value otherwise.
+FixtureRayCastOutput RayCastClosest(const DynamicTree& tree, const RayCastInput& input);
+
+/// @brief Ray-casts the dynamic tree for the closest fixture children in the paths of the
+///   given packet of rays.
+/// @details Traverses the tree once for all of the rays instead of once per ray. Nodes
+///   outside of the bounds of the whole packet get culled without testing any rays against
+///   them and the rest get tested against groups of rays at once. Leaves get tested against
+///   all of the rays still reaching them with their fixture's shape and transformation
+///   looked up only once.
+/// @note Rays sharing the same origin, like the fans of rays of line-of-sight checks, are
+///   the most coherent and get the most benefit from this.
+/// @note Gets the same results as ray-casting the tree for the closest hit of every ray.
+/// @param tree Dynamic tree to ray cast.
+/// @param inputs Ray cast input data of the rays.
+/// @param outputs Output data for the rays. Gets set to the closest hit of the ray at the
+///   same index of the inputs or to an empty value for rays that didn't hit anything.
+/// @throws InvalidArgument if the outputs has fewer elements than the inputs.
+/// @sa RayCastClosest(const DynamicTree&, const RayCastInput&).
+void RayCastClosest(const DynamicTree& tree, Span<const RayCastInput> inputs,
+                    Span<FixtureRayCastOutput> outputs);
+
 /// @}
 
 } // namespace d2
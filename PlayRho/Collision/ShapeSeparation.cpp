@@ -64,6 +64,59 @@ LengthIndices GetMinSeparationInfo(Length2 origin, UnitVec direction,
     return LengthIndices{minSeparation, {{first, second}}};
 }
 
+/// @brief Gets the minimum separation information for the vertices of the given proxy
+///   from the given origin in the given direction.
+/// @details Gets the same information as checking every vertex does. For proxies having
+///   at least <code>MinSupportSearchVertices</code> vertices this starts from the vertex
+///   found by <code>GetSupportIndexBySearch</code> and only checks the vertices around it.
+LengthIndices GetMinSeparationInfo(Length2 origin, UnitVec direction, const DistanceProxy& proxy)
+{
+    const auto count = proxy.GetVertexCount();
+    const auto start = (count >= MinSupportSearchVertices)?
+        GetSupportIndexBySearch(proxy, -GetVec2(direction)): InvalidVertex;
+    if (start == InvalidVertex)
+    {
+        return GetMinSeparationInfo(origin, direction, proxy.GetVertices());
+    }
+
+    // Climbs down past any vertex that rounding misplaced the search by.
+    const auto getSeparation = [&](VertexCounter i) {
+        return Dot(direction, proxy.GetVertex(i) - origin);
+    };
+    auto first = start;
+    auto minSeparation = getSeparation(first);
+    for (auto next = GetModuloNext(first, count); getSeparation(next) < minSeparation;
+         next = GetModuloNext(first, count))
+    {
+        first = next;
+        minSeparation = getSeparation(first);
+    }
+    for (auto prev = GetModuloPrev(first, count); getSeparation(prev) < minSeparation;
+         prev = GetModuloPrev(first, count))
+    {
+        first = prev;
+        minSeparation = getSeparation(first);
+    }
+
+    // Any other vertex that's as separated makes an edge whose lower index is first.
+    auto second = InvalidVertex;
+    const auto next = GetModuloNext(first, count);
+    const auto prev = GetModuloPrev(first, count);
+    if (getSeparation(next) == minSeparation)
+    {
+        second = next;
+    }
+    else if (getSeparation(prev) == minSeparation)
+    {
+        second = prev;
+    }
+    if (second < first)
+    {
+        std::swap(first, second);
+    }
+    return LengthIndices{minSeparation, {{first, second}}};
+}
+
 } // anonymous namespace
 
 SeparationInfo GetMaxSeparation4x4(const DistanceProxy& proxy1, Transformation xf1,
@@ -117,13 +170,12 @@ SeparationInfo GetMaxSeparation(const DistanceProxy& proxy1, Transformation xf1,
     auto secondIndices = VertexCounter2{{InvalidVertex, InvalidVertex}};
     const auto count1 = proxy1.GetVertexCount();
     const auto xf = MulT(xf2, xf1);
-    const auto proxy2vertices = proxy2.GetVertices();
     for (auto i = VertexCounter{0}; i < count1; ++i)
     {
         // Get proxy1 normal and vertex relative to proxy2.
         const auto origin = Transform(proxy1.GetVertex(i), xf);
         const auto normal = Rotate(proxy1.GetNormal(i), xf.q);
-        const auto ap = GetMinSeparationInfo(origin, normal, proxy2vertices);
+        const auto ap = GetMinSeparationInfo(origin, normal, proxy2);
         if (separation < ap.distance)
         {
             separation = ap.distance;
@@ -149,7 +201,7 @@ SeparationInfo GetMaxSeparation(const DistanceProxy& proxy1, Transformation xf1,
         // Get proxy1 normal and vertex relative to proxy2.
         const auto origin = Transform(proxy1.GetVertex(i), xf);
         const auto normal = Rotate(proxy1.GetNormal(i), xf.q);
-        const auto ap = GetMinSeparationInfo(origin, normal, proxy2.GetVertices());
+        const auto ap = GetMinSeparationInfo(origin, normal, proxy2);
         if (stop < ap.distance)
         {
             return SeparationInfo{ap.distance, i, ap.indices};
@@ -177,7 +229,7 @@ SeparationInfo GetMaxSeparation(const DistanceProxy& proxy1, const DistanceProxy
         // Get proxy1 normal and vertex relative to proxy2.
         const auto origin = proxy1.GetVertex(i);
         const auto normal = proxy1.GetNormal(i);
-        const auto ap = GetMinSeparationInfo(origin, normal, proxy2.GetVertices());
+        const auto ap = GetMinSeparationInfo(origin, normal, proxy2);
         if (stop < ap.distance)
         {
             return SeparationInfo{ap.distance, i, ap.indices};
@@ -191,6 +243,29 @@ SeparationInfo GetMaxSeparation(const DistanceProxy& proxy1, const DistanceProxy
     }
     return SeparationInfo{separation, firstIndex, secondIndices};
 }
+
+Length GetSeparation(const DistanceProxy& proxy1, Transformation xf1, VertexCounter index,
+                     const DistanceProxy& proxy2, Transformation xf2)
+{
+    const auto xf = MulT(xf2, xf1);
+    const auto origin = Transform(proxy1.GetVertex(index), xf);
+    const auto normal = Rotate(proxy1.GetNormal(index), xf.q);
+    return GetMinSeparationInfo(origin, normal, proxy2).distance;
+}
+
+Length GetSeparation4x4(const DistanceProxy& proxy1, Transformation xf1, VertexCounter index,
+                        const DistanceProxy& proxy2, Transformation xf2)
+{
+    const auto xf = MulT(xf1, xf2);
+    const Length2 p2vertices[4] = {
+        Transform(proxy2.GetVertex(0), xf),
+        Transform(proxy2.GetVertex(1), xf),
+        Transform(proxy2.GetVertex(2), xf),
+        Transform(proxy2.GetVertex(3), xf),
+    };
+    const auto vertices = Range<DistanceProxy::ConstVertexIterator>(p2vertices, p2vertices + 4);
+    return GetMinSeparationInfo(proxy1.GetVertex(index), proxy1.GetNormal(index), vertices).distance;
+}
     
 } // namespace d2
 } // namespace playrho
@@ -66,6 +66,25 @@ SeparationInfo GetMaxSeparation(const DistanceProxy& proxy1,
                                 const DistanceProxy& proxy2,
                                 Length stop = MaxFloat * Meter);
 
+/// @brief Gets the separation of the given shapes in the direction of the edge normal of
+///   the first shape at the given index.
+/// @details Calculates the same separation as the <code>GetMaxSeparation</code> functions
+///   that take two transformations do for that edge normal.
+/// @warning Behavior is undefined if the index isn't less than the vertex count of
+///   <code>proxy1</code>.
+/// @sa GetMaxSeparation.
+Length GetSeparation(const DistanceProxy& proxy1, Transformation xf1, VertexCounter index,
+                     const DistanceProxy& proxy2, Transformation xf2);
+
+/// @brief Gets the separation of the given shapes in the direction of the edge normal of
+///   the first shape at the given index for the first four vertices of the shapes.
+/// @details Calculates the same separation as <code>GetMaxSeparation4x4</code> does
+///   for that edge normal.
+/// @warning Behavior is undefined if the index isn't less than four.
+/// @sa GetMaxSeparation4x4.
+Length GetSeparation4x4(const DistanceProxy& proxy1, Transformation xf1, VertexCounter index,
+                        const DistanceProxy& proxy2, Transformation xf2);
+
 } // namespace d2
 } // namespace playrho
 
@@ -94,5 +94,19 @@ bool TestPoint(const Shape& shape, Length2 point) noexcept
     return false;
 }
 
+NonNegative<Length> GetExtent(const Shape& shape)
+{
+    auto extent = 0_m;
+    const auto childCount = GetChildCount(shape);
+    for (auto i = decltype(childCount){0}; i < childCount; ++i)
+    {
+        for (const auto& vertex: GetChild(shape, i).GetVertices())
+        {
+            extent = std::max(extent, GetMagnitude(vertex));
+        }
+    }
+    return extent;
+}
+
 } // namespace d2
 } // namespace playrho
@@ -433,6 +433,12 @@ private:
 /// @ingroup TestPointGroup
 bool TestPoint(const Shape& shape, Length2 point) noexcept;
 
+/// @brief Gets the extent of the given shape.
+/// @details This is the greatest distance of a vertex of any child of the given shape from
+///   the origin of the shape, not including the vertex radius.
+/// @relatedalso Shape
+NonNegative<Length> GetExtent(const Shape& shape);
+
 } // namespace d2
 
 /// @brief Visits the given shape with the potentially non-null user data pointer.
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <PlayRho/Collision/SweepAndPrune.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace playrho {
+namespace d2 {
+
+namespace {
+
+/// @brief How many times more spread out the proxies must be along the other axis for
+///   sorting to switch to that axis.
+/// @note Being more than 1 keeps the sorted axis from flip-flopping.
+PLAYRHO_CONSTEXPR const auto AxisSwitchRatio = Real{2};
+
+/// @brief Max average count of places entries may get moved by while restoring the sort
+///   order before it's faster to just sort them all over again.
+PLAYRHO_CONSTEXPR const auto MaxAverageShifts = std::size_t{8};
+
+/// @brief Whether the first given entry sorts before the second given entry.
+inline bool IsBefore(const SweepAndPrune::Entry& lhs, const SweepAndPrune::Entry& rhs) noexcept
+{
+    return lhs.min < rhs.min;
+}
+
+} // anonymous namespace
+
+SweepAndPrune::SweepAndPrune(Size capacity)
+{
+    m_proxies.reserve(capacity);
+    m_entries.reserve(capacity);
+}
+
+SweepAndPrune::Size SweepAndPrune::CreateProxy(const AABB& aabb, const LeafData& data)
+{
+    auto id = Size{0};
+    if (empty(m_freeIds))
+    {
+        id = static_cast<Size>(size(m_proxies));
+        m_proxies.push_back(Proxy{aabb, data, true});
+    }
+    else
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+        m_proxies[id] = Proxy{aabb, data, true};
+    }
+    const auto range = aabb.ranges[m_axis];
+    m_entries.push_back(Entry{range.GetMin(), range.GetMax(), id});
+    ++m_proxyCount;
+    m_sorted = false;
+    return id;
+}
+
+void SweepAndPrune::DestroyProxy(Size id) noexcept
+{
+    assert(IsProxy(id));
+    m_proxies[id].used = false;
+    m_destroyedIds.push_back(id);
+    --m_proxyCount;
+    m_sorted = false;
+}
+
+void SweepAndPrune::UpdateProxy(Size id, const AABB& aabb) noexcept
+{
+    assert(IsProxy(id));
+    m_proxies[id].aabb = aabb;
+    m_sorted = false;
+}
+
+void SweepAndPrune::Sort()
+{
+    if (m_sorted)
+    {
+        return;
+    }
+
+    // Drop the entries of destroyed proxies. Their identifiers can be reused from now on.
+    if (!empty(m_destroyedIds))
+    {
+        const auto isDestroyed = [this](const Entry& entry) {
+            return !m_proxies[entry.id].used;
+        };
+        const auto first = begin(m_entries);
+        const auto sortedLast = first + static_cast<std::ptrdiff_t>(m_sortedCount);
+        const auto newSortedLast = std::remove_if(first, sortedLast, isDestroyed);
+        const auto newTailLast = std::remove_if(sortedLast, end(m_entries), isDestroyed);
+        const auto newLast = std::move(sortedLast, newTailLast, newSortedLast);
+        m_entries.erase(newLast, end(m_entries));
+        m_sortedCount = static_cast<std::size_t>(newSortedLast - first);
+        m_freeIds.insert(end(m_freeIds), begin(m_destroyedIds), end(m_destroyedIds));
+        m_destroyedIds.clear();
+    }
+
+    // Switch axes if the proxies' centers have become more spread out along the other.
+    if (!empty(m_entries))
+    {
+        auto lowest = std::array<Length, 2>{};
+        auto highest = std::array<Length, 2>{};
+        for (auto i = std::size_t{0}; i < 2; ++i)
+        {
+            lowest[i] = std::numeric_limits<Length>::infinity();
+            highest[i] = -std::numeric_limits<Length>::infinity();
+        }
+        for (const auto& entry: m_entries)
+        {
+            const auto& aabb = m_proxies[entry.id].aabb;
+            for (auto i = std::size_t{0}; i < 2; ++i)
+            {
+                const auto center = (aabb.ranges[i].GetMin() + aabb.ranges[i].GetMax()) / 2;
+                lowest[i] = std::min(lowest[i], center);
+                highest[i] = std::max(highest[i], center);
+            }
+        }
+        const auto other = 1 - m_axis;
+        if ((highest[other] - lowest[other]) > (highest[m_axis] - lowest[m_axis]) * AxisSwitchRatio)
+        {
+            m_axis = other;
+            m_sortedCount = 0;
+        }
+    }
+
+    // Refresh the bounds of the entries.
+    m_maxExtent = 0_m;
+    for (auto& entry: m_entries)
+    {
+        const auto range = m_proxies[entry.id].aabb.ranges[m_axis];
+        entry.min = range.GetMin();
+        entry.max = range.GetMax();
+        m_maxExtent = std::max(m_maxExtent, entry.max - entry.min);
+    }
+
+    // Restore the order of the previously sorted entries by insertion sort. That's linear
+    // for entries that moved only a few places but it's quadratic in the worst case, so
+    // fall back to sorting them all over again if it's taking too long.
+    const auto first = begin(m_entries);
+    const auto sortedLast = first + static_cast<std::ptrdiff_t>(m_sortedCount);
+    const auto maxShifts = m_sortedCount * MaxAverageShifts;
+    auto shifts = std::size_t{0};
+    for (auto it = first + ((m_sortedCount > 0)? 1: 0); it < sortedLast; ++it)
+    {
+        const auto entry = *it;
+        auto place = it;
+        for (; (place != first) && IsBefore(entry, *(place - 1)); --place)
+        {
+            *place = *(place - 1);
+            ++shifts;
+        }
+        *place = entry;
+        if (shifts > maxShifts)
+        {
+            std::sort(first, sortedLast, IsBefore);
+            break;
+        }
+    }
+
+    // Sort the entries of the new proxies and merge them in.
+    std::sort(sortedLast, end(m_entries), IsBefore);
+    std::inplace_merge(first, sortedLast, end(m_entries), IsBefore);
+    m_sortedCount = size(m_entries);
+    m_sorted = true;
+}
+
+void SweepAndPrune::ShiftOrigin(Length2 newOrigin) noexcept
+{
+    for (auto& proxy: m_proxies)
+    {
+        if (proxy.used)
+        {
+            proxy.aabb = GetMovedAABB(proxy.aabb, -newOrigin);
+        }
+    }
+
+    // Shifting all the proxies by the same amount leaves the sort order as is.
+    const auto shift = newOrigin[m_axis];
+    for (auto& entry: m_entries)
+    {
+        entry.min -= shift;
+        entry.max -= shift;
+    }
+}
+
+} // namespace d2
+} // namespace playrho
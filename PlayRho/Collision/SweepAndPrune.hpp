@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PLAYRHO_COLLISION_SWEEPANDPRUNE_HPP
+#define PLAYRHO_COLLISION_SWEEPANDPRUNE_HPP
+
+/// @file
+/// Declaration of the <code>SweepAndPrune</code> class.
+
+#include <PlayRho/Collision/DynamicTree.hpp>
+#include <PlayRho/Collision/RayCastOutput.hpp>
+#include <PlayRho/Common/Span.hpp>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+namespace playrho {
+namespace d2 {
+
+/// @brief Sweep and prune broad-phase.
+///
+/// @details This is an alternative to <code>DynamicTree</code> for keeping track of the
+///   AABBs of fixture proxies. It keeps its proxies sorted by their lower bounds along
+///   one axis - the axis along which the proxies' centers are the most spread out. Moving
+///   a proxy only sets its AABB. The sort order is then incrementally restored by
+///   <code>Sort</code>, which is cheap when proxies don't pass each other by much, so
+///   moving proxies costs much less than reinserting them into a tree does. Overlapping
+///   pairs are found by sweeping along the sorted axis.
+///
+/// @note This works best when the proxies are spread out along a dominant axis, like for
+///   side-scrolling scenes.
+/// @note Proxy identifiers are reused after the proxies they were for are destroyed and
+///   the proxies are next sorted.
+///
+/// @sa DynamicTree, https://en.wikipedia.org/wiki/Sweep_and_prune
+///
+class SweepAndPrune
+{
+public:
+    /// @brief Size type.
+    using Size = DynamicTree::Size;
+
+    /// @brief Leaf data type.
+    using LeafData = DynamicTree::LeafData;
+
+    /// @brief Entry of the sort order.
+    /// @details The lower and upper bounds along the sorted axis of the identified proxy.
+    struct Entry
+    {
+        Length min; ///< Lower bound along the sorted axis.
+        Length max; ///< Upper bound along the sorted axis.
+        Size id; ///< Identifier of the proxy.
+    };
+
+    /// @brief Gets the invalid size value.
+    static PLAYRHO_CONSTEXPR inline Size GetInvalidSize() noexcept
+    {
+        return DynamicTree::GetInvalidSize();
+    }
+
+    /// @brief Default constructor.
+    SweepAndPrune() = default;
+
+    /// @brief Size initializing constructor.
+    /// @param capacity Count of proxies to reserve space for.
+    explicit SweepAndPrune(Size capacity);
+
+    /// @brief Creates a proxy for the given AABB and leaf data.
+    /// @return Identifier of the new proxy.
+    Size CreateProxy(const AABB& aabb, const LeafData& data);
+
+    /// @brief Destroys the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void DestroyProxy(Size id) noexcept;
+
+    /// @brief Updates the identified proxy to have the given AABB.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void UpdateProxy(Size id, const AABB& aabb) noexcept;
+
+    /// @brief Gets the AABB of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    AABB GetAABB(Size id) const noexcept;
+
+    /// @brief Gets the leaf data of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    LeafData GetLeafData(Size id) const noexcept;
+
+    /// @brief Sets the leaf data of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void SetLeafData(Size id, LeafData value) noexcept;
+
+    /// @brief Whether the given identifier is of a current proxy.
+    bool IsProxy(Size id) const noexcept;
+
+    /// @brief Gets the count of proxies.
+    Size GetProxyCount() const noexcept;
+
+    /// @brief Gets the upper bound of the identifiers of proxies.
+    /// @details All proxy identifiers are less than this.
+    Size GetIdLimit() const noexcept;
+
+    /// @brief Whether the sort order is up to date.
+    /// @details The sort order isn't up to date after any proxy was created, destroyed or
+    ///   updated until the next call to <code>Sort</code>.
+    bool IsSorted() const noexcept;
+
+    /// @brief Gets the index of the axis that the proxies are sorted along.
+    /// @return 0 for the X-axis or 1 for the Y-axis.
+    std::size_t GetAxis() const noexcept;
+
+    /// @brief Gets the greatest extent along the sorted axis of any of the proxies.
+    /// @note This is only up to date while the sort order is.
+    Length GetMaxExtent() const noexcept;
+
+    /// @brief Gets the sort order entries.
+    /// @note These are only up to date while the sort order is.
+    Span<const Entry> GetEntries() const noexcept;
+
+    /// @brief Brings the sort order up to date.
+    /// @details Switches the axis to sort along if the proxies have become more spread out
+    ///   along the other axis, then restores the sort order incrementally.
+    /// @post <code>IsSorted()</code> returns true.
+    void Sort();
+
+    /// @brief Shifts the world origin.
+    /// @note Useful for large worlds.
+    /// @note The shift formula is: <code>position -= newOrigin</code>.
+    /// @param newOrigin the new origin with respect to the old origin.
+    void ShiftOrigin(Length2 newOrigin) noexcept;
+
+private:
+    /// @brief Proxy data.
+    struct Proxy
+    {
+        AABB aabb; ///< AABB of the proxy.
+        LeafData data; ///< Leaf data of the proxy.
+        bool used; ///< Whether this is the data of a current proxy.
+    };
+
+    std::vector<Proxy> m_proxies; ///< Proxies indexed by identifier.
+    std::vector<Size> m_freeIds; ///< Identifiers free for reuse.
+    std::vector<Size> m_destroyedIds; ///< Identifiers freed since the last sort.
+    std::vector<Entry> m_entries; ///< Sort order followed by entries for new proxies.
+    std::size_t m_sortedCount = 0; ///< Count of entries in sort order at the last sort.
+    Length m_maxExtent = 0_m; ///< Greatest extent along the sorted axis.
+    Size m_proxyCount = 0; ///< Count of current proxies.
+    std::size_t m_axis = 0; ///< Index of the sorted axis.
+    bool m_sorted = true; ///< Whether the sort order is up to date.
+};
+
+inline bool SweepAndPrune::IsProxy(Size id) const noexcept
+{
+    return (id < m_proxies.size()) && m_proxies[id].used;
+}
+
+inline SweepAndPrune::Size SweepAndPrune::GetProxyCount() const noexcept
+{
+    return m_proxyCount;
+}
+
+inline SweepAndPrune::Size SweepAndPrune::GetIdLimit() const noexcept
+{
+    return static_cast<Size>(m_proxies.size());
+}
+
+inline bool SweepAndPrune::IsSorted() const noexcept
+{
+    return m_sorted;
+}
+
+inline std::size_t SweepAndPrune::GetAxis() const noexcept
+{
+    return m_axis;
+}
+
+inline Length SweepAndPrune::GetMaxExtent() const noexcept
+{
+    return m_maxExtent;
+}
+
+inline Span<const SweepAndPrune::Entry> SweepAndPrune::GetEntries() const noexcept
+{
+    return Span<const Entry>(m_entries.data(), m_entries.size());
+}
+
+inline AABB SweepAndPrune::GetAABB(Size id) const noexcept
+{
+    assert(id < m_proxies.size());
+    assert(m_proxies[id].used);
+    return m_proxies[id].aabb;
+}
+
+inline SweepAndPrune::LeafData SweepAndPrune::GetLeafData(Size id) const noexcept
+{
+    assert(id < m_proxies.size());
+    assert(m_proxies[id].used);
+    return m_proxies[id].data;
+}
+
+inline void SweepAndPrune::SetLeafData(Size id, LeafData value) noexcept
+{
+    assert(id < m_proxies.size());
+    assert(m_proxies[id].used);
+    m_proxies[id].data = value;
+}
+
+/// @brief Gets the "size" of the given sweep and prune broad-phase.
+/// @note Size in this context is defined as the proxy count.
+/// @relatedalso SweepAndPrune
+inline std::size_t size(const SweepAndPrune& sap) noexcept
+{
+    return sap.GetProxyCount();
+}
+
+/// @brief Queries the given sweep and prune broad-phase for proxies overlapping the given
+///   AABB.
+/// @details Uses the sort order to only visit the proxies that overlap the given AABB
+///   along the sorted axis when the sort order is up to date. Otherwise checks all the
+///   proxies.
+/// @param sap Sweep and prune broad-phase to query.
+/// @param aabb The query box.
+/// @param callback Callable object that's called with the identifier of each overlapping
+///   proxy and that returns <code>DynamicTreeOpcode::End</code> to terminate the query.
+/// @relatedalso SweepAndPrune
+template <typename F>
+std::enable_if_t<std::is_invocable_r<DynamicTreeOpcode, F, SweepAndPrune::Size>::value>
+Query(const SweepAndPrune& sap, const AABB& aabb, F&& callback)
+{
+    if (!sap.IsSorted())
+    {
+        const auto idLimit = sap.GetIdLimit();
+        for (auto id = SweepAndPrune::Size{0}; id < idLimit; ++id)
+        {
+            if (sap.IsProxy(id) && TestOverlap(sap.GetAABB(id), aabb))
+            {
+                if (callback(id) == DynamicTreeOpcode::End)
+                {
+                    return;
+                }
+            }
+        }
+        return;
+    }
+    
+    const auto range = aabb.ranges[sap.GetAxis()];
+    const auto entries = sap.GetEntries();
+    const auto lowest = range.GetMin() - sap.GetMaxExtent();
+    auto it = std::lower_bound(begin(entries), end(entries), lowest,
+                               [](const SweepAndPrune::Entry& entry, Length value) {
+        return entry.min < value;
+    });
+    for (; (it != end(entries)) && (it->min <= range.GetMax()); ++it)
+    {
+        if ((it->max >= range.GetMin()) && TestOverlap(sap.GetAABB(it->id), aabb))
+        {
+            if (callback(it->id) == DynamicTreeOpcode::End)
+            {
+                return;
+            }
+        }
+    }
+}
+
+/// @brief Queries the given sweep and prune broad-phase for all fixtures that potentially
+///   overlap the given AABB.
+/// @param sap Sweep and prune broad-phase to query.
+/// @param aabb The query box.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature.
+///   It returns <code>false</code> to terminate the query.
+/// @relatedalso SweepAndPrune
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const SweepAndPrune& sap, const AABB& aabb, F&& callback)
+{
+    Query(sap, aabb, [&](SweepAndPrune::Size id) {
+        const auto leafData = sap.GetLeafData(id);
+        return callback(leafData.fixture, leafData.childIndex)?
+            DynamicTreeOpcode::Continue: DynamicTreeOpcode::End;
+    });
+}
+
+/// @brief Queries the given sweep and prune broad-phase for all fixtures that potentially
+///   overlap the given AABB and whose category bits have any of the given mask bits.
+/// @param sap Sweep and prune broad-phase to query.
+/// @param aabb The query box.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature.
+///   It returns <code>false</code> to terminate the query.
+/// @see Filter
+/// @relatedalso SweepAndPrune
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const SweepAndPrune& sap, const AABB& aabb, Filter::bits_type maskBits, F&& callback)
+{
+    Query(sap, aabb, [&](SweepAndPrune::Size id) {
+        const auto leafData = sap.GetLeafData(id);
+        if ((leafData.categoryBits & maskBits) == 0)
+        {
+            return DynamicTreeOpcode::Continue;
+        }
+        return callback(leafData.fixture, leafData.childIndex)?
+            DynamicTreeOpcode::Continue: DynamicTreeOpcode::End;
+    });
+}
+
+/// @brief Calls the given callback for every pair of overlapping proxies of the given
+///   sweep and prune broad-phase.
+/// @details Sweeps along the sorted axis so only pairs of proxies that overlap along that
+///   axis get their AABBs tested for overlap.
+/// @param sap Sweep and prune broad-phase to find the overlapping pairs of.
+/// @param callback Callable object that's called with the identifiers of the two proxies
+///   of each overlapping pair.
+/// @pre The sort order is up to date.
+/// @relatedalso SweepAndPrune
+template <typename F>
+void QueryPairs(const SweepAndPrune& sap, F&& callback)
+{
+    assert(sap.IsSorted());
+    const auto entries = sap.GetEntries();
+    const auto last = end(entries);
+    for (auto it = begin(entries); it != last; ++it)
+    {
+        const auto aabb = sap.GetAABB(it->id);
+        for (auto other = it + 1; (other != last) && (other->min <= it->max); ++other)
+        {
+            if (TestOverlap(aabb, sap.GetAABB(other->id)))
+            {
+                callback(it->id, other->id);
+            }
+        }
+    }
+}
+
+/// @brief Cast rays against the proxies of the given sweep and prune broad-phase.
+/// @param sap Sweep and prune broad-phase to ray cast.
+/// @param input the ray-cast input data.
+/// @param callback Callable object that's called with the identifier of each proxy whose
+///   AABB is hit by the ray and with the ray-cast input data. It should return 0 to
+///   terminate ray casting, or greater than 0 to update the segment bounding box. Values
+///   less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @sa RayCast(const DynamicTree&, RayCastInput, F&&).
+/// @relatedalso SweepAndPrune
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, SweepAndPrune::Size, const RayCastInput&>::value, bool>
+RayCast(const SweepAndPrune& sap, RayCastInput input, F&& callback)
+{
+    const auto v = GetRevPerpendicular(GetUnitVector(input.p2 - input.p1, UnitVec::GetZero()));
+    const auto abs_v = abs(v);
+    auto segmentAABB = d2::GetAABB(input);
+    auto terminated = false;
+    Query(sap, segmentAABB, [&](SweepAndPrune::Size id) {
+        const auto aabb = sap.GetAABB(id);
+        if (!TestOverlap(aabb, segmentAABB))
+        {
+            return DynamicTreeOpcode::Continue;
+        }
+        
+        // Separating axis for segment (Gino, p80).
+        // |dot(v, p1 - ctr)| > dot(|v|, extents)
+        const auto separation = abs(Dot(v, input.p1 - GetCenter(aabb)))
+            - Dot(abs_v, GetExtents(aabb));
+        if (separation > 0_m)
+        {
+            return DynamicTreeOpcode::Continue;
+        }
+        
+        const auto value = static_cast<Real>(callback(id, input));
+        if (value == 0)
+        {
+            terminated = true; // Callback has terminated the ray cast.
+            return DynamicTreeOpcode::End;
+        }
+        if (value > 0)
+        {
+            // Update segment bounding box.
+            input.maxFraction = value;
+            segmentAABB = d2::GetAABB(input);
+        }
+        return DynamicTreeOpcode::Continue;
+    });
+    return terminated;
+}
+
+/// @brief Cast rays against the fixtures of the proxies of the given sweep and prune
+///   broad-phase.
+/// @param sap Sweep and prune broad-phase to ray cast.
+/// @param input the ray-cast input data.
+/// @param callback Callable object having the <code>DynamicTreeRayCastCB</code> signature.
+///   It should return 0 to terminate ray casting, or greater than 0 to update the
+///   segment bounding box. Values less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @relatedalso SweepAndPrune
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, Fixture*, ChildCounter, const RayCastInput&>::value, bool>
+RayCast(const SweepAndPrune& sap, const RayCastInput& input, F&& callback)
+{
+    return RayCast(sap, input, [&](SweepAndPrune::Size id, const RayCastInput& in) {
+        const auto leafData = sap.GetLeafData(id);
+        return callback(leafData.fixture, leafData.childIndex, in);
+    });
+}
+
+/// @brief Cast rays against the fixtures of the proxies of the given sweep and prune
+///   broad-phase whose category bits have any of the given mask bits.
+/// @param sap Sweep and prune broad-phase to ray cast.
+/// @param input the ray-cast input data.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>DynamicTreeRayCastCB</code> signature.
+///   It should return 0 to terminate ray casting, or greater than 0 to update the
+///   segment bounding box. Values less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @see Filter
+/// @relatedalso SweepAndPrune
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, Fixture*, ChildCounter, const RayCastInput&>::value, bool>
+RayCast(const SweepAndPrune& sap, const RayCastInput& input, Filter::bits_type maskBits,
+        F&& callback)
+{
+    return RayCast(sap, input, [&](SweepAndPrune::Size id, const RayCastInput& in) {
+        const auto leafData = sap.GetLeafData(id);
+        if ((leafData.categoryBits & maskBits) == 0)
+        {
+            return Real{-1};
+        }
+        return static_cast<Real>(callback(leafData.fixture, leafData.childIndex, in));
+    });
+}
+
+/// @brief Ray-cast the given sweep and prune broad-phase for all fixtures in the path of
+///   the ray.
+/// @param sap Sweep and prune broad-phase to ray cast.
+/// @param input Ray cast input data.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+/// @relatedalso SweepAndPrune
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const SweepAndPrune& sap, const RayCastInput& input, F&& callback)
+{
+    return RayCast(sap, input, [&callback](Fixture* fixture, ChildCounter child,
+                                           const RayCastInput& in) {
+        return RayCastFixtureChild(fixture, child, in, callback);
+    });
+}
+
+/// @brief Ray-cast the given sweep and prune broad-phase for all fixtures in the path of
+///   the ray whose category bits have any of the given mask bits.
+/// @param sap Sweep and prune broad-phase to ray cast.
+/// @param input Ray cast input data.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+/// @see Filter
+/// @relatedalso SweepAndPrune
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const SweepAndPrune& sap, const RayCastInput& input, Filter::bits_type maskBits,
+        F&& callback)
+{
+    return RayCast(sap, input, maskBits, [&callback](Fixture* fixture, ChildCounter child,
+                                                     const RayCastInput& in) {
+        return RayCastFixtureChild(fixture, child, in, callback);
+    });
+}
+
+} // namespace d2
+} // namespace playrho
+
+#endif // PLAYRHO_COLLISION_SWEEPANDPRUNE_HPP
@@ -25,6 +25,7 @@
 #include <PlayRho/Common/Math.hpp>
 #include <PlayRho/Common/Wider.hpp>
 #include <PlayRho/Common/BoundedValue.hpp>
+#include <PlayRho/Collision/Simplex.hpp>
 
 namespace playrho {
 
@@ -297,6 +298,29 @@ TOIOutput GetToiViaSat(const DistanceProxy& proxyA, const Sweep& sweepA,
                        const DistanceProxy& proxyB, const Sweep& sweepB,
                        ToiConf conf = GetDefaultToiConf());
 
+/// @brief Gets the time of impact for two disjoint convex sets using the
+///    Separating Axis Theorem warm starting from the given simplex cache.
+///
+/// @details Same as the other <code>GetToiViaSat</code> function except that its distance
+///   calculations start from the given cache, which gets set to the cache of the last one.
+///   For shapes whose cache is kept from one calculation to the next, the distance
+///   calculations usually take fewer iterations.
+///
+/// @param proxyA Proxy A. The proxy's vertex count must be 1 or more.
+/// @param sweepA Sweep A. Sweep of motion for shape represented by proxy A.
+/// @param proxyB Proxy B. The proxy's vertex count must be 1 or more.
+/// @param sweepB Sweep B. Sweep of motion for shape represented by proxy B.
+/// @param cache Simplex cache of earlier distance calculations between the two proxies.
+/// @param conf Configuration details for on calculation. Like the targeted depth of penetration.
+///
+/// @return Time of impact output data.
+///
+/// @relatedalso ::playrho::TOIOutput
+///
+TOIOutput GetToiViaSat(const DistanceProxy& proxyA, const Sweep& sweepA,
+                       const DistanceProxy& proxyB, const Sweep& sweepB,
+                       Simplex::Cache& cache, ToiConf conf = GetDefaultToiConf());
+
 } // namespace d2
 } // namespace playrho
 
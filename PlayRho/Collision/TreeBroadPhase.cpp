@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <PlayRho/Collision/TreeBroadPhase.hpp>
+
+#include <vector>
+
+namespace playrho {
+namespace d2 {
+
+namespace {
+
+    /// @brief Divisor of the leaf count of a tree giving the count of changes to it
+    ///   between checks of whether it has degraded.
+    PLAYRHO_CONSTEXPR const auto LeafCountPerChangeBetweenChecks = TreeBroadPhase::Size{8};
+
+    /// @brief Rebuilds the given tree if its perimeter ratio has grown to more than the given
+    ///   degradation times the given ratio or if the given ratio is zero.
+    /// @details Only checks the tree if the given ratio is zero or if the given count of
+    ///   changes is at least the tree's leaf count divided by
+    ///   <code>LeafCountPerChangeBetweenChecks</code>.
+    /// @param tree Tree to check and possibly rebuild.
+    /// @param ratio Perimeter ratio of the tree when it was last rebuilt. Set to the new
+    ///   ratio whenever the tree is rebuilt.
+    /// @param changes Count of changes to the tree since it was last checked. Reset
+    ///   whenever the tree is checked.
+    /// @param maxDegradation Max degradation.
+    /// @param maxThreads Max threads to rebuild the tree with.
+    void RebuildTreeIfDegraded(DynamicTree& tree, Real& ratio, TreeBroadPhase::Size& changes,
+                               Real maxDegradation, unsigned maxThreads)
+    {
+        if ((ratio != 0) &&
+            ((changes == 0) || (changes < tree.GetLeafCount() / LeafCountPerChangeBetweenChecks)))
+        {
+            return;
+        }
+        changes = 0;
+        const auto current = ComputePerimeterRatio(tree);
+        if ((current > 0) && ((ratio == 0) || (current > ratio * maxDegradation)))
+        {
+            tree.RebuildTopDown(maxThreads);
+            ratio = ComputePerimeterRatio(tree);
+        }
+    }
+
+} // anonymous namespace
+
+TreeBroadPhase::TreeBroadPhase(Size capacity, bool separateStaticTree):
+    m_tree{capacity},
+    m_staticTree{separateStaticTree? capacity: Size{0}},
+    m_separateStaticTree{separateStaticTree}
+{
+    // Intentionally empty.
+}
+
+TreeBroadPhase::Size TreeBroadPhase::CreateProxy(const AABB& aabb, const LeafData& data,
+                                                 bool isStatic)
+{
+    if (isStatic && m_separateStaticTree)
+    {
+        const auto index = m_staticTree.CreateLeaf(aabb, data);
+        assert(!IsStaticProxy(index));
+        ++m_staticTreeChanges;
+        return index | StaticProxyFlag;
+    }
+    ++m_treeChanges;
+    return m_tree.CreateLeaf(aabb, data);
+}
+
+void TreeBroadPhase::DestroyProxy(Size id) noexcept
+{
+    GetTree(id).DestroyLeaf(GetLeafIndex(id));
+    ++(IsStaticProxy(id)? m_staticTreeChanges: m_treeChanges);
+}
+
+void TreeBroadPhase::UpdateProxy(Size id, const AABB& aabb)
+{
+    GetTree(id).UpdateLeaf(GetLeafIndex(id), aabb);
+    ++(IsStaticProxy(id)? m_staticTreeChanges: m_treeChanges);
+}
+
+void TreeBroadPhase::RebuildIfDegraded(Real maxDegradation, unsigned maxThreads)
+{
+    RebuildTreeIfDegraded(m_tree, m_treeRatio, m_treeChanges, maxDegradation, maxThreads);
+    if (m_separateStaticTree)
+    {
+        RebuildTreeIfDegraded(m_staticTree, m_staticTreeRatio, m_staticTreeChanges,
+                              maxDegradation, maxThreads);
+    }
+}
+
+void TreeBroadPhase::ShiftOrigin(Length2 newOrigin)
+{
+    m_tree.ShiftOrigin(newOrigin);
+    m_staticTree.ShiftOrigin(newOrigin);
+}
+
+FixtureRayCastOutput RayCastClosest(const TreeBroadPhase& broadPhase, const RayCastInput& input)
+{
+    auto result = RayCastClosest(broadPhase.GetTree(), input);
+    if (broadPhase.IsSeparateStaticTree())
+    {
+        auto clipped = input;
+        if (result.has_value())
+        {
+            clipped.maxFraction = result->fraction;
+        }
+        const auto staticResult = RayCastClosest(broadPhase.GetStaticTree(), clipped);
+        if (staticResult.has_value() &&
+            (!result.has_value() || (staticResult->fraction < result->fraction)))
+        {
+            result = staticResult;
+        }
+    }
+    return result;
+}
+
+void RayCastClosest(const TreeBroadPhase& broadPhase, Span<const RayCastInput> inputs,
+                    Span<FixtureRayCastOutput> outputs)
+{
+    RayCastClosest(broadPhase.GetTree(), inputs, outputs);
+    if (broadPhase.IsSeparateStaticTree())
+    {
+        auto clipped = std::vector<RayCastInput>(begin(inputs), end(inputs));
+        for (auto i = std::size_t{0}; i < size(clipped); ++i)
+        {
+            if (outputs[i].has_value())
+            {
+                clipped[i].maxFraction = outputs[i]->fraction;
+            }
+        }
+        auto staticOutputs = std::vector<FixtureRayCastOutput>(size(clipped));
+        RayCastClosest(broadPhase.GetStaticTree(), clipped, staticOutputs);
+        for (auto i = std::size_t{0}; i < size(clipped); ++i)
+        {
+            if (staticOutputs[i].has_value() &&
+                (!outputs[i].has_value() || (staticOutputs[i]->fraction < outputs[i]->fraction)))
+            {
+                outputs[i] = staticOutputs[i];
+            }
+        }
+    }
+}
+
+} // namespace d2
+} // namespace playrho
@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PLAYRHO_COLLISION_TREEBROADPHASE_HPP
+#define PLAYRHO_COLLISION_TREEBROADPHASE_HPP
+
+/// @file
+/// Declaration of the <code>TreeBroadPhase</code> class.
+
+#include <PlayRho/Collision/DynamicTree.hpp>
+#include <PlayRho/Collision/RayCastOutput.hpp>
+#include <PlayRho/Common/Span.hpp>
+
+#include <type_traits>
+
+namespace playrho {
+namespace d2 {
+
+/// @brief Dynamic tree broad-phase.
+///
+/// @details Keeps track of the AABBs of fixture proxies in a <code>DynamicTree</code>.
+///   Optionally keeps the proxies of static bodies in a second tree of their own. That
+///   tree is then only changed when static bodies are, and the other tree only holds the
+///   proxies that can move.
+///
+/// @note Proxy identifiers of the static tree are its leaf indices with the
+///   <code>StaticProxyFlag</code> bit set so they never collide with the proxy
+///   identifiers of the other tree.
+///
+/// @sa DynamicTree, SweepAndPrune, UniformGrid
+///
+class TreeBroadPhase
+{
+public:
+    /// @brief Size type.
+    using Size = DynamicTree::Size;
+
+    /// @brief Leaf data type.
+    using LeafData = DynamicTree::LeafData;
+
+    /// @brief Flag of the proxy identifiers that identify leaves of the static tree.
+    static PLAYRHO_CONSTEXPR const auto StaticProxyFlag = Size{1} << 31u;
+
+    /// @brief Gets the invalid size value.
+    static PLAYRHO_CONSTEXPR inline Size GetInvalidSize() noexcept
+    {
+        return DynamicTree::GetInvalidSize();
+    }
+
+    /// @brief Gets whether the given proxy identifier identifies a leaf of the static tree.
+    static PLAYRHO_CONSTEXPR inline bool IsStaticProxy(Size id) noexcept
+    {
+        return (id & StaticProxyFlag) != 0u;
+    }
+
+    /// @brief Gets the leaf index within its tree of the given proxy identifier.
+    static PLAYRHO_CONSTEXPR inline Size GetLeafIndex(Size id) noexcept
+    {
+        return id & ~StaticProxyFlag;
+    }
+
+    /// @brief Default constructor.
+    TreeBroadPhase() = default;
+
+    /// @brief Initializing constructor.
+    /// @param capacity Count of nodes to initially allocate in the trees.
+    /// @param separateStaticTree Whether to keep static proxies in a separate tree.
+    explicit TreeBroadPhase(Size capacity, bool separateStaticTree = false);
+
+    /// @brief Creates a proxy for the given AABB and leaf data.
+    /// @param aabb AABB of the proxy.
+    /// @param data Leaf data of the proxy.
+    /// @param isStatic Whether the proxy is of a static body. Static proxies are created
+    ///   in the static tree when there's a separate static tree.
+    /// @return Identifier of the new proxy.
+    Size CreateProxy(const AABB& aabb, const LeafData& data, bool isStatic = false);
+
+    /// @brief Destroys the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void DestroyProxy(Size id) noexcept;
+
+    /// @brief Updates the identified proxy to have the given AABB.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void UpdateProxy(Size id, const AABB& aabb);
+
+    /// @brief Gets the AABB of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    AABB GetAABB(Size id) const noexcept;
+
+    /// @brief Gets the leaf data of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    LeafData GetLeafData(Size id) const noexcept;
+
+    /// @brief Sets the leaf data of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void SetLeafData(Size id, LeafData value) noexcept;
+
+    /// @brief Gets the tree of the proxies of non-static bodies.
+    /// @note This is the tree of all the proxies unless there's a separate static tree.
+    const DynamicTree& GetTree() const noexcept;
+
+    /// @brief Gets the tree of the proxies of static bodies.
+    /// @note This is empty unless there's a separate static tree.
+    const DynamicTree& GetStaticTree() const noexcept;
+
+    /// @brief Gets the tree having the identified proxy.
+    const DynamicTree& GetTree(Size id) const noexcept;
+
+    /// @brief Gets whether the proxies of static bodies are kept in a separate tree.
+    bool IsSeparateStaticTree() const noexcept;
+
+    /// @brief Rebuilds the trees that have degraded by more than the given factor.
+    /// @details A tree is rebuilt if its perimeter ratio has grown to more than the given
+    ///   degradation times its perimeter ratio when it was last rebuilt. Computing the
+    ///   perimeter ratio is linear in the size of the tree, so a tree is only checked once
+    ///   the count of its proxies created, destroyed, or updated since it was last checked
+    ///   reaches an eighth of its leaf count.
+    /// @param maxDegradation Max degradation.
+    /// @param maxThreads Max threads to rebuild the trees with.
+    void RebuildIfDegraded(Real maxDegradation, unsigned maxThreads);
+
+    /// @brief Shifts the world origin.
+    /// @note Useful for large worlds.
+    /// @note The shift formula is: <code>position -= newOrigin</code>.
+    /// @param newOrigin the new origin with respect to the old origin.
+    void ShiftOrigin(Length2 newOrigin);
+
+private:
+    /// @brief Gets the tree having the identified proxy.
+    DynamicTree& GetTree(Size id) noexcept;
+
+    DynamicTree m_tree; ///< Tree of the proxies of non-static bodies.
+    DynamicTree m_staticTree; ///< Tree of the proxies of static bodies.
+    Real m_treeRatio = 0; ///< Perimeter ratio of the tree when last rebuilt.
+    Real m_staticTreeRatio = 0; ///< Perimeter ratio of the static tree when last rebuilt.
+    Size m_treeChanges = 0; ///< Count of changes to the tree since it was last checked.
+    Size m_staticTreeChanges = 0; ///< Count of changes to the static tree since last checked.
+    bool m_separateStaticTree = false; ///< Whether there's a separate static tree.
+};
+
+inline AABB TreeBroadPhase::GetAABB(Size id) const noexcept
+{
+    return GetTree(id).GetAABB(GetLeafIndex(id));
+}
+
+inline TreeBroadPhase::LeafData TreeBroadPhase::GetLeafData(Size id) const noexcept
+{
+    return GetTree(id).GetLeafData(GetLeafIndex(id));
+}
+
+inline void TreeBroadPhase::SetLeafData(Size id, LeafData value) noexcept
+{
+    GetTree(id).SetLeafData(GetLeafIndex(id), value);
+}
+
+inline const DynamicTree& TreeBroadPhase::GetTree() const noexcept
+{
+    return m_tree;
+}
+
+inline const DynamicTree& TreeBroadPhase::GetStaticTree() const noexcept
+{
+    return m_staticTree;
+}
+
+inline const DynamicTree& TreeBroadPhase::GetTree(Size id) const noexcept
+{
+    return IsStaticProxy(id)? m_staticTree: m_tree;
+}
+
+inline DynamicTree& TreeBroadPhase::GetTree(Size id) noexcept
+{
+    return IsStaticProxy(id)? m_staticTree: m_tree;
+}
+
+inline bool TreeBroadPhase::IsSeparateStaticTree() const noexcept
+{
+    return m_separateStaticTree;
+}
+
+/// @brief Queries the given tree broad-phase for all fixtures that potentially overlap the
+///   given AABB.
+/// @details Queries the static tree too when there's a separate static tree.
+/// @param broadPhase Tree broad-phase to query.
+/// @param aabb The query box.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature.
+///   It returns <code>false</code> to terminate the query.
+/// @relatedalso TreeBroadPhase
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const TreeBroadPhase& broadPhase, const AABB& aabb, F&& callback)
+{
+    auto proceed = true;
+    const auto cb = [&](Fixture* fixture, ChildCounter child) {
+        proceed = callback(fixture, child);
+        return proceed;
+    };
+    Query(broadPhase.GetTree(), aabb, cb);
+    if (proceed && broadPhase.IsSeparateStaticTree())
+    {
+        Query(broadPhase.GetStaticTree(), aabb, cb);
+    }
+}
+
+/// @brief Queries the given tree broad-phase for all fixtures that potentially overlap the
+///   given AABB and whose category bits have any of the given mask bits.
+/// @details Queries the static tree too when there's a separate static tree.
+/// @param broadPhase Tree broad-phase to query.
+/// @param aabb The query box.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature.
+///   It returns <code>false</code> to terminate the query.
+/// @see Filter
+/// @relatedalso TreeBroadPhase
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const TreeBroadPhase& broadPhase, const AABB& aabb, Filter::bits_type maskBits,
+      F&& callback)
+{
+    auto proceed = true;
+    const auto cb = [&](Fixture* fixture, ChildCounter child) {
+        proceed = callback(fixture, child);
+        return proceed;
+    };
+    Query(broadPhase.GetTree(), aabb, maskBits, cb);
+    if (proceed && broadPhase.IsSeparateStaticTree())
+    {
+        Query(broadPhase.GetStaticTree(), aabb, maskBits, cb);
+    }
+}
+
+/// @brief Cast rays against the fixtures of the proxies of the given tree broad-phase.
+/// @details Ray-casts the static tree too when there's a separate static tree. Any
+///   clipping of the ray by the callback carries over from one tree to the other.
+/// @param broadPhase Tree broad-phase to ray cast.
+/// @param input the ray-cast input data.
+/// @param callback Callable object having the <code>DynamicTreeRayCastCB</code> signature.
+///   It should return 0 to terminate ray casting, or greater than 0 to update the
+///   segment bounding box. Values less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @relatedalso TreeBroadPhase
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, Fixture*, ChildCounter, const RayCastInput&>::value, bool>
+RayCast(const TreeBroadPhase& broadPhase, RayCastInput input, F&& callback)
+{
+    auto maxFraction = Real{input.maxFraction};
+    const auto cb = [&](Fixture* fixture, ChildCounter child, const RayCastInput& in) {
+        const auto value = static_cast<Real>(callback(fixture, child, in));
+        if (value > 0)
+        {
+            maxFraction = value;
+        }
+        return value;
+    };
+    if (RayCast(broadPhase.GetTree(), input, cb))
+    {
+        return true;
+    }
+    if (broadPhase.IsSeparateStaticTree())
+    {
+        input.maxFraction = maxFraction;
+        return RayCast(broadPhase.GetStaticTree(), input, cb);
+    }
+    return false;
+}
+
+/// @brief Cast rays against the fixtures of the proxies of the given tree broad-phase
+///   whose category bits have any of the given mask bits.
+/// @details Ray-casts the static tree too when there's a separate static tree. Any
+///   clipping of the ray by the callback carries over from one tree to the other.
+/// @param broadPhase Tree broad-phase to ray cast.
+/// @param input the ray-cast input data.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>DynamicTreeRayCastCB</code> signature.
+///   It should return 0 to terminate ray casting, or greater than 0 to update the
+///   segment bounding box. Values less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @see Filter
+/// @relatedalso TreeBroadPhase
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, Fixture*, ChildCounter, const RayCastInput&>::value, bool>
+RayCast(const TreeBroadPhase& broadPhase, RayCastInput input, Filter::bits_type maskBits,
+        F&& callback)
+{
+    auto maxFraction = Real{input.maxFraction};
+    const auto cb = [&](Fixture* fixture, ChildCounter child, const RayCastInput& in) {
+        const auto value = static_cast<Real>(callback(fixture, child, in));
+        if (value > 0)
+        {
+            maxFraction = value;
+        }
+        return value;
+    };
+    if (RayCast(broadPhase.GetTree(), input, maskBits, cb))
+    {
+        return true;
+    }
+    if (broadPhase.IsSeparateStaticTree())
+    {
+        input.maxFraction = maxFraction;
+        return RayCast(broadPhase.GetStaticTree(), input, maskBits, cb);
+    }
+    return false;
+}
+
+/// @brief Ray-cast the given tree broad-phase for all fixtures in the path of the ray.
+/// @param broadPhase Tree broad-phase to ray cast.
+/// @param input Ray cast input data.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+/// @relatedalso TreeBroadPhase
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const TreeBroadPhase& broadPhase, const RayCastInput& input, F&& callback)
+{
+    return RayCast(broadPhase, input, [&callback](Fixture* fixture, ChildCounter child,
+                                                  const RayCastInput& in) {
+        return RayCastFixtureChild(fixture, child, in, callback);
+    });
+}
+
+/// @brief Ray-cast the given tree broad-phase for all fixtures in the path of the ray
+///   whose category bits have any of the given mask bits.
+/// @param broadPhase Tree broad-phase to ray cast.
+/// @param input Ray cast input data.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+/// @see Filter
+/// @relatedalso TreeBroadPhase
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const TreeBroadPhase& broadPhase, const RayCastInput& input,
+        Filter::bits_type maskBits, F&& callback)
+{
+    return RayCast(broadPhase, input, maskBits, [&callback](Fixture* fixture, ChildCounter child,
+                                                            const RayCastInput& in) {
+        return RayCastFixtureChild(fixture, child, in, callback);
+    });
+}
+
+/// @brief Ray-casts the given tree broad-phase for the closest fixture child in the path
+///   of the ray.
+/// @details Ray-casts the static tree too when there's a separate static tree, with the
+///   ray clipped to the closest hit in the other tree.
+/// @param broadPhase Tree broad-phase to ray cast.
+/// @param input Ray cast input data.
+/// @return Closest hit if the ray hit anything, or an empty value otherwise.
+/// @sa RayCastClosest(const DynamicTree&, const RayCastInput&).
+/// @relatedalso TreeBroadPhase
+FixtureRayCastOutput RayCastClosest(const TreeBroadPhase& broadPhase, const RayCastInput& input);
+
+/// @brief Ray-casts the given tree broad-phase for the closest fixture children in the
+///   paths of the given packet of rays.
+/// @details Ray-casts the static tree too when there's a separate static tree, with the
+///   rays clipped to their closest hits in the other tree.
+/// @param broadPhase Tree broad-phase to ray cast.
+/// @param inputs Ray cast input data of the rays.
+/// @param outputs Output data for the rays. Gets set to the closest hit of the ray at the
+///   same index of the inputs or to an empty value for rays that didn't hit anything.
+/// @throws InvalidArgument if the outputs has fewer elements than the inputs.
+/// @sa RayCastClosest(const DynamicTree&, Span<const RayCastInput>, Span<FixtureRayCastOutput>).
+/// @relatedalso TreeBroadPhase
+void RayCastClosest(const TreeBroadPhase& broadPhase, Span<const RayCastInput> inputs,
+                    Span<FixtureRayCastOutput> outputs);
+
+} // namespace d2
+} // namespace playrho
+
+#endif // PLAYRHO_COLLISION_TREEBROADPHASE_HPP
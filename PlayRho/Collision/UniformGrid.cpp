@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <PlayRho/Collision/UniformGrid.hpp>
+
+#include <algorithm>
+
+namespace playrho {
+namespace d2 {
+
+namespace {
+
+/// @brief Least count of buckets.
+PLAYRHO_CONSTEXPR const auto MinBucketCount = std::size_t{64};
+
+/// @brief Max average count of entries per bucket before the count of buckets is doubled.
+PLAYRHO_CONSTEXPR const auto MaxLoadFactor = std::size_t{2};
+
+/// @brief Gets the least power of two that's not less than the given value.
+std::size_t GetPowerOfTwoAtLeast(std::size_t value) noexcept
+{
+    auto result = MinBucketCount;
+    while (result < value)
+    {
+        result *= 2;
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+UniformGrid::UniformGrid(Positive<Length> cellSize, Size capacity):
+    m_cellSize{cellSize}
+{
+    m_proxies.reserve(capacity);
+    if (capacity > 0)
+    {
+        m_buckets.resize(GetPowerOfTwoAtLeast(std::size_t{capacity} * MaxLoadFactor));
+    }
+}
+
+UniformGrid::Size UniformGrid::CreateProxy(const AABB& aabb, const LeafData& data)
+{
+    auto id = Size{0};
+    const auto proxy = Proxy{aabb, data, GetCells(aabb), true, false};
+    if (empty(m_freeIds))
+    {
+        id = static_cast<Size>(size(m_proxies));
+        m_proxies.push_back(proxy);
+    }
+    else
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+        m_proxies[id] = proxy;
+    }
+    Insert(id);
+    ++m_proxyCount;
+    return id;
+}
+
+void UniformGrid::DestroyProxy(Size id) noexcept
+{
+    assert(IsProxy(id));
+    Remove(id);
+    m_proxies[id].used = false;
+    m_freeIds.push_back(id);
+    --m_proxyCount;
+}
+
+void UniformGrid::UpdateProxy(Size id, const AABB& aabb)
+{
+    assert(IsProxy(id));
+    auto& proxy = m_proxies[id];
+    proxy.aabb = aabb;
+    const auto cells = GetCells(aabb);
+    if (cells != proxy.cells)
+    {
+        Remove(id);
+        proxy.cells = cells;
+        Insert(id);
+    }
+}
+
+void UniformGrid::ShiftOrigin(Length2 newOrigin)
+{
+    for (auto& bucket: m_buckets)
+    {
+        bucket.clear();
+    }
+    m_entryCount = 0;
+    m_oversized.clear();
+    const auto idLimit = GetIdLimit();
+    for (auto id = Size{0}; id < idLimit; ++id)
+    {
+        auto& proxy = m_proxies[id];
+        if (proxy.used)
+        {
+            proxy.aabb = GetMovedAABB(proxy.aabb, -newOrigin);
+            proxy.cells = GetCells(proxy.aabb);
+            Insert(id);
+        }
+    }
+}
+
+void UniformGrid::Insert(Size id)
+{
+    auto& proxy = m_proxies[id];
+    const auto cells = proxy.cells;
+    const auto count = GetCellCount(cells);
+
+    // Entering a proxy into every cell it overlaps takes time and memory proportional to
+    // its area so ones overlapping more cells than there are buckets are listed instead.
+    proxy.oversized = count > std::max(size(m_buckets), MinBucketCount);
+    if (proxy.oversized)
+    {
+        m_oversized.push_back(id);
+        return;
+    }
+
+    if (empty(m_buckets) || ((m_entryCount + count) > (size(m_buckets) * MaxLoadFactor)))
+    {
+        Rehash(GetPowerOfTwoAtLeast((m_entryCount + count) / MaxLoadFactor * 2));
+    }
+    for (auto y = cells.minY; y <= cells.maxY; ++y)
+    {
+        for (auto x = cells.minX; x <= cells.maxX; ++x)
+        {
+            m_buckets[GetBucketIndex(x, y)].push_back(CellEntry{x, y, id});
+        }
+    }
+    m_entryCount += count;
+}
+
+void UniformGrid::Remove(Size id) noexcept
+{
+    if (m_proxies[id].oversized)
+    {
+        const auto it = std::find(begin(m_oversized), end(m_oversized), id);
+        assert(it != end(m_oversized));
+        *it = m_oversized.back();
+        m_oversized.pop_back();
+        return;
+    }
+
+    const auto cells = m_proxies[id].cells;
+    for (auto y = cells.minY; y <= cells.maxY; ++y)
+    {
+        for (auto x = cells.minX; x <= cells.maxX; ++x)
+        {
+            auto& bucket = m_buckets[GetBucketIndex(x, y)];
+            const auto it = std::find_if(begin(bucket), end(bucket), [&](const CellEntry& entry) {
+                return (entry.id == id) && (entry.x == x) && (entry.y == y);
+            });
+            assert(it != end(bucket));
+            *it = bucket.back();
+            bucket.pop_back();
+        }
+    }
+    m_entryCount -= GetCellCount(cells);
+}
+
+void UniformGrid::Rehash(std::size_t count)
+{
+    auto buckets = std::vector<std::vector<CellEntry>>(count);
+    swap(buckets, m_buckets);
+    for (const auto& bucket: buckets)
+    {
+        for (const auto& entry: bucket)
+        {
+            m_buckets[GetBucketIndex(entry.x, entry.y)].push_back(entry);
+        }
+    }
+}
+
+} // namespace d2
+} // namespace playrho
@@ -0,0 +1,692 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PLAYRHO_COLLISION_UNIFORMGRID_HPP
+#define PLAYRHO_COLLISION_UNIFORMGRID_HPP
+
+/// @file
+/// Declaration of the <code>UniformGrid</code> class.
+
+#include <PlayRho/Collision/DynamicTree.hpp>
+#include <PlayRho/Collision/RayCastOutput.hpp>
+#include <PlayRho/Common/BoundedValue.hpp>
+#include <PlayRho/Common/Span.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace playrho {
+namespace d2 {
+
+/// @brief Uniform grid broad-phase.
+///
+/// @details This is an alternative to <code>DynamicTree</code> for keeping track of the
+///   AABBs of fixture proxies. It divides space into square cells of a fixed size and
+///   keeps every proxy in each of the cells that its AABB overlaps. Cells are found by
+///   hashing their coordinates so space doesn't need to be bounded and only cells having
+///   proxies take up memory. Creating, moving and destroying proxies take constant time
+///   and queries only visit the cells their boxes overlap.
+///
+/// @note This works best when the proxies are of about the same size and the cell size is
+///   about that size, like for crowds of similarly sized disks. Proxies much larger than
+///   the cell size occupy many cells. Proxies that would occupy more cells than there are
+///   buckets are instead kept in a list of oversized proxies that every query checks.
+///
+/// @sa DynamicTree, https://en.wikipedia.org/wiki/Grid_(spatial_index)
+///
+class UniformGrid
+{
+public:
+    /// @brief Size type.
+    using Size = DynamicTree::Size;
+
+    /// @brief Leaf data type.
+    using LeafData = DynamicTree::LeafData;
+
+    /// @brief Cell coordinate type.
+    using CellCoord = std::int32_t;
+
+    /// @brief Rectangular range of cells.
+    struct CellRange
+    {
+        CellCoord minX; ///< Lowest X coordinate of the cells.
+        CellCoord minY; ///< Lowest Y coordinate of the cells.
+        CellCoord maxX; ///< Highest X coordinate of the cells.
+        CellCoord maxY; ///< Highest Y coordinate of the cells.
+    };
+
+    /// @brief Entry of a cell bucket.
+    /// @details Says that the identified proxy is in the cell at the given coordinates.
+    struct CellEntry
+    {
+        CellCoord x; ///< X coordinate of the cell.
+        CellCoord y; ///< Y coordinate of the cell.
+        Size id; ///< Identifier of the proxy.
+    };
+
+    /// @brief Gets the invalid size value.
+    static PLAYRHO_CONSTEXPR inline Size GetInvalidSize() noexcept
+    {
+        return DynamicTree::GetInvalidSize();
+    }
+
+    /// @brief Gets the default cell size.
+    static PLAYRHO_CONSTEXPR inline Length GetDefaultCellSize() noexcept
+    {
+        return 2_m;
+    }
+
+    /// @brief Default constructor.
+    UniformGrid() = default;
+
+    /// @brief Initializing constructor.
+    /// @param cellSize Width and height of the cells.
+    /// @param capacity Count of proxies to reserve space for.
+    explicit UniformGrid(Positive<Length> cellSize, Size capacity = 0);
+
+    /// @brief Creates a proxy for the given AABB and leaf data.
+    /// @return Identifier of the new proxy.
+    Size CreateProxy(const AABB& aabb, const LeafData& data);
+
+    /// @brief Destroys the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void DestroyProxy(Size id) noexcept;
+
+    /// @brief Updates the identified proxy to have the given AABB.
+    /// @details Only moves the proxy between cells if the cells its AABB overlaps changed.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void UpdateProxy(Size id, const AABB& aabb);
+
+    /// @brief Gets the AABB of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    AABB GetAABB(Size id) const noexcept;
+
+    /// @brief Gets the leaf data of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    LeafData GetLeafData(Size id) const noexcept;
+
+    /// @brief Sets the leaf data of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void SetLeafData(Size id, LeafData value) noexcept;
+
+    /// @brief Gets the range of cells that the identified proxy is in.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    CellRange GetCells(Size id) const noexcept;
+
+    /// @brief Gets the range of cells that the given AABB overlaps.
+    CellRange GetCells(const AABB& aabb) const noexcept;
+
+    /// @brief Gets the coordinate of the cells containing the given coordinate.
+    CellCoord GetCell(Length value) const noexcept;
+
+    /// @brief Gets the bucket that the cell at the given coordinates hashes to.
+    /// @note The bucket may hold entries for other cells too.
+    Span<const CellEntry> GetBucket(CellCoord x, CellCoord y) const noexcept;
+
+    /// @brief Gets the count of buckets that cells are hashed into.
+    std::size_t GetBucketCount() const noexcept;
+
+    /// @brief Gets the buckets that cells are hashed into.
+    Span<const std::vector<CellEntry>> GetBuckets() const noexcept;
+
+    /// @brief Gets the identifiers of the oversized proxies.
+    /// @details These are the proxies that overlapped more cells than there were buckets
+    ///   when they were last put into the grid. They aren't in any bucket.
+    Span<const Size> GetOversized() const noexcept;
+
+    /// @brief Gets the width and height of the cells.
+    Length GetCellSize() const noexcept;
+
+    /// @brief Whether the given identifier is of a current proxy.
+    bool IsProxy(Size id) const noexcept;
+
+    /// @brief Gets the count of proxies.
+    Size GetProxyCount() const noexcept;
+
+    /// @brief Gets the count of cell entries.
+    /// @details This is the sum over all the proxies that aren't oversized of the count of
+    ///   cells each is in.
+    std::size_t GetEntryCount() const noexcept;
+
+    /// @brief Gets the upper bound of the identifiers of proxies.
+    /// @details All proxy identifiers are less than this.
+    Size GetIdLimit() const noexcept;
+
+    /// @brief Shifts the world origin.
+    /// @note Useful for large worlds.
+    /// @note The shift formula is: <code>position -= newOrigin</code>.
+    /// @param newOrigin the new origin with respect to the old origin.
+    void ShiftOrigin(Length2 newOrigin);
+
+private:
+    /// @brief Proxy data.
+    struct Proxy
+    {
+        AABB aabb; ///< AABB of the proxy.
+        LeafData data; ///< Leaf data of the proxy.
+        CellRange cells; ///< Cells the proxy is in.
+        bool used; ///< Whether this is the data of a current proxy.
+        bool oversized; ///< Whether the proxy is in the oversized list instead of the buckets.
+    };
+
+    /// @brief Gets the index of the bucket that the cell at the given coordinates hashes to.
+    /// @pre There's at least one bucket.
+    std::size_t GetBucketIndex(CellCoord x, CellCoord y) const noexcept;
+
+    /// @brief Adds entries for the identified proxy to the buckets of the cells it's in.
+    /// @details Adds the proxy to the oversized list instead if it's in more cells than
+    ///   there are buckets.
+    void Insert(Size id);
+
+    /// @brief Removes the entries for the identified proxy from the buckets or removes it
+    ///   from the oversized list.
+    void Remove(Size id) noexcept;
+
+    /// @brief Redistributes all the entries into the given count of buckets.
+    /// @pre The given count is a power of two.
+    void Rehash(std::size_t count);
+
+    std::vector<Proxy> m_proxies; ///< Proxies indexed by identifier.
+    std::vector<Size> m_freeIds; ///< Identifiers free for reuse.
+    std::vector<std::vector<CellEntry>> m_buckets; ///< Buckets of cell entries.
+    std::vector<Size> m_oversized; ///< Identifiers of the oversized proxies.
+    std::size_t m_entryCount = 0; ///< Count of entries in all the buckets.
+    Length m_cellSize = GetDefaultCellSize(); ///< Width and height of the cells.
+    Size m_proxyCount = 0; ///< Count of current proxies.
+};
+
+inline bool UniformGrid::IsProxy(Size id) const noexcept
+{
+    return (id < m_proxies.size()) && m_proxies[id].used;
+}
+
+inline UniformGrid::Size UniformGrid::GetProxyCount() const noexcept
+{
+    return m_proxyCount;
+}
+
+inline std::size_t UniformGrid::GetEntryCount() const noexcept
+{
+    return m_entryCount;
+}
+
+inline UniformGrid::Size UniformGrid::GetIdLimit() const noexcept
+{
+    return static_cast<Size>(m_proxies.size());
+}
+
+inline Length UniformGrid::GetCellSize() const noexcept
+{
+    return m_cellSize;
+}
+
+inline std::size_t UniformGrid::GetBucketCount() const noexcept
+{
+    return m_buckets.size();
+}
+
+inline Span<const std::vector<UniformGrid::CellEntry>> UniformGrid::GetBuckets() const noexcept
+{
+    return Span<const std::vector<CellEntry>>(m_buckets.data(), m_buckets.size());
+}
+
+inline Span<const UniformGrid::Size> UniformGrid::GetOversized() const noexcept
+{
+    return Span<const Size>(m_oversized.data(), m_oversized.size());
+}
+
+inline AABB UniformGrid::GetAABB(Size id) const noexcept
+{
+    assert(id < m_proxies.size());
+    assert(m_proxies[id].used);
+    return m_proxies[id].aabb;
+}
+
+inline UniformGrid::LeafData UniformGrid::GetLeafData(Size id) const noexcept
+{
+    assert(id < m_proxies.size());
+    assert(m_proxies[id].used);
+    return m_proxies[id].data;
+}
+
+inline void UniformGrid::SetLeafData(Size id, LeafData value) noexcept
+{
+    assert(id < m_proxies.size());
+    assert(m_proxies[id].used);
+    m_proxies[id].data = value;
+}
+
+inline UniformGrid::CellRange UniformGrid::GetCells(Size id) const noexcept
+{
+    assert(id < m_proxies.size());
+    assert(m_proxies[id].used);
+    return m_proxies[id].cells;
+}
+
+inline UniformGrid::CellCoord UniformGrid::GetCell(Length value) const noexcept
+{
+    // Clamps coordinates to well within the range of the coordinate type so stepping to
+    // neighboring cells can't overflow.
+    PLAYRHO_CONSTEXPR const auto limit = double{std::numeric_limits<CellCoord>::max() / 2};
+    const auto cell = std::floor(static_cast<double>(Real{value / m_cellSize}));
+    return static_cast<CellCoord>(std::min(std::max(cell, -limit), limit));
+}
+
+inline UniformGrid::CellRange UniformGrid::GetCells(const AABB& aabb) const noexcept
+{
+    return CellRange{
+        GetCell(aabb.ranges[0].GetMin()), GetCell(aabb.ranges[1].GetMin()),
+        GetCell(aabb.ranges[0].GetMax()), GetCell(aabb.ranges[1].GetMax())
+    };
+}
+
+inline std::size_t UniformGrid::GetBucketIndex(CellCoord x, CellCoord y) const noexcept
+{
+    assert(!m_buckets.empty());
+    // Hash from "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+    // by Teschner et al.
+    const auto hash = (static_cast<std::uint32_t>(x) * 73856093u) ^
+                      (static_cast<std::uint32_t>(y) * 19349663u);
+    return hash & (m_buckets.size() - 1u);
+}
+
+inline Span<const UniformGrid::CellEntry> UniformGrid::GetBucket(CellCoord x,
+                                                                  CellCoord y) const noexcept
+{
+    if (m_buckets.empty())
+    {
+        return Span<const CellEntry>{};
+    }
+    const auto& bucket = m_buckets[GetBucketIndex(x, y)];
+    return Span<const CellEntry>(bucket.data(), bucket.size());
+}
+
+/// @brief Gets the "size" of the given uniform grid broad-phase.
+/// @note Size in this context is defined as the proxy count.
+/// @relatedalso UniformGrid
+inline std::size_t size(const UniformGrid& grid) noexcept
+{
+    return grid.GetProxyCount();
+}
+
+/// @brief Equality operator.
+/// @relatedalso UniformGrid::CellRange
+PLAYRHO_CONSTEXPR inline bool operator== (const UniformGrid::CellRange& lhs,
+                                          const UniformGrid::CellRange& rhs) noexcept
+{
+    return (lhs.minX == rhs.minX) && (lhs.minY == rhs.minY)
+        && (lhs.maxX == rhs.maxX) && (lhs.maxY == rhs.maxY);
+}
+
+/// @brief Inequality operator.
+/// @relatedalso UniformGrid::CellRange
+PLAYRHO_CONSTEXPR inline bool operator!= (const UniformGrid::CellRange& lhs,
+                                          const UniformGrid::CellRange& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+/// @brief Gets the count of cells in the given range.
+/// @relatedalso UniformGrid::CellRange
+inline std::uint64_t GetCellCount(const UniformGrid::CellRange& cells) noexcept
+{
+    return static_cast<std::uint64_t>(std::int64_t{cells.maxX} - cells.minX + 1) *
+           static_cast<std::uint64_t>(std::int64_t{cells.maxY} - cells.minY + 1);
+}
+
+/// @brief Whether the cell at the given coordinates is in the given range.
+/// @relatedalso UniformGrid::CellRange
+inline bool IsWithin(const UniformGrid::CellRange& cells,
+                     UniformGrid::CellCoord x, UniformGrid::CellCoord y) noexcept
+{
+    return (x >= cells.minX) && (x <= cells.maxX) && (y >= cells.minY) && (y <= cells.maxY);
+}
+
+/// @brief Queries the given uniform grid broad-phase for proxies overlapping the given AABB.
+/// @details Visits the cells that the given AABB overlaps. Proxies in more than one of
+///   those cells are only checked from the first cell they share with the AABB. When the
+///   AABB overlaps more cells than there are buckets, visits all the buckets instead.
+///   Oversized proxies are checked directly.
+/// @param grid Uniform grid broad-phase to query.
+/// @param aabb The query box.
+/// @param callback Callable object that's called with the identifier of each overlapping
+///   proxy and that returns <code>DynamicTreeOpcode::End</code> to terminate the query.
+/// @relatedalso UniformGrid
+template <typename F>
+std::enable_if_t<std::is_invocable_r<DynamicTreeOpcode, F, UniformGrid::Size>::value>
+Query(const UniformGrid& grid, const AABB& aabb, F&& callback)
+{
+    const auto cells = grid.GetCells(aabb);
+    const auto visit = [&](const UniformGrid::CellEntry& entry) {
+        const auto other = grid.GetCells(entry.id);
+        if ((entry.x != std::max(other.minX, cells.minX)) ||
+            (entry.y != std::max(other.minY, cells.minY)))
+        {
+            return DynamicTreeOpcode::Continue;
+        }
+        return TestOverlap(grid.GetAABB(entry.id), aabb)?
+            callback(entry.id): DynamicTreeOpcode::Continue;
+    };
+
+    for (const auto id: grid.GetOversized())
+    {
+        if (TestOverlap(grid.GetAABB(id), aabb) && (callback(id) == DynamicTreeOpcode::End))
+        {
+            return;
+        }
+    }
+
+    if (GetCellCount(cells) > grid.GetBucketCount())
+    {
+        for (const auto& bucket: grid.GetBuckets())
+        {
+            for (const auto& entry: bucket)
+            {
+                if (IsWithin(cells, entry.x, entry.y) && (visit(entry) == DynamicTreeOpcode::End))
+                {
+                    return;
+                }
+            }
+        }
+        return;
+    }
+
+    for (auto y = cells.minY; y <= cells.maxY; ++y)
+    {
+        for (auto x = cells.minX; x <= cells.maxX; ++x)
+        {
+            for (const auto& entry: grid.GetBucket(x, y))
+            {
+                if ((entry.x == x) && (entry.y == y) && (visit(entry) == DynamicTreeOpcode::End))
+                {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+/// @brief Queries the given uniform grid broad-phase for all fixtures that potentially
+///   overlap the given AABB.
+/// @param grid Uniform grid broad-phase to query.
+/// @param aabb The query box.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature.
+///   It returns <code>false</code> to terminate the query.
+/// @relatedalso UniformGrid
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const UniformGrid& grid, const AABB& aabb, F&& callback)
+{
+    Query(grid, aabb, [&](UniformGrid::Size id) {
+        const auto leafData = grid.GetLeafData(id);
+        return callback(leafData.fixture, leafData.childIndex)?
+            DynamicTreeOpcode::Continue: DynamicTreeOpcode::End;
+    });
+}
+
+/// @brief Queries the given uniform grid broad-phase for all fixtures that potentially
+///   overlap the given AABB and whose category bits have any of the given mask bits.
+/// @param grid Uniform grid broad-phase to query.
+/// @param aabb The query box.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature.
+///   It returns <code>false</code> to terminate the query.
+/// @see Filter
+/// @relatedalso UniformGrid
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const UniformGrid& grid, const AABB& aabb, Filter::bits_type maskBits, F&& callback)
+{
+    Query(grid, aabb, [&](UniformGrid::Size id) {
+        const auto leafData = grid.GetLeafData(id);
+        if ((leafData.categoryBits & maskBits) == 0)
+        {
+            return DynamicTreeOpcode::Continue;
+        }
+        return callback(leafData.fixture, leafData.childIndex)?
+            DynamicTreeOpcode::Continue: DynamicTreeOpcode::End;
+    });
+}
+
+/// @brief Cast rays against the proxies of the given uniform grid broad-phase.
+/// @details Walks the cells along the ray in order from its start using the algorithm
+///   from "A Fast Voxel Traversal Algorithm for Ray Tracing" by Amanatides and Woo. The
+///   walk stops once it's past the ray's max fraction, so clipping the ray stops the walk
+///   early. Proxies in more than one cell along the ray are only checked from the first.
+///   When the ray's AABB overlaps more cells than there are buckets, uses a query of that
+///   box instead. Oversized proxies are checked before walking the cells.
+/// @param grid Uniform grid broad-phase to ray cast.
+/// @param input the ray-cast input data.
+/// @param callback Callable object that's called with the identifier of each proxy whose
+///   AABB is hit by the ray and with the ray-cast input data. It should return 0 to
+///   terminate ray casting, or greater than 0 to update the segment bounding box. Values
+///   less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @sa RayCast(const DynamicTree&, RayCastInput, F&&).
+/// @relatedalso UniformGrid
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, UniformGrid::Size, const RayCastInput&>::value, bool>
+RayCast(const UniformGrid& grid, RayCastInput input, F&& callback)
+{
+    const auto delta = input.p2 - input.p1;
+    const auto v = GetRevPerpendicular(GetUnitVector(delta, UnitVec::GetZero()));
+    const auto abs_v = abs(v);
+    auto segmentAABB = d2::GetAABB(input);
+    auto terminated = false;
+    const auto visit = [&](UniformGrid::Size id) {
+        const auto aabb = grid.GetAABB(id);
+        if (!TestOverlap(aabb, segmentAABB))
+        {
+            return DynamicTreeOpcode::Continue;
+        }
+
+        // Separating axis for segment (Gino, p80).
+        // |dot(v, p1 - ctr)| > dot(|v|, extents)
+        const auto separation = abs(Dot(v, input.p1 - GetCenter(aabb)))
+            - Dot(abs_v, GetExtents(aabb));
+        if (separation > 0_m)
+        {
+            return DynamicTreeOpcode::Continue;
+        }
+
+        const auto value = static_cast<Real>(callback(id, input));
+        if (value == 0)
+        {
+            terminated = true; // Callback has terminated the ray cast.
+            return DynamicTreeOpcode::End;
+        }
+        if (value > 0)
+        {
+            // Update segment bounding box.
+            input.maxFraction = value;
+            segmentAABB = d2::GetAABB(input);
+        }
+        return DynamicTreeOpcode::Continue;
+    };
+
+    const auto cells = grid.GetCells(segmentAABB);
+    if (GetCellCount(cells) > grid.GetBucketCount())
+    {
+        Query(grid, segmentAABB, visit);
+        return terminated;
+    }
+
+    for (const auto id: grid.GetOversized())
+    {
+        if (visit(id) == DynamicTreeOpcode::End)
+        {
+            return terminated;
+        }
+    }
+
+    const auto cellSize = grid.GetCellSize();
+    const auto start = std::array<double, 2>{
+        static_cast<double>(Real{GetX(input.p1) / cellSize}),
+        static_cast<double>(Real{GetY(input.p1) / cellSize})
+    };
+    const auto offset = std::array<double, 2>{
+        static_cast<double>(Real{GetX(delta) / cellSize}),
+        static_cast<double>(Real{GetY(delta) / cellSize})
+    };
+    auto cell = std::array<UniformGrid::CellCoord, 2>{
+        grid.GetCell(GetX(input.p1)), grid.GetCell(GetY(input.p1))
+    };
+    auto step = std::array<UniformGrid::CellCoord, 2>{};
+    auto tMax = std::array<double, 2>{};
+    auto tDelta = std::array<double, 2>{};
+    for (auto i = std::size_t{0}; i < 2; ++i)
+    {
+        const auto floor = std::floor(start[i]);
+        step[i] = (offset[i] > 0)? 1: -1;
+        tMax[i] = (offset[i] > 0)? (floor + 1 - start[i]) / offset[i]:
+                  (offset[i] < 0)? (floor - start[i]) / offset[i]:
+                  std::numeric_limits<double>::infinity();
+        tDelta[i] = (offset[i] != 0)? 1 / std::abs(offset[i]):
+                    std::numeric_limits<double>::infinity();
+    }
+
+    auto previous = cell;
+    auto first = true;
+    while (IsWithin(cells, cell[0], cell[1]))
+    {
+        for (const auto& entry: grid.GetBucket(cell[0], cell[1]))
+        {
+            if ((entry.x != cell[0]) || (entry.y != cell[1]))
+            {
+                continue;
+            }
+            // Cells along the ray form a monotonic path so the cells a proxy shares with
+            // the path are contiguous. A proxy is only visited from the first of those.
+            if (!first && IsWithin(grid.GetCells(entry.id), previous[0], previous[1]))
+            {
+                continue;
+            }
+            if (visit(entry.id) == DynamicTreeOpcode::End)
+            {
+                return terminated;
+            }
+        }
+        const auto axis = (tMax[0] < tMax[1])? std::size_t{0}: std::size_t{1};
+        if (tMax[axis] > static_cast<double>(Real{input.maxFraction}))
+        {
+            break;
+        }
+        previous = cell;
+        first = false;
+        cell[axis] += step[axis];
+        tMax[axis] += tDelta[axis];
+    }
+    return terminated;
+}
+
+/// @brief Cast rays against the fixtures of the proxies of the given uniform grid
+///   broad-phase.
+/// @param grid Uniform grid broad-phase to ray cast.
+/// @param input the ray-cast input data.
+/// @param callback Callable object having the <code>DynamicTreeRayCastCB</code> signature.
+///   It should return 0 to terminate ray casting, or greater than 0 to update the
+///   segment bounding box. Values less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @relatedalso UniformGrid
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, Fixture*, ChildCounter, const RayCastInput&>::value, bool>
+RayCast(const UniformGrid& grid, const RayCastInput& input, F&& callback)
+{
+    return RayCast(grid, input, [&](UniformGrid::Size id, const RayCastInput& in) {
+        const auto leafData = grid.GetLeafData(id);
+        return callback(leafData.fixture, leafData.childIndex, in);
+    });
+}
+
+/// @brief Cast rays against the fixtures of the proxies of the given uniform grid
+///   broad-phase whose category bits have any of the given mask bits.
+/// @param grid Uniform grid broad-phase to ray cast.
+/// @param input the ray-cast input data.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>DynamicTreeRayCastCB</code> signature.
+///   It should return 0 to terminate ray casting, or greater than 0 to update the
+///   segment bounding box. Values less than zero are ignored.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @see Filter
+/// @relatedalso UniformGrid
+template <typename F>
+std::enable_if_t<std::is_invocable_r<Real, F, Fixture*, ChildCounter, const RayCastInput&>::value, bool>
+RayCast(const UniformGrid& grid, const RayCastInput& input, Filter::bits_type maskBits,
+        F&& callback)
+{
+    return RayCast(grid, input, [&](UniformGrid::Size id, const RayCastInput& in) {
+        const auto leafData = grid.GetLeafData(id);
+        if ((leafData.categoryBits & maskBits) == 0)
+        {
+            return Real{-1};
+        }
+        return static_cast<Real>(callback(leafData.fixture, leafData.childIndex, in));
+    });
+}
+
+/// @brief Ray-cast the given uniform grid broad-phase for all fixtures in the path of
+///   the ray.
+/// @param grid Uniform grid broad-phase to ray cast.
+/// @param input Ray cast input data.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+/// @relatedalso UniformGrid
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const UniformGrid& grid, const RayCastInput& input, F&& callback)
+{
+    return RayCast(grid, input, [&callback](Fixture* fixture, ChildCounter child,
+                                            const RayCastInput& in) {
+        return RayCastFixtureChild(fixture, child, in, callback);
+    });
+}
+
+/// @brief Ray-cast the given uniform grid broad-phase for all fixtures in the path of
+///   the ray whose category bits have any of the given mask bits.
+/// @param grid Uniform grid broad-phase to ray cast.
+/// @param input Ray cast input data.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+/// @see Filter
+/// @relatedalso UniformGrid
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const UniformGrid& grid, const RayCastInput& input, Filter::bits_type maskBits,
+        F&& callback)
+{
+    return RayCast(grid, input, maskBits, [&callback](Fixture* fixture, ChildCounter child,
+                                                      const RayCastInput& in) {
+        return RayCastFixtureChild(fixture, child, in, callback);
+    });
+}
+
+} // namespace d2
+} // namespace playrho
+
+#endif // PLAYRHO_COLLISION_UNIFORMGRID_HPP
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <PlayRho/Collision/WideTree.hpp>
+#include <PlayRho/Common/GrowableStack.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#define PLAYRHO_WIDETREE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace playrho {
+namespace d2 {
+
+namespace {
+
+/// @brief Whether single precision bounds are the exact bounds.
+PLAYRHO_CONSTEXPR const auto BoundsAreExact = std::is_same<Real, float>::value;
+
+/// @brief Single precision infinity.
+PLAYRHO_CONSTEXPR const auto FloatInfinity = std::numeric_limits<float>::infinity();
+
+/// @brief Single precision AABB.
+struct FloatAABB
+{
+    float minX; ///< Lower X bound.
+    float minY; ///< Lower Y bound.
+    float maxX; ///< Upper X bound.
+    float maxY; ///< Upper Y bound.
+};
+
+/// @brief Single precision ray data.
+struct FloatRay
+{
+    float p1x; ///< X coordinate of the ray's first point.
+    float p1y; ///< Y coordinate of the ray's first point.
+    float vx; ///< X component of the ray's perpendicular.
+    float vy; ///< Y component of the ray's perpendicular.
+    float tolerance; ///< Error bound of the separation computation.
+    FloatAABB segment; ///< Bounds of the ray's segment.
+};
+
+/// @brief Converts the given value to single precision rounding down.
+inline float RoundDown(Real value) noexcept
+{
+    auto result = static_cast<float>(value);
+    if (static_cast<Real>(result) > value)
+    {
+        result = std::nextafter(result, -FloatInfinity);
+    }
+    return result;
+}
+
+/// @brief Converts the given value to single precision rounding up.
+inline float RoundUp(Real value) noexcept
+{
+    auto result = static_cast<float>(value);
+    if (static_cast<Real>(result) < value)
+    {
+        result = std::nextafter(result, FloatInfinity);
+    }
+    return result;
+}
+
+/// @brief Converts the given AABB to a single precision AABB covering it.
+inline FloatAABB ToFloatAABB(const AABB& aabb) noexcept
+{
+    return FloatAABB{
+        RoundDown(StripUnit(aabb.ranges[0].GetMin())),
+        RoundDown(StripUnit(aabb.ranges[1].GetMin())),
+        RoundUp(StripUnit(aabb.ranges[0].GetMax())),
+        RoundUp(StripUnit(aabb.ranges[1].GetMax()))
+    };
+}
+
+#if defined(PLAYRHO_WIDETREE_SSE)
+
+/// @brief Gets the bit mask of the given node's children whose bounds overlap the given AABB.
+inline unsigned GetOverlapMask(const WideTree::Node& node, const FloatAABB& aabb) noexcept
+{
+    const auto x = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minX.data()), _mm_set1_ps(aabb.maxX)),
+                              _mm_cmple_ps(_mm_set1_ps(aabb.minX), _mm_load_ps(node.maxX.data())));
+    const auto y = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minY.data()), _mm_set1_ps(aabb.maxY)),
+                              _mm_cmple_ps(_mm_set1_ps(aabb.minY), _mm_load_ps(node.maxY.data())));
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_and_ps(x, y)));
+}
+
+/// @brief Gets the bit mask of the given node's children whose bounds the given ray may hit.
+/// @details Applies the same tests as the dynamic tree's ray cast does but to four children
+///   at once and allowing for the error of doing so in single precision.
+inline unsigned GetRayMask(const WideTree::Node& node, const FloatRay& ray) noexcept
+{
+    const auto half = _mm_set1_ps(0.5f);
+    const auto minX = _mm_load_ps(node.minX.data());
+    const auto minY = _mm_load_ps(node.minY.data());
+    const auto maxX = _mm_load_ps(node.maxX.data());
+    const auto maxY = _mm_load_ps(node.maxY.data());
+    const auto vx = _mm_set1_ps(ray.vx);
+    const auto vy = _mm_set1_ps(ray.vy);
+    const auto signMask = _mm_set1_ps(-0.0f);
+    const auto dx = _mm_sub_ps(_mm_set1_ps(ray.p1x), _mm_mul_ps(_mm_add_ps(minX, maxX), half));
+    const auto dy = _mm_sub_ps(_mm_set1_ps(ray.p1y), _mm_mul_ps(_mm_add_ps(minY, maxY), half));
+    const auto ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+    const auto ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+    const auto dist = _mm_andnot_ps(signMask, _mm_add_ps(_mm_mul_ps(vx, dx), _mm_mul_ps(vy, dy)));
+    const auto reach = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, vx), ex),
+                                  _mm_mul_ps(_mm_andnot_ps(signMask, vy), ey));
+    // Comparisons with NaN are false so unused children (with inverted bounds) are culled.
+    const auto near = _mm_cmple_ps(_mm_sub_ps(dist, reach), _mm_set1_ps(ray.tolerance));
+    return static_cast<unsigned>(_mm_movemask_ps(near)) & GetOverlapMask(node, ray.segment);
+}
+
+#else
+
+/// @brief Gets the bit mask of the given node's children whose bounds overlap the given AABB.
+inline unsigned GetOverlapMask(const WideTree::Node& node, const FloatAABB& aabb) noexcept
+{
+    auto mask = 0u;
+    for (auto i = std::size_t{0}; i < WideTree::Width; ++i)
+    {
+        const auto overlap = (node.minX[i] <= aabb.maxX) && (aabb.minX <= node.maxX[i])
+                          && (node.minY[i] <= aabb.maxY) && (aabb.minY <= node.maxY[i]);
+        mask |= overlap? (1u << i): 0u;
+    }
+    return mask;
+}
+
+/// @brief Gets the bit mask of the given node's children whose bounds the given ray may hit.
+/// @details Applies the same tests as the dynamic tree's ray cast does but allowing for
+///   the error of doing so in single precision.
+inline unsigned GetRayMask(const WideTree::Node& node, const FloatRay& ray) noexcept
+{
+    auto mask = 0u;
+    for (auto i = std::size_t{0}; i < WideTree::Width; ++i)
+    {
+        const auto dx = ray.p1x - (node.minX[i] + node.maxX[i]) * 0.5f;
+        const auto dy = ray.p1y - (node.minY[i] + node.maxY[i]) * 0.5f;
+        const auto ex = (node.maxX[i] - node.minX[i]) * 0.5f;
+        const auto ey = (node.maxY[i] - node.minY[i]) * 0.5f;
+        const auto dist = std::abs(ray.vx * dx + ray.vy * dy);
+        const auto reach = std::abs(ray.vx) * ex + std::abs(ray.vy) * ey;
+        // Comparisons with NaN are false so unused children (with inverted bounds) are culled.
+        mask |= ((dist - reach) <= ray.tolerance)? (1u << i): 0u;
+    }
+    return mask & GetOverlapMask(node, ray.segment);
+}
+
+#endif
+
+} // anonymous namespace
+
+WideTree::WideTree(const DynamicTree& tree)
+{
+    const auto root = tree.GetRootIndex();
+    if (root == DynamicTree::GetInvalidSize())
+    {
+        return;
+    }
+
+    const auto leafCount = tree.GetLeafCount();
+    m_nodes.reserve(leafCount / 2 + 1);
+    m_leafAABBs.reserve(leafCount);
+    m_leafData.reserve(leafCount);
+    m_leafIndices.reserve(leafCount);
+    const auto rootAABB = ToFloatAABB(tree.GetAABB(root));
+    m_maxAbsCoord = std::max(std::max(std::abs(rootAABB.minX), std::abs(rootAABB.minY)),
+                             std::max(std::abs(rootAABB.maxX), std::abs(rootAABB.maxY)));
+
+    Append(tree, root);
+}
+
+WideTree::Size WideTree::Append(const DynamicTree& tree, DynamicTree::Size index)
+{
+    // Collapses the binary sub-tree at the given index into up to four children by
+    // repeatedly opening up the child branch having the largest perimeter.
+    auto items = std::array<DynamicTree::Size, Width>{};
+    auto count = std::size_t{0};
+    if (DynamicTree::IsBranch(tree.GetHeight(index)))
+    {
+        const auto branchData = tree.GetBranchData(index);
+        items[count++] = branchData.child1;
+        items[count++] = branchData.child2;
+        while (count < Width)
+        {
+            auto widest = Width;
+            auto widestPerimeter = 0_m;
+            for (auto i = std::size_t{0}; i < count; ++i)
+            {
+                if (DynamicTree::IsBranch(tree.GetHeight(items[i])))
+                {
+                    const auto perimeter = GetPerimeter(tree.GetAABB(items[i]));
+                    if ((widest == Width) || (perimeter > widestPerimeter))
+                    {
+                        widest = i;
+                        widestPerimeter = perimeter;
+                    }
+                }
+            }
+            if (widest == Width)
+            {
+                break;
+            }
+            const auto opened = tree.GetBranchData(items[widest]);
+            std::copy_backward(begin(items) + widest + 1, begin(items) + count,
+                               begin(items) + count + 1);
+            items[widest] = opened.child1;
+            items[widest + 1] = opened.child2;
+            ++count;
+        }
+    }
+    else
+    {
+        // Only a lone root leaf gets here.
+        items[count++] = index;
+    }
+
+    const auto position = static_cast<Size>(size(m_nodes));
+    m_nodes.push_back(Node{});
+
+    auto node = Node{};
+    node.minX.fill(FloatInfinity);
+    node.minY.fill(FloatInfinity);
+    node.maxX.fill(-FloatInfinity);
+    node.maxY.fill(-FloatInfinity);
+    node.children.fill(DynamicTree::GetInvalidSize());
+    node.leafMask = 0;
+    node.count = static_cast<std::uint8_t>(count);
+    for (auto i = std::size_t{0}; i < count; ++i)
+    {
+        const auto aabb = tree.GetAABB(items[i]);
+        const auto bounds = ToFloatAABB(aabb);
+        node.minX[i] = bounds.minX;
+        node.minY[i] = bounds.minY;
+        node.maxX[i] = bounds.maxX;
+        node.maxY[i] = bounds.maxY;
+        if (DynamicTree::IsLeaf(tree.GetHeight(items[i])))
+        {
+            node.children[i] = static_cast<Size>(size(m_leafIndices));
+            node.leafMask |= static_cast<std::uint8_t>(1u << i);
+            m_leafAABBs.push_back(aabb);
+            m_leafData.push_back(tree.GetLeafData(items[i]));
+            m_leafIndices.push_back(items[i]);
+        }
+        else
+        {
+            node.children[i] = Append(tree, items[i]);
+        }
+    }
+    m_nodes[position] = node;
+    return position;
+}
+
+void Query(const WideTree& tree, const AABB& aabb, const DynamicTreeSizeCB& callback)
+{
+    if (tree.GetNodeCount() == 0)
+    {
+        return;
+    }
+
+    const auto bounds = ToFloatAABB(aabb);
+    GrowableStack<WideTree::Size, 256> stack;
+    stack.push(0);
+    while (!empty(stack))
+    {
+        const auto& node = tree.GetNode(stack.top());
+        stack.pop();
+        const auto mask = GetOverlapMask(node, bounds);
+        for (auto i = std::size_t{0}; i < WideTree::Width; ++i)
+        {
+            const auto bit = 1u << i;
+            if ((mask & bit) == 0)
+            {
+                continue;
+            }
+            const auto child = node.children[i];
+            if ((node.leafMask & bit) == 0)
+            {
+                stack.push(child);
+            }
+            else if (BoundsAreExact || TestOverlap(tree.GetLeafAABB(child), aabb))
+            {
+                if (callback(tree.GetLeafIndex(child)) == DynamicTreeOpcode::End)
+                {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+bool RayCast(const WideTree& tree, RayCastInput input, const DynamicTreeRayCastCB& callback)
+{
+    if (tree.GetNodeCount() == 0)
+    {
+        return false;
+    }
+
+    const auto v = GetRevPerpendicular(GetUnitVector(input.p2 - input.p1, UnitVec::GetZero()));
+    const auto abs_v = abs(v);
+    auto segmentAABB = d2::GetAABB(input);
+
+    auto ray = FloatRay{};
+    ray.p1x = static_cast<float>(StripUnit(GetX(input.p1)));
+    ray.p1y = static_cast<float>(StripUnit(GetY(input.p1)));
+    ray.vx = static_cast<float>(v.GetX());
+    ray.vy = static_cast<float>(v.GetY());
+    // Bounds the rounding error of computing the separations in single precision. This
+    // only lets through a few more branches and leaves are confirmed exactly anyway.
+    ray.tolerance = std::numeric_limits<float>::epsilon() * 16
+        * (std::abs(ray.p1x) + std::abs(ray.p1y) + tree.GetMaxAbsCoord() * 2);
+    ray.segment = ToFloatAABB(segmentAABB);
+
+    GrowableStack<WideTree::Size, 256> stack;
+    stack.push(0);
+    while (!empty(stack))
+    {
+        const auto& node = tree.GetNode(stack.top());
+        stack.pop();
+        const auto mask = GetRayMask(node, ray);
+        for (auto i = std::size_t{0}; i < WideTree::Width; ++i)
+        {
+            const auto bit = 1u << i;
+            if ((mask & bit) == 0)
+            {
+                continue;
+            }
+            const auto child = node.children[i];
+            if ((node.leafMask & bit) == 0)
+            {
+                stack.push(child);
+                continue;
+            }
+
+            const auto aabb = tree.GetLeafAABB(child);
+            if (!TestOverlap(aabb, segmentAABB))
+            {
+                continue;
+            }
+
+            // Separating axis for segment (Gino, p80).
+            // |dot(v, p1 - ctr)| > dot(|v|, extents)
+            const auto center = GetCenter(aabb);
+            const auto extents = GetExtents(aabb);
+            const auto separation = abs(Dot(v, input.p1 - center)) - Dot(abs_v, extents);
+            if (separation > 0_m)
+            {
+                continue;
+            }
+
+            const auto leafData = tree.GetLeafData(child);
+            const auto value = callback(leafData.fixture, leafData.childIndex, input);
+            if (value == 0)
+            {
+                return true; // Callback has terminated the ray cast.
+            }
+            if (value > 0)
+            {
+                // Update segment bounding box.
+                input.maxFraction = value;
+                segmentAABB = d2::GetAABB(input);
+                ray.segment = ToFloatAABB(segmentAABB);
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace d2
+} // namespace playrho
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PLAYRHO_COLLISION_WIDETREE_HPP
+#define PLAYRHO_COLLISION_WIDETREE_HPP
+
+/// @file
+/// Declaration of the <code>WideTree</code> class.
+
+#include <PlayRho/Collision/DynamicTree.hpp>
+#include <PlayRho/Collision/RayCastOutput.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace playrho {
+namespace d2 {
+
+/// @brief A four-wide copy of a dynamic tree's hierarchy for data parallel traversal.
+///
+/// @details This collapses the binary hierarchy of a <code>DynamicTree</code> into a
+///   hierarchy where every node has up to four children. The bounds of a node's children
+///   are stored together as single precision structure-of-arrays data so that all four
+///   of them can be tested against a query AABB, or against a ray, at once using SIMD
+///   instructions (SSE where available, otherwise plain scalar code). Compared to the
+///   binary tree, this roughly halves the traversal depth and the number of data
+///   dependent branches taken per query.
+///
+/// @note Single precision bounds are rounded outward so traversal stays conservative.
+///   Leaves are confirmed against their exact bounds, using the same tests as the dynamic
+///   tree's functions do, before being reported. So results are the same as for the
+///   dynamic tree this was made from, though the order of them may differ.
+/// @note This is a snapshot. It doesn't reflect changes made to the dynamic tree it was
+///   made from after it was made. Construct it anew from the dynamic tree after that's
+///   been updated (after the proxies have been moved for a step for instance).
+///
+/// @sa DynamicTree, CompactTree.
+///
+class WideTree
+{
+public:
+    /// @brief Size type.
+    using Size = DynamicTree::Size;
+
+    /// @brief Maximum number of children per node.
+    static PLAYRHO_CONSTEXPR const auto Width = std::size_t{4};
+
+    /// @brief Node of a wide tree.
+    /// @details Unused child slots have inverted (empty) bounds so they never overlap.
+    struct alignas(16) Node
+    {
+        std::array<float, Width> minX; ///< Lower X bounds of the children.
+        std::array<float, Width> minY; ///< Lower Y bounds of the children.
+        std::array<float, Width> maxX; ///< Upper X bounds of the children.
+        std::array<float, Width> maxY; ///< Upper Y bounds of the children.
+
+        /// @brief Child indices.
+        /// @details Leaf slot index for a child whose bit is set in the leaf mask, or node
+        ///   index otherwise.
+        std::array<Size, Width> children;
+
+        std::uint8_t leafMask; ///< Bit mask of the children that are leaves.
+        std::uint8_t count; ///< Number of children in use.
+    };
+
+    /// @brief Default constructor.
+    /// @details Constructs an empty tree.
+    WideTree() = default;
+
+    /// @brief Initializing constructor.
+    /// @details Constructs a four-wide copy of the given dynamic tree's hierarchy.
+    explicit WideTree(const DynamicTree& tree);
+
+    /// @brief Gets the count of nodes in this tree.
+    /// @note This doesn't include leaves. The root node, if any, is at index zero.
+    Size GetNodeCount() const noexcept
+    {
+        return static_cast<Size>(m_nodes.size());
+    }
+
+    /// @brief Gets the node at the given index.
+    /// @warning Behavior is undefined if the given index is not less than the node count.
+    const Node& GetNode(Size index) const noexcept
+    {
+        assert(index < GetNodeCount());
+        return m_nodes[index];
+    }
+
+    /// @brief Gets the count of leaves in this tree.
+    Size GetLeafCount() const noexcept
+    {
+        return static_cast<Size>(m_leafIndices.size());
+    }
+
+    /// @brief Gets the dynamic tree leaf index of the leaf in the given slot.
+    /// @warning Behavior is undefined if the given slot is not less than the leaf count.
+    Size GetLeafIndex(Size slot) const noexcept
+    {
+        assert(slot < GetLeafCount());
+        return m_leafIndices[slot];
+    }
+
+    /// @brief Gets the exact AABB of the leaf in the given slot.
+    /// @warning Behavior is undefined if the given slot is not less than the leaf count.
+    AABB GetLeafAABB(Size slot) const noexcept
+    {
+        assert(slot < GetLeafCount());
+        return m_leafAABBs[slot];
+    }
+
+    /// @brief Gets the leaf data of the leaf in the given slot.
+    /// @warning Behavior is undefined if the given slot is not less than the leaf count.
+    DynamicTree::LeafData GetLeafData(Size slot) const noexcept
+    {
+        assert(slot < GetLeafCount());
+        return m_leafData[slot];
+    }
+
+    /// @brief Gets the largest absolute coordinate value of any bounds in this tree.
+    /// @note This is used for bounding the error of single precision ray tests.
+    float GetMaxAbsCoord() const noexcept
+    {
+        return m_maxAbsCoord;
+    }
+
+private:
+    /// @brief Adds a node for the branch of the given tree at the given index.
+    /// @return Index of the added node.
+    Size Append(const DynamicTree& tree, DynamicTree::Size index);
+
+    std::vector<Node> m_nodes; ///< Nodes with the root first.
+    std::vector<AABB> m_leafAABBs; ///< Exact AABBs of the leaves by slot.
+    std::vector<DynamicTree::LeafData> m_leafData; ///< Leaf data of the leaves by slot.
+    std::vector<Size> m_leafIndices; ///< Dynamic tree leaf indices of the leaves by slot.
+    float m_maxAbsCoord = 0; ///< Largest absolute coordinate value.
+};
+
+/// @brief Queries the given wide tree for leaves overlapping the given AABB.
+/// @note The callback is called with the leaf indices of the dynamic tree the wide tree
+///   was made from.
+/// @relatedalso WideTree
+void Query(const WideTree& tree, const AABB& aabb, const DynamicTreeSizeCB& callback);
+
+/// @brief Casts a ray against the leaves of the given wide tree.
+/// @details This behaves the same as the dynamic tree ray cast function except for the
+///   order in which leaves are visited.
+/// @return <code>true</code> if terminated at the callback's request,
+///   <code>false</code> otherwise.
+/// @sa RayCast(const DynamicTree&, RayCastInput, const DynamicTreeRayCastCB&).
+/// @relatedalso WideTree
+bool RayCast(const WideTree& tree, RayCastInput input, const DynamicTreeRayCastCB& callback);
+
+/// @brief Gets the "size" of the given tree.
+/// @note Size in this context is defined as the leaf count.
+/// @relatedalso WideTree
+inline std::size_t size(const WideTree& tree) noexcept
+{
+    return tree.GetLeafCount();
+}
+
+} // namespace d2
+} // namespace playrho
+
+#endif // PLAYRHO_COLLISION_WIDETREE_HPP
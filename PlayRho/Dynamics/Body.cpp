@@ -281,9 +281,12 @@ void Body::SetTransformation(Transformation value) noexcept
     assert(IsValid(value));
     if (m_xf != value)
     {
+        // How far this body moved bounds how much closer its shapes got to other shapes.
+        const auto linear = GetMagnitude(value.p - m_xf.p);
+        const auto chord = GetMagnitude(GetVec2(value.q) - GetVec2(m_xf.q));
         m_xf = value;
         std::for_each(cbegin(m_contacts), cend(m_contacts), [&](KeyedContactPtr ci) {
-            std::get<Contact*>(ci)->FlagForUpdating();
+            std::get<Contact*>(ci)->FlagForUpdating(*this, linear, chord);
         });
     }
 }
@@ -575,6 +575,12 @@ private:
     ///   I.e. if a body is under-active for long enough, it should go to sleep.
     /// @note 4-bytes.
     Time m_underActiveTime = 0;
+
+    /// Recent displacement.
+    /// @details Decaying peak of the distances the body's origin moved by per step.
+    ///   Used for sizing the fattening of the AABBs of the body's fixtures' proxies.
+    /// @note 4-bytes.
+    Length m_recentDisplacement = 0_m;
 };
 
 /// @example Body.cpp
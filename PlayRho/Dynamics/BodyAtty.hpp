@@ -190,6 +190,18 @@ private:
         b.m_sweep.pos1 = value;
     }
     
+    /// @brief Gets the recent displacement of the given body.
+    static Length GetRecentDisplacement(const Body& b) noexcept
+    {
+        return b.m_recentDisplacement;
+    }
+    
+    /// @brief Sets the recent displacement of the given body.
+    static void SetRecentDisplacement(Body& b, Length value) noexcept
+    {
+        b.m_recentDisplacement = value;
+    }
+    
     /// @brief Resets the given body's "alpha-0" value.
     static void ResetAlpha0(Body& b) noexcept
     {
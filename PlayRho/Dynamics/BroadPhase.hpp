@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PLAYRHO_DYNAMICS_BROADPHASE_HPP
+#define PLAYRHO_DYNAMICS_BROADPHASE_HPP
+
+/// @file
+/// Declaration of the <code>BroadPhase</code> class.
+
+#include <PlayRho/Collision/SweepAndPrune.hpp>
+#include <PlayRho/Collision/TreeBroadPhase.hpp>
+#include <PlayRho/Collision/UniformGrid.hpp>
+#include <PlayRho/Dynamics/WorldConf.hpp>
+
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace playrho {
+namespace d2 {
+
+/// @brief Broad-phase.
+///
+/// @details Holds the fixture proxies of a world in whichever one of the broad-phase data
+///   structures the world was configured to use. Provides the operations on proxies that
+///   all of them have and visiting of the one in use for anything else.
+///
+/// @note The alternatives are in the order of the <code>BroadPhaseType</code> values.
+///
+/// @sa BroadPhaseType, TreeBroadPhase, SweepAndPrune, UniformGrid
+///
+class BroadPhase
+{
+public:
+    /// @brief Size type.
+    using Size = DynamicTree::Size;
+
+    /// @brief Leaf data type.
+    using LeafData = DynamicTree::LeafData;
+
+    /// @brief Gets the invalid size value.
+    static PLAYRHO_CONSTEXPR inline Size GetInvalidSize() noexcept
+    {
+        return DynamicTree::GetInvalidSize();
+    }
+
+    /// @brief Default constructor.
+    /// @details Constructs a dynamic tree broad-phase without any initial capacity.
+    BroadPhase() = default;
+
+    /// @brief Initializing constructor.
+    /// @details Constructs the type of broad-phase that the given configuration says to
+    ///   with the configured initial size.
+    explicit BroadPhase(const WorldConf& conf);
+
+    /// @brief Gets the type of the broad-phase.
+    BroadPhaseType GetType() const noexcept;
+
+    /// @brief Creates a proxy for the given AABB and leaf data.
+    /// @param aabb AABB of the proxy.
+    /// @param data Leaf data of the proxy.
+    /// @param isStatic Whether the proxy is of a static body.
+    /// @return Identifier of the new proxy.
+    Size CreateProxy(const AABB& aabb, const LeafData& data, bool isStatic);
+
+    /// @brief Destroys the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void DestroyProxy(Size id) noexcept;
+
+    /// @brief Updates the identified proxy to have the given AABB.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void UpdateProxy(Size id, const AABB& aabb);
+
+    /// @brief Gets the AABB of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    AABB GetAABB(Size id) const noexcept;
+
+    /// @brief Gets the leaf data of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    LeafData GetLeafData(Size id) const noexcept;
+
+    /// @brief Sets the leaf data of the identified proxy.
+    /// @warning Behavior is undefined if the given identifier isn't of a current proxy.
+    void SetLeafData(Size id, LeafData value) noexcept;
+
+    /// @brief Shifts the world origin.
+    /// @note Useful for large worlds.
+    /// @note The shift formula is: <code>position -= newOrigin</code>.
+    /// @param newOrigin the new origin with respect to the old origin.
+    void ShiftOrigin(Length2 newOrigin);
+
+    /// @brief Gets the broad-phase data structure of the given type.
+    /// @return Pointer to the data structure if it's the one in use, or
+    ///   <code>nullptr</code> otherwise.
+    template <typename T>
+    const T* Get() const noexcept
+    {
+        return std::get_if<T>(&m_variant);
+    }
+
+    /// @brief Gets the broad-phase data structure of the given type.
+    /// @return Pointer to the data structure if it's the one in use, or
+    ///   <code>nullptr</code> otherwise.
+    template <typename T>
+    T* Get() noexcept
+    {
+        return std::get_if<T>(&m_variant);
+    }
+
+    /// @brief Calls the given visitor with the broad-phase data structure in use.
+    /// @return Whatever the visitor returns.
+    template <typename F>
+    decltype(auto) Visit(F&& visitor) const
+    {
+        return std::visit(std::forward<F>(visitor), m_variant);
+    }
+
+    /// @brief Calls the given visitor with the broad-phase data structure in use.
+    /// @return Whatever the visitor returns.
+    template <typename F>
+    decltype(auto) Visit(F&& visitor)
+    {
+        return std::visit(std::forward<F>(visitor), m_variant);
+    }
+
+private:
+    /// @brief Broad-phase data structures in the order of the broad-phase types.
+    using Variant = std::variant<TreeBroadPhase, SweepAndPrune, UniformGrid>;
+
+    Variant m_variant; ///< Broad-phase data structure in use.
+};
+
+inline BroadPhaseType BroadPhase::GetType() const noexcept
+{
+    return static_cast<BroadPhaseType>(m_variant.index());
+}
+
+inline BroadPhase::Size BroadPhase::CreateProxy(const AABB& aabb, const LeafData& data,
+                                                bool isStatic)
+{
+    return Visit([&](auto& broadPhase) {
+        // Only the tree broad-phase keeps static proxies apart from the others.
+        if constexpr (std::is_same<std::decay_t<decltype(broadPhase)>, TreeBroadPhase>::value)
+        {
+            return broadPhase.CreateProxy(aabb, data, isStatic);
+        }
+        else
+        {
+            return broadPhase.CreateProxy(aabb, data);
+        }
+    });
+}
+
+inline void BroadPhase::DestroyProxy(Size id) noexcept
+{
+    Visit([id](auto& broadPhase) {
+        broadPhase.DestroyProxy(id);
+    });
+}
+
+inline void BroadPhase::UpdateProxy(Size id, const AABB& aabb)
+{
+    Visit([&](auto& broadPhase) {
+        broadPhase.UpdateProxy(id, aabb);
+    });
+}
+
+inline AABB BroadPhase::GetAABB(Size id) const noexcept
+{
+    return Visit([id](const auto& broadPhase) {
+        return broadPhase.GetAABB(id);
+    });
+}
+
+inline BroadPhase::LeafData BroadPhase::GetLeafData(Size id) const noexcept
+{
+    return Visit([id](const auto& broadPhase) {
+        return broadPhase.GetLeafData(id);
+    });
+}
+
+inline void BroadPhase::SetLeafData(Size id, LeafData value) noexcept
+{
+    Visit([&](auto& broadPhase) {
+        broadPhase.SetLeafData(id, value);
+    });
+}
+
+inline void BroadPhase::ShiftOrigin(Length2 newOrigin)
+{
+    Visit([&](auto& broadPhase) {
+        broadPhase.ShiftOrigin(newOrigin);
+    });
+}
+
+} // namespace d2
+} // namespace playrho
+
+#endif // PLAYRHO_DYNAMICS_BROADPHASE_HPP
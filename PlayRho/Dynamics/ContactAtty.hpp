@@ -97,6 +97,45 @@ private:
     {
         c.Update(conf, listener);
     }
+
+    /// @brief Calls the given contact's <code>Contact::Update</code> method with the given
+    ///   newly calculated manifold.
+    static void Update(Contact& c, const Manifold& manifold, const Contact::UpdateConf& conf,
+                       ContactListener* listener)
+    {
+        c.Update(manifold, conf, listener);
+    }
+
+    /// @brief Calls the given contact's <code>Contact::UpdateSensor</code> method.
+    static void UpdateSensor(Contact& c, bool overlapping, ContactListener* listener)
+    {
+        c.UpdateSensor(overlapping, listener);
+    }
+
+    /// @brief Calls the given contact's <code>Contact::SetSeparation</code> method.
+    static void SetSeparation(Contact& c, Length separation,
+                              const Contact::UpdateConf& conf) noexcept
+    {
+        c.SetSeparation(separation, conf);
+    }
+
+    /// @brief Calls the given contact's <code>Contact::SetSimplexCache</code> method.
+    static void SetSimplexCache(Contact& c, const Simplex::Cache& value) noexcept
+    {
+        c.SetSimplexCache(value);
+    }
+
+    /// @brief Calls the given contact's <code>Contact::SetSeparatingAxis</code> method.
+    static void SetSeparatingAxis(Contact& c, SeparatingAxis value) noexcept
+    {
+        c.SetSeparatingAxis(value);
+    }
+
+    /// @brief Calls the given contact's <code>Contact::UnflagForUpdating</code> method.
+    static void UnflagForUpdating(Contact& c) noexcept
+    {
+        c.UnflagForUpdating();
+    }
     
     /// @brief Whether the given contact is in the is-in-island state.
     static bool IsIslanded(const Contact& c) noexcept
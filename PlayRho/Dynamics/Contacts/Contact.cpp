@@ -50,53 +50,51 @@ inline DistanceConf GetDistanceConf(const playrho::StepConf& conf)
     distanceConf.maxIterations = conf.maxDistanceIters;
     return distanceConf;
 }
+
 } // namespace
 
 Contact::UpdateConf Contact::GetUpdateConf(const playrho::StepConf& conf) noexcept
 {
-    return UpdateConf{GetDistanceConf(conf), GetManifoldConf(conf)};
+    return UpdateConf{GetDistanceConf(conf), GetManifoldConf(conf), conf.doSepAxisCaching};
 }
 
 Contact::Contact(Fixture* fA, ChildCounter iA, Fixture* fB, ChildCounter iB):
     m_fixtureA{fA}, m_fixtureB{fB},
     m_indexA{iA}, m_indexB{iB},
     m_friction{MixFriction(fA->GetFriction(), fB->GetFriction())},
-    m_restitution{MixRestitution(fA->GetRestitution(), fB->GetRestitution())}
+    m_restitution{MixRestitution(fA->GetRestitution(), fB->GetRestitution())},
+    m_shapeKindA{GetShapeKind(fA->GetShape())},
+    m_shapeKindB{GetShapeKind(fB->GetShape())}
 {
     assert(fA != fB);
     assert(fA->GetBody() != fB->GetBody());
 }
 
+// NOTE: Ideally, the touching state returned by the TestOverlap function
+//   agrees 100% of the time with that returned from the CollideShapes function.
+//   This is not always the case however especially as the separation or overlap
+//   approaches zero.
+#define OVERLAP_TOLERANCE (SquareMeter / Real(20))
+
 void Contact::Update(const UpdateConf& conf, ContactListener* listener)
 {
-    const auto oldManifold = m_manifold;
-
     // Note: do not assume the fixture AABBs are overlapping or are valid.
-    const auto oldTouching = (m_flags & e_touchingFlag) != 0;
-    auto newTouching = false;
-
     const auto fixtureA = GetFixtureA();
     const auto indexA = GetChildIndexA();
     const auto fixtureB = GetFixtureB();
     const auto indexB = GetChildIndexB();
-    const auto shapeA = fixtureA->GetShape();
+    const auto& shapeA = fixtureA->GetShape();
     const auto xfA = fixtureA->GetBody()->GetTransformation();
-    const auto shapeB = fixtureB->GetShape();
+    const auto& shapeB = fixtureB->GetShape();
     const auto xfB = fixtureB->GetBody()->GetTransformation();
-    const auto childA = GetChild(shapeA, indexA);
-    const auto childB = GetChild(shapeB, indexB);
-
-    // NOTE: Ideally, the touching state returned by the TestOverlap function
-    //   agrees 100% of the time with that returned from the CollideShapes function.
-    //   This is not always the case however especially as the separation or overlap
-    //   approaches zero.
-#define OVERLAP_TOLERANCE (SquareMeter / Real(20))
 
     const auto sensor = fixtureA->IsSensor() || fixtureB->IsSensor();
     if (sensor)
     {
-        const auto overlapping = TestOverlap(childA, xfA, childB, xfB, conf.distance);
-        newTouching = (overlapping >= 0_m2);
+        const auto childA = GetChild(shapeA, indexA);
+        const auto childB = GetChild(shapeB, indexB);
+        const auto overlapping = TestOverlap(childA, xfA, childB, xfB, m_simplexCache, conf.distance);
+        const auto newTouching = (overlapping >= 0_m2);
 
 #ifdef OVERLAP_TOLERANCE
 #ifndef NDEBUG
@@ -107,92 +105,140 @@ void Contact::Update(const UpdateConf& conf, ContactListener* listener)
 #endif
 #endif
         
-        // Sensors don't generate manifolds.
-        m_manifold = Manifold{};
+        UpdateSensor(newTouching, listener);
+        SetSeparation(GetSeparation(overlapping, childA.GetVertexRadius() + childB.GetVertexRadius()),
+                      conf);
     }
     else
     {
-        auto newManifold = CollideShapes(childA, xfA, childB, xfB, conf.manifold);
+        const auto manifold = (conf.doSepAxisCaching && HasSeparatingAxis(m_shapeKindA, m_shapeKindB))?
+            CollideShapes(GetChild(shapeA, indexA), xfA, GetChild(shapeB, indexB), xfB, m_sepAxis,
+                          conf.manifold):
+            GetCollideShapesFunction(m_shapeKindA, m_shapeKindB)(shapeA, indexA, xfA,
+                                                                 shapeB, indexB, xfB, conf.manifold);
+        Update(manifold, conf, listener);
+        SetSeparation((manifold.GetPointCount() > 0)? 0_m:
+                      CalcSeparation(*this, m_simplexCache, conf.distance), conf);
+    }
+}
+
+void Contact::Update(Manifold newManifold, const UpdateConf& conf, ContactListener* listener)
+{
+    assert(!HasSensor(*this));
 
-        const auto old_point_count = oldManifold.GetPointCount();
-        const auto new_point_count = newManifold.GetPointCount();
+    const auto oldManifold = m_manifold;
+    const auto old_point_count = oldManifold.GetPointCount();
+    const auto new_point_count = newManifold.GetPointCount();
 
-        newTouching = new_point_count > 0;
+    const auto newTouching = new_point_count > 0;
 
 #ifdef OVERLAP_TOLERANCE
 #ifndef NDEBUG
-        const auto tolerance = OVERLAP_TOLERANCE;
-        const auto overlapping = TestOverlap(childA, xfA, childB, xfB, conf.distance);
-        assert(newTouching == (overlapping >= 0_m2) ||
-               abs(overlapping) < tolerance);
+    const auto tolerance = OVERLAP_TOLERANCE;
+    const auto overlapping = TestOverlap(GetChild(GetFixtureA()->GetShape(), GetChildIndexA()),
+                                         GetFixtureA()->GetBody()->GetTransformation(),
+                                         GetChild(GetFixtureB()->GetShape(), GetChildIndexB()),
+                                         GetFixtureB()->GetBody()->GetTransformation(),
+                                         conf.distance);
+    assert(newTouching == (overlapping >= 0_m2) ||
+           abs(overlapping) < tolerance);
+#else
+    (void)conf;
 #endif
 #endif
-        // Match old contact ids to new contact ids and copy the stored impulses to warm
-        // start the solver. Note: missing any opportunities to warm start the solver
-        // results in squishier stacking and less stable simulations.
-        bool found[2] = {false, new_point_count < 2};
-        for (auto i = decltype(new_point_count){0}; i < new_point_count; ++i)
+    // Match old contact ids to new contact ids and copy the stored impulses to warm
+    // start the solver. Note: missing any opportunities to warm start the solver
+    // results in squishier stacking and less stable simulations.
+    bool found[2] = {false, new_point_count < 2};
+    for (auto i = decltype(new_point_count){0}; i < new_point_count; ++i)
+    {
+        const auto new_cf = newManifold.GetContactFeature(i);
+        for (auto j = decltype(old_point_count){0}; j < old_point_count; ++j)
         {
-            const auto new_cf = newManifold.GetContactFeature(i);
-            for (auto j = decltype(old_point_count){0}; j < old_point_count; ++j)
+            if (new_cf == oldManifold.GetContactFeature(j))
             {
-                if (new_cf == oldManifold.GetContactFeature(j))
-                {
-                    found[i] = true;
-                    newManifold.SetContactImpulses(i, oldManifold.GetContactImpulses(j));
-                    break;
-                }
+                found[i] = true;
+                newManifold.SetContactImpulses(i, oldManifold.GetContactImpulses(j));
+                break;
             }
         }
-        // If warm starting data wasn't found for a manifold point via contact feature
-        // matching, it's better to just set the data to whatever old point is closest
-        // to the new one.
-        for (auto i = decltype(new_point_count){0}; i < new_point_count; ++i)
+    }
+    // If warm starting data wasn't found for a manifold point via contact feature
+    // matching, it's better to just set the data to whatever old point is closest
+    // to the new one.
+    for (auto i = decltype(new_point_count){0}; i < new_point_count; ++i)
+    {
+        if (!found[i])
         {
-            if (!found[i])
+            auto leastSquareDiff = std::numeric_limits<Area>::infinity();
+            const auto newPt = newManifold.GetPoint(i);
+            for (auto j = decltype(old_point_count){0}; j < old_point_count; ++j)
             {
-                auto leastSquareDiff = std::numeric_limits<Area>::infinity();
-                const auto newPt = newManifold.GetPoint(i);
-                for (auto j = decltype(old_point_count){0}; j < old_point_count; ++j)
+                const auto oldPt = oldManifold.GetPoint(j);
+                const auto squareDiff = GetMagnitudeSquared(oldPt.localPoint - newPt.localPoint);
+                if (leastSquareDiff > squareDiff)
                 {
-                    const auto oldPt = oldManifold.GetPoint(j);
-                    const auto squareDiff = GetMagnitudeSquared(oldPt.localPoint - newPt.localPoint);
-                    if (leastSquareDiff > squareDiff)
-                    {
-                        leastSquareDiff = squareDiff;
-                        newManifold.SetContactImpulses(i, oldManifold.GetContactImpulses(j));
-                    }
+                    leastSquareDiff = squareDiff;
+                    newManifold.SetContactImpulses(i, oldManifold.GetContactImpulses(j));
                 }
             }
         }
+    }
 
-        // Ideally this method is **NEVER** called unless a dependency changed such
-        // that the following assertion is **ALWAYS** valid.
-        //assert(newManifold != oldManifold);
+    // Ideally this method is **NEVER** called unless a dependency changed such
+    // that the following assertion is **ALWAYS** valid.
+    //assert(newManifold != oldManifold);
 
-        m_manifold = newManifold;
+    m_manifold = newManifold;
 
 #ifdef MAKE_CONTACT_PROCESSING_ORDER_DEPENDENT
-        const auto bodyA = fixtureA->GetBody();
-        const auto bodyB = fixtureB->GetBody();
-
-        assert(bodyA);
-        assert(bodyB);
-
-        /*
-         * The following code creates an ordering dependency in terms of update processing
-         * over a container of contacts. It also puts this method into the situation of
-         * modifying bodies which adds race potential in a multi-threaded mode of operation.
-         * Lastly, without this code, the step-statistics show a world getting to sleep in
-         * less TOI position iterations.
-         */
-        if (newTouching != oldTouching)
-        {
-            bodyA->SetAwake();
-            bodyB->SetAwake();
-        }
+    const auto bodyA = GetFixtureA()->GetBody();
+    const auto bodyB = GetFixtureB()->GetBody();
+
+    assert(bodyA);
+    assert(bodyB);
+
+    /*
+     * The following code creates an ordering dependency in terms of update processing
+     * over a container of contacts. It also puts this method into the situation of
+     * modifying bodies which adds race potential in a multi-threaded mode of operation.
+     * Lastly, without this code, the step-statistics show a world getting to sleep in
+     * less TOI position iterations.
+     */
+    if (newTouching != IsTouching())
+    {
+        bodyA->SetAwake();
+        bodyB->SetAwake();
+    }
 #endif
+
+    UpdateTouching(newTouching, listener);
+
+    if (newTouching && listener)
+    {
+        listener->PreSolve(*this, oldManifold);
     }
+}
+
+void Contact::UpdateSensor(bool overlapping, ContactListener* listener)
+{
+    assert(HasSensor(*this));
+
+    // Sensors don't generate manifolds.
+    m_manifold = Manifold{};
+    UpdateTouching(overlapping, listener);
+}
+
+void Contact::FlagForUpdating(const Body& body, Length linear, Real chord) noexcept
+{
+    const auto fixture = (m_fixtureA->GetBody() == &body)? m_fixtureA: m_fixtureB;
+    m_separationBound -= linear + chord * Length{fixture->GetExtent()};
+    m_flags |= e_dirtyFlag;
+}
+
+void Contact::UpdateTouching(bool newTouching, ContactListener* listener)
+{
+    const auto oldTouching = (m_flags & e_touchingFlag) != 0;
 
     UnflagForUpdating();
 
@@ -212,14 +258,6 @@ void Contact::Update(const UpdateConf& conf, ContactListener* listener)
             listener->EndContact(*this);
         }
     }
-
-    if (!sensor && newTouching)
-    {
-        if (listener)
-        {
-            listener->PreSolve(*this, oldManifold);
-        }
-    }
 }
 
 // Free functions...
@@ -282,6 +320,12 @@ void ResetRestitution(Contact& contact) noexcept
 }
 
 TOIOutput CalcToi(const Contact& contact, ToiConf conf)
+{
+    auto cache = contact.GetSimplexCache();
+    return CalcToi(contact, conf, cache);
+}
+
+TOIOutput CalcToi(const Contact& contact, ToiConf conf, Simplex::Cache& cache)
 {
     const auto fA = contact.GetFixtureA();
     const auto fB = contact.GetFixtureB();
@@ -298,7 +342,24 @@ TOIOutput CalcToi(const Contact& contact, ToiConf conf)
     // Compute the TOI for this contact (one or both bodies are active and impenetrable).
     // Computes the time of impact in interval [0, 1]
     // Large rotations can make the root finder of TimeOfImpact fail, so normalize the sweep angles.
-    return GetToiViaSat(proxyA, sweepA, proxyB, sweepB, conf);
+    return GetToiViaSat(proxyA, sweepA, proxyB, sweepB, cache, conf);
+}
+
+Length CalcSeparation(const Contact& contact, DistanceConf conf)
+{
+    auto cache = contact.GetSimplexCache();
+    return CalcSeparation(contact, cache, conf);
+}
+
+Length CalcSeparation(const Contact& contact, Simplex::Cache& cache, DistanceConf conf)
+{
+    const auto fA = contact.GetFixtureA();
+    const auto fB = contact.GetFixtureB();
+    const auto proxyA = GetChild(fA->GetShape(), contact.GetChildIndexA());
+    const auto proxyB = GetChild(fB->GetShape(), contact.GetChildIndexB());
+    const auto overlap = TestOverlap(proxyA, fA->GetBody()->GetTransformation(),
+                                     proxyB, fB->GetBody()->GetTransformation(), cache, conf);
+    return GetSeparation(overlap, proxyA.GetVertexRadius() + proxyB.GetVertexRadius());
 }
 
 } // namespace d2
@@ -90,6 +90,7 @@ public:
     {
         DistanceConf distance; ///< Distance configuration data.
         Manifold::Conf manifold; ///< Manifold configuration data.
+        bool doSepAxisCaching = true; ///< Whether to do separating axis caching.
     };
     
     /// @brief Gets the update configuration from the given step configuration data.
@@ -157,6 +158,12 @@ public:
     /// @brief Get the child primitive index for fixture B.
     ChildCounter GetChildIndexB() const noexcept;
 
+    /// @brief Gets the kind of the shape of fixture A.
+    ShapeKind GetShapeKindA() const noexcept;
+
+    /// @brief Gets the kind of the shape of fixture B.
+    ShapeKind GetShapeKindB() const noexcept;
+
     /// @brief Sets the friction value for this contact.
     /// @details Override the default friction mixture.
     /// @note You can call this in <code>ContactListener::PreSolve</code>.
@@ -201,17 +208,54 @@ public:
     Real GetToi() const;
 
     /// @brief Flags the contact for filtering.
+    /// @note The world only does the filtering of a flagged contact when it checks the
+    ///   contacts of a fixture proxy of the contact. It does this for the proxies that moved
+    ///   or were touched. Use <code>Fixture::Refilter</code> to be sure the filtering gets done.
     void FlagForFiltering() noexcept;
 
     /// @brief Whether or not the contact needs filtering.
     bool NeedsFiltering() const noexcept;
 
     /// @brief Flags the contact for updating.
+    /// @note This also resets the separation bound, so the contact gets updated.
+    /// @sa GetSeparationBound.
     void FlagForUpdating() noexcept;
 
+    /// @brief Flags the contact for updating after the given body moved.
+    /// @details Reduces the separation bound by how far any point of the shape of the
+    ///   given body's fixture could have moved from the given motion of the body.
+    /// @param body Body of fixture A or B of this contact.
+    /// @param linear Distance the origin of the body moved.
+    /// @param chord Distance the body's rotation moved a point that's a unit distance away
+    ///   from the origin of the body.
+    /// @sa GetSeparationBound.
+    void FlagForUpdating(const Body& body, Length linear, Real chord) noexcept;
+
     /// @brief Whether or not the contact needs updating.
     bool NeedsUpdating() const noexcept;
 
+    /// @brief Gets the separation bound.
+    /// @details This is a lower bound of the distance between the shapes of this contact
+    ///   beyond their total vertex radius. It's set from the separation found whenever this
+    ///   contact is updated and reduced by every motion of the bodies since.
+    /// @note The shapes can't be touching while this is greater than zero, so the world
+    ///   skips updating such contacts.
+    Length GetSeparationBound() const noexcept;
+
+    /// @brief Gets the simplex cache.
+    /// @details This is the cache of the simplex of the last distance calculation between
+    ///   the child shapes of this contact. The distance calculations for this contact start
+    ///   from it, so they usually take just one or two iterations.
+    /// @sa CalcToi, CalcSeparation.
+    const Simplex::Cache& GetSimplexCache() const noexcept;
+
+    /// @brief Gets the separating axis.
+    /// @details This is the axis that last separated the child shapes of this contact or
+    ///   that was last the reference face of its manifold. Updates of this contact test it
+    ///   first when separating axis caching is enabled.
+    /// @sa StepConf::doSepAxisCaching, HasSeparatingAxis.
+    SeparatingAxis GetSeparatingAxis() const noexcept;
+
 private:
 
     friend class ContactAtty;
@@ -248,6 +292,22 @@ private:
     /// @brief Unflags this contact for updating.
     void UnflagForUpdating() noexcept;
 
+    /// @brief Sets the separation bound from the given separation of the shapes.
+    /// @details Leaves a margin of the linear slop for the error of calculating the separation.
+    /// @param separation Separation of the shapes beyond their total vertex radius as
+    ///   calculated for the current transformations of the bodies.
+    /// @param conf Per-step configuration information.
+    /// @sa GetSeparationBound.
+    void SetSeparation(Length separation, const UpdateConf& conf) noexcept;
+
+    /// @brief Sets the simplex cache to the given value.
+    /// @sa GetSimplexCache.
+    void SetSimplexCache(const Simplex::Cache& value) noexcept;
+
+    /// @brief Sets the separating axis to the given value.
+    /// @sa GetSeparatingAxis.
+    void SetSeparatingAxis(SeparatingAxis value) noexcept;
+
     /// @brief Updates the touching related state and notifies listener (if one given).
     ///
     /// @note Ideally this method is only called when a dependent change has occurred.
@@ -264,6 +324,29 @@ private:
     ///
     void Update(const UpdateConf& conf, ContactListener* listener = nullptr);
 
+    /// @brief Updates the touching related state from the given newly calculated manifold
+    ///   and notifies listener (if one given).
+    /// @details This is the part of updating a contact that follows calculating its manifold.
+    ///   It allows the manifolds of many contacts to be calculated together beforehand.
+    /// @warning Behavior is undefined if this contact has a sensor.
+    /// @param manifold Manifold calculated for the current transformations of the bodies.
+    /// @param conf Per-step configuration information.
+    /// @param listener Listener that if non-null is called with status information.
+    /// @sa Update(const UpdateConf&, ContactListener*).
+    void Update(Manifold manifold, const UpdateConf& conf, ContactListener* listener = nullptr);
+
+    /// @brief Updates the touching related state of this contact having a sensor from the
+    ///   given overlap state and notifies listener (if one given).
+    /// @details This is the part of updating a contact having a sensor that follows testing
+    ///   its shapes for overlap.
+    /// @warning Behavior is undefined if this contact doesn't have a sensor.
+    /// @sa Update(const UpdateConf&, ContactListener*).
+    void UpdateSensor(bool overlapping, ContactListener* listener = nullptr);
+
+    /// @brief Updates the touching flag state to the given value and notifies the listener
+    ///   (if one given) of any change.
+    void UpdateTouching(bool touching, ContactListener* listener);
+
     /// @brief Sets the time of impact (TOI).
     /// @details After returning, this object will have a TOI that is set as indicated by <code>HasValidToi()</code>.
     /// @note Behavior is undefined if the value assigned is less than 0 or greater than 1.
@@ -329,9 +412,21 @@ private:
     /// @note Only valid if <code>m_flags & e_toiFlag</code>.
     Real m_toi;
     
+    /// Separation bound. @sa GetSeparationBound.
+    Length m_separationBound = 0_m;
+
+    /// Simplex cache. 12-bytes. @sa GetSimplexCache.
+    Simplex::Cache m_simplexCache;
+
     substep_type m_toiCount = 0; ///< Count of TOI calculations contact has gone through since last reset.
     
     FlagsType m_flags = e_enabledFlag|e_dirtyFlag; ///< Flags.
+
+    // initialized on construction (construction-time depedent)
+    ShapeKind const m_shapeKindA; ///< Kind of the shape of fixture A. @sa CollideShapes.
+    ShapeKind const m_shapeKindB; ///< Kind of the shape of fixture B. @sa CollideShapes.
+
+    SeparatingAxis m_sepAxis; ///< Separating axis. 2-bytes. @sa GetSeparatingAxis.
 };
 
 /// @example Contact.cpp
@@ -422,6 +517,7 @@ inline bool Contact::NeedsFiltering() const noexcept
 inline void Contact::FlagForUpdating() noexcept
 {
     m_flags |= e_dirtyFlag;
+    m_separationBound = 0_m;
 }
 
 inline void Contact::UnflagForUpdating() noexcept
@@ -434,6 +530,36 @@ inline bool Contact::NeedsUpdating() const noexcept
     return (m_flags & Contact::e_dirtyFlag) != 0;
 }
 
+inline Length Contact::GetSeparationBound() const noexcept
+{
+    return m_separationBound;
+}
+
+inline void Contact::SetSeparation(Length separation, const UpdateConf& conf) noexcept
+{
+    m_separationBound = separation - conf.manifold.linearSlop;
+}
+
+inline const Simplex::Cache& Contact::GetSimplexCache() const noexcept
+{
+    return m_simplexCache;
+}
+
+inline void Contact::SetSimplexCache(const Simplex::Cache& value) noexcept
+{
+    m_simplexCache = value;
+}
+
+inline SeparatingAxis Contact::GetSeparatingAxis() const noexcept
+{
+    return m_sepAxis;
+}
+
+inline void Contact::SetSeparatingAxis(SeparatingAxis value) noexcept
+{
+    m_sepAxis = value;
+}
+
 inline void Contact::SetFriction(Real friction) noexcept
 {
     assert(friction >= 0);
@@ -523,6 +649,16 @@ inline ChildCounter Contact::GetChildIndexB() const noexcept
     return m_indexB;
 }
 
+inline ShapeKind Contact::GetShapeKindA() const noexcept
+{
+    return m_shapeKindA;
+}
+
+inline ShapeKind Contact::GetShapeKindB() const noexcept
+{
+    return m_shapeKindB;
+}
+
 // Free functions...
 
 /// @brief Contact pointer type.
@@ -589,9 +725,38 @@ void ResetFriction(Contact& contact);
 void ResetRestitution(Contact& contact) noexcept;
 
 /// @brief Calculates the Time Of Impact for the given contact with the given configuration.
+/// @note This warm starts from the contact's simplex cache.
 /// @relatedalso Contact
 TOIOutput CalcToi(const Contact& contact, ToiConf conf);
 
+/// @brief Calculates the Time Of Impact for the given contact warm starting from the
+///   given simplex cache.
+/// @param contact Contact to calculate the time of impact for.
+/// @param conf Time of impact configuration.
+/// @param cache Simplex cache to start from that gets set to the cache of the last
+///   distance calculation.
+/// @relatedalso Contact
+TOIOutput CalcToi(const Contact& contact, ToiConf conf, Simplex::Cache& cache);
+
+/// @brief Calculates the separation of the shapes of the given contact.
+/// @note This warm starts from the contact's simplex cache.
+/// @return Distance between the child shapes of the contact beyond their total vertex
+///   radius for the current transformations of the bodies. This is negative if the
+///   shapes overlap.
+/// @sa GetSeparation.
+/// @relatedalso Contact
+Length CalcSeparation(const Contact& contact, DistanceConf conf = DistanceConf{});
+
+/// @brief Calculates the separation of the shapes of the given contact warm starting from
+///   the given simplex cache.
+/// @param contact Contact to calculate the separation of the shapes of.
+/// @param cache Simplex cache to start from that gets set to the cache of the distance
+///   calculation.
+/// @param conf Distance configuration.
+/// @relatedalso Contact
+Length CalcSeparation(const Contact& contact, Simplex::Cache& cache,
+                      DistanceConf conf = DistanceConf{});
+
 } // namespace d2
 } // namespace playrho
 
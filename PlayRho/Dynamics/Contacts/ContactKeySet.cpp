@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include <PlayRho/Dynamics/Contacts/ContactKeySet.hpp>
+
+namespace playrho {
+
+namespace {
+
+/// @brief Unused bucket key value.
+PLAYRHO_CONSTEXPR const auto UnusedKey = ContactKey{};
+
+/// @brief Maximum load factor expressed as the ratio of buckets to keys.
+PLAYRHO_CONSTEXPR const auto MinBucketsPerKey = std::size_t{2};
+
+} // anonymous namespace
+
+ContactKeySet::size_type ContactKeySet::GetHomeIndex(ContactKey key) const noexcept
+{
+    // Uses Fibonacci hashing of the combined key indices and takes its upper bits.
+    // The lower bits of the product are too dependent on the lower bits of the key
+    // indices and the indices are often sequential.
+    const auto value = (std::uint64_t{key.GetMin()} << 32u) ^ std::uint64_t{key.GetMax()};
+    const auto hash = value * std::uint64_t{0x9E3779B97F4A7C15u};
+    return static_cast<size_type>(hash >> 32u) & (m_buckets.size() - 1u);
+}
+
+ContactKeySet::size_type ContactKeySet::Find(ContactKey key) const noexcept
+{
+    const auto mask = m_buckets.size() - 1u;
+    auto index = GetHomeIndex(key);
+    while ((m_buckets[index] != key) && (m_buckets[index] != UnusedKey))
+    {
+        index = (index + 1u) & mask;
+    }
+    return index;
+}
+
+void ContactKeySet::Rehash(size_type count)
+{
+    auto buckets = std::vector<ContactKey>(count, UnusedKey);
+    swap(buckets, m_buckets);
+    for (const auto& key: buckets)
+    {
+        if (key != UnusedKey)
+        {
+            m_buckets[Find(key)] = key;
+        }
+    }
+}
+
+bool ContactKeySet::insert(ContactKey key)
+{
+    assert(key != UnusedKey);
+    if (((m_count + 1u) * MinBucketsPerKey) > m_buckets.size())
+    {
+        Rehash(m_buckets.empty()? GetInitialBucketCount(): m_buckets.size() * 2u);
+    }
+    const auto index = Find(key);
+    if (m_buckets[index] == key)
+    {
+        return false;
+    }
+    m_buckets[index] = key;
+    ++m_count;
+    return true;
+}
+
+bool ContactKeySet::erase(ContactKey key) noexcept
+{
+    if (m_count == 0)
+    {
+        return false;
+    }
+    auto index = Find(key);
+    if (m_buckets[index] != key)
+    {
+        return false;
+    }
+
+    // Shifts back any following keys that could be found in the bucket being emptied,
+    // so probe sequences for them don't get broken up by the emptied bucket.
+    const auto mask = m_buckets.size() - 1u;
+    auto next = index;
+    for (;;)
+    {
+        next = (next + 1u) & mask;
+        const auto nextKey = m_buckets[next];
+        if (nextKey == UnusedKey)
+        {
+            break;
+        }
+        const auto home = GetHomeIndex(nextKey);
+        const auto stays = (index <= next)?
+            ((index < home) && (home <= next)): ((index < home) || (home <= next));
+        if (!stays)
+        {
+            m_buckets[index] = nextKey;
+            index = next;
+        }
+    }
+    m_buckets[index] = UnusedKey;
+    --m_count;
+    return true;
+}
+
+bool ContactKeySet::contains(ContactKey key) const noexcept
+{
+    return (m_count != 0) && (m_buckets[Find(key)] == key);
+}
+
+void ContactKeySet::reserve(size_type count)
+{
+    auto buckets = m_buckets.empty()? GetInitialBucketCount(): m_buckets.size();
+    while (buckets < (count * MinBucketsPerKey))
+    {
+        buckets *= 2u;
+    }
+    if (buckets != m_buckets.size())
+    {
+        Rehash(buckets);
+    }
+}
+
+void ContactKeySet::clear() noexcept
+{
+    std::fill(begin(m_buckets), end(m_buckets), UnusedKey);
+    m_count = 0;
+}
+
+} // namespace playrho
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef PLAYRHO_DYNAMICS_CONTACTS_CONTACTKEYSET_HPP
+#define PLAYRHO_DYNAMICS_CONTACTS_CONTACTKEYSET_HPP
+
+/// @file
+/// Declaration of the <code>ContactKeySet</code> class.
+
+#include <PlayRho/Dynamics/Contacts/ContactKey.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace playrho {
+
+/// @brief Set of contact keys.
+/// @details An open-addressing (linear probing) hash set of <code>ContactKey</code>
+///   values providing constant time insertion, look up, and erasure on average.
+/// @note Erasure uses backward shifting rather than "tombstones" so look ups never
+///   degrade as keys are inserted and erased over time.
+/// @note The default constructed <code>ContactKey</code> value is reserved for
+///   marking unused slots and cannot be inserted.
+class ContactKeySet
+{
+public:
+    /// @brief Size type.
+    using size_type = std::size_t;
+
+    /// @brief Gets the bucket count that an empty set grows to when first inserted into.
+    static PLAYRHO_CONSTEXPR inline size_type GetInitialBucketCount() noexcept
+    {
+        return size_type{64};
+    }
+
+    ContactKeySet() = default;
+
+    /// @brief Inserts the given key.
+    /// @pre The given key is not the default constructed <code>ContactKey</code> value.
+    /// @return <code>true</code> if the key was inserted, <code>false</code> if the key
+    ///   was already in this set.
+    bool insert(ContactKey key);
+
+    /// @brief Erases the given key.
+    /// @return <code>true</code> if the key was erased, <code>false</code> if the key
+    ///   was not in this set.
+    bool erase(ContactKey key) noexcept;
+
+    /// @brief Whether this set contains the given key.
+    bool contains(ContactKey key) const noexcept;
+
+    /// @brief Reserves enough buckets to hold the given count of keys without rehashing.
+    void reserve(size_type count);
+
+    /// @brief Clears this set of all its keys.
+    /// @note This doesn't free any memory.
+    void clear() noexcept;
+
+    /// @brief Gets the count of keys in this set.
+    size_type size() const noexcept
+    {
+        return m_count;
+    }
+
+    /// @brief Whether this set is empty.
+    bool empty() const noexcept
+    {
+        return m_count == 0;
+    }
+
+    /// @brief Gets the bucket count.
+    /// @note This is always zero or a power of two.
+    size_type bucket_count() const noexcept
+    {
+        return m_buckets.size();
+    }
+
+private:
+    /// @brief Gets the "home" bucket index for the given key.
+    /// @pre The bucket count is not zero.
+    size_type GetHomeIndex(ContactKey key) const noexcept;
+
+    /// @brief Finds the bucket index of the given key or the empty bucket it would go in.
+    /// @pre The bucket count is not zero.
+    size_type Find(ContactKey key) const noexcept;
+
+    /// @brief Rehashes this set's keys into the given count of buckets.
+    /// @pre The given count is a power of two greater than twice the count of keys.
+    void Rehash(size_type count);
+
+    std::vector<ContactKey> m_buckets; ///< Buckets of keys or the unused key value.
+    size_type m_count = 0; ///< Count of keys in this set.
+};
+
+/// @brief Gets the count of keys in the given set.
+/// @relatedalso ContactKeySet
+inline ContactKeySet::size_type size(const ContactKeySet& set) noexcept
+{
+    return set.size();
+}
+
+/// @brief Whether the given set is empty.
+/// @relatedalso ContactKeySet
+inline bool empty(const ContactKeySet& set) noexcept
+{
+    return set.empty();
+}
+
+} // namespace playrho
+
+#endif // PLAYRHO_DYNAMICS_CONTACTS_CONTACTKEYSET_HPP
@@ -82,6 +82,22 @@ bool TestPoint(const Fixture& f, Length2 p) noexcept
     return TestPoint(f.GetShape(), InverseTransform(p, GetTransformation(f)));
 }
 
+bool TestPoint(const Fixture& f, ChildCounter child, Length2 p) noexcept
+{
+    return TestPoint(GetChild(f.GetShape(), child), InverseTransform(p, GetTransformation(f)));
+}
+
+Length GetDistance(const Fixture& f, ChildCounter child, Length2 p)
+{
+    return GetDistance(GetChild(f.GetShape(), child), GetTransformation(f), p);
+}
+
+bool IsOverlapping(const Fixture& f, ChildCounter child,
+                   const DistanceProxy& proxy, const Transformation& xf)
+{
+    return IsOverlapping(GetChild(f.GetShape(), child), GetTransformation(f), proxy, xf);
+}
+
 void SetAwake(const Fixture& f) noexcept
 {
     f.GetBody()->SetAwake();
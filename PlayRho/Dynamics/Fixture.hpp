@@ -67,7 +67,14 @@ public:
     
     /// @brief Gets the child shape.
     /// @details The shape is not modifiable. Use a new fixture instead.
-    Shape GetShape() const noexcept;
+    const Shape& GetShape() const noexcept;
+
+    /// @brief Gets the extent of the shape of this fixture.
+    /// @details This is the greatest distance of a vertex of the shape from the origin of
+    ///   the body. No point of the shape moves further than this times the chord length of
+    ///   a rotation of the body.
+    /// @sa GetExtent(const Shape&).
+    NonNegative<Length> GetExtent() const noexcept;
     
     /// @brief Set if this fixture is a sensor.
     void SetSensor(bool sensor) noexcept;
@@ -86,6 +93,8 @@ public:
     Filter GetFilterData() const noexcept;
 
     /// @brief Re-filter the fixture.
+    /// @details Flags the contacts of this fixture for filtering and touches its proxies so
+    ///   that the world filters those contacts at the next step even if no body moves.
     /// @note Call this if you want to establish collision that was previously disabled by
     ///   <code>ShouldCollide(const Fixture&, const Fixture&)</code>.
     /// @sa bool ShouldCollide(const Fixture& fixtureA, const Fixture& fixtureB) noexcept
@@ -148,7 +157,8 @@ private:
         m_userData{def.userData},
         m_shape{shape},
         m_filter{def.filter},
-        m_isSensor{def.isSensor}
+        m_isSensor{def.isSensor},
+        m_extent{d2::GetExtent(shape)}
     {
         // Intentionally empty.
     }
@@ -197,13 +207,20 @@ private:
     Filter m_filter; ///< Filter object. 6-bytes.
     
     bool m_isSensor = false; ///< Is/is-not sensor. 1-bytes.
+
+    NonNegative<Length> m_extent; ///< Extent of the shape. Set on construction. 4-bytes.
 };
 
-inline Shape Fixture::GetShape() const noexcept
+inline const Shape& Fixture::GetShape() const noexcept
 {
     return m_shape;
 }
 
+inline NonNegative<Length> Fixture::GetExtent() const noexcept
+{
+    return m_extent;
+}
+
 inline bool Fixture::IsSensor() const noexcept
 {
     return m_isSensor;
@@ -299,6 +316,34 @@ inline AreaDensity Fixture::GetDensity() const noexcept
 /// @ingroup TestPointGroup
 bool TestPoint(const Fixture& f, Length2 p) noexcept;
 
+/// @brief Tests a point for containment in the identified child of a fixture.
+/// @param f Fixture to use for test.
+/// @param child Child index of the fixture's shape to test the point with.
+/// @param p Point in world coordinates.
+/// @relatedalso Fixture
+/// @ingroup TestPointGroup
+bool TestPoint(const Fixture& f, ChildCounter child, Length2 p) noexcept;
+
+/// @brief Gets the distance from a point to the identified child of a fixture.
+/// @param f Fixture to get the distance to.
+/// @param child Child index of the fixture's shape to get the distance to.
+/// @param p Point in world coordinates.
+/// @return Zero if the point is within the child, else the distance to it.
+/// @relatedalso Fixture
+Length GetDistance(const Fixture& f, ChildCounter child, Length2 p);
+
+/// @brief Determines whether the identified child of a fixture touches or overlaps the
+///   given shape child.
+/// @param f Fixture to test.
+/// @param child Child index of the fixture's shape to test.
+/// @param proxy Distance proxy of the shape child to test the fixture child with.
+/// @param xf Transformation of the shape child in world coordinates.
+/// @sa IsOverlapping(const DistanceProxy&, const Transformation&, const DistanceProxy&,
+///   const Transformation&).
+/// @relatedalso Fixture
+bool IsOverlapping(const Fixture& f, ChildCounter child,
+                   const DistanceProxy& proxy, const Transformation& xf);
+
 /// @brief Sets the associated body's sleep status to awake.
 /// @note This is a convenience function that simply looks up the fixture's body and
 ///   calls that body' <code>SetAwake</code> method.
@@ -36,7 +36,7 @@ namespace playrho {
 /// the values have defaults. These defaults are intended to most likely be the values desired.
 /// @note Be sure to confirm that the delta time (the time-per-step i.e. <code>dt</code>) is
 ///   correct for your use.
-/// @note This data structure is 108-bytes large (with 4-byte Real on at least one 64-bit platform).
+/// @note This data structure is 116-bytes large (with 4-byte Real on at least one 64-bit platform).
 /// @sa World::Step.
 class StepConf
 {
@@ -49,6 +49,10 @@ public:
     /// @brief Invalid iteration value.
     static PLAYRHO_CONSTEXPR const auto InvalidIteration = static_cast<iteration_type>(-1);
 
+    /// @brief Thread count type.
+    /// @details A type for counting the threads that step processing may use.
+    using thread_count_type = std::uint8_t;
+
     /// @brief Gets the delta time (time amount for this time step).
     /// @sa SetTime(Real).
     /// @return Time step amount in seconds.
@@ -240,6 +244,19 @@ public:
     /// @note Should be greater than 0.
     Length aabbExtension = DefaultAabbExtension;
 
+    /// @brief AABB prediction steps.
+    /// @details When greater than 0, this is how many steps worth of a body's expected
+    ///   displacement its proxies' AABBs get fattened by instead of by the
+    ///   <code>aabbExtension</code> amount. A body's expected displacement is the greater
+    ///   of the distance its velocity takes it in one step and the decaying peak of the
+    ///   distances it recently moved per step. Fast bodies thereby get fattened enough to
+    ///   avoid updating their proxies every step while slow bodies get fattened little
+    ///   enough to avoid finding contacts they won't reach.
+    /// @note The fattening is never less than the <code>linearSlop</code> amount.
+    /// @note Values of 0 (or less) disable this.
+    /// @sa aabbExtension.
+    Real aabbPredictionSteps = 0;
+
     /// @brief Max. circles ratio.
     /// @details When the ratio of the closest face's length to the vertex radius is
     ///   more than this amount, then face-manifolds are forced, else circles-manifolds
@@ -247,6 +264,17 @@ public:
     /// @note This is used in the calculation of new contact manifolds.
     Real maxCirclesRatio = DefaultCirclesRatio;
 
+    /// @brief Max tree degradation.
+    /// @details This is how many times more the perimeter ratio of the world's tree may
+    ///   grow to, from what it was right after the tree was last rebuilt, before the tree
+    ///   gets rebuilt top-down. Trees get rebuilt the first time this is used as well.
+    /// @note Values of 0 (or less) disable rebuilding the tree.
+    /// @note Values of 1 or less rebuild the tree whenever it's found to be degraded at all.
+    /// @note The tree is only checked for degradation once enough of its proxies have changed
+    ///   since it was last checked, so that checking doesn't cost linear time every step.
+    /// @sa maxThreads, ComputePerimeterRatio, DynamicTree::RebuildTopDown.
+    Real maxTreeDegradation = 0;
+
     /// @brief Regular velocity iterations.
     /// @details The number of iterations of velocity resolution that will be done in the step.
     /// @note Used in the regular phase of step processing.
@@ -298,6 +326,14 @@ public:
     /// @note Used in the TOI phase of step processing.
     iteration_type maxSubSteps = DefaultMaxSubSteps;
     
+    /// @brief Maximum threads.
+    /// @details Maximum number of threads that step processing may use for its
+    ///   concurrently processable phases like the finding of new contacts and the
+    ///   calculating of contact manifolds.
+    /// @note Values of 0 or 1 result in that processing being done serially in the
+    ///   calling thread. Results are the same regardless of this setting.
+    thread_count_type maxThreads = 1;
+    
     /// @brief Do warm start.
     /// @details Whether or not to perform warm starting (in the regular phase).
     /// @note Used in the regular phase of step processing.
@@ -315,6 +351,13 @@ public:
     /// @brief Do the block-solve algorithm.
     bool doBlocksolve = true;
 
+    /// @brief Do separating axis caching.
+    /// @details Whether or not contacts between shapes that aren't disks remember the axis
+    ///   that last separated their shapes or that was last the reference face of their
+    ///   manifold and test that axis first whenever they're updated.
+    /// @note Used when updating contacts. Results are the same regardless of this setting.
+    bool doSepAxisCaching = true;
+
 private:
     /// @brief Delta time.
     /// @details This is the time step in seconds.
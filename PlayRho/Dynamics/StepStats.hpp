@@ -26,7 +26,7 @@
 namespace playrho {
     
     /// @brief Pre-phase per-step statistics.
-    /// @note This data structure is 24-bytes large (on at least one 64-bit platform).
+    /// @note This data structure is 28-bytes large (on at least one 64-bit platform).
     struct PreStepStats
     {
         /// @brief Counter type.
@@ -38,10 +38,11 @@ namespace playrho {
         counter_type ignored = 0; ///< Count of contacts ignored during update processing.
         counter_type updated = 0; ///< Count of contacts updated (during update processing).
         counter_type skipped = 0; ///< Count of contacts Skipped (during update processing).
+        counter_type separated = 0; ///< Count of contacts not updated for being too far apart.
     };
     
     /// @brief Regular-phase per-step statistics.
-    /// @note This data structure is 32-bytes large (on at least one 64-bit platform with
+    /// @note This data structure is 36-bytes large (on at least one 64-bit platform with
     ///   4-byte Real type).
     struct RegStepStats
     {
@@ -59,12 +60,13 @@ namespace playrho {
         counter_type contactsAdded = 0; ///< Contacts added count.
         counter_type bodiesSlept = 0; ///< Bodies slept count.
         counter_type proxiesMoved = 0; ///< Proxies moved count.
+        counter_type proxiesKept = 0; ///< Proxies of moved bodies still within their AABBs.
         counter_type sumPosIters = 0; ///< Sum of the position iterations.
         counter_type sumVelIters = 0; ///< Sum of the velocity iterations.
     };
     
     /// @brief TOI-phase per-step statistics.
-    /// @note This data structure is 60-bytes large (on at least one 64-bit platform with
+    /// @note This data structure is 68-bytes large (on at least one 64-bit platform with
     ///   4-byte Real type).
     struct ToiStepStats
     {
@@ -89,6 +91,14 @@ namespace playrho {
         counter_type sumPosIters = 0; ///< Sum position iterations count.
         counter_type sumVelIters = 0; ///< Sum velocity iterations count.
         counter_type maxSimulContacts = 0; ///< Max contacts occurring simultaneously.
+
+        /// @brief Sum of distance iterations.
+        /// @note Divided by <code>sumToiIters</code>, this is the average count of
+        ///   iterations per distance calculation.
+        counter_type sumDistIters = 0;
+
+        /// @brief Sum of TOI iterations. Each calculates the distance between shapes once.
+        counter_type sumToiIters = 0;
         
         /// @brief Distance iteration type.
         using dist_iter_type = std::remove_const<decltype(DefaultMaxDistanceIters)>::type;
@@ -70,15 +70,13 @@
 #include <set>
 #include <vector>
 #include <unordered_map>
+#include <future>
+#include <iterator>
 
-#ifdef DO_PAR_UNSEQ
 #include <atomic>
-#endif
+#include <numeric>
 
 //#define DO_THREADED
-#if defined(DO_THREADED)
-#include <future>
-#endif
 
 #define PLAYRHO_MAGIC(x) (x)
 
@@ -396,7 +394,11 @@ namespace {
         return state == TOIOutput::e_touching;
     }
     
-    void FlagContactsForFiltering(const Body& bodyA, const Body& bodyB) noexcept
+    /// @brief Flags the contacts between the given bodies for filtering.
+    /// @details Adds a proxy of each contact flagged to the given proxies so the contact
+    ///   gets its filtering done the next time the proxies' contacts are checked.
+    void FlagContactsForFiltering(const Body& bodyA, const Body& bodyB,
+                                  std::vector<DynamicTree::Size>& proxies)
     {
         for (auto& ci: bodyB.GetContacts())
         {
@@ -411,14 +413,331 @@ namespace {
                 // Flag the contact for filtering at the next time step (where either
                 // body is awake).
                 contact->FlagForFiltering();
+                proxies.push_back(std::get<ContactKey>(ci).GetMin());
+            }
+        }
+    }
+    
+    /// @brief Minimum number of proxies worth querying in a thread of its own.
+    /// @details Below this, the overhead of launching a thread isn't worth it.
+    PLAYRHO_CONSTEXPR const auto MinProxiesPerThread = std::size_t{32};
+    
+    /// @brief Min ratio of the count of all sweep and prune proxies to the count of the
+    ///   moved ones for which querying for each moved proxy is used to find new pairs.
+    /// @details Below this, sweeping through all of the proxies once is used instead.
+    PLAYRHO_CONSTEXPR const auto MinSweptProxiesRatio = std::size_t{4};
+    
+    /// @brief Sorts the given contact keys and removes any duplicates.
+    inline void SortAndUnique(std::vector<ContactKey>& keys)
+    {
+        sort(begin(keys), end(keys));
+        keys.erase(unique(begin(keys), end(keys)), end(keys));
+    }
+    
+    /// @brief Merges the given sorted sets of contact keys into the first of them.
+    /// @details Merges pairs of sets concurrently in rounds until only one set is left.
+    /// @pre Each of the given sets is sorted and has no duplicates.
+    /// @post The first set is sorted and has no duplicates and the other sets are empty.
+    void MergeUnique(std::vector<std::vector<ContactKey>>& sets)
+    {
+        auto numSets = size(sets);
+        auto futures = std::vector<std::future<void>>{};
+        futures.reserve(numSets / 2);
+        while (numSets > 1)
+        {
+            const auto numPairs = numSets / 2;
+            for (auto i = decltype(numPairs){0}; i < numPairs; ++i)
+            {
+                futures.push_back(std::async(std::launch::async, [&sets,i,numPairs]{
+                    auto& keysA = sets[i];
+                    auto& keysB = sets[i + numPairs];
+                    auto merged = std::vector<ContactKey>{};
+                    merged.reserve(size(keysA) + size(keysB));
+                    std::set_union(cbegin(keysA), cend(keysA), cbegin(keysB), cend(keysB),
+                                   std::back_inserter(merged));
+                    keysA = std::move(merged);
+                    keysB.clear();
+                }));
+            }
+            for (auto& future: futures)
+            {
+                future.get();
+            }
+            futures.clear();
+            
+            // An odd set out is moved down to be merged in the next round.
+            if (numSets % 2)
+            {
+                sets[numPairs] = std::move(sets[numSets - 1]);
+                sets[numSets - 1].clear();
             }
+            numSets = numSets - numPairs;
         }
     }
     
+    /// @brief Decay per step of the recent displacements of bodies.
+    PLAYRHO_CONSTEXPR const auto RecentDisplacementDecay = Real{7} / Real{8};
+
+    /// @brief Gets the count of proxies that the fixtures of the given body have.
+    ContactCounter GetProxyCount(const Body& body) noexcept
+    {
+        auto count = ContactCounter{0};
+        for (const auto& f: body.GetFixtures())
+        {
+            count += GetRef(f).GetProxyCount();
+        }
+        return count;
+    }
+
+    /// @brief Gets the least time factor at which the given AABB overlaps the given target AABB
+    ///   while being moved by the given delta.
+    /// @return Value in the range of [0,1] or infinity if the AABBs don't overlap in that range.
+    Real GetSweptEntryTime(const AABB& aabb, Length2 delta, const AABB& target) noexcept
+    {
+        auto tmin = Real{0};
+        auto tmax = Real{1};
+        for (auto i = decltype(delta.max_size()){0}; i < delta.max_size(); ++i)
+        {
+            // The AABBs overlap on this axis when the delta moved is in the range of [lo, hi].
+            const auto lo = target.ranges[i].GetMin() - aabb.ranges[i].GetMax();
+            const auto hi = target.ranges[i].GetMax() - aabb.ranges[i].GetMin();
+            if (delta[i] == 0_m)
+            {
+                if ((lo > 0_m) || (hi < 0_m))
+                {
+                    return std::numeric_limits<Real>::infinity();
+                }
+                continue;
+            }
+            auto t1 = Real{lo / delta[i]};
+            auto t2 = Real{hi / delta[i]};
+            if (t1 > t2)
+            {
+                std::swap(t1, t2);
+            }
+            tmin = std::max(tmin, t1);
+            tmax = std::min(tmax, t2);
+            if (tmin > tmax)
+            {
+                return std::numeric_limits<Real>::infinity();
+            }
+        }
+        return tmin;
+    }
+
+    /// @brief Count of buckets of contacts.
+    /// @details One bucket per pair of shape kinds plus one for contacts having sensors.
+    PLAYRHO_CONSTEXPR const auto ContactBucketCount = ShapeKindCount * ShapeKindCount + 1;
+
+    /// @brief Bucket of disk-disk contacts not having sensors.
+    PLAYRHO_CONSTEXPR const auto DiskDiskBucket = static_cast<std::size_t>(ShapeKind::Disk) *
+        ShapeKindCount + static_cast<std::size_t>(ShapeKind::Disk);
+
+    /// @brief Bucket of contacts having sensors.
+    PLAYRHO_CONSTEXPR const auto SensorBucket = ContactBucketCount - 1;
+
+    /// @brief Count of contacts that a narrow-phase thread takes on at a time.
+    /// @details Threads keep taking the next chunk of contacts until there are none left so
+    ///   the work balances itself across threads however costly the contacts are.
+    PLAYRHO_CONSTEXPR const auto ContactsPerChunk = std::size_t{128};
+
+    /// @brief Minimum number of contacts worth updating in a thread of its own.
+    /// @details Below this, the overhead of launching a thread isn't worth it.
+    PLAYRHO_CONSTEXPR const auto MinContactsPerThread = std::size_t{512};
+
+    /// @brief Gets the index of the bucket of the given contact.
+    inline std::size_t GetContactBucket(const Contact& contact) noexcept
+    {
+        return HasSensor(contact)? SensorBucket:
+            static_cast<std::size_t>(contact.GetShapeKindA()) * ShapeKindCount +
+            static_cast<std::size_t>(contact.GetShapeKindB());
+    }
+
+    /// @brief Narrow-phase results for contacts.
+    struct NarrowPhaseResults
+    {
+        /// @brief Manifolds of the contacts by index. Unset for contacts having sensors.
+        std::vector<Manifold> manifolds;
+
+        /// @brief Whether the shapes of the contacts by index overlap. Only set for contacts
+        ///   having sensors.
+        std::vector<std::uint8_t> overlapping;
+
+        /// @brief Separations of the shapes of the contacts by index. Zero for contacts whose
+        ///   shapes are touching. @sa CalcSeparation.
+        std::vector<Length> separations;
+
+        /// @brief Simplex caches of the contacts by index. @sa Contact::GetSimplexCache.
+        std::vector<Simplex::Cache> caches;
+
+        /// @brief Separating axes of the contacts by index. @sa Contact::GetSeparatingAxis.
+        std::vector<SeparatingAxis> axes;
+    };
+
+    /// @brief Calculates the narrow-phase results of the given contacts.
+    /// @details Calculates the results in buckets of contacts having the same kinds of shapes
+    ///   and calculates the manifolds of disk-disk contacts several at once. Uses up to the
+    ///   given number of threads which take on chunks of contacts until none are left. Only
+    ///   reads the contacts, so the results are the same regardless of the number of threads.
+    ///   Distance calculations start from the simplex caches of the contacts and, if separating
+    ///   axis caching is enabled, manifold calculations start from the separating axes of them.
+    NarrowPhaseResults CalcNarrowPhase(const std::vector<Contact*>& contacts,
+                                       const Contact::UpdateConf& conf, unsigned maxThreads)
+    {
+        // Counting sort of the indices of the contacts by bucket.
+        auto offsets = std::array<std::size_t, ContactBucketCount + 1>{};
+        for (const auto& contact: contacts)
+        {
+            ++offsets[GetContactBucket(*contact) + 1];
+        }
+        std::partial_sum(begin(offsets), end(offsets), begin(offsets));
+        auto order = std::vector<std::size_t>(size(contacts));
+        auto next = offsets;
+        for (auto i = std::size_t{0}; i < size(contacts); ++i)
+        {
+            order[next[GetContactBucket(*contacts[i])]++] = i;
+        }
+
+        auto results = NarrowPhaseResults{
+            std::vector<Manifold>(size(contacts)),
+            std::vector<std::uint8_t>(size(contacts)),
+            std::vector<Length>(size(contacts)),
+            std::vector<Simplex::Cache>(size(contacts)),
+            std::vector<SeparatingAxis>(size(contacts))
+        };
+        std::transform(cbegin(contacts), cend(contacts), begin(results.caches), [](const Contact* c) {
+            return c->GetSimplexCache();
+        });
+        std::transform(cbegin(contacts), cend(contacts), begin(results.axes), [](const Contact* c) {
+            return c->GetSeparatingAxis();
+        });
+        const auto calcBucket = [&](std::size_t bucket, std::size_t first, std::size_t last,
+                                    std::vector<PointManifoldInput>& inputs,
+                                    std::vector<Manifold>& manifolds) {
+            if (bucket == DiskDiskBucket)
+            {
+                inputs.clear();
+                for (auto k = first; k < last; ++k)
+                {
+                    const auto& contact = *contacts[order[k]];
+                    const auto fixtureA = contact.GetFixtureA();
+                    const auto fixtureB = contact.GetFixtureB();
+                    inputs.push_back(GetPointManifoldInput(fixtureA->GetShape(),
+                                                           fixtureA->GetBody()->GetTransformation(),
+                                                           fixtureB->GetShape(),
+                                                           fixtureB->GetBody()->GetTransformation()));
+                }
+                manifolds.resize(size(inputs));
+                GetManifolds(inputs, manifolds);
+                for (auto k = first; k < last; ++k)
+                {
+                    const auto& manifold = manifolds[k - first];
+                    results.manifolds[order[k]] = manifold;
+                    if (manifold.GetPointCount() == 0)
+                    {
+                        const auto& input = inputs[k - first];
+                        results.separations[order[k]] = GetMagnitude(Transform(input.locationB, input.xfB) -
+                                                                     Transform(input.locationA, input.xfA)) -
+                            input.totalRadius;
+                    }
+                }
+            }
+            else if (bucket == SensorBucket)
+            {
+                for (auto k = first; k < last; ++k)
+                {
+                    const auto& contact = *contacts[order[k]];
+                    const auto fixtureA = contact.GetFixtureA();
+                    const auto fixtureB = contact.GetFixtureB();
+                    const auto childA = GetChild(fixtureA->GetShape(), contact.GetChildIndexA());
+                    const auto childB = GetChild(fixtureB->GetShape(), contact.GetChildIndexB());
+                    const auto overlap = TestOverlap(childA, fixtureA->GetBody()->GetTransformation(),
+                                                     childB, fixtureB->GetBody()->GetTransformation(),
+                                                     results.caches[order[k]], conf.distance);
+                    results.overlapping[order[k]] = (overlap >= 0_m2)? 1u: 0u;
+                    results.separations[order[k]] = GetSeparation(overlap, childA.GetVertexRadius() +
+                                                                  childB.GetVertexRadius());
+                }
+            }
+            else
+            {
+                const auto kindA = static_cast<ShapeKind>(bucket / ShapeKindCount);
+                const auto kindB = static_cast<ShapeKind>(bucket % ShapeKindCount);
+                const auto collide = GetCollideShapesFunction(kindA, kindB);
+                const auto cached = conf.doSepAxisCaching && HasSeparatingAxis(kindA, kindB);
+                for (auto k = first; k < last; ++k)
+                {
+                    const auto& contact = *contacts[order[k]];
+                    const auto fixtureA = contact.GetFixtureA();
+                    const auto fixtureB = contact.GetFixtureB();
+                    const auto manifold = cached?
+                        CollideShapes(GetChild(fixtureA->GetShape(), contact.GetChildIndexA()),
+                                      fixtureA->GetBody()->GetTransformation(),
+                                      GetChild(fixtureB->GetShape(), contact.GetChildIndexB()),
+                                      fixtureB->GetBody()->GetTransformation(),
+                                      results.axes[order[k]], conf.manifold):
+                        collide(fixtureA->GetShape(), contact.GetChildIndexA(),
+                                fixtureA->GetBody()->GetTransformation(),
+                                fixtureB->GetShape(), contact.GetChildIndexB(),
+                                fixtureB->GetBody()->GetTransformation(),
+                                conf.manifold);
+                    results.manifolds[order[k]] = manifold;
+                    if (manifold.GetPointCount() == 0)
+                    {
+                        results.separations[order[k]] = CalcSeparation(contact, results.caches[order[k]],
+                                                                       conf.distance);
+                    }
+                }
+            }
+        };
+
+        // Each thread takes on the next chunk of the ordered contacts until none are left. A chunk
+        // may span more than one bucket. Every contact's results are written by one thread only.
+        auto nextChunk = std::atomic<std::size_t>{0};
+        const auto calcChunks = [&]() {
+            auto inputs = std::vector<PointManifoldInput>{};
+            auto manifolds = std::vector<Manifold>{};
+            for (;;)
+            {
+                const auto first = nextChunk.fetch_add(ContactsPerChunk);
+                if (first >= size(order))
+                {
+                    break;
+                }
+                const auto last = std::min(first + ContactsPerChunk, size(order));
+                auto bucket = static_cast<std::size_t>(std::upper_bound(cbegin(offsets), cend(offsets),
+                                                                        first) - cbegin(offsets)) - 1;
+                for (auto k = first; k < last; ++bucket)
+                {
+                    const auto end = std::min(last, offsets[bucket + 1]);
+                    if (k < end)
+                    {
+                        calcBucket(bucket, k, end, inputs, manifolds);
+                        k = end;
+                    }
+                }
+            }
+        };
+
+        const auto numThreads = std::min(std::size_t{maxThreads}, size(contacts) / MinContactsPerThread);
+        auto futures = std::vector<std::future<void>>{};
+        futures.reserve((numThreads > 1)? numThreads - 1: 0);
+        for (auto i = std::size_t{1}; i < numThreads; ++i)
+        {
+            futures.push_back(std::async(std::launch::async, calcChunks));
+        }
+        calcChunks();
+        for (auto& future: futures)
+        {
+            future.get();
+        }
+        return results;
+    }
+
 } // anonymous namespace
 
 World::World(const WorldConf& def):
-    m_tree{def.initialTreeSize},
+    m_broadPhase{def},
     m_minVertexRadius{def.minVertexRadius},
     m_maxVertexRadius{def.maxVertexRadius}
 {
@@ -431,7 +750,8 @@ World::World(const WorldConf& def):
 }
 
 World::World(const World& other):
-    m_tree{other.m_tree},
+    m_broadPhase{other.m_broadPhase},
+    m_movedProxies{other.m_movedProxies},
     m_destructionListener{other.m_destructionListener},
     m_contactListener{other.m_contactListener},
     m_flags{other.m_flags},
@@ -456,7 +776,8 @@ World& World::operator= (const World& other)
     m_inv_dt0 = other.m_inv_dt0;
     m_minVertexRadius = other.m_minVertexRadius;
     m_maxVertexRadius = other.m_maxVertexRadius;
-    m_tree = other.m_tree;
+    m_broadPhase = other.m_broadPhase;
+    m_movedProxies = other.m_movedProxies;
 
     auto bodyMap = std::map<const Body*, Body*>();
     auto fixtureMap = std::map<const Fixture*, Fixture*>();
@@ -481,10 +802,25 @@ void World::Clear()
     InternalClear();
 }
 
+const DynamicTree& World::GetTree() const noexcept
+{
+    static const auto empty = DynamicTree{};
+    const auto tree = m_broadPhase.Get<TreeBroadPhase>();
+    return tree? tree->GetTree(): empty;
+}
+
+const DynamicTree& World::GetStaticTree() const noexcept
+{
+    static const auto empty = DynamicTree{};
+    const auto tree = m_broadPhase.Get<TreeBroadPhase>();
+    return tree? tree->GetStaticTree(): empty;
+}
+
 void World::InternalClear() noexcept
 {
     m_proxyKeys.clear();
     m_proxies.clear();
+    m_movedProxies.clear();
     m_fixturesForProxies.clear();
     m_bodiesForProxies.clear();
 
@@ -518,6 +854,7 @@ void World::InternalClear() noexcept
     m_bodies.clear();
     m_joints.clear();
     m_contacts.clear();
+    m_contactKeys.clear();
 }
 
 void World::CopyBodies(std::map<const Body*, Body*>& bodyMap,
@@ -541,12 +878,14 @@ void World::CopyBodies(std::map<const Body*, Body*>& bodyMap,
             {
                 const auto fp = otherFixture.GetProxy(childIndex);
                 proxies[childIndex] = FixtureProxy{fp.treeId};
-                const auto newData = DynamicTree::LeafData{newBody, newFixture, childIndex};
-                m_tree.SetLeafData(fp.treeId, newData);
+                m_broadPhase.SetLeafData(fp.treeId, DynamicTree::LeafData{newBody, newFixture, childIndex,
+                    fixtureConf.filter.categoryBits});
             }
             FixtureAtty::SetProxies(*newFixture, std::move(proxies), childCount);
         }
         newBody->SetMassData(GetMassData(GetRef(otherBody)));
+        BodyAtty::SetRecentDisplacement(*newBody,
+                                        BodyAtty::GetRecentDisplacement(GetRef(otherBody)));
         bodyMap[GetPtr(otherBody)] = newBody;
     }
 }
@@ -572,6 +911,7 @@ void World::CopyContacts(const std::map<const Body*, Body*>& bodyMap,
         {
             const auto key = std::get<ContactKey>(contact);
             m_contacts.push_back(KeyedContactPtr{key, newContact});
+            m_contactKeys.insert(key);
 
             BodyAtty::Insert(*newBodyA, key, newContact);
             BodyAtty::Insert(*newBodyB, key, newContact);
@@ -816,7 +1156,7 @@ Joint* World::CreateJoint(const JointConf& def)
     // If the joint prevents collisions, then flag any contacts for filtering.
     if ((!def.collideConnected) && bodyA && bodyB)
     {
-        FlagContactsForFiltering(*bodyA, *bodyB);
+        FlagContactsForFiltering(*bodyA, *bodyB, m_movedProxies);
     }
     
     return j;
@@ -880,7 +1220,7 @@ void World::InternalDestroy(Joint& joint) noexcept
     // If the joint prevented collisions, then flag any contacts for filtering.
     if ((!collideConnected) && bodyA && bodyB)
     {
-        FlagContactsForFiltering(*bodyA, *bodyB);
+        FlagContactsForFiltering(*bodyA, *bodyB, m_movedProxies);
     }
 }
 
@@ -1086,14 +1426,26 @@ RegStepStats World::SolveReg(const StepConf& conf)
         // A non-static body that was in an island may have moved.
         if (IsIslanded(&body) && body.IsSpeedable())
         {
+            const auto xfm0 = GetTransform0(body.GetSweep());
+            const auto xfm1 = body.GetTransformation();
+            if (conf.aabbPredictionSteps > 0)
+            {
+                UpdateRecentDisplacement(body, xfm1.p - xfm0.p);
+            }
+            
             // Update fixtures (for broad-phase).
-            stats.proxiesMoved += Synchronize(body, GetTransform0(body.GetSweep()), body.GetTransformation(),
-                        conf.displaceMultiplier, conf.aabbExtension);
+            const auto moved = Synchronize(body, xfm0, xfm1, conf.displaceMultiplier,
+                                           GetAabbExtension(body, conf));
+            stats.proxiesMoved += moved;
+            if (xfm0 != xfm1)
+            {
+                stats.proxiesKept += GetProxyCount(body) - moved;
+            }
         }
     }
 
     // Look for new contacts.
-    stats.contactsAdded = FindNewContacts();
+    stats.contactsAdded = FindNewContacts(conf);
     
     return stats;
 }
@@ -1276,7 +1628,9 @@ World::UpdateContactsData World::UpdateContactTOIs(const StepConf& conf)
         
         // Compute the TOI for this contact (one or both bodies are active and impenetrable).
         // Computes the time of impact in interval [0, 1]
-        const auto output = CalcToi(c, toiConf);
+        auto cache = c.GetSimplexCache();
+        const auto output = CalcToi(c, toiConf, cache);
+        ContactAtty::SetSimplexCache(c, cache);
         
         // Use Min function to handle floating point imprecision which possibly otherwise
         // could provide a TOI that's greater than 1.
@@ -1286,6 +1640,8 @@ World::UpdateContactsData World::UpdateContactTOIs(const StepConf& conf)
         ContactAtty::SetToi(c, toi);
         
         results.maxDistIters = std::max(results.maxDistIters, output.stats.max_dist_iters);
+        results.sumDistIters += output.stats.sum_dist_iters;
+        results.sumToiIters += output.stats.toi_iters;
         results.maxToiIters = std::max(results.maxToiIters, output.stats.toi_iters);
         results.maxRootIters = std::max(results.maxRootIters, output.stats.max_root_iters);
         ++results.numUpdatedTOI;
@@ -1340,6 +1696,8 @@ ToiStepStats World::SolveToi(const StepConf& conf)
         stats.contactsAtMaxSubSteps += updateData.numAtMaxSubSteps;
         stats.contactsUpdatedToi += updateData.numUpdatedTOI;
         stats.maxDistIters = std::max(stats.maxDistIters, updateData.maxDistIters);
+        stats.sumDistIters += updateData.sumDistIters;
+        stats.sumToiIters += updateData.sumToiIters;
         stats.maxRootIters = std::max(stats.maxRootIters, updateData.maxRootIters);
         stats.maxToiIters = std::max(stats.maxToiIters, updateData.maxToiIters);
         
@@ -1394,8 +1752,8 @@ ToiStepStats World::SolveToi(const StepConf& conf)
                 {
                     const auto xfm0 = GetTransform0(body.GetSweep());
                     const auto xfm1 = body.GetTransformation();
-                    stats.proxiesMoved += Synchronize(body, xfm0, xfm1,
-                                                      conf.displaceMultiplier, conf.aabbExtension);
+                    stats.proxiesMoved += Synchronize(body, xfm0, xfm1, conf.displaceMultiplier,
+                                                      GetAabbExtension(body, conf));
                     ResetContactsForSolveTOI(body);
                 }
             }
@@ -1403,7 +1761,7 @@ ToiStepStats World::SolveToi(const StepConf& conf)
 
         // Commit fixture proxy movements to the broad-phase so that new contacts are created.
         // Also, some contacts can be destroyed.
-        stats.contactsAdded += FindNewContacts();
+        stats.contactsAdded += FindNewContacts(conf);
 
         if (subStepping)
         {
@@ -1820,6 +2178,8 @@ StepStats World::Step(const StepConf& conf)
         stepStats.pre.proxiesMoved = SynchronizeProxies(conf);
         // pre.proxiesMoved is usually zero but sometimes isn't.
 
+        RebuildTrees(conf);
+
         {
             // Note: this may update bodies (in addition to the contacts container).
             const auto destroyStats = DestroyContacts(m_contacts);
@@ -1832,7 +2192,7 @@ StepStats World::Step(const StepConf& conf)
             
             // New fixtures were added: need to find and create the new contacts.
             // Note: this may update bodies (in addition to the contacts container).
-            stepStats.pre.added = FindNewContacts();
+            stepStats.pre.added = FindNewContacts(conf);
         }
 
         if (conf.GetTime() != 0_s)
@@ -1844,6 +2204,7 @@ StepStats World::Step(const StepConf& conf)
             stepStats.pre.ignored = updateStats.ignored;
             stepStats.pre.updated = updateStats.updated;
             stepStats.pre.skipped = updateStats.skipped;
+            stepStats.pre.separated = updateStats.separated;
 
             // Integrate velocities, solve velocity constraints, and integrate positions.
             if (IsStepComplete())
@@ -1887,7 +2248,7 @@ void World::ShiftOrigin(Length2 newOrigin)
         GetRef(j).ShiftOrigin(newOrigin);
     });
 
-    m_tree.ShiftOrigin(newOrigin);
+    m_broadPhase.ShiftOrigin(newOrigin);
 }
 
 void World::InternalDestroy(Contact* contact, Body* from)
@@ -1936,23 +2297,67 @@ void World::Destroy(Contact* contact, Body* from)
     });
     if (it != cend(m_contacts))
     {
+        m_contactKeys.erase(std::get<ContactKey>(*it));
         m_contacts.erase(it);
     }
 }
 
 World::DestroyContactsStats World::DestroyContacts(Contacts& contacts)
 {
-    const auto beforeSize = size(contacts);
-    contacts.erase(std::remove_if(begin(contacts), end(contacts), [&](Contacts::value_type& c)
+    // Gather the contacts of the proxies that moved or were touched. These are the only
+    // contacts whose proxies may have stopped overlapping or that may need filtering.
+    sort(begin(m_movedProxies), end(m_movedProxies));
+    m_movedProxies.erase(unique(begin(m_movedProxies), end(m_movedProxies)), end(m_movedProxies));
+
+    // Scans the contacts of each body having moved proxies only once, regardless of how
+    // many of its proxies moved.
+    auto bodies = std::vector<Body*>{};
+    for_each(cbegin(m_movedProxies), cend(m_movedProxies), [&](ProxyId pid) {
+        if (pid != DynamicTree::GetInvalidSize())
+        {
+            bodies.push_back(m_broadPhase.GetLeafData(pid).body);
+        }
+    });
+    sort(begin(bodies), end(bodies));
+    bodies.erase(unique(begin(bodies), end(bodies)), end(bodies));
+
+    const auto moved = [&](ProxyId pid) {
+        return std::binary_search(cbegin(m_movedProxies), cend(m_movedProxies), pid);
+    };
+    auto candidates = std::vector<KeyedContactPtr>{};
+    for_each(cbegin(bodies), cend(bodies), [&](Body* body) {
+        for (auto&& ci: body->GetContacts())
+        {
+            const auto key = std::get<ContactKey>(ci);
+            if (moved(key.GetMin()) || moved(key.GetMax()))
+            {
+                candidates.push_back(ci);
+            }
+        }
+    });
+    m_movedProxies.clear();
+
+    // Contacts between bodies that both moved get gathered twice so eliminate the duplicates.
+    sort(begin(candidates), end(candidates), [](KeyedContactPtr lhs, KeyedContactPtr rhs) {
+        return std::get<ContactKey>(lhs) < std::get<ContactKey>(rhs);
+    });
+    candidates.erase(unique(begin(candidates), end(candidates)), end(candidates));
+
+    auto erasedKeys = ContactKeySet{};
+    for_each(cbegin(candidates), cend(candidates), [&](KeyedContactPtr c)
     {
         const auto key = std::get<ContactKey>(c);
         auto& contact = GetRef(std::get<Contact*>(c));
         
-        if (!TestOverlap(m_tree, key.GetMin(), key.GetMax()))
+        const auto min = key.GetMin();
+        const auto max = key.GetMax();
+        if (!TestOverlap(m_broadPhase.GetAABB(min), m_broadPhase.GetAABB(max)))
         {
             // Destroy contacts that cease to overlap in the broad-phase.
             InternalDestroy(&contact);
-            return true;
+            m_contactKeys.erase(key);
+            erasedKeys.insert(key);
+            return;
         }
         
         // Is this contact flagged for filtering?
@@ -1966,18 +2371,26 @@ World::DestroyContactsStats World::DestroyContacts(Contacts& contacts)
             if (!ShouldCollide(*bodyB, *bodyA) || !ShouldCollide(*fixtureA, *fixtureB))
             {
                 InternalDestroy(&contact);
-                return true;
+                m_contactKeys.erase(key);
+                erasedKeys.insert(key);
+                return;
             }
             ContactAtty::UnflagForFiltering(contact);
         }
+    });
 
-        return false;
-    }), end(contacts));
-    const auto afterSize = size(contacts);
+    // Remove the destroyed contacts while keeping the remaining contacts in order.
+    if (!empty(erasedKeys))
+    {
+        contacts.erase(std::remove_if(begin(contacts), end(contacts), [&](Contacts::value_type& c)
+        {
+            return erasedKeys.contains(std::get<ContactKey>(c));
+        }), end(contacts));
+    }
 
     auto stats = DestroyContactsStats{};
-    stats.ignored = static_cast<ContactCounter>(afterSize);
-    stats.erased = static_cast<ContactCounter>(beforeSize - afterSize);
+    stats.ignored = static_cast<ContactCounter>(size(contacts));
+    stats.erased = static_cast<ContactCounter>(size(erasedKeys));
     return stats;
 }
 
@@ -1987,20 +2400,18 @@ World::UpdateContactsStats World::UpdateContacts(Contacts& contacts, const StepC
     atomic<uint32_t> ignored;
     atomic<uint32_t> updated;
     atomic<uint32_t> skipped;
+    atomic<uint32_t> separated;
 #else
     auto ignored = uint32_t{0};
     auto updated = uint32_t{0};
     auto skipped = uint32_t{0};
+    auto separated = uint32_t{0};
 #endif
 
     const auto updateConf = Contact::GetUpdateConf(conf);
     
-#if defined(DO_THREADED)
     std::vector<Contact*> contactsNeedingUpdate;
     contactsNeedingUpdate.reserve(size(contacts));
-    std::vector<std::future<void>> futures;
-    futures.reserve(size(contacts));
-#endif
 
     // Update awake contacts.
     for_each(/*execution::par_unseq,*/ begin(contacts), end(contacts),
@@ -2036,17 +2447,21 @@ World::UpdateContactsStats World::UpdateContacts(Contacts& contacts, const StepC
         //   - The "maxCirclesRatio" per-step configuration state if contact IS NOT for sensor.
         //   - The "maxDistanceIters" per-step configuration state if contact IS for sensor.
         //
+        // Contacts whose shapes remain further apart than the bodies could have moved since
+        //   they were last updated aren't touching and still have empty manifolds.
+        //
         if (contact.NeedsUpdating())
         {
-            // The following may call listener but is otherwise thread-safe.
-#if defined(DO_THREADED)
-            contactsNeedingUpdate.push_back(&contact);
-            //futures.push_back(async(&ContactAtty::Update, *contact, conf, m_contactListener)));
-            //futures.push_back(async(launch::async, [=]{ ContactAtty::Update(*contact, conf, m_contactListener); }));
-#else
-            ContactAtty::Update(contact, updateConf, m_contactListener);
-#endif
-        	++updated;
+            if (contact.GetSeparationBound() > 0_m)
+            {
+                ContactAtty::UnflagForUpdating(contact);
+                ++separated;
+            }
+            else
+            {
+                contactsNeedingUpdate.push_back(&contact);
+                ++updated;
+            }
         }
         else
         {
@@ -2055,43 +2470,46 @@ World::UpdateContactsStats World::UpdateContacts(Contacts& contacts, const StepC
 #endif
     });
     
-#if defined(DO_THREADED)
-    auto numJobs = size(contactsNeedingUpdate);
-    const auto jobsPerCore = numJobs / 4;
-    for (auto i = decltype(numJobs){0}; numJobs > 0 && i < 3; ++i)
+    // The narrow phase only reads the contacts so may be done concurrently. The contacts then
+    // get updated from its results in the calling thread and in the order of the contacts,
+    // so the listener gets called from this thread in the same order regardless.
+    const auto results = CalcNarrowPhase(contactsNeedingUpdate, updateConf, conf.maxThreads);
+    for (auto i = std::size_t{0}; i < size(contactsNeedingUpdate); ++i)
     {
-        futures.push_back(std::async(std::launch::async, [=]{
-            const auto offset = jobsPerCore * i;
-            for (auto j = decltype(jobsPerCore){0}; j < jobsPerCore; ++j)
-            {
-	            ContactAtty::Update(*contactsNeedingUpdate[offset + j], updateConf, m_contactListener);
-            }
-        }));
-        numJobs -= jobsPerCore;
-    }
-    if (numJobs > 0)
-    {
-        futures.push_back(std::async(std::launch::async, [=]{
-            const auto offset = jobsPerCore * 3;
-            for (auto j = decltype(numJobs){0}; j < numJobs; ++j)
-            {
-                ContactAtty::Update(*contactsNeedingUpdate[offset + j], updateConf, m_contactListener);
-            }
-        }));
-    }
-    for (auto&& future: futures)
-    {
-        future.get();
+        auto& contact = *contactsNeedingUpdate[i];
+        if (HasSensor(contact))
+        {
+            ContactAtty::UpdateSensor(contact, results.overlapping[i] != 0u, m_contactListener);
+        }
+        else
+        {
+            ContactAtty::Update(contact, results.manifolds[i], updateConf, m_contactListener);
+        }
+        ContactAtty::SetSeparation(contact, results.separations[i], updateConf);
+        ContactAtty::SetSimplexCache(contact, results.caches[i]);
+        ContactAtty::SetSeparatingAxis(contact, results.axes[i]);
     }
-#endif
     
     return UpdateContactsStats{
         static_cast<ContactCounter>(ignored),
         static_cast<ContactCounter>(updated),
-        static_cast<ContactCounter>(skipped)
+        static_cast<ContactCounter>(skipped),
+        static_cast<ContactCounter>(separated)
     };
 }
 
+void World::RebuildTrees(const StepConf& conf)
+{
+    if (!(conf.maxTreeDegradation > 0))
+    {
+        return;
+    }
+    if (const auto tree = m_broadPhase.Get<TreeBroadPhase>())
+    {
+        tree->RebuildIfDegraded(conf.maxTreeDegradation, conf.maxThreads);
+    }
+}
+
 void World::UnregisterForProcessing(ProxyId pid) noexcept
 {
     const auto itEnd = end(m_proxies);
@@ -2100,48 +2518,199 @@ void World::UnregisterForProcessing(ProxyId pid) noexcept
     {
         *it = DynamicTree::GetInvalidSize();
     }
+    std::replace(begin(m_movedProxies), end(m_movedProxies), pid, DynamicTree::GetInvalidSize());
 }
 
-ContactCounter World::FindNewContacts()
+ContactCounter World::FindNewContacts(const StepConf& conf)
 {
     m_proxyKeys.clear();
+    m_broadPhase.Visit([&](auto& broadPhase) {
+        FindKeys(broadPhase, conf);
+    });
+    m_proxies.clear();
+
+    const auto numContactsBefore = size(m_contacts);
+    for_each(cbegin(m_proxyKeys), cend(m_proxyKeys), [&](ContactKey key)
+    {
+        Add(key);
+    });
+    const auto numContactsAfter = size(m_contacts);
+    return static_cast<ContactCounter>(numContactsAfter - numContactsBefore);
+}
 
+void World::FindKeys(const TreeBroadPhase& broadPhase, const StepConf& conf)
+{
     // Accumalate contact keys for pairs of nodes that are overlapping and aren't identical.
     // Note that if the dynamic tree node provides the body pointer, it's assumed to be faster
     // to eliminate any node pairs that have the same body here before the key pairs are
     // sorted.
+    // When there's a separate static tree, its proxies are only queried for by the
+    // proxies of the other tree since static bodies never collide with each other.
+    const auto& dynamicTree = broadPhase.GetTree();
+    const auto& staticTree = broadPhase.GetStaticTree();
+    const auto findKeys = [&](ProxyQueue::const_iterator first,
+                              ProxyQueue::const_iterator last,
+                              ContactKeyQueue& keys) {
+        const auto separateStaticTree = broadPhase.IsSeparateStaticTree();
+        for_each(first, last, [&](ProxyId pid) {
+            const auto leafData = broadPhase.GetLeafData(pid);
+            const auto body0 = leafData.body;
+            const auto aabb = broadPhase.GetAABB(pid);
+            // Sub-trees without any of the categories the proxy's fixture collides with
+            // are skipped unless a positive group index could override its mask bits.
+            const auto filter = leafData.fixture->GetFilterData();
+            const auto query = [&](const DynamicTree& other, auto&& callback) {
+                if (filter.groupIndex > 0)
+                {
+                    Query(other, aabb, callback);
+                }
+                else
+                {
+                    Query(other, aabb, filter.maskBits, callback);
+                }
+            };
+            query(dynamicTree, [&](DynamicTree::Size nodeId) {
+                const auto body1 = dynamicTree.GetLeafData(nodeId).body;
+                // A proxy cannot form a pair with itself.
+                if ((nodeId != pid) && (body0 != body1))
+                {
+                    keys.push_back(ContactKey{nodeId, pid});
+                }
+                return DynamicTreeOpcode::Continue;
+            });
+            if (separateStaticTree && !TreeBroadPhase::IsStaticProxy(pid))
+            {
+                query(staticTree, [&](DynamicTree::Size nodeId) {
+                    if (body0 != staticTree.GetLeafData(nodeId).body)
+                    {
+                        keys.push_back(ContactKey{nodeId | TreeBroadPhase::StaticProxyFlag, pid});
+                    }
+                    return DynamicTreeOpcode::Continue;
+                });
+            }
+        });
+    };
+
+    const auto numProxies = size(m_proxies);
+    const auto numThreads = std::min(std::size_t{conf.maxThreads},
+                                     numProxies / MinProxiesPerThread);
+    if (numThreads > 1)
+    {
+        // Queries are read-only so can be done concurrently as long as each thread has its
+        // own key buffer. Since the key buffers get sorted and merged into one set, the
+        // result is identical to the serial result.
+        auto keySets = std::vector<ContactKeyQueue>(numThreads);
+        auto futures = std::vector<std::future<void>>{};
+        futures.reserve(numThreads - 1);
+        const auto proxiesPerThread = numProxies / numThreads;
+        for (auto i = decltype(numThreads){0}; i < numThreads; ++i)
+        {
+            const auto first = cbegin(m_proxies) + static_cast<std::ptrdiff_t>(i * proxiesPerThread);
+            const auto last = (i == (numThreads - 1))? cend(m_proxies):
+                first + static_cast<std::ptrdiff_t>(proxiesPerThread);
+            auto& keys = keySets[i];
+            const auto task = [&findKeys,first,last,&keys]() {
+                findKeys(first, last, keys);
+                SortAndUnique(keys);
+            };
+            if (i == (numThreads - 1))
+            {
+                task();
+            }
+            else
+            {
+                futures.push_back(std::async(std::launch::async, task));
+            }
+        }
+        for (auto& future: futures)
+        {
+            future.get();
+        }
+        MergeUnique(keySets);
+        swap(m_proxyKeys, keySets.front());
+    }
+    else
+    {
+        findKeys(cbegin(m_proxies), cend(m_proxies), m_proxyKeys);
+
+        // Sort and eliminate any duplicate contact keys.
+        SortAndUnique(m_proxyKeys);
+    }
+}
+
+void World::FindKeys(SweepAndPrune& broadPhase, const StepConf&)
+{
+    broadPhase.Sort();
+    
+    // When enough of the proxies moved, sweeping through all of them once finds the
+    // pairs faster than querying for each of the moved ones does.
+    const auto numProxies = size(m_proxies);
+    if ((numProxies * MinSweptProxiesRatio) >= broadPhase.GetProxyCount())
+    {
+        auto moved = std::vector<bool>(broadPhase.GetIdLimit());
+        for_each(cbegin(m_proxies), cend(m_proxies), [&](ProxyId pid) {
+            if (pid != SweepAndPrune::GetInvalidSize())
+            {
+                moved[pid] = true;
+            }
+        });
+        QueryPairs(broadPhase, [&](SweepAndPrune::Size id0, SweepAndPrune::Size id1) {
+            if ((moved[id0] || moved[id1]) &&
+                (broadPhase.GetLeafData(id0).body != broadPhase.GetLeafData(id1).body))
+            {
+                m_proxyKeys.push_back(ContactKey{id0, id1});
+            }
+        });
+    }
+    else
+    {
+        for_each(cbegin(m_proxies), cend(m_proxies), [&](ProxyId pid) {
+            if (pid == SweepAndPrune::GetInvalidSize())
+            {
+                return;
+            }
+            const auto body0 = broadPhase.GetLeafData(pid).body;
+            Query(broadPhase, broadPhase.GetAABB(pid), [&](SweepAndPrune::Size id) {
+                // A proxy cannot form a pair with itself.
+                if ((id != pid) && (body0 != broadPhase.GetLeafData(id).body))
+                {
+                    m_proxyKeys.push_back(ContactKey{id, pid});
+                }
+                return DynamicTreeOpcode::Continue;
+            });
+        });
+    }
+    
+    // Sort and eliminate any duplicate contact keys.
+    SortAndUnique(m_proxyKeys);
+}
+
+void World::FindKeys(const UniformGrid& broadPhase, const StepConf&)
+{
     for_each(cbegin(m_proxies), cend(m_proxies), [&](ProxyId pid) {
-        const auto body0 = m_tree.GetLeafData(pid).body;
-        const auto aabb = m_tree.GetAABB(pid);
-        Query(m_tree, aabb, [&](DynamicTree::Size nodeId) {
-            const auto body1 = m_tree.GetLeafData(nodeId).body;
+        if (pid == UniformGrid::GetInvalidSize())
+        {
+            return;
+        }
+        const auto body0 = broadPhase.GetLeafData(pid).body;
+        Query(broadPhase, broadPhase.GetAABB(pid), [&](UniformGrid::Size id) {
             // A proxy cannot form a pair with itself.
-            if ((nodeId != pid) && (body0 != body1))
+            if ((id != pid) && (body0 != broadPhase.GetLeafData(id).body))
             {
-                m_proxyKeys.push_back(ContactKey{nodeId, pid});
+                m_proxyKeys.push_back(ContactKey{id, pid});
             }
             return DynamicTreeOpcode::Continue;
         });
     });
-    m_proxies.clear();
-
+    
     // Sort and eliminate any duplicate contact keys.
-    sort(begin(m_proxyKeys), end(m_proxyKeys));
-    m_proxyKeys.erase(unique(begin(m_proxyKeys), end(m_proxyKeys)), end(m_proxyKeys));
-
-    const auto numContactsBefore = size(m_contacts);
-    for_each(cbegin(m_proxyKeys), cend(m_proxyKeys), [&](ContactKey key)
-    {
-        Add(key);
-    });
-    const auto numContactsAfter = size(m_contacts);
-    return static_cast<ContactCounter>(numContactsAfter - numContactsBefore);
+    SortAndUnique(m_proxyKeys);
 }
 
 bool World::Add(ContactKey key)
 {
-    const auto minKeyLeafData = m_tree.GetLeafData(key.GetMin());
-    const auto maxKeyLeafData = m_tree.GetLeafData(key.GetMax());
+    const auto minKeyLeafData = m_broadPhase.GetLeafData(key.GetMin());
+    const auto maxKeyLeafData = m_broadPhase.GetLeafData(key.GetMax());
 
     const auto fixtureA = minKeyLeafData.fixture;
     const auto indexA = minKeyLeafData.childIndex;
@@ -2197,18 +2766,10 @@ bool World::Add(ContactKey key)
     // W/ World::list<Contact> and Body::vector<ContactKey,Contact*> .219s@step15, 0.659s-sumstep20
 
     // Does a contact already exist?
-    // Identify body with least contacts and search it.
-    // NOTE: Time trial testing found the following rough ordering of data structures, to be
-    // fastest to slowest: vector, list, unorderered_set, unordered_map,
-    //     set, map.
-    const auto searchBody = (size(bodyA->GetContacts()) < size(bodyB->GetContacts()))?
-        bodyA: bodyB;
-    
-    const auto contacts = searchBody->GetContacts();
-    const auto it = find_if(cbegin(contacts), cend(contacts), [&](KeyedContactPtr ci) {
-        return std::get<ContactKey>(ci) == key;
-    });
-    if (it != cend(contacts))
+    // NOTE: Searching linearly through the contacts of the body with the least contacts
+    //   was found to take time proportional to the square of the number of contacts on
+    //   bodies that touch hundreds of others. The keyed set makes this constant time.
+    if (m_contactKeys.contains(key))
     {
         return false;
     }
@@ -2230,6 +2791,7 @@ bool World::Add(ContactKey key)
     // adding means container more a LIFO container, while back adding means more a FIFO.
     //
     m_contacts.push_back(KeyedContactPtr{key, contact});
+    m_contactKeys.insert(key);
 
     BodyAtty::Insert(*bodyA, key, contact);
     BodyAtty::Insert(*bodyB, key, contact);
@@ -2295,7 +2857,7 @@ void World::CreateAndDestroyProxies(Fixture& fixture, const StepConf& conf)
     {
         if (enabled)
         {
-            CreateProxies(fixture, conf.aabbExtension);
+            CreateProxies(fixture, GetAabbExtension(*body, conf));
         }
     }
     else
@@ -2320,13 +2882,31 @@ void World::CreateAndDestroyProxies(Fixture& fixture, const StepConf& conf)
     }
 }
 
+void World::UpdateRecentDisplacement(Body& body, Length2 displacement) noexcept
+{
+    const auto decayed = BodyAtty::GetRecentDisplacement(body) * RecentDisplacementDecay;
+    BodyAtty::SetRecentDisplacement(body, std::max(GetMagnitude(displacement), decayed));
+}
+
+Length World::GetAabbExtension(const Body& body, const StepConf& conf) noexcept
+{
+    if (!(conf.aabbPredictionSteps > 0))
+    {
+        return conf.aabbExtension;
+    }
+    const auto predicted = GetMagnitude(body.GetVelocity().linear) * conf.GetTime();
+    const auto expected = std::max(BodyAtty::GetRecentDisplacement(body), predicted);
+    return std::max(Length{conf.linearSlop}, conf.aabbPredictionSteps * expected);
+}
+
 PreStepStats::counter_type World::SynchronizeProxies(const StepConf& conf)
 {
     auto proxiesMoved = PreStepStats::counter_type{0};
     for_each(begin(m_bodiesForProxies), end(m_bodiesForProxies), [&](Body *b) {
         const auto xfm = b->GetTransformation();
         // Not always true: assert(GetTransform0(b->GetSweep()) == xfm);
-        proxiesMoved += Synchronize(*b, xfm, xfm, conf.displaceMultiplier, conf.aabbExtension);
+        proxiesMoved += Synchronize(*b, xfm, xfm, conf.displaceMultiplier,
+                                    GetAabbExtension(*b, conf));
     });
     m_bodiesForProxies.clear();
     return proxiesMoved;
@@ -2345,6 +2925,7 @@ void World::SetType(Body& body, playrho::BodyType type)
         throw WrongState("World::SetType: world is locked");
     }
     
+    const auto wasStatic = (body.GetType() == BodyType::Static);
     BodyAtty::SetTypeFlags(body, type);
     body.ResetMassData();
     
@@ -2354,6 +2935,20 @@ void World::SetType(Body& body, playrho::BodyType type)
         return true;
     });
 
+    if (IsSeparateStaticTree() && (wasStatic != (type == BodyType::Static)))
+    {
+        // Moves the proxies to the other tree by recreating them in the next step.
+        const auto fixtures = body.GetFixtures();
+        for_each(begin(fixtures), end(fixtures), [&](Body::Fixtures::value_type& f) {
+            auto& fixture = GetRef(f);
+            if (fixture.GetProxyCount() > 0)
+            {
+                DestroyProxies(fixture);
+                RegisterForProxies(fixture);
+            }
+        });
+    }
+
     if (type == BodyType::Static)
     {
 #ifndef NDEBUG
@@ -2489,6 +3084,7 @@ void World::CreateProxies(Fixture& fixture, Length aabbExtension)
     
     // Reserve proxy space and create proxies in the broad-phase.
     const auto childCount = GetChildCount(shape);
+    const auto isStatic = (body->GetType() == BodyType::Static);
     auto proxies = std::make_unique<FixtureProxy[]>(childCount);
     for (auto childIndex = decltype(childCount){0}; childIndex < childCount; ++childIndex)
     {
@@ -2497,8 +3093,9 @@ void World::CreateProxies(Fixture& fixture, Length aabbExtension)
 
         // Note: treeId from CreateLeaf can be higher than the number of fixture proxies.
         const auto fattenedAABB = GetFattenedAABB(aabb, aabbExtension);
-        const auto treeId = m_tree.CreateLeaf(fattenedAABB, DynamicTree::LeafData{
-            body, &fixture, childIndex});
+        const auto leafData = DynamicTree::LeafData{body, &fixture, childIndex,
+            fixture.GetFilterData().categoryBits};
+        const auto treeId = m_broadPhase.CreateProxy(fattenedAABB, leafData, isStatic);
         RegisterForProcessing(treeId);
         proxies[childIndex] = FixtureProxy{treeId};
     }
@@ -2517,7 +3114,7 @@ void World::DestroyProxies(Fixture& fixture) noexcept
         {
             const auto treeId = proxies[i].treeId;
             UnregisterForProcessing(treeId);
-            m_tree.DestroyLeaf(treeId);
+            m_broadPhase.DestroyProxy(treeId);
         }
     }
     FixtureAtty::ResetProxies(fixture);
@@ -2526,6 +3123,20 @@ void World::DestroyProxies(Fixture& fixture) noexcept
 void World::TouchProxies(Fixture& fixture) noexcept
 {
     assert(fixture.GetBody()->GetWorld() == this);
+
+    // Fixture's filter data may have changed so refresh the category bits of its proxies.
+    const auto categoryBits = fixture.GetFilterData().categoryBits;
+    const auto proxyCount = fixture.GetProxyCount();
+    for (auto i = decltype(proxyCount){0}; i < proxyCount; ++i)
+    {
+        const auto treeId = fixture.GetProxy(i).treeId;
+        auto leafData = m_broadPhase.GetLeafData(treeId);
+        if (leafData.categoryBits != categoryBits)
+        {
+            leafData.categoryBits = categoryBits;
+            m_broadPhase.SetLeafData(treeId, leafData);
+        }
+    }
     InternalTouchProxies(fixture);
 }
 
@@ -2571,11 +3182,11 @@ ContactCounter World::Synchronize(Fixture& fixture,
         
         // Compute an AABB that covers the swept shape (may miss some rotation effect).
         const auto aabb = ComputeAABB(GetChild(shape, childIndex), xfm1, xfm2);
-        if (!Contains(m_tree.GetAABB(treeId), aabb))
+        if (!Contains(m_broadPhase.GetAABB(treeId), aabb))
         {
             const auto newAabb = GetDisplacedAABB(GetFattenedAABB(aabb, extension),
                                                   displacement);
-            m_tree.UpdateLeaf(treeId, newAabb);
+            m_broadPhase.UpdateProxy(treeId, newAabb);
             RegisterForProcessing(treeId);
             ++updatedCount;
         }
@@ -2692,6 +3303,209 @@ Body* FindClosestBody(const World& world, Length2 location) noexcept
     return found;
 }
 
+FixtureChildDistance FindClosestFixture(const World& world, Length2 point, Length maxDistance)
+{
+    auto found = std::vector<FixtureChildDistance>{};
+    FindClosestFixtures(world, point, 1, found, maxDistance);
+    return empty(found)? FixtureChildDistance{}: found.front();
+}
+
+void FindClosestFixtures(const World& world, Length2 point, std::size_t count,
+                         std::vector<FixtureChildDistance>& found, Length maxDistance)
+{
+    found.clear();
+    if (count == 0)
+    {
+        return;
+    }
+    const auto findInTree = [&](const DynamicTree& tree) {
+        auto remaining = count;
+        QueryNearest(tree, point, maxDistance, [&](DynamicTree::Size index) {
+            const auto leafData = tree.GetLeafData(index);
+            return GetDistance(*leafData.fixture, leafData.childIndex, point);
+        }, [&](DynamicTree::Size index, Length distance) {
+            const auto leafData = tree.GetLeafData(index);
+            found.push_back(FixtureChildDistance{leafData.fixture, leafData.childIndex, distance});
+            --remaining;
+            return (remaining > 0)? DynamicTreeOpcode::Continue: DynamicTreeOpcode::End;
+        });
+    };
+    if (const auto tree = world.GetBroadPhase().Get<TreeBroadPhase>())
+    {
+        findInTree(tree->GetTree());
+        if (tree->IsSeparateStaticTree())
+        {
+            findInTree(tree->GetStaticTree());
+        }
+    }
+    else
+    {
+        // No hierarchy to traverse best-first so get the distances of all the fixture
+        // children whose proxies are within range.
+        Query(world, GetFattenedAABB(AABB{point}, maxDistance), [&](Fixture* fixture,
+                                                                    ChildCounter child) {
+            const auto distance = GetDistance(*fixture, child, point);
+            if (distance <= maxDistance)
+            {
+                found.push_back(FixtureChildDistance{fixture, child, distance});
+            }
+            return true;
+        });
+    }
+    std::stable_sort(begin(found), end(found), [](const FixtureChildDistance& lhs,
+                                                  const FixtureChildDistance& rhs) {
+        return lhs.distance < rhs.distance;
+    });
+    if (size(found) > count)
+    {
+        found.resize(count);
+    }
+}
+
+FixtureRayCastOutput RayCastClosest(const World& world, const RayCastInput& input)
+{
+    if (const auto tree = world.GetBroadPhase().Get<TreeBroadPhase>())
+    {
+        return RayCastClosest(*tree, input);
+    }
+    // No hierarchy to traverse front-to-back so clip the ray to every closer hit instead.
+    auto result = FixtureRayCastOutput{};
+    world.GetBroadPhase().Visit([&](const auto& broadPhase) {
+        RayCast(broadPhase, input, [&](Fixture* fixture, ChildCounter child,
+                                       const RayCastInput& in) {
+            const auto output = RayCast(*fixture, child, in);
+            if (!output.has_value())
+            {
+                return Real{in.maxFraction};
+            }
+            if (!result.has_value() || (output->fraction < result->fraction))
+            {
+                const auto fraction = Real{output->fraction};
+                result = FixtureRayCastHit{
+                    fixture, child, in.p1 + (in.p2 - in.p1) * fraction,
+                    output->normal, output->fraction
+                };
+            }
+            return Real{output->fraction};
+        });
+    });
+    return result;
+}
+
+void RayCastClosest(const World& world, Span<const RayCastInput> inputs,
+                    Span<FixtureRayCastOutput> outputs)
+{
+    if (size(outputs) < size(inputs))
+    {
+        throw InvalidArgument("too few outputs");
+    }
+    if (const auto tree = world.GetBroadPhase().Get<TreeBroadPhase>())
+    {
+        RayCastClosest(*tree, inputs, outputs);
+        return;
+    }
+    for (auto i = std::size_t{0}; i < size(inputs); ++i)
+    {
+        outputs[i] = RayCastClosest(world, inputs[i]);
+    }
+}
+
+FixtureShapeCastOutput ShapeCast(const World& world, const DistanceProxy& proxy,
+                                 const Sweep& sweep, Filter filter, ToiConf conf)
+{
+    struct Candidate
+    {
+        Fixture* fixture; ///< Fixture.
+        ChildCounter childIndex; ///< Child index of the fixture's shape.
+        Real time; ///< Time factor at which the bounds start to overlap.
+    };
+    
+    assert(sweep.GetAlpha0() == 0);
+    const auto delta = sweep.pos1.linear - sweep.pos0.linear;
+    auto aabb = ComputeAABB(proxy, GetTransform0(sweep));
+    if (sweep.pos0.angular != sweep.pos1.angular)
+    {
+        // The shape rotates about its center so a disk around the center bounds it instead.
+        auto radius = 0_m;
+        for (const auto& vertex: proxy.GetVertices())
+        {
+            radius = std::max(radius, GetMagnitude(vertex - sweep.GetLocalCenter()));
+        }
+        radius += proxy.GetVertexRadius();
+        aabb = GetFattenedAABB(AABB{sweep.pos0.linear}, radius);
+    }
+    auto sweptAABB = GetMovedAABB(aabb, delta);
+    Include(sweptAABB, aabb);
+    
+    auto candidates = std::vector<Candidate>{};
+    const auto addCandidate = [&](Fixture* fixture, ChildCounter child) {
+        if (ShouldCollide(filter, fixture->GetFilterData()))
+        {
+            const auto childAABB = ComputeAABB(GetChild(fixture->GetShape(), child),
+                                               fixture->GetBody()->GetTransformation());
+            const auto time = GetSweptEntryTime(aabb, delta, childAABB);
+            if (time <= conf.tMax)
+            {
+                candidates.push_back(Candidate{fixture, child, time});
+            }
+        }
+        return true;
+    };
+    // Fixtures without any of the categories of the mask bits are skipped unless a positive
+    // group index could override the mask bits.
+    if (filter.groupIndex > 0)
+    {
+        Query(world, sweptAABB, addCandidate);
+    }
+    else
+    {
+        Query(world, sweptAABB, filter.maskBits, addCandidate);
+    }
+    std::stable_sort(begin(candidates), end(candidates), [](const Candidate& lhs,
+                                                            const Candidate& rhs) {
+        return lhs.time < rhs.time;
+    });
+    
+    auto earliest = static_cast<const Candidate*>(nullptr);
+    auto earliestTime = Real{0};
+    for (const auto& candidate: candidates)
+    {
+        if (earliest && (candidate.time >= conf.tMax))
+        {
+            break; // Remaining candidates can't be hit any earlier.
+        }
+        const auto body = candidate.fixture->GetBody();
+        const auto output = GetToiViaSat(proxy, sweep,
+                                         GetChild(candidate.fixture->GetShape(), candidate.childIndex),
+                                         Sweep{Position{body->GetLocation(), body->GetAngle()}}, conf);
+        if ((output.state == TOIOutput::e_touching) || (output.state == TOIOutput::e_overlapped))
+        {
+            if (!earliest || (output.time < earliestTime))
+            {
+                earliest = &candidate;
+                earliestTime = output.time;
+                conf.UseTimeMax(output.time);
+            }
+        }
+    }
+    if (!earliest)
+    {
+        return FixtureShapeCastOutput{};
+    }
+    
+    // Gets where the shapes touch from the closest points of the shapes at the time of impact.
+    const auto childProxy = GetChild(earliest->fixture->GetShape(), earliest->childIndex);
+    const auto output = Distance(proxy, GetTransformation(sweep, earliestTime), childProxy,
+                                 earliest->fixture->GetBody()->GetTransformation());
+    const auto witnessPoints = GetWitnessPoints(output.simplex);
+    const auto normal = GetUnitVector(std::get<0>(witnessPoints) - std::get<1>(witnessPoints),
+                                      UnitVec::GetZero());
+    const auto point = std::get<1>(witnessPoints) + normal * childProxy.GetVertexRadius();
+    return FixtureShapeCastOutput{
+        FixtureShapeCastHit{earliest->fixture, earliest->childIndex, earliestTime, point, normal}
+    };
+}
+
 } // namespace d2
 
 RegStepStats& Update(RegStepStats& lhs, const IslandStats& rhs) noexcept
@@ -34,7 +34,11 @@
 #include <PlayRho/Dynamics/WorldCallbacks.hpp>
 #include <PlayRho/Dynamics/StepStats.hpp>
 #include <PlayRho/Collision/DynamicTree.hpp>
+#include <PlayRho/Collision/RayCastOutput.hpp>
+#include <PlayRho/Collision/TimeOfImpact.hpp>
+#include <PlayRho/Dynamics/BroadPhase.hpp>
 #include <PlayRho/Dynamics/Contacts/ContactKey.hpp>
+#include <PlayRho/Dynamics/Contacts/ContactKeySet.hpp>
 #include <PlayRho/Dynamics/ContactAtty.hpp>
 #include <PlayRho/Dynamics/JointAtty.hpp>
 #include <PlayRho/Dynamics/IslandStats.hpp>
@@ -342,8 +346,31 @@ public:
     void SetSubStepping(bool flag) noexcept;
 
     /// @brief Gets access to the broad-phase dynamic tree information.
+    /// @note This is the tree of all the fixture proxies unless this world was constructed
+    ///   to use a separate static tree. In that case, it's the tree of only the proxies
+    ///   of non-static bodies.
+    /// @note This is an empty tree for other than the <code>BroadPhaseType::DynamicTree</code>
+    ///   broad-phase.
+    /// @sa GetStaticTree, GetBroadPhase.
     const DynamicTree& GetTree() const noexcept;
 
+    /// @brief Gets access to the broad-phase static tree information.
+    /// @note This is the tree of the fixture proxies of static bodies if this world was
+    ///   constructed to use a separate static tree, or an empty tree otherwise.
+    /// @sa GetTree, WorldConf::separateStaticTree.
+    const DynamicTree& GetStaticTree() const noexcept;
+
+    /// @brief Gets whether this world keeps the proxies of static bodies in a separate tree.
+    bool IsSeparateStaticTree() const noexcept;
+
+    /// @brief Gets the type of broad-phase this world keeps its fixture proxies in.
+    /// @sa WorldConf::broadPhase.
+    BroadPhaseType GetBroadPhaseType() const noexcept;
+
+    /// @brief Gets access to the broad-phase that this world keeps its fixture proxies in.
+    /// @sa WorldConf::broadPhase.
+    const BroadPhase& GetBroadPhase() const noexcept;
+
     /// @brief Is the world locked (in the middle of a time step).
     bool IsLocked() const noexcept;
 
@@ -642,6 +669,10 @@ private:
         
         /// @brief Number of contacts skipped because they weren't marked as needing updating.
         ContactCounter skipped = 0;
+
+        /// @brief Number of contacts not updated because their shapes were known to be
+        ///   too far apart to touch. @sa Contact::GetSeparationBound.
+        ContactCounter separated = 0;
     };
     
     /// @brief Destroy contacts statistics.
@@ -665,6 +696,8 @@ private:
         ContactCounter numAtMaxSubSteps = 0; ///< # at max sub-steps (lower the better).
         ContactCounter numUpdatedTOI = 0; ///< # updated TOIs (made valid).
         ContactCounter numValidTOI = 0; ///< # already valid TOIs.
+        std::uint32_t sumDistIters = 0; ///< Sum of distance iterations.
+        std::uint32_t sumToiIters = 0; ///< Sum of TOI iterations (one distance calculation each).
     
         /// @brief Distance iterations type alias.
         using dist_iter_type = std::remove_const<decltype(DefaultMaxDistanceIters)>::type;
@@ -698,7 +731,34 @@ private:
     /// @brief Finds new contacts.
     /// @details Finds and adds new valid contacts to the contacts container.
     /// @note The new contacts will all have overlapping AABBs.
-    ContactCounter FindNewContacts();
+    /// @note Uses up to the configuration's maximum threads worth of threads for querying
+    ///   the dynamic tree. The contacts found and the order they're added in are the same
+    ///   regardless of how many threads are used.
+    /// @param conf Step configuration whose maximum threads setting is to be used.
+    ContactCounter FindNewContacts(const StepConf& conf);
+    
+    /// @brief Finds the keys of the pairs of overlapping tree proxies that include a
+    ///   proxy from the proxies queue.
+    /// @details Fills the proxy keys with the keys sorted and without duplicates.
+    /// @param broadPhase Tree broad-phase having the proxies.
+    /// @param conf Step configuration whose maximum threads setting is to be used.
+    void FindKeys(const TreeBroadPhase& broadPhase, const StepConf& conf);
+    
+    /// @brief Finds the keys of the pairs of overlapping sweep and prune proxies that
+    ///   include a proxy from the proxies queue.
+    /// @details Fills the proxy keys with the keys sorted and without duplicates. These
+    ///   are keys for the same pairs of fixtures as the tree broad-phase gets.
+    /// @param broadPhase Sweep and prune broad-phase having the proxies. Gets sorted.
+    /// @param conf Step configuration.
+    void FindKeys(SweepAndPrune& broadPhase, const StepConf& conf);
+    
+    /// @brief Finds the keys of the pairs of overlapping uniform grid proxies that
+    ///   include a proxy from the proxies queue.
+    /// @details Fills the proxy keys with the keys sorted and without duplicates. These
+    ///   are keys for the same pairs of fixtures as the tree broad-phase gets.
+    /// @param broadPhase Uniform grid broad-phase having the proxies.
+    /// @param conf Step configuration.
+    void FindKeys(const UniformGrid& broadPhase, const StepConf& conf);
     
     /// @brief Processes the narrow phase collision for the contacts collection.
     /// @details
@@ -707,6 +767,13 @@ private:
     /// have active bodies (either or both) get their Update methods called with the current
     /// contact listener as its argument.
     /// Essentially this really just purges contacts that are no longer relevant.
+    /// @note Only the contacts of the proxies that were moved or touched since this was last
+    ///   called are checked. Other contacts can't have stopped overlapping and can't have been
+    ///   flagged for filtering by this world. This makes the work done here scale with the
+    ///   movement in the world rather than with the number of contacts in the world.
+    /// @note Contacts flagged for filtering through <code>Contact::FlagForFiltering</code>
+    ///   alone, unlike through <code>Fixture::Refilter</code> or joints that disable
+    ///   collision, only get filtered once a proxy of theirs moves or gets touched.
     DestroyContactsStats DestroyContacts(Contacts& contacts);
     
     /// @brief Update contacts.
@@ -735,6 +802,13 @@ private:
     /// @sa bool ShouldCollide(const Body& lhs, const Body& rhs) noexcept
     bool Add(ContactKey key);
     
+    /// @brief Rebuilds the trees whose quality has degraded too much.
+    /// @details Uses the step configuration's max tree degradation to determine whether
+    ///   trees need rebuilding and its max threads for how many threads to rebuild with.
+    /// @note The static tree is only checked when it's changed.
+    /// @sa StepConf::maxTreeDegradation.
+    void RebuildTrees(const StepConf& conf);
+
     /// @brief Registers the given dynamic tree ID for processing.
     void RegisterForProcessing(ProxyId pid) noexcept;
 
@@ -776,6 +850,16 @@ private:
     /// @brief Creates and destroys proxies for the given fixture.
     void CreateAndDestroyProxies(Fixture& fixture, const StepConf& conf);
     
+    /// @brief Updates the recent displacement of the given body with the given displacement
+    ///   of its origin over the last step.
+    /// @details The recent displacement holds onto the peak displacement while decaying so
+    ///   that a body that moves in bursts doesn't get its proxies updated for each burst.
+    static void UpdateRecentDisplacement(Body& body, Length2 displacement) noexcept;
+    
+    /// @brief Gets the AABB extension to fatten the proxies of the given body by.
+    /// @sa StepConf::aabbPredictionSteps.
+    static Length GetAabbExtension(const Body& body, const StepConf& conf) noexcept;
+    
     /// @brief Synchronizes proxies of the bodies for proxies.
     PreStepStats::counter_type SynchronizeProxies(const StepConf& conf);
 
@@ -808,10 +892,11 @@ private:
 
     /******** Member variables. ********/
     
-    DynamicTree m_tree; ///< Dynamic tree.
+    BroadPhase m_broadPhase; ///< Broad-phase having the fixture proxies.
     
     ContactKeyQueue m_proxyKeys; ///< Proxy keys.
     ProxyQueue m_proxies; ///< Proxies queue.
+    ProxyQueue m_movedProxies; ///< Proxies moved or touched since contacts were last destroyed.
     Fixtures m_fixturesForProxies; ///< Fixtures for proxies queue.
     Bodies m_bodiesForProxies; ///< Bodies for proxies queue.
     
@@ -823,6 +908,10 @@ private:
     /// @note In the <em>add pair</em> stress-test, 401 bodies can have some 31000 contacts
     ///   during a given time step.
     Contacts m_contacts;
+
+    /// @brief Keys of the contacts in the contacts container.
+    /// @details Used for quickly determining whether a contact already exists.
+    ContactKeySet m_contactKeys;
     
     DestructionListener* m_destructionListener = nullptr; ///< Destruction listener. 8-bytes.
     
@@ -962,9 +1051,20 @@ inline Frequency World::GetInvDeltaTime() const noexcept
     return m_inv_dt0;
 }
 
-inline const DynamicTree& World::GetTree() const noexcept
+inline bool World::IsSeparateStaticTree() const noexcept
+{
+    const auto tree = m_broadPhase.Get<TreeBroadPhase>();
+    return tree && tree->IsSeparateStaticTree();
+}
+
+inline BroadPhaseType World::GetBroadPhaseType() const noexcept
 {
-    return m_tree;
+    return m_broadPhase.GetType();
+}
+
+inline const BroadPhase& World::GetBroadPhase() const noexcept
+{
+    return m_broadPhase;
 }
 
 inline void World::SetDestructionListener(DestructionListener* listener) noexcept
@@ -1026,6 +1126,7 @@ inline void World::RegisterForProcessing(ProxyId pid) noexcept
 {
     assert(pid != DynamicTree::GetInvalidSize());
     m_proxies.push_back(pid);
+    m_movedProxies.push_back(pid);
 }
 
 // Free functions.
@@ -1148,9 +1249,289 @@ inline void ClearForces(World& world) noexcept
 }
 
 /// @brief Finds body in given world that's closest to the given location.
+/// @note This compares the locations of the bodies and checks every body in the world.
+///   Use <code>FindClosestFixture</code> to find the closest body by its fixtures using
+///   the world's broad-phase instead.
 /// @relatedalso World
 Body* FindClosestBody(const World& world, Length2 location) noexcept;
 
+/// @brief Fixture child distance.
+/// @details Identifies a child of a fixture's shape and its distance from some point.
+struct FixtureChildDistance
+{
+    Fixture* fixture = nullptr; ///< Fixture or <code>nullptr</code> if there's none.
+    ChildCounter childIndex = 0; ///< Child index of the fixture's shape.
+    Length distance = std::numeric_limits<Length>::infinity(); ///< Distance from the point.
+};
+
+/// @brief Finds the fixture child in the given world that's closest to the given point.
+/// @details Traverses the world's dynamic trees best-first so only the proxies whose
+///   AABBs are closer than the closest fixture child have their distances calculated.
+/// @note Use the fixture's body for the closest body.
+/// @param world World to find the closest fixture child in.
+/// @param point Point in world coordinates.
+/// @param maxDistance Maximum distance from the point of the fixture child to find.
+/// @return Closest fixture child within the maximum distance of the point having a zero
+///   distance if the point is within it, or a value having a null fixture if there's none.
+/// @relatedalso World
+FixtureChildDistance FindClosestFixture(const World& world, Length2 point,
+                                        Length maxDistance = std::numeric_limits<Length>::infinity());
+
+/// @brief Finds the given count of fixture children in the given world that are closest
+///   to the given point.
+/// @details Traverses the world's dynamic trees best-first so only the proxies whose
+///   AABBs are closer than the last fixture child to be found have their distances
+///   calculated.
+/// @param world World to find the closest fixture children in.
+/// @param point Point in world coordinates.
+/// @param count Maximum count of fixture children to find.
+/// @param found Buffer the found fixture children are written to ordered by increasing
+///   distance. This is cleared first. Its capacity is reused so it doesn't need
+///   reallocating when used for similar finds.
+/// @param maxDistance Maximum distance from the point of the fixture children to find.
+/// @relatedalso World
+void FindClosestFixtures(const World& world, Length2 point, std::size_t count,
+                         std::vector<FixtureChildDistance>& found,
+                         Length maxDistance = std::numeric_limits<Length>::infinity());
+
+/// @brief Ray-casts the given world for the closest fixture child in the path of the ray.
+/// @details Ray-casts whichever broad-phase the world keeps its proxies in. Dynamic trees
+///   get traversed front-to-back so the sub-trees that the ray enters beyond the closest
+///   hit found so far don't get visited.
+/// @note The ray-cast ignores shapes that contain the starting point.
+/// @param world World to ray cast.
+/// @param input Ray cast input data.
+/// @return Closest hit if the ray hit anything, or an empty value otherwise.
+/// @sa RayCastClosest(const DynamicTree&, const RayCastInput&).
+/// @relatedalso World
+FixtureRayCastOutput RayCastClosest(const World& world, const RayCastInput& input);
+
+/// @brief Ray-casts the given world for the closest fixture children in the paths of the
+///   given packet of rays.
+/// @details Traverses dynamic trees once for all of the rays. The other broad-phases get
+///   ray-cast for one ray at a time.
+/// @param world World to ray cast.
+/// @param inputs Ray cast input data of the rays.
+/// @param outputs Output data for the rays. Gets set to the closest hit of the ray at the
+///   same index of the inputs or to an empty value for rays that didn't hit anything.
+/// @throws InvalidArgument if the outputs has fewer elements than the inputs.
+/// @sa RayCastClosest(const DynamicTree&, Span<const RayCastInput>, Span<FixtureRayCastOutput>).
+/// @relatedalso World
+void RayCastClosest(const World& world, Span<const RayCastInput> inputs,
+                    Span<FixtureRayCastOutput> outputs);
+
+/// @brief Fixture shape cast hit data.
+/// @details Identifies the child of a fixture that a swept shape hits first and where the
+///   swept shape hits it.
+struct FixtureShapeCastHit
+{
+    Fixture* fixture = nullptr; ///< Fixture that was hit.
+    ChildCounter childIndex = 0; ///< Child index of the fixture's shape that was hit.
+    
+    /// @brief Time factor in the range of [0,1] of the sweep at which the shapes touch.
+    Real time = 0;
+    
+    Length2 point; ///< Point on the hit fixture child's surface in world coordinates.
+    
+    /// @brief Surface normal of the hit fixture child at the point in world coordinates.
+    /// @note This is invalid if the shapes' cores overlap at the time.
+    UnitVec normal;
+};
+
+/// @brief Fixture shape cast output.
+/// @details This is a type alias for an optional <code>FixtureShapeCastHit</code> instance.
+using FixtureShapeCastOutput = Optional<FixtureShapeCastHit>;
+
+/// @brief Shape-casts the given world for the fixture child that the given shape hits
+///   first while being swept along the given sweep.
+/// @details Queries the broad-phase for the fixture children within the AABB of the whole
+///   sweep and orders them by the time at which the swept shape's bounds start to overlap
+///   theirs. Then it gets the time of impact with each of them using the separating axis
+///   theorem until the next one couldn't be hit any earlier than the earliest hit found so
+///   far. Every time of impact calculation is limited to that earliest hit too.
+/// @note Fixtures are treated as staying where they are.
+/// @pre The given sweep's alpha 0 is 0.
+/// @param world World to shape cast.
+/// @param proxy Distance proxy of the shape to sweep. Its vertex count must be 1 or more.
+/// @param sweep Sweep of motion of the shape.
+/// @param filter Filter data of the swept shape. Only fixtures that should collide with
+///   the swept shape according to the fixtures' filter data get hit.
+/// @param conf Time of impact configuration. Its time max limits how far along the sweep
+///   the shape gets cast.
+/// @return Earliest hit if the swept shape hits anything, or an empty value otherwise.
+/// @sa GetToiViaSat, ShouldCollide.
+/// @relatedalso World
+FixtureShapeCastOutput ShapeCast(const World& world, const DistanceProxy& proxy,
+                                 const Sweep& sweep, Filter filter = Filter{},
+                                 ToiConf conf = GetDefaultToiConf());
+
+/// @brief Queries the given world for all fixtures that potentially overlap the given AABB.
+/// @details Queries whichever broad-phase the world keeps its proxies in. Covers the
+///   world's static tree too when the world keeps static proxies in a separate tree.
+/// @param world World to query.
+/// @param aabb The query box.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature.
+///   It returns <code>false</code> to terminate the query.
+/// @sa Query(const DynamicTree&, const AABB&, F&&).
+/// @relatedalso World
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const World& world, const AABB& aabb, F&& callback)
+{
+    world.GetBroadPhase().Visit([&](const auto& broadPhase) {
+        Query(broadPhase, aabb, callback);
+    });
+}
+
+/// @brief Ray-casts the given world for all fixtures in the path of the ray.
+/// @details Ray-casts whichever broad-phase the world keeps its proxies in. Covers the
+///   world's static tree too when the world keeps static proxies in a separate tree.
+///   Any clipping of the ray by the callback carries over from one tree to the other.
+/// @param world World to ray cast.
+/// @param input Ray cast input data.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+/// @sa RayCast(const DynamicTree&, const RayCastInput&, F&&).
+/// @relatedalso World
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const World& world, const RayCastInput& input, F&& callback)
+{
+    return world.GetBroadPhase().Visit([&](const auto& broadPhase) {
+        return RayCast(broadPhase, input, callback);
+    });
+}
+
+/// @brief Queries the given world for all fixtures that potentially overlap the given AABB
+///   and whose collision category bits have any of the given mask bits.
+/// @details Prunes whole sub-trees of dynamic tree broad-phases that don't have any
+///   fixtures with matching category bits.
+/// @param world World to query.
+/// @param aabb The query box.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature.
+///   It returns <code>false</code> to terminate the query.
+/// @sa Filter
+/// @relatedalso World
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+Query(const World& world, const AABB& aabb, Filter::bits_type maskBits, F&& callback)
+{
+    world.GetBroadPhase().Visit([&](const auto& broadPhase) {
+        Query(broadPhase, aabb, maskBits, callback);
+    });
+}
+
+/// @brief Ray-casts the given world for all fixtures in the path of the ray whose
+///   collision category bits have any of the given mask bits.
+/// @details Prunes whole sub-trees of dynamic tree broad-phases that don't have any
+///   fixtures with matching category bits.
+/// @param world World to ray cast.
+/// @param input Ray cast input data.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>FixtureRayCastCB</code> signature.
+/// @return <code>true</code> if terminated by callback, <code>false</code> otherwise.
+/// @sa Filter
+/// @relatedalso World
+template <typename F>
+std::enable_if_t<std::is_invocable_r<RayCastOpcode, F, Fixture*, ChildCounter, Length2, UnitVec>::value, bool>
+RayCast(const World& world, const RayCastInput& input, Filter::bits_type maskBits,
+        F&& callback)
+{
+    return world.GetBroadPhase().Visit([&](const auto& broadPhase) {
+        return RayCast(broadPhase, input, maskBits, callback);
+    });
+}
+
+/// @brief Queries the given world for all fixture children containing the given point.
+/// @details Tests the point for containment in the children whose proxies' AABBs
+///   contain the point.
+/// @param world World to query.
+/// @param point Point in world coordinates.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature
+///   that's called for each fixture child containing the point. It returns
+///   <code>false</code> to terminate the query.
+/// @sa TestPoint(const Fixture&, ChildCounter, Length2).
+/// @relatedalso World
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+QueryPoint(const World& world, Length2 point, F&& callback)
+{
+    Query(world, AABB{point}, [&](Fixture* fixture, ChildCounter child) {
+        return !TestPoint(*fixture, child, point) || callback(fixture, child);
+    });
+}
+
+/// @brief Queries the given world for all fixture children touching or overlapping the
+///   given shape child.
+/// @details Tests the shape child for overlap with the children whose proxies' AABBs
+///   overlap the shape child's AABB. Uses direct overlap tests for disks and boxes.
+/// @param world World to query.
+/// @param proxy Distance proxy of the shape child to query with.
+/// @param xf Transformation of the shape child in world coordinates.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature
+///   that's called for each fixture child overlapping the shape child. It returns
+///   <code>false</code> to terminate the query.
+/// @sa IsOverlapping(const Fixture&, ChildCounter, const DistanceProxy&, const Transformation&).
+/// @relatedalso World
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+QueryOverlap(const World& world, const DistanceProxy& proxy, const Transformation& xf,
+             F&& callback)
+{
+    Query(world, ComputeAABB(proxy, xf), [&](Fixture* fixture, ChildCounter child) {
+        return !IsOverlapping(*fixture, child, proxy, xf) || callback(fixture, child);
+    });
+}
+
+/// @brief Queries the given world for all fixture children touching or overlapping the
+///   given shape child and whose collision category bits have any of the given mask bits.
+/// @details Prunes whole sub-trees of dynamic tree broad-phases that don't have any
+///   fixtures with matching category bits.
+/// @param world World to query.
+/// @param proxy Distance proxy of the shape child to query with.
+/// @param xf Transformation of the shape child in world coordinates.
+/// @param maskBits Mask of the category bits to call back for fixtures having any of.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature
+///   that's called for each fixture child overlapping the shape child. It returns
+///   <code>false</code> to terminate the query.
+/// @relatedalso World
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+QueryOverlap(const World& world, const DistanceProxy& proxy, const Transformation& xf,
+             Filter::bits_type maskBits, F&& callback)
+{
+    Query(world, ComputeAABB(proxy, xf), maskBits, [&](Fixture* fixture, ChildCounter child) {
+        return !IsOverlapping(*fixture, child, proxy, xf) || callback(fixture, child);
+    });
+}
+
+/// @brief Queries the given world for all fixture children touching or overlapping the
+///   given shape.
+/// @note Fixture children overlapping more than one of the shape's children get called
+///   back once for each of those.
+/// @param world World to query.
+/// @param shape Shape to query with.
+/// @param xf Transformation of the shape in world coordinates.
+/// @param callback Callable object having the <code>QueryFixtureCallback</code> signature
+///   that's called for each fixture child overlapping the shape. It returns
+///   <code>false</code> to terminate the query.
+/// @relatedalso World
+template <typename F>
+std::enable_if_t<std::is_invocable_r<bool, F, Fixture*, ChildCounter>::value>
+QueryOverlap(const World& world, const Shape& shape, const Transformation& xf, F&& callback)
+{
+    auto proceed = true;
+    const auto childCount = GetChildCount(shape);
+    for (auto i = ChildCounter{0}; proceed && (i < childCount); ++i)
+    {
+        QueryOverlap(world, GetChild(shape, i), xf, [&](Fixture* fixture, ChildCounter child) {
+            proceed = callback(fixture, child);
+            return proceed;
+        });
+    }
+}
+
 } // namespace d2
 
 /// @brief Updates the given regular step statistics.
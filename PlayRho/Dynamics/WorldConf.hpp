@@ -27,9 +27,31 @@
 #include <PlayRho/Common/Math.hpp>
 #include <PlayRho/Common/BoundedValue.hpp>
 
+#include <cstdint>
+
 namespace playrho {
 namespace d2 {
 
+/// @brief Broad-phase type enumeration.
+/// @details Identifies the data structure that a world keeps its fixture proxies in.
+enum class BroadPhaseType: std::uint8_t
+{
+    /// @brief Dynamic tree.
+    /// @details Proxies are kept in a bounding volume hierarchy.
+    /// @sa DynamicTree.
+    DynamicTree,
+    
+    /// @brief Sweep and prune.
+    /// @details Proxies are kept sorted along the axis they're most spread out along.
+    /// @sa SweepAndPrune.
+    SweepAndPrune,
+    
+    /// @brief Uniform grid.
+    /// @details Proxies are kept in the hashed cells of a grid of equally sized cells.
+    /// @sa UniformGrid, WorldConf::gridCellSize.
+    UniformGrid,
+};
+
 /// @brief World configuration data.
 struct WorldConf
 {
@@ -42,6 +64,15 @@ struct WorldConf
     /// @brief Uses the given value as the initial dynamic tree size.
     PLAYRHO_CONSTEXPR inline WorldConf& UseInitialTreeSize(ContactCounter value) noexcept;
     
+    /// @brief Uses the given value for whether to use a separate static tree.
+    PLAYRHO_CONSTEXPR inline WorldConf& UseSeparateStaticTree(bool value) noexcept;
+    
+    /// @brief Uses the given broad-phase type.
+    PLAYRHO_CONSTEXPR inline WorldConf& UseBroadPhase(BroadPhaseType value) noexcept;
+    
+    /// @brief Uses the given grid cell size.
+    PLAYRHO_CONSTEXPR inline WorldConf& UseGridCellSize(Positive<Length> value) noexcept;
+    
     /// @brief Minimum vertex radius.
     /// @details This is the minimum vertex radius that this world establishes which bodies
     ///    shall allow fixtures to be created with. Trying to create a fixture with a shape
@@ -63,6 +94,35 @@ struct WorldConf
     
     /// @brief Initial tree size.
     ContactCounter initialTreeSize = 4096;
+    
+    /// @brief Separate static tree.
+    /// @details Whether the fixture proxies of static bodies are kept in a tree of their
+    ///   own. When they are, that tree is only changed when static bodies are, proxies of
+    ///   static bodies are never queried against each other, and the other tree only
+    ///   holds the proxies that can move. This speeds up finding new contacts and
+    ///   updating the moved proxies for worlds having lots of static geometry.
+    /// @note Contacts are then ordered differently so simulations won't be bit-identical
+    ///   to ones without a separate static tree.
+    /// @note This only applies to the <code>BroadPhaseType::DynamicTree</code> broad-phase.
+    bool separateStaticTree = false;
+    
+    /// @brief Broad-phase.
+    /// @details Type of data structure the world keeps its fixture proxies in. The same
+    ///   pairs of fixtures are found to be overlapping regardless.
+    /// @note Contacts are ordered differently for other than the default broad-phase
+    ///   so simulations won't be bit-identical to ones with the default broad-phase.
+    /// @note <code>World::GetTree()</code> is empty for other than the
+    ///   <code>BroadPhaseType::DynamicTree</code> broad-phase. Use the <code>World</code>
+    ///   taking <code>Query</code> and <code>RayCast</code> functions to query the
+    ///   world regardless of its broad-phase.
+    BroadPhaseType broadPhase = BroadPhaseType::DynamicTree;
+    
+    /// @brief Grid cell size.
+    /// @details Width and height of the cells of the <code>BroadPhaseType::UniformGrid</code>
+    ///   broad-phase. This works best at about the size of the fattened AABBs of most of
+    ///   the fixtures, like the diameter of the disks in a world of similarly sized disks.
+    /// @note This only applies to the <code>BroadPhaseType::UniformGrid</code> broad-phase.
+    Positive<Length> gridCellSize = 2_m;
 };
 
 PLAYRHO_CONSTEXPR inline WorldConf& WorldConf::UseMinVertexRadius(Positive<Length> value) noexcept
@@ -83,6 +143,24 @@ PLAYRHO_CONSTEXPR inline WorldConf& WorldConf::UseInitialTreeSize(ContactCounter
     return *this;
 }
 
+PLAYRHO_CONSTEXPR inline WorldConf& WorldConf::UseSeparateStaticTree(bool value) noexcept
+{
+    separateStaticTree = value;
+    return *this;
+}
+
+PLAYRHO_CONSTEXPR inline WorldConf& WorldConf::UseBroadPhase(BroadPhaseType value) noexcept
+{
+    broadPhase = value;
+    return *this;
+}
+
+PLAYRHO_CONSTEXPR inline WorldConf& WorldConf::UseGridCellSize(Positive<Length> value) noexcept
+{
+    gridCellSize = value;
+    return *this;
+}
+
 /// Gets the default definitions value.
 /// @note This method exists as a work-around for providing the World constructor a default
 ///   value without otherwise getting a compiler error such as:
@@ -418,6 +418,16 @@ TEST(AABB, StreamOutputOperator)
     EXPECT_STREQ(aabbStream.str().c_str(), comp.c_str());
 }
 
+TEST(AABB, GetDistanceSquared)
+{
+    const auto aabb = AABB{Length2{1_m, 2_m}, Length2{3_m, 4_m}};
+    EXPECT_EQ(GetDistanceSquared(aabb, Length2{2_m, 3_m}), 0_m2);
+    EXPECT_EQ(GetDistanceSquared(aabb, Length2{1_m, 4_m}), 0_m2);
+    EXPECT_EQ(GetDistanceSquared(aabb, Length2{0_m, 3_m}), 1_m2);
+    EXPECT_EQ(GetDistanceSquared(aabb, Length2{2_m, 6_m}), 4_m2);
+    EXPECT_EQ(GetDistanceSquared(aabb, Length2{6_m, 0_m}), 13_m2);
+}
+
 TEST(AABB, ComputeAabbForFixtureAtBodyOrigin)
 {
     const auto shape = DiskShapeConf{};
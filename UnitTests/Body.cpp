@@ -146,24 +146,24 @@ TEST(Body, ByteSize)
     {
         case  4:
 #if defined(_WIN64)
-            EXPECT_EQ(sizeof(Body), std::size_t(192));
+            EXPECT_EQ(sizeof(Body), std::size_t(200));
 #elif defined(_WIN32)
 #if !defined(NDEBUG)
             // Win32 debug
-            EXPECT_EQ(sizeof(Body), std::size_t(192));
+            EXPECT_EQ(sizeof(Body), std::size_t(200));
 #else
             // Win32 release
-            EXPECT_EQ(sizeof(Body), std::size_t(144));
+            EXPECT_EQ(sizeof(Body), std::size_t(148));
 #endif
 #else
-            EXPECT_EQ(sizeof(Body), std::size_t(192));
+            EXPECT_EQ(sizeof(Body), std::size_t(200));
 #endif
             break;
         case  8:
-            EXPECT_EQ(sizeof(Body), std::size_t(288));
+            EXPECT_EQ(sizeof(Body), std::size_t(296));
             break;
         case 16:
-            EXPECT_EQ(sizeof(Body), std::size_t(496));
+            EXPECT_EQ(sizeof(Body), std::size_t(512));
             break;
         default: FAIL(); break;
     }
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+
+#include "UnitTests.hpp"
+
+#include <PlayRho/Dynamics/BroadPhase.hpp>
+#include <vector>
+
+using namespace playrho;
+using namespace playrho::d2;
+
+TEST(BroadPhase, DefaultConstruction)
+{
+    const auto broadPhase = BroadPhase{};
+    EXPECT_EQ(broadPhase.GetType(), BroadPhaseType::DynamicTree);
+    EXPECT_NE(broadPhase.Get<TreeBroadPhase>(), nullptr);
+    EXPECT_EQ(broadPhase.Get<SweepAndPrune>(), nullptr);
+    EXPECT_EQ(broadPhase.Get<UniformGrid>(), nullptr);
+}
+
+TEST(BroadPhase, HoldsOnlyConfiguredType)
+{
+    for (const auto type: {BroadPhaseType::DynamicTree, BroadPhaseType::SweepAndPrune,
+        BroadPhaseType::UniformGrid})
+    {
+        const auto broadPhase = BroadPhase{WorldConf{}.UseBroadPhase(type)};
+        EXPECT_EQ(broadPhase.GetType(), type);
+        EXPECT_EQ(broadPhase.Get<TreeBroadPhase>() != nullptr,
+                  type == BroadPhaseType::DynamicTree);
+        EXPECT_EQ(broadPhase.Get<SweepAndPrune>() != nullptr,
+                  type == BroadPhaseType::SweepAndPrune);
+        EXPECT_EQ(broadPhase.Get<UniformGrid>() != nullptr,
+                  type == BroadPhaseType::UniformGrid);
+    }
+}
+
+TEST(BroadPhase, ProxyOperations)
+{
+    for (const auto type: {BroadPhaseType::DynamicTree, BroadPhaseType::SweepAndPrune,
+        BroadPhaseType::UniformGrid})
+    {
+        auto broadPhase = BroadPhase{WorldConf{}.UseBroadPhase(type).UseGridCellSize(1_m)};
+        const auto aabb0 = AABB{Length2{0_m, 0_m}, Length2{1_m, 1_m}};
+        const auto aabb1 = AABB{Length2{2_m, 2_m}, Length2{3_m, 3_m}};
+        const auto id = broadPhase.CreateProxy(aabb0, DynamicTree::LeafData{nullptr, nullptr, 2},
+                                               false);
+        EXPECT_NE(id, BroadPhase::GetInvalidSize());
+        EXPECT_EQ(broadPhase.GetAABB(id), aabb0);
+        EXPECT_EQ(broadPhase.GetLeafData(id).childIndex, ChildCounter(2));
+        broadPhase.UpdateProxy(id, aabb1);
+        EXPECT_EQ(broadPhase.GetAABB(id), aabb1);
+        broadPhase.SetLeafData(id, DynamicTree::LeafData{nullptr, nullptr, 3});
+        EXPECT_EQ(broadPhase.GetLeafData(id).childIndex, ChildCounter(3));
+        broadPhase.ShiftOrigin(Length2{1_m, 1_m});
+        EXPECT_EQ(broadPhase.GetAABB(id), (AABB{Length2{1_m, 1_m}, Length2{2_m, 2_m}}));
+        broadPhase.DestroyProxy(id);
+    }
+}
+
+TEST(BroadPhase, StaticProxiesInSeparateStaticTree)
+{
+    auto broadPhase = BroadPhase{WorldConf{}.UseSeparateStaticTree(true)};
+    const auto tree = broadPhase.Get<TreeBroadPhase>();
+    ASSERT_NE(tree, nullptr);
+    EXPECT_TRUE(tree->IsSeparateStaticTree());
+    const auto aabb = AABB{Length2{0_m, 0_m}, Length2{1_m, 1_m}};
+    const auto data = DynamicTree::LeafData{nullptr, nullptr, 0};
+    const auto staticId = broadPhase.CreateProxy(aabb, data, true);
+    const auto otherId = broadPhase.CreateProxy(aabb, data, false);
+    EXPECT_TRUE(TreeBroadPhase::IsStaticProxy(staticId));
+    EXPECT_FALSE(TreeBroadPhase::IsStaticProxy(otherId));
+    EXPECT_EQ(tree->GetStaticTree().GetLeafCount(), DynamicTree::Size(1));
+    EXPECT_EQ(tree->GetTree().GetLeafCount(), DynamicTree::Size(1));
+    EXPECT_EQ(broadPhase.GetAABB(staticId), aabb);
+    broadPhase.DestroyProxy(staticId);
+    EXPECT_EQ(tree->GetStaticTree().GetLeafCount(), DynamicTree::Size(0));
+}
+
+TEST(TreeBroadPhase, RebuildIfDegradedChecksPeriodically)
+{
+    // Any degradation factor this small has any checked tree get rebuilt.
+    const auto maxDegradation = Real(0.001);
+    const auto getRebuiltRatio = [](DynamicTree tree) {
+        tree.RebuildTopDown(1u);
+        return ComputePerimeterRatio(tree);
+    };
+
+    auto broadPhase = TreeBroadPhase{};
+    const auto data = DynamicTree::LeafData{nullptr, nullptr, 0};
+    auto ids = std::vector<TreeBroadPhase::Size>{};
+    for (auto i = 0; i < 64; ++i)
+    {
+        const auto x = Real((i * 37) % 100) * 1_m;
+        const auto y = Real((i * 53) % 97) * 1_m;
+        ids.push_back(broadPhase.CreateProxy(AABB{Length2{x, y}, Length2{x + 1_m, y + 1_m}},
+                                             data));
+    }
+    broadPhase.RebuildIfDegraded(maxDegradation, 1u);
+    EXPECT_EQ(ComputePerimeterRatio(broadPhase.GetTree()), getRebuiltRatio(broadPhase.GetTree()));
+
+    const auto moveAcross = [&](TreeBroadPhase::Size id) {
+        const auto aabb = broadPhase.GetAABB(id);
+        broadPhase.UpdateProxy(id, GetMovedAABB(aabb, Length2{99_m, 96_m} -
+                                                Real(2) * GetLowerBound(aabb)));
+    };
+    moveAcross(ids[0]);
+    const auto ratio = ComputePerimeterRatio(broadPhase.GetTree());
+    ASSERT_NE(ratio, getRebuiltRatio(broadPhase.GetTree()));
+
+    // Too few changes since the last check for the tree to get checked again.
+    broadPhase.RebuildIfDegraded(maxDegradation, 1u);
+    EXPECT_EQ(ComputePerimeterRatio(broadPhase.GetTree()), ratio);
+
+    // Enough changes since the last check for the tree to get checked again.
+    for (auto i = std::size_t{1}; i < 8; ++i)
+    {
+        moveAcross(ids[i * 9 % 64]);
+    }
+    broadPhase.RebuildIfDegraded(maxDegradation, 1u);
+    EXPECT_EQ(ComputePerimeterRatio(broadPhase.GetTree()), getRebuiltRatio(broadPhase.GetTree()));
+}
@@ -25,6 +25,10 @@
 #include <PlayRho/Collision/Shapes/DiskShapeConf.hpp>
 #include <PlayRho/Collision/Shapes/PolygonShapeConf.hpp>
 #include <PlayRho/Collision/Shapes/EdgeShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/ChainShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/MultiShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/Shape.hpp>
+#include <vector>
 
 using namespace playrho;
 using namespace playrho::d2;
@@ -1669,3 +1673,153 @@ TEST(CollideShapes, R0EdgePerpendicularCrossingFromR0Edge)
     EXPECT_NEAR(static_cast<double>(StripUnit(GetY(manifold.GetLocalPoint()))), 0.0, 0.0001);
     EXPECT_EQ(manifold.GetPointCount(), decltype(manifold.GetPointCount()){1});
 }
+
+TEST(CollideShapes, GetShapeKind)
+{
+    EXPECT_EQ(GetShapeKind(Shape{DiskShapeConf{}}), ShapeKind::Disk);
+    EXPECT_EQ(GetShapeKind(Shape{PolygonShapeConf{1_m, 1_m}}), ShapeKind::Polygon);
+    EXPECT_EQ(GetShapeKind(Shape{EdgeShapeConf{}}), ShapeKind::Edge);
+    EXPECT_EQ(GetShapeKind(Shape{ChainShapeConf{}}), ShapeKind::Chain);
+    EXPECT_EQ(GetShapeKind(Shape{MultiShapeConf{}}), ShapeKind::Other);
+}
+
+TEST(CollideShapes, ShapesDispatchMatchesDistanceProxies)
+{
+    auto hull = VertexSet{};
+    hull.add(Length2{0_m, 0_m});
+    hull.add(Length2{1_m, 0_m});
+    hull.add(Length2{0_m, 1_m});
+    auto multi = MultiShapeConf{};
+    multi.AddConvexHull(hull);
+    auto chain = ChainShapeConf{};
+    chain.Add(Length2{-2_m, 0_m});
+    chain.Add(Length2{0_m, 0.25_m});
+    chain.Add(Length2{2_m, 0_m});
+    auto point = PolygonShapeConf{};
+    auto single = VertexSet{};
+    single.add(Length2{0.5_m, 0_m});
+    point.Set(single);
+    point.UseVertexRadius(0.5_m);
+    ASSERT_EQ(point.GetVertexCount(), VertexCounter(1));
+    const auto shapes = std::vector<Shape>{
+        Shape{DiskShapeConf{0.75_m}},
+        Shape{PolygonShapeConf{1_m, 0.5_m}},
+        Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m, Length2{0.25_m, 0_m}, 30_deg)},
+        Shape{point},
+        Shape{EdgeShapeConf{Length2{-1_m, 0_m}, Length2{1_m, 0_m}}},
+        Shape{chain},
+        Shape{multi},
+    };
+    const auto xfA = Transformation{Length2{0_m, 0_m}, UnitVec::Get(10_deg)};
+    for (const auto& shapeA: shapes)
+    {
+        for (const auto& shapeB: shapes)
+        {
+            for (auto offset = Real(-1.5); offset <= Real(1.5); offset += Real(0.5))
+            {
+                const auto xfB = Transformation{Length2{offset * Meter, Real(0.5) * Meter},
+                    UnitVec::Get(-25_deg)};
+                for (auto indexA = ChildCounter{0}; indexA < GetChildCount(shapeA); ++indexA)
+                {
+                    for (auto indexB = ChildCounter{0}; indexB < GetChildCount(shapeB); ++indexB)
+                    {
+                        EXPECT_EQ(CollideShapes(shapeA, indexA, xfA, shapeB, indexB, xfB),
+                                  CollideShapes(GetChild(shapeA, indexA), xfA,
+                                                GetChild(shapeB, indexB), xfB));
+                    }
+                }
+            }
+        }
+    }
+    EXPECT_THROW(CollideShapes(shapes[0], 1, xfA, shapes[1], 0, xfA), InvalidArgument);
+    EXPECT_THROW(CollideShapes(shapes[1], 0, xfA, shapes[5], 2, xfA), InvalidArgument);
+}
+
+TEST(CollideShapes, GetManifoldsMatchesGetManifold)
+{
+    auto inputs = std::vector<PointManifoldInput>{};
+    for (auto i = 0; i < 23; ++i)
+    {
+        const auto angle = Real(i) * 0.7_rad;
+        inputs.push_back(PointManifoldInput{
+            Length2{Real(i % 3) * 0.1_m, -0.2_m},
+            Transformation{Length2{Real(i) * 0.1_m, 0_m}, UnitVec::Get(angle)},
+            Length2{0.3_m, Real(i % 5) * 0.05_m},
+            Transformation{Length2{Real(i) * 0.15_m, 0.5_m}, UnitVec::Get(-angle)},
+            Real(i % 4) * 0.4_m
+        });
+    }
+    auto manifolds = std::vector<Manifold>(size(inputs));
+    GetManifolds(inputs, manifolds);
+    auto touching = 0;
+    for (auto i = std::size_t{0}; i < size(inputs); ++i)
+    {
+        const auto& input = inputs[i];
+        EXPECT_EQ(manifolds[i], GetManifold(input.locationA, input.xfA,
+                                            input.locationB, input.xfB, input.totalRadius));
+        touching += (manifolds[i].GetPointCount() > 0)? 1: 0;
+    }
+    EXPECT_GT(touching, 0);
+    EXPECT_LT(touching, static_cast<int>(size(inputs)));
+
+    const auto diskA = Shape{DiskShapeConf{0.5_m}.UseLocation(Length2{0.1_m, 0_m})};
+    const auto diskB = Shape{DiskShapeConf{0.25_m}};
+    const auto xfB = Transformation{Length2{0.5_m, 0.2_m}, UnitVec::Get(30_deg)};
+    const auto input = GetPointManifoldInput(diskA, Transformation{}, diskB, xfB);
+    GetManifolds(Span<const PointManifoldInput>(&input, 1), manifolds);
+    EXPECT_EQ(manifolds[0], CollideShapes(diskA, 0, Transformation{}, diskB, 0, xfB));
+
+    EXPECT_THROW(GetManifolds(inputs, Span<Manifold>(manifolds.data(), 2)), InvalidArgument);
+}
+
+TEST(CollideShapes, SeparatingAxisMatchesUncached)
+{
+    const auto boxA = PolygonShapeConf{}.SetAsBox(0.5_m, 0.25_m);
+    const auto boxB = PolygonShapeConf{}.SetAsBox(0.3_m, 0.3_m);
+    const auto vertices = GetCircleVertices(0.4_m, 5);
+    const auto pentagon = PolygonShapeConf{}.Set(Span<const Length2>(vertices.data(), size(vertices)));
+    const std::pair<DistanceProxy, DistanceProxy> pairs[] = {
+        std::make_pair(GetChild(boxA, 0), GetChild(boxB, 0)),
+        std::make_pair(GetChild(boxA, 0), GetChild(pentagon, 0)),
+        std::make_pair(GetChild(pentagon, 0), GetChild(boxB, 0)),
+    };
+    for (const auto& pair: pairs)
+    {
+        auto axis = SeparatingAxis{};
+        auto touching = 0;
+        auto separated = 0;
+        for (auto i = 0; i < 60; ++i)
+        {
+            const auto xfA = Transformation{Length2{}, UnitVec::Get(Real(i) * 0.05_rad)};
+            const auto xfB = Transformation{Length2{Real(i % 30) * 0.05_m, 0.4_m},
+                                            UnitVec::Get(Real(i) * -0.11_rad)};
+            const auto manifold = CollideShapes(pair.first, xfA, pair.second, xfB, axis);
+            EXPECT_EQ(manifold, CollideShapes(pair.first, xfA, pair.second, xfB));
+            ASSERT_NE(axis.type, SeparatingAxis::e_unset);
+            const auto faceA = (axis.type == SeparatingAxis::e_faceA);
+            const auto separation = faceA?
+                GetSeparation(pair.first, xfA, axis.index, pair.second, xfB):
+                GetSeparation(pair.second, xfB, axis.index, pair.first, xfA);
+            if (manifold.GetPointCount() > 0)
+            {
+                ++touching;
+                EXPECT_EQ(manifold.GetType(), faceA? Manifold::e_faceA: Manifold::e_faceB);
+                EXPECT_LE(separation, pair.first.GetVertexRadius() + pair.second.GetVertexRadius());
+            }
+            else
+            {
+                ++separated;
+            }
+        }
+        EXPECT_GT(touching, 0);
+        EXPECT_GT(separated, 0);
+    }
+
+    // Disks have no edge normals so the axis isn't used nor changed for them.
+    auto axis = SeparatingAxis{SeparatingAxis::e_faceA, 7};
+    const auto disk = DiskShapeConf{0.5_m};
+    EXPECT_EQ(CollideShapes(GetChild(disk, 0), Transformation{}, GetChild(boxB, 0),
+                            Transformation{}, axis).GetPointCount(), Manifold::size_type(1));
+    EXPECT_EQ(axis.type, SeparatingAxis::e_faceA);
+    EXPECT_EQ(axis.index, VertexCounter(7));
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "UnitTests.hpp"
+
+#include <PlayRho/Collision/CompactTree.hpp>
+#include <vector>
+
+using namespace playrho;
+using namespace playrho::d2;
+
+namespace {
+
+std::vector<DynamicTree::Size> QueryLeaves(const DynamicTree& tree, const AABB& aabb)
+{
+    auto leaves = std::vector<DynamicTree::Size>{};
+    Query(tree, aabb, [&](DynamicTree::Size index) {
+        leaves.push_back(index);
+        return DynamicTreeOpcode::Continue;
+    });
+    return leaves;
+}
+
+std::vector<DynamicTree::Size> QueryLeaves(const CompactTree& tree, const AABB& aabb)
+{
+    auto leaves = std::vector<DynamicTree::Size>{};
+    Query(tree, aabb, [&](DynamicTree::Size index) {
+        leaves.push_back(index);
+        return DynamicTreeOpcode::Continue;
+    });
+    return leaves;
+}
+
+AABB GetBox(Real x, Real y, Real size)
+{
+    return AABB{Length2{x * Meter, y * Meter}, Length2{(x + size) * Meter, (y + size) * Meter}};
+}
+
+} // anonymous namespace
+
+TEST(CompactTree, DefaultConstruction)
+{
+    const auto tree = CompactTree{};
+    EXPECT_EQ(tree.GetNodeCount(), CompactTree::Size(0));
+    EXPECT_EQ(tree.GetLeafCount(), CompactTree::Size(0));
+    EXPECT_EQ(size(tree), std::size_t(0));
+    EXPECT_EQ(tree.GetBounds(), CompactTree::Bounds::Exact);
+    EXPECT_FALSE(tree.Quantize(GetBox(0, 0, 1)).has_value());
+    EXPECT_TRUE(QueryLeaves(tree, GetBox(0, 0, 1)).empty());
+}
+
+TEST(CompactTree, EmptyDynamicTree)
+{
+    const auto tree = CompactTree{DynamicTree{}, CompactTree::Bounds::Quantized};
+    EXPECT_EQ(tree.GetNodeCount(), CompactTree::Size(0));
+    EXPECT_EQ(tree.GetBounds(), CompactTree::Bounds::Quantized);
+    EXPECT_TRUE(QueryLeaves(tree, GetBox(0, 0, 1)).empty());
+}
+
+TEST(CompactTree, Layout)
+{
+    auto dynamicTree = DynamicTree{};
+    const auto leaf0 = dynamicTree.CreateLeaf(GetBox(0, 0, 1), DynamicTree::LeafData{});
+    const auto leaf1 = dynamicTree.CreateLeaf(GetBox(4, 0, 1), DynamicTree::LeafData{});
+    
+    const auto tree = CompactTree{dynamicTree};
+    ASSERT_EQ(tree.GetNodeCount(), CompactTree::Size(3));
+    EXPECT_EQ(tree.GetLeafCount(), CompactTree::Size(2));
+    EXPECT_FALSE(IsLeaf(tree, 0));
+    EXPECT_EQ(tree.GetEscapeIndex(0), CompactTree::Size(3));
+    EXPECT_EQ(tree.GetLeaf(0), DynamicTree::GetInvalidSize());
+    EXPECT_EQ(tree.GetAABB(0), GetAABB(dynamicTree));
+    EXPECT_TRUE(IsLeaf(tree, 1));
+    EXPECT_TRUE(IsLeaf(tree, 2));
+    EXPECT_EQ(tree.GetLeaf(1), leaf1);
+    EXPECT_EQ(tree.GetLeaf(2), leaf0);
+}
+
+TEST(CompactTree, Quantize)
+{
+    auto dynamicTree = DynamicTree{};
+    dynamicTree.CreateLeaf(GetBox(0, 0, 1), DynamicTree::LeafData{});
+    dynamicTree.CreateLeaf(GetBox(99, 99, 1), DynamicTree::LeafData{});
+    
+    const auto tree = CompactTree{dynamicTree, CompactTree::Bounds::Quantized};
+    const auto whole = tree.GetQuantizedAABB(0);
+    EXPECT_EQ(whole[0], 0u);
+    EXPECT_EQ(whole[1], 0u);
+    EXPECT_EQ(whole[2], 65535u);
+    EXPECT_EQ(whole[3], 65535u);
+    
+    EXPECT_FALSE(tree.Quantize(GetBox(200, 200, 1)).has_value());
+    const auto q = tree.Quantize(GetBox(-10, 50, 20));
+    ASSERT_TRUE(q.has_value());
+    EXPECT_EQ((*q)[0], 0u);
+    EXPECT_LE((*q)[1], 50u * 65535u / 100u);
+    EXPECT_GE((*q)[3], 70u * 65535u / 100u);
+}
+
+TEST(CompactTree, QuerySameAsDynamicTree)
+{
+    auto dynamicTree = DynamicTree{};
+    auto value = std::uint32_t{42};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<Real>((value >> 16u) % 1000u) / Real{10};
+    };
+    for (auto i = 0; i < 1000; ++i)
+    {
+        dynamicTree.CreateLeaf(GetBox(next(), next(), next() / 20), DynamicTree::LeafData{});
+    }
+    
+    const auto exactTree = CompactTree{dynamicTree, CompactTree::Bounds::Exact};
+    const auto quantizedTree = CompactTree{dynamicTree, CompactTree::Bounds::Quantized};
+    EXPECT_EQ(exactTree.GetNodeCount(), dynamicTree.GetNodeCount());
+    EXPECT_EQ(exactTree.GetLeafCount(), dynamicTree.GetLeafCount());
+    
+    auto totalFound = std::size_t{0};
+    for (auto i = 0; i < 200; ++i)
+    {
+        const auto aabb = GetBox(next(), next(), next() / 10);
+        const auto expected = QueryLeaves(dynamicTree, aabb);
+        EXPECT_EQ(QueryLeaves(exactTree, aabb), expected);
+        EXPECT_EQ(QueryLeaves(quantizedTree, aabb), expected);
+        totalFound += size(expected);
+    }
+    EXPECT_GT(totalFound, std::size_t(0));
+}
+
+TEST(CompactTree, QueryEnd)
+{
+    auto dynamicTree = DynamicTree{};
+    dynamicTree.CreateLeaf(GetBox(0, 0, 1), DynamicTree::LeafData{});
+    dynamicTree.CreateLeaf(GetBox(0, 0, 1), DynamicTree::LeafData{});
+    const auto tree = CompactTree{dynamicTree};
+    auto ncalls = 0;
+    Query(tree, GetBox(0, 0, 1), [&](DynamicTree::Size) {
+        ++ncalls;
+        return DynamicTreeOpcode::End;
+    });
+    EXPECT_EQ(ncalls, 1);
+}
@@ -68,6 +68,25 @@ TEST(Contact, Enabled)
     EXPECT_TRUE(c.IsEnabled());
 }
 
+TEST(Contact, FlagForUpdatingReducesSeparationBound)
+{
+    const auto shape = DiskShapeConf{}.UseRadius(0.5_m).UseLocation(Length2{2_m, 0_m});
+    auto world = World{};
+    const auto bA = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic));
+    const auto bB = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic));
+    const auto fA = bA->CreateFixture(Shape{DiskShapeConf{}});
+    const auto fB = bB->CreateFixture(Shape{shape});
+    auto c = Contact{fA, 0u, fB, 0u};
+    EXPECT_EQ(c.GetSeparationBound(), 0_m);
+    c.FlagForUpdating(*bA, 1_m, Real{1});
+    EXPECT_TRUE(c.NeedsUpdating());
+    EXPECT_EQ(c.GetSeparationBound(), -1_m);
+    c.FlagForUpdating(*bB, 1_m, Real{1});
+    EXPECT_EQ(c.GetSeparationBound(), -4_m);
+    c.FlagForUpdating();
+    EXPECT_EQ(c.GetSeparationBound(), 0_m);
+}
+
 TEST(Contact, SetAwake)
 {
     const auto shape = DiskShapeConf{};
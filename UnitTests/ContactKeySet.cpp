@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "UnitTests.hpp"
+
+#include <PlayRho/Dynamics/Contacts/ContactKeySet.hpp>
+#include <set>
+
+using namespace playrho;
+
+TEST(ContactKeySet, DefaultConstruction)
+{
+    const auto set = ContactKeySet{};
+    EXPECT_EQ(set.size(), ContactKeySet::size_type(0));
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.bucket_count(), ContactKeySet::size_type(0));
+    EXPECT_FALSE(set.contains(ContactKey{0, 1}));
+}
+
+TEST(ContactKeySet, InsertContainsErase)
+{
+    auto set = ContactKeySet{};
+    EXPECT_TRUE(set.insert(ContactKey{1, 2}));
+    EXPECT_EQ(size(set), ContactKeySet::size_type(1));
+    EXPECT_EQ(set.bucket_count(), ContactKeySet::GetInitialBucketCount());
+    EXPECT_TRUE(set.contains(ContactKey{1, 2}));
+    EXPECT_TRUE(set.contains(ContactKey{2, 1}));
+    EXPECT_FALSE(set.contains(ContactKey{1, 3}));
+    EXPECT_FALSE(set.insert(ContactKey{2, 1}));
+    EXPECT_EQ(size(set), ContactKeySet::size_type(1));
+    EXPECT_FALSE(set.erase(ContactKey{1, 3}));
+    EXPECT_TRUE(set.erase(ContactKey{1, 2}));
+    EXPECT_FALSE(set.erase(ContactKey{1, 2}));
+    EXPECT_FALSE(set.contains(ContactKey{1, 2}));
+    EXPECT_TRUE(empty(set));
+}
+
+TEST(ContactKeySet, Reserve)
+{
+    auto set = ContactKeySet{};
+    set.reserve(1000);
+    const auto buckets = set.bucket_count();
+    EXPECT_GE(buckets, ContactKeySet::size_type(2000));
+    for (auto i = ContactCounter{0}; i < 1000; ++i)
+    {
+        set.insert(ContactKey{i, i + 1});
+    }
+    EXPECT_EQ(set.bucket_count(), buckets);
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.bucket_count(), buckets);
+    EXPECT_FALSE(set.contains(ContactKey{0, 1}));
+}
+
+TEST(ContactKeySet, SameAsStdSet)
+{
+    // Exercises growth and the shifting back of keys on erasure by mirroring
+    // operations on a std::set.
+    auto set = ContactKeySet{};
+    auto reference = std::set<ContactKey>{};
+    auto value = std::uint32_t{12345};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<ContactCounter>((value >> 16u) % 200u);
+    };
+    for (auto i = 0; i < 20000; ++i)
+    {
+        const auto key = ContactKey{next(), next()};
+        if (i % 3 == 0)
+        {
+            EXPECT_EQ(set.erase(key), reference.erase(key) > 0);
+        }
+        else
+        {
+            EXPECT_EQ(set.insert(key), reference.insert(key).second);
+        }
+        ASSERT_EQ(size(set), size(reference));
+    }
+    for (auto i = ContactCounter{0}; i < 200; ++i)
+    {
+        for (auto j = i; j < 200; ++j)
+        {
+            const auto key = ContactKey{i, j};
+            EXPECT_EQ(set.contains(key), reference.count(key) > 0);
+        }
+    }
+}
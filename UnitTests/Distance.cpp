@@ -19,6 +19,12 @@
 #include "UnitTests.hpp"
 #include <PlayRho/Collision/Distance.hpp>
 #include <PlayRho/Collision/DistanceProxy.hpp>
+#include <PlayRho/Collision/Manifold.hpp>
+#include <PlayRho/Collision/Shapes/DiskShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/EdgeShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/PolygonShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/Shape.hpp>
+#include <vector>
 
 using namespace playrho;
 using namespace playrho::d2;
@@ -661,3 +667,159 @@ TEST(Distance, SquareSquareOverlappingDiagnally)
     
     EXPECT_EQ(conf.cache.metric, Real{-64});
 }
+
+TEST(Distance, GetDistanceToPoint)
+{
+    const auto square = PolygonShapeConf{}.UseVertexRadius(0_m).SetAsBox(1_m, 1_m);
+    const auto proxy = GetChild(square, 0);
+    const auto xfm = Transformation{Length2{10_m, 0_m}, UnitVec::GetRight()};
+    EXPECT_EQ(GetDistance(proxy, xfm, Length2{10_m, 0_m}), 0_m);
+    EXPECT_EQ(GetDistance(proxy, xfm, Length2{10.5_m, 0.5_m}), 0_m);
+    EXPECT_NEAR(static_cast<double>(Real{GetDistance(proxy, xfm, Length2{14_m, 0_m}) / Meter}),
+                3.0, 1e-5);
+    EXPECT_NEAR(static_cast<double>(Real{GetDistance(proxy, xfm, Length2{14_m, 5_m}) / Meter}),
+                5.0, 1e-5);
+    
+    const auto disk = DiskShapeConf{}.UseRadius(2_m);
+    EXPECT_NEAR(static_cast<double>(Real{GetDistance(GetChild(disk, 0), xfm, Length2{10_m, 5_m})
+                                         / Meter}), 3.0, 1e-5);
+    EXPECT_EQ(GetDistance(GetChild(disk, 0), xfm, Length2{11_m, 1_m}), 0_m);
+}
+
+TEST(Distance, IsOverlapping)
+{
+    const auto squareConf = PolygonShapeConf{}.UseVertexRadius(0_m).SetAsBox(1_m, 1_m);
+    const auto diskConf = DiskShapeConf{}.UseRadius(1_m);
+    const auto square = GetChild(squareConf, 0);
+    const auto disk = GetChild(diskConf, 0);
+    const auto at = [](Real x, Real y) {
+        return Transformation{Length2{x * Meter, y * Meter}, UnitVec::GetRight()};
+    };
+    EXPECT_TRUE(IsOverlapping(disk, at(0, 0), disk, at(1.5, 0)));
+    EXPECT_FALSE(IsOverlapping(disk, at(0, 0), disk, at(2.5, 0)));
+    EXPECT_TRUE(IsOverlapping(square, at(0, 0), disk, at(1.5, 0.5)));
+    EXPECT_TRUE(IsOverlapping(disk, at(1.5, 0.5), square, at(0, 0)));
+    EXPECT_FALSE(IsOverlapping(square, at(0, 0), disk, at(2.5, 0)));
+    EXPECT_TRUE(IsOverlapping(square, at(0, 0), disk, at(0, 0)));
+    // Disk is within a unit of the corner's AABB but not of the corner itself.
+    EXPECT_FALSE(IsOverlapping(square, at(0, 0), disk, at(1.8, 1.8)));
+    EXPECT_TRUE(IsOverlapping(square, at(0, 0), square, at(1.5, 1.5)));
+    EXPECT_FALSE(IsOverlapping(square, at(0, 0), square, at(2.5, 0)));
+    EXPECT_FALSE(IsOverlapping(square, at(0, 0), square,
+                               Transformation{Length2{2.5_m, 2.5_m}, UnitVec::Get(45_deg)}));
+    EXPECT_TRUE(IsOverlapping(square, at(0, 0), square,
+                              Transformation{Length2{2.2_m, 0_m}, UnitVec::Get(45_deg)}));
+}
+
+TEST(Distance, IsOverlappingAgreesWithTestOverlap)
+{
+    auto value = std::uint32_t{7};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<Real>((value >> 16u) % 1000u) / Real{1000};
+    };
+    const auto shapes = std::vector<Shape>{
+        Shape{DiskShapeConf{}.UseRadius(0.5_m)},
+        Shape{DiskShapeConf{}.UseRadius(1_m).UseLocation(Length2{0.5_m, 0_m})},
+        Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 1_m)},
+        Shape{PolygonShapeConf{}.UseVertexRadius(0.2_m).SetAsBox(1_m, 0.25_m)},
+        Shape{PolygonShapeConf{}.Set({Length2{0_m, 0_m}, Length2{1_m, 0_m}, Length2{0_m, 1_m}})},
+        Shape{EdgeShapeConf{Length2{-1_m, 0_m}, Length2{1_m, 0.5_m}}},
+    };
+    auto overlapping = 0;
+    auto separated = 0;
+    for (auto i = 0; i < 4000; ++i)
+    {
+        const auto& shapeA = shapes[static_cast<std::size_t>(i) % size(shapes)];
+        const auto& shapeB = shapes[static_cast<std::size_t>(i / 6) % size(shapes)];
+        const auto xfA = Transformation{Length2{next() * 4_m, next() * 4_m},
+                                        UnitVec::Get(next() * 360_deg)};
+        const auto xfB = Transformation{Length2{next() * 4_m, next() * 4_m},
+                                        UnitVec::Get(next() * 360_deg)};
+        const auto proxyA = GetChild(shapeA, 0);
+        const auto proxyB = GetChild(shapeB, 0);
+        const auto area = TestOverlap(proxyA, xfA, proxyB, xfB);
+        if (abs(area) < 0.0001_m2)
+        {
+            continue; // Touching to within numerical precision.
+        }
+        const auto expected = area >= 0_m2;
+        EXPECT_EQ(IsOverlapping(proxyA, xfA, proxyB, xfB), expected) << i;
+        EXPECT_EQ(IsOverlapping(proxyB, xfB, proxyA, xfA), expected) << i;
+        ++(expected? overlapping: separated);
+    }
+    EXPECT_GT(overlapping, 500);
+    EXPECT_GT(separated, 500);
+}
+
+TEST(Distance, GetSeparation)
+{
+    const auto disk = Shape{DiskShapeConf{}.UseRadius(0.5_m)};
+    const auto proxy = GetChild(disk, 0);
+    const auto xfA = Transformation{Length2{0_m, 0_m}, UnitVec::GetRight()};
+    const auto xfB = Transformation{Length2{3_m, 4_m}, UnitVec::GetRight()};
+    EXPECT_NEAR(static_cast<double>(Real{GetSeparation(TestOverlap(proxy, xfA, proxy, xfB),
+                                                       1_m) / Meter}), 4.0, 0.0001);
+    EXPECT_NEAR(static_cast<double>(Real{GetSeparation(TestOverlap(proxy, xfA, proxy, xfA),
+                                                       1_m) / Meter}), -1.0, 0.0001);
+}
+
+TEST(Distance, TestOverlapWarmStartsFromSimplexCache)
+{
+    const auto square = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m)};
+    const auto proxy = GetChild(square, 0);
+    const auto xfA = Transformation{Length2{0_m, 0_m}, UnitVec::GetRight()};
+    auto cache = Simplex::Cache{};
+    for (auto i = 0; i < 10; ++i)
+    {
+        const auto xfB = Transformation{Length2{1.5_m - i * 0.1_m, 0.25_m}, UnitVec::Get(i * 2_deg)};
+        const auto expected = TestOverlap(proxy, xfA, proxy, xfB);
+        EXPECT_NEAR(static_cast<double>(Real{TestOverlap(proxy, xfA, proxy, xfB, cache) / SquareMeter}),
+                    static_cast<double>(Real{expected / SquareMeter}), 0.0001);
+        EXPECT_NE(cache.indices, InvalidIndexPair3);
+
+        // The distance calculation from the cache of the earlier call only needs one iteration.
+        auto conf = DistanceConf{};
+        conf.cache = cache;
+        EXPECT_EQ(Distance(proxy, xfA, proxy, xfB, conf).iterations, 1);
+    }
+}
+
+TEST(Distance, SeparatedShapesHaveEmptyManifolds)
+{
+    // Skipping the manifold calculation for shapes separated by more than the linear slop
+    // depends on such shapes never getting manifold points.
+    auto value = std::uint32_t{11};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<Real>((value >> 16u) % 1000u) / Real{1000};
+    };
+    const auto shapes = std::vector<Shape>{
+        Shape{DiskShapeConf{}.UseRadius(0.5_m)},
+        Shape{DiskShapeConf{}.UseRadius(1_m).UseLocation(Length2{0.5_m, 0_m})},
+        Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 1_m)},
+        Shape{PolygonShapeConf{}.UseVertexRadius(0.2_m).SetAsBox(1_m, 0.25_m)},
+        Shape{PolygonShapeConf{}.Set({Length2{0_m, 0_m}, Length2{1_m, 0_m}, Length2{0_m, 1_m}})},
+        Shape{EdgeShapeConf{Length2{-1_m, 0_m}, Length2{1_m, 0.5_m}}},
+    };
+    auto separated = 0;
+    for (auto i = 0; i < 4000; ++i)
+    {
+        const auto& shapeA = shapes[static_cast<std::size_t>(i) % size(shapes)];
+        const auto& shapeB = shapes[static_cast<std::size_t>(i / 6) % size(shapes)];
+        const auto xfA = Transformation{Length2{next() * 4_m, next() * 4_m},
+                                        UnitVec::Get(next() * 360_deg)};
+        const auto xfB = Transformation{Length2{next() * 4_m, next() * 4_m},
+                                        UnitVec::Get(next() * 360_deg)};
+        const auto proxyA = GetChild(shapeA, 0);
+        const auto proxyB = GetChild(shapeB, 0);
+        const auto separation = GetSeparation(TestOverlap(proxyA, xfA, proxyB, xfB),
+                                              proxyA.GetVertexRadius() + proxyB.GetVertexRadius());
+        if (separation > DefaultLinearSlop)
+        {
+            EXPECT_EQ(CollideShapes(proxyA, xfA, proxyB, xfB).GetPointCount(), 0u) << i;
+            ++separated;
+        }
+    }
+    EXPECT_GT(separated, 500);
+}
@@ -19,7 +19,9 @@
 #include "UnitTests.hpp"
 #include <PlayRho/Collision/DistanceProxy.hpp>
 #include <PlayRho/Collision/ShapeSeparation.hpp>
+#include <PlayRho/Collision/Shapes/PolygonShapeConf.hpp>
 #include <initializer_list>
+#include <limits>
 #include <vector>
 
 using namespace playrho;
@@ -253,3 +255,91 @@ TEST(DistanceProxy, Equality)
     EXPECT_TRUE(DistanceProxy(0.0_m, 4, verts, norms) == DistanceProxy(0.0_m, 4, verts, norms));
     EXPECT_FALSE(DistanceProxy(1.0_m, 4, verts, norms) == DistanceProxy(0.0_m, 4, verts, norms));
 }
+
+TEST(DistanceProxy, GetSupportIndexBySearchMatchesEveryVertex)
+{
+    auto rock = std::vector<Length2>{};
+    for (auto i = 0; i < 400; ++i)
+    {
+        const auto angle = Real(i * 7919 % 360) * 1_deg;
+        const auto radius = Real(2 + (i * 104729) % 7) * 0.25_m;
+        rock.push_back(Rotate(Length2{radius, 0_m}, UnitVec::Get(angle)));
+    }
+    const auto getPolygon = [](const std::vector<Length2>& vertices) {
+        return PolygonShapeConf{}.Set(Span<const Length2>(vertices.data(), size(vertices)));
+    };
+    const PolygonShapeConf shapes[] = {
+        getPolygon(GetCircleVertices(1_m, 32)),
+        getPolygon(GetCircleVertices(2_m, 128)),
+        getPolygon(GetCircleVertices(0.5_m, 250)),
+        getPolygon(rock),
+    };
+    const auto getSupportIndex = [](const DistanceProxy& proxy, Vec2 dir) {
+        auto index = InvalidVertex;
+        auto maxValue = -std::numeric_limits<Length>::infinity();
+        for (auto i = VertexCounter{0}; i < proxy.GetVertexCount(); ++i)
+        {
+            const auto value = Dot(proxy.GetVertex(i), dir);
+            if (maxValue < value)
+            {
+                maxValue = value;
+                index = i;
+            }
+        }
+        return index;
+    };
+    for (const auto& shape: shapes)
+    {
+        const auto proxy = GetChild(shape, 0);
+        ASSERT_GE(proxy.GetVertexCount(), MinSupportSearchVertices);
+        for (auto i = 0; i < 720; ++i)
+        {
+            const auto dir = GetVec2(UnitVec::Get(Real(i) * 0.5_deg));
+            EXPECT_EQ(GetSupportIndex(proxy, dir), getSupportIndex(proxy, dir));
+        }
+        for (auto i = VertexCounter{0}; i < proxy.GetVertexCount(); ++i)
+        {
+            // Directions of the normals make ties between the vertices of their edges.
+            const auto dir = GetVec2(proxy.GetNormal(i));
+            EXPECT_EQ(GetSupportIndex(proxy, dir), getSupportIndex(proxy, dir));
+            EXPECT_EQ(GetSupportIndex(proxy, -dir), getSupportIndex(proxy, -dir));
+        }
+        EXPECT_EQ(GetSupportIndex(proxy, Vec2{}), VertexCounter(0));
+        EXPECT_EQ(GetSupportIndex(proxy, GetInvalid<Vec2>()), InvalidVertex);
+    }
+}
+
+TEST(DistanceProxy, GetMaxSeparationOfManyVertices)
+{
+    const auto vertices = GetCircleVertices(2_m, 100);
+    const auto many = PolygonShapeConf{}.Set(Span<const Length2>(vertices.data(), size(vertices)));
+    const auto box = PolygonShapeConf{}.SetAsBox(1_m, 0.5_m);
+    const auto proxyMany = GetChild(many, 0);
+    const auto proxyBox = GetChild(box, 0);
+    for (auto i = 0; i < 60; ++i)
+    {
+        const auto xfMany = Transformation{Length2{}, UnitVec::Get(Real(i) * 1.3_deg)};
+        const auto xfBox = Transformation{Length2{Real(i % 10) * 0.5_m, 2_m}, UnitVec::Get(Real(i) * 6_deg)};
+        const auto xf = MulT(xfMany, xfBox);
+        auto expected = -std::numeric_limits<Length>::infinity();
+        auto expectedIndex = InvalidVertex;
+        for (auto j = VertexCounter{0}; j < proxyBox.GetVertexCount(); ++j)
+        {
+            const auto origin = Transform(proxyBox.GetVertex(j), xf);
+            const auto normal = Rotate(proxyBox.GetNormal(j), xf.q);
+            auto minSeparation = std::numeric_limits<Length>::infinity();
+            for (const auto& vertex: proxyMany.GetVertices())
+            {
+                minSeparation = std::min(minSeparation, Length{Dot(normal, vertex - origin)});
+            }
+            if (expected < minSeparation)
+            {
+                expected = minSeparation;
+                expectedIndex = j;
+            }
+        }
+        const auto result = GetMaxSeparation(proxyBox, xfBox, proxyMany, xfMany);
+        EXPECT_EQ(result.distance, expected);
+        EXPECT_EQ(result.firstShape, expectedIndex);
+    }
+}
@@ -20,9 +20,12 @@
 
 #include "UnitTests.hpp"
 #include <PlayRho/Collision/DynamicTree.hpp>
+#include <PlayRho/Collision/RayCastOutput.hpp>
 #include <type_traits>
 #include <algorithm>
 #include <iterator>
+#include <memory>
+#include <vector>
 
 using namespace playrho;
 using namespace playrho::d2;
@@ -44,7 +47,7 @@ TEST(DynamicTree, TreeNodeByteSize)
     {
         case  4:
 #if defined(_WIN32) && !defined(_WIN64)
-            EXPECT_EQ(sizeof(DynamicTree::TreeNode), std::size_t(36));
+            EXPECT_EQ(sizeof(DynamicTree::TreeNode), std::size_t(40));
 #else
             EXPECT_EQ(sizeof(DynamicTree::TreeNode), std::size_t(48));
 #endif
@@ -177,11 +180,11 @@ TEST(DynamicTreeLeafData, Traits)
 {
     EXPECT_TRUE(std::is_default_constructible<DynamicTree::LeafData>::value);
     EXPECT_TRUE(std::is_nothrow_default_constructible<DynamicTree::LeafData>::value);
-    EXPECT_TRUE(std::is_trivially_default_constructible<DynamicTree::LeafData>::value);
+    EXPECT_FALSE(std::is_trivially_default_constructible<DynamicTree::LeafData>::value);
 
     EXPECT_TRUE(std::is_nothrow_constructible<DynamicTree::LeafData>::value);
     EXPECT_TRUE(std::is_constructible<DynamicTree::LeafData>::value);
-    EXPECT_TRUE(std::is_trivially_constructible<DynamicTree::LeafData>::value);
+    EXPECT_FALSE(std::is_trivially_constructible<DynamicTree::LeafData>::value);
 
     EXPECT_TRUE(std::is_copy_constructible<DynamicTree::LeafData>::value);
     EXPECT_TRUE(std::is_nothrow_copy_constructible<DynamicTree::LeafData>::value);
@@ -200,11 +203,11 @@ TEST(DynamicTreeVariantData, Traits)
 {
     EXPECT_TRUE(std::is_default_constructible<DynamicTree::VariantData>::value);
     EXPECT_TRUE(std::is_nothrow_default_constructible<DynamicTree::VariantData>::value);
-    EXPECT_TRUE(std::is_trivially_default_constructible<DynamicTree::VariantData>::value);
+    EXPECT_FALSE(std::is_trivially_default_constructible<DynamicTree::VariantData>::value);
     
     EXPECT_TRUE(std::is_nothrow_constructible<DynamicTree::VariantData>::value);
     EXPECT_TRUE(std::is_constructible<DynamicTree::VariantData>::value);
-    EXPECT_TRUE(std::is_trivially_constructible<DynamicTree::VariantData>::value);
+    EXPECT_FALSE(std::is_trivially_constructible<DynamicTree::VariantData>::value);
     
     EXPECT_TRUE(std::is_copy_constructible<DynamicTree::VariantData>::value);
     EXPECT_TRUE(std::is_nothrow_copy_constructible<DynamicTree::VariantData>::value);
@@ -1018,3 +1021,404 @@ TEST(DynamicTree, QueryFF)
     });
     EXPECT_EQ(ncalls, 2);
 }
+
+TEST(DynamicTree, QueryTakesAnyCallable)
+{
+    auto tree = DynamicTree{};
+    tree.CreateLeaf(AABB{LengthInterval{-10_m, 10_m}, LengthInterval{-20_m, 20_m}},
+                    DynamicTree::LeafData{nullptr, nullptr, 0});
+    tree.CreateLeaf(AABB{LengthInterval{-10_m, 10_m}, LengthInterval{-20_m, 20_m}},
+                    DynamicTree::LeafData{nullptr, nullptr, 1});
+    const auto aabb = AABB{LengthInterval{-20_m, 20_m}, LengthInterval{-20_m, 20_m}};
+
+    // A callable that can't be copied can't be a std::function but works for the templates.
+    auto ncalls = 0;
+    auto counter = std::make_unique<int*>(&ncalls);
+    Query(tree, aabb, [counter = std::move(counter)](DynamicTree::Size) {
+        ++**counter;
+        return DynamicTreeOpcode::Continue;
+    });
+    EXPECT_EQ(ncalls, 2);
+    
+    auto children = std::vector<ChildCounter>{};
+    Query(tree, aabb, [&](Fixture* fixture, ChildCounter child) {
+        EXPECT_EQ(fixture, nullptr);
+        children.push_back(child);
+        return true;
+    });
+    std::sort(begin(children), end(children));
+    EXPECT_EQ(children, (std::vector<ChildCounter>{0, 1}));
+
+    auto count = 0;
+    Query(tree, aabb, [&](Fixture*, ChildCounter) {
+        ++count;
+        return false;
+    });
+    EXPECT_EQ(count, 1);
+    
+    count = 0;
+    const auto callback = QueryFixtureCallback{[&](Fixture*, ChildCounter) {
+        ++count;
+        return true;
+    }};
+    Query(tree, aabb, callback);
+    EXPECT_EQ(count, 2);
+}
+
+TEST(DynamicTree, CategoryBitsPruneMaskedTraversals)
+{
+    auto value = std::uint32_t{11};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<Real>((value >> 16u) % 1000u) / Real{10};
+    };
+    const auto bitsOf = [](int i) {
+        return static_cast<Filter::bits_type>(1u << (i % 4));
+    };
+
+    auto tree = DynamicTree{};
+    auto leaves = std::vector<DynamicTree::Size>{};
+    for (auto i = 0; i < 200; ++i)
+    {
+        const auto x = next();
+        const auto y = next();
+        leaves.push_back(tree.CreateLeaf(AABB{Length2{x * Meter, y * Meter},
+                                              Length2{(x + 2) * Meter, (y + 2) * Meter}},
+            DynamicTree::LeafData{nullptr, nullptr, static_cast<ChildCounter>(i), bitsOf(i)}));
+    }
+    for (auto i = std::size_t{0}; i < size(leaves); i += 5)
+    {
+        const auto x = next();
+        const auto y = next();
+        tree.UpdateLeaf(leaves[i], AABB{Length2{x * Meter, y * Meter},
+                                        Length2{(x + 1) * Meter, (y + 1) * Meter}});
+    }
+    EXPECT_TRUE(ValidateMetrics(tree, tree.GetRootIndex()));
+    EXPECT_EQ(tree.GetCategoryBits(tree.GetRootIndex()), Filter::bits_type(0xF));
+
+    const auto aabb = AABB{Length2{20_m, 20_m}, Length2{70_m, 70_m}};
+    const auto getChildren = [&](const DynamicTree& t, Filter::bits_type maskBits) {
+        auto children = std::vector<ChildCounter>{};
+        Query(t, aabb, maskBits, [&](Fixture*, ChildCounter child) {
+            children.push_back(child);
+            return true;
+        });
+        std::sort(begin(children), end(children));
+        return children;
+    };
+    const auto getExpected = [&](const DynamicTree& t, Filter::bits_type maskBits) {
+        auto children = std::vector<ChildCounter>{};
+        Query(t, aabb, [&](Fixture*, ChildCounter child) {
+            if ((t.GetLeafData(leaves[child]).categoryBits & maskBits) != 0)
+            {
+                children.push_back(child);
+            }
+            return true;
+        });
+        std::sort(begin(children), end(children));
+        return children;
+    };
+    EXPECT_FALSE(empty(getChildren(tree, 0x2)));
+    EXPECT_EQ(getChildren(tree, 0x2), getExpected(tree, 0x2));
+    EXPECT_EQ(getChildren(tree, 0x5), getExpected(tree, 0x5));
+    EXPECT_TRUE(empty(getChildren(tree, 0x10)));
+
+    // Visiting a masked out sub-tree isn't needed so fewer nodes get tested.
+    auto maskedCount = 0;
+    auto unmaskedCount = 0;
+    Query(tree, aabb, Filter::bits_type(0x2), [&](DynamicTree::Size) {
+        ++maskedCount;
+        return DynamicTreeOpcode::Continue;
+    });
+    Query(tree, aabb, [&](DynamicTree::Size) {
+        ++unmaskedCount;
+        return DynamicTreeOpcode::Continue;
+    });
+    EXPECT_LT(maskedCount, unmaskedCount);
+
+    // Changing a leaf's category bits updates its ancestors.
+    auto data = tree.GetLeafData(leaves[1]);
+    data.categoryBits = 0x10;
+    tree.SetLeafData(leaves[1], data);
+    EXPECT_EQ(tree.GetLeafData(leaves[1]).categoryBits, Filter::bits_type(0x10));
+    EXPECT_EQ(tree.GetCategoryBits(tree.GetRootIndex()), Filter::bits_type(0x1F));
+    EXPECT_TRUE(ValidateMetrics(tree, tree.GetRootIndex()));
+    EXPECT_EQ(getChildren(tree, 0x10), getExpected(tree, 0x10));
+
+    // Rebuilt trees have the same category bits for their leaves.
+    auto topDown = tree;
+    topDown.RebuildTopDown();
+    EXPECT_TRUE(ValidateMetrics(topDown, topDown.GetRootIndex()));
+    EXPECT_EQ(getChildren(topDown, 0x5), getExpected(tree, 0x5));
+    auto bottomUp = tree;
+    bottomUp.RebuildBottomUp();
+    EXPECT_TRUE(ValidateMetrics(bottomUp, bottomUp.GetRootIndex()));
+    EXPECT_EQ(getChildren(bottomUp, 0x5), getExpected(tree, 0x5));
+
+    const auto input = RayCastInput{Length2{0_m, 0_m}, Length2{102_m, 102_m},
+        UnitInterval<Real>{1}};
+    const auto castAll = [&](Filter::bits_type maskBits) {
+        auto children = std::vector<ChildCounter>{};
+        RayCast(tree, input, maskBits, [&](Fixture*, ChildCounter child, const RayCastInput& in) {
+            children.push_back(child);
+            return Real{in.maxFraction};
+        });
+        std::sort(begin(children), end(children));
+        return children;
+    };
+    auto expected = std::vector<ChildCounter>{};
+    RayCast(tree, input, [&](Fixture*, ChildCounter child, const RayCastInput& in) {
+        if ((tree.GetLeafData(leaves[child]).categoryBits & 0x5) != 0)
+        {
+            expected.push_back(child);
+        }
+        return Real{in.maxFraction};
+    });
+    std::sort(begin(expected), end(expected));
+    EXPECT_FALSE(empty(expected));
+    EXPECT_EQ(castAll(0x5), expected);
+    EXPECT_TRUE(empty(castAll(0)));
+}
+
+TEST(DynamicTree, QueryNearest)
+{
+    auto value = std::uint32_t{5};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<Real>((value >> 16u) % 1000u) / Real{10};
+    };
+    
+    auto tree = DynamicTree{};
+    const auto noLeaves = [](DynamicTree::Size) { return 0_m; };
+    QueryNearest(tree, Length2{}, 10_m, noLeaves, [](DynamicTree::Size, Length) {
+        ADD_FAILURE();
+        return DynamicTreeOpcode::Continue;
+    });
+    
+    // Leaves stand for the points at the centers of their AABBs.
+    for (auto i = 0; i < 500; ++i)
+    {
+        const auto x = next();
+        const auto y = next();
+        tree.CreateLeaf(AABB{Length2{x * Meter, y * Meter}, Length2{(x + 1) * Meter, (y + 1) * Meter}},
+                        DynamicTree::LeafData{nullptr, nullptr, static_cast<ChildCounter>(i)});
+    }
+    const auto point = Length2{50_m, 50_m};
+    const auto distance = [&](DynamicTree::Size index) {
+        return GetMagnitude(GetCenter(tree.GetAABB(index)) - point);
+    };
+    auto expected = std::vector<Length>{};
+    for (auto i = DynamicTree::Size{0}; i < tree.GetNodeCapacity(); ++i)
+    {
+        if (DynamicTree::IsLeaf(tree.GetHeight(i)))
+        {
+            expected.push_back(distance(i));
+        }
+    }
+    std::sort(begin(expected), end(expected));
+    
+    auto found = std::vector<Length>{};
+    QueryNearest(tree, point, std::numeric_limits<Length>::infinity(), distance,
+                 [&](DynamicTree::Size index, Length d) {
+        EXPECT_EQ(d, distance(index));
+        found.push_back(d);
+        return DynamicTreeOpcode::Continue;
+    });
+    EXPECT_EQ(found, expected);
+    
+    // Only the k nearest within the maximum distance get called back for.
+    found.clear();
+    QueryNearest(tree, point, 20_m, distance, [&](DynamicTree::Size, Length d) {
+        found.push_back(d);
+        return (size(found) < 10u)? DynamicTreeOpcode::Continue: DynamicTreeOpcode::End;
+    });
+    EXPECT_EQ(found, std::vector<Length>(begin(expected), begin(expected) + 10));
+    found.clear();
+    QueryNearest(tree, point, expected[4], distance, [&](DynamicTree::Size, Length d) {
+        found.push_back(d);
+        return DynamicTreeOpcode::Continue;
+    });
+    EXPECT_EQ(found, std::vector<Length>(begin(expected), begin(expected) + 5));
+    
+    // Leaves having infinite distances are excluded.
+    found.clear();
+    QueryNearest(tree, point, std::numeric_limits<Length>::infinity(),
+                 [](DynamicTree::Size) { return std::numeric_limits<Length>::infinity(); },
+                 [&](DynamicTree::Size, Length d) {
+        found.push_back(d);
+        return DynamicTreeOpcode::Continue;
+    });
+    EXPECT_TRUE(empty(found));
+}
+
+TEST(DynamicTree, RayCastClosestOfEmptyTree)
+{
+    const auto tree = DynamicTree{};
+    const auto input = RayCastInput{Length2{-10_m, 0_m}, Length2{10_m, 0_m},
+        UnitInterval<Real>{1}};
+    EXPECT_FALSE(RayCastClosest(tree, input).has_value());
+    
+    const auto inputs = std::vector<RayCastInput>{input, input};
+    auto outputs = std::vector<FixtureRayCastOutput>(2, FixtureRayCastOutput{FixtureRayCastHit{}});
+    RayCastClosest(tree, inputs, outputs);
+    EXPECT_FALSE(outputs[0].has_value());
+    EXPECT_FALSE(outputs[1].has_value());
+}
+
+TEST(DynamicTree, RebuildTopDown)
+{
+    {
+        auto foo = DynamicTree{};
+        foo.RebuildTopDown();
+        EXPECT_EQ(foo.GetRootIndex(), DynamicTree::GetInvalidSize());
+        EXPECT_EQ(foo.GetNodeCount(), DynamicTree::Size(0));
+    }
+    {
+        auto foo = DynamicTree{};
+        const auto leaf = foo.CreateLeaf(AABB{Length2{}, Length2{1_m, 1_m}},
+                                         DynamicTree::LeafData{nullptr, nullptr, 0});
+        foo.RebuildTopDown();
+        EXPECT_EQ(foo.GetRootIndex(), leaf);
+        EXPECT_EQ(foo.GetNodeCount(), DynamicTree::Size(1));
+    }
+
+    auto value = std::uint32_t{42};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<Real>((value >> 16u) % 1000u) / Real{10};
+    };
+    const auto getLeaves = [](const DynamicTree& tree, const AABB& aabb) {
+        auto leaves = std::vector<DynamicTree::Size>{};
+        Query(tree, aabb, [&](DynamicTree::Size index) {
+            leaves.push_back(index);
+            return DynamicTreeOpcode::Continue;
+        });
+        std::sort(begin(leaves), end(leaves));
+        return leaves;
+    };
+
+    auto foo = DynamicTree{};
+    for (auto i = 0; i < 300; ++i)
+    {
+        const auto x = next();
+        const auto y = next();
+        const auto s = next() / 50;
+        foo.CreateLeaf(AABB{Length2{x * Meter, y * Meter}, Length2{(x + s) * Meter, (y + s) * Meter}},
+                       DynamicTree::LeafData{nullptr, nullptr, 0});
+    }
+    auto topDown = foo;
+    topDown.RebuildTopDown();
+    EXPECT_TRUE(ValidateStructure(topDown, topDown.GetRootIndex()));
+    EXPECT_TRUE(ValidateMetrics(topDown, topDown.GetRootIndex()));
+    EXPECT_EQ(topDown.GetNodeCount(), foo.GetNodeCount());
+    EXPECT_EQ(topDown.GetLeafCount(), foo.GetLeafCount());
+    EXPECT_EQ(GetAABB(topDown), GetAABB(foo));
+    EXPECT_LT(ComputePerimeterRatio(topDown), ComputePerimeterRatio(foo));
+    for (auto i = 0; i < 50; ++i)
+    {
+        const auto x = next();
+        const auto y = next();
+        const auto aabb = AABB{Length2{x * Meter, y * Meter}, Length2{(x + 5) * Meter, (y + 5) * Meter}};
+        EXPECT_EQ(getLeaves(topDown, aabb), getLeaves(foo, aabb));
+    }
+
+    auto bottomUp = foo;
+    bottomUp.RebuildBottomUp();
+    EXPECT_LT(ComputePerimeterRatio(topDown), ComputePerimeterRatio(bottomUp) * Real(1.1));
+    
+    // Trees stay usable after being rebuilt.
+    const auto leaf = topDown.CreateLeaf(AABB{Length2{}, Length2{1_m, 1_m}},
+                                         DynamicTree::LeafData{nullptr, nullptr, 0});
+    topDown.UpdateLeaf(leaf, AABB{Length2{50_m, 50_m}, Length2{51_m, 51_m}});
+    topDown.DestroyLeaf(leaf);
+    EXPECT_TRUE(ValidateStructure(topDown, topDown.GetRootIndex()));
+    EXPECT_TRUE(ValidateMetrics(topDown, topDown.GetRootIndex()));
+}
+
+TEST(DynamicTree, RebuildTopDownSameForAnyMaxThreads)
+{
+    auto value = std::uint32_t{7};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<Real>((value >> 16u) % 10000u) / Real{10};
+    };
+    auto serial = DynamicTree{};
+    for (auto i = 0; i < 10000; ++i)
+    {
+        const auto x = next();
+        const auto y = next();
+        serial.CreateLeaf(AABB{Length2{x * Meter, y * Meter}, Length2{(x + 1) * Meter, (y + 1) * Meter}},
+                          DynamicTree::LeafData{nullptr, nullptr, 0});
+    }
+    auto threaded = serial;
+    serial.RebuildTopDown(1);
+    threaded.RebuildTopDown(4);
+    ASSERT_EQ(threaded.GetRootIndex(), serial.GetRootIndex());
+    ASSERT_EQ(threaded.GetNodeCapacity(), serial.GetNodeCapacity());
+    for (auto i = DynamicTree::Size{0}; i < serial.GetNodeCapacity(); ++i)
+    {
+        ASSERT_EQ(threaded.GetHeight(i), serial.GetHeight(i));
+        if (DynamicTree::IsBranch(serial.GetHeight(i)))
+        {
+            EXPECT_EQ(threaded.GetBranchData(i).child1, serial.GetBranchData(i).child1);
+            EXPECT_EQ(threaded.GetBranchData(i).child2, serial.GetBranchData(i).child2);
+            EXPECT_EQ(threaded.GetAABB(i), serial.GetAABB(i));
+        }
+    }
+    EXPECT_TRUE(ValidateStructure(threaded, threaded.GetRootIndex()));
+    EXPECT_TRUE(ValidateMetrics(threaded, threaded.GetRootIndex()));
+}
+
+TEST(DynamicTree, BatchedQuery)
+{
+    auto value = std::uint32_t{3};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<Real>((value >> 16u) % 1000u) / Real{10};
+    };
+    const auto getBox = [&](Real size) {
+        const auto x = next();
+        const auto y = next();
+        return AABB{Length2{x * Meter, y * Meter}, Length2{(x + size) * Meter, (y + size) * Meter}};
+    };
+    
+    auto hits = std::vector<DynamicTreeQueryHit>{DynamicTreeQueryHit{0u, 0u}};
+    auto aabbs = std::vector<AABB>{};
+    Query(DynamicTree{}, aabbs, hits);
+    EXPECT_TRUE(hits.empty());
+    
+    auto tree = DynamicTree{};
+    for (auto i = 0; i < 1000; ++i)
+    {
+        tree.CreateLeaf(getBox(1), DynamicTree::LeafData{nullptr, nullptr, 0});
+    }
+    for (auto i = 0; i < 1000; ++i)
+    {
+        aabbs.push_back(getBox(3));
+    }
+    
+    auto expected = std::vector<DynamicTreeQueryHit>{};
+    for (auto i = std::size_t{0}; i < size(aabbs); ++i)
+    {
+        Query(tree, aabbs[i], [&](DynamicTree::Size leaf) {
+            expected.push_back(DynamicTreeQueryHit{i, leaf});
+            return DynamicTreeOpcode::Continue;
+        });
+    }
+    ASSERT_FALSE(expected.empty());
+    
+    Query(tree, aabbs, hits);
+    EXPECT_EQ(hits, expected);
+    Query(tree, aabbs, hits, 4u);
+    EXPECT_EQ(hits, expected);
+    
+    auto scratch = DynamicTreeQueryScratch{};
+    Query(tree, aabbs, hits, scratch, 4u);
+    EXPECT_EQ(hits, expected);
+    const auto orderData = scratch.order.data();
+    const auto offsetsData = scratch.offsets.data();
+    Query(tree, aabbs, hits, scratch, 1u);
+    EXPECT_EQ(hits, expected);
+    EXPECT_EQ(scratch.order.data(), orderData);
+    EXPECT_EQ(scratch.offsets.data(), offsetsData);
+}
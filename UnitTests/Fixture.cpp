@@ -33,13 +33,13 @@ TEST(Fixture, ByteSize)
     {
         case  4:
 #if defined(_WIN32) && !defined(_WIN64)
-            EXPECT_EQ(sizeof(Fixture), std::size_t(36));
+            EXPECT_EQ(sizeof(Fixture), std::size_t(40));
 #else
             EXPECT_EQ(sizeof(Fixture), std::size_t(56));
 #endif
             break;
-        case  8: EXPECT_EQ(sizeof(Fixture), std::size_t(56)); break;
-        case 16: EXPECT_EQ(sizeof(Fixture), std::size_t(56)); break;
+        case  8: EXPECT_EQ(sizeof(Fixture), std::size_t(64)); break;
+        case 16: EXPECT_EQ(sizeof(Fixture), std::size_t(80)); break;
         default: FAIL(); break;
     }
 }
@@ -24,7 +24,9 @@
 #include <PlayRho/Collision/RayCastInput.hpp>
 #include <PlayRho/Collision/AABB.hpp>
 #include <PlayRho/Collision/DistanceProxy.hpp>
+#include <PlayRho/Collision/Distance.hpp>
 #include <PlayRho/Collision/Shapes/DiskShapeConf.hpp>
+#include <PlayRho/Collision/Shapes/PolygonShapeConf.hpp>
 #include <PlayRho/Collision/Shapes/Shape.hpp>
 
 #include <type_traits>
@@ -237,3 +239,38 @@ TEST(RayCastHit, InitConstruction)
     EXPECT_EQ(foo.fraction, fraction);
 }
 
+
+TEST(RayCastOutput, RayCastDistanceProxyOfManyVertices)
+{
+    const auto vertices = GetCircleVertices(2_m, 64);
+    const auto conf = PolygonShapeConf{}.UseVertexRadius(0.1_m)
+        .Set(Span<const Length2>(vertices.data(), size(vertices)));
+    const auto proxy = GetChild(conf, 0);
+    ASSERT_GE(proxy.GetVertexCount(), MinSupportSearchVertices);
+    const auto xf = Transformation{Length2{1_m, -1_m}, UnitVec::Get(10_deg)};
+    auto hits = 0;
+    auto misses = 0;
+    for (auto i = 0; i < 200; ++i)
+    {
+        // Rays start outside the proxy and some of them stop short of it.
+        const auto p1 = Transform(Rotate(Length2{4_m, 0_m}, UnitVec::Get(Real(i) * 7_deg)), xf);
+        const auto p2 = p1 + Rotate(Length2{Real(1 + i % 5) * 1_m, 0_m},
+                                    UnitVec::Get(Real(i) * 13_deg));
+        const auto segment = Length2{p2 - p1};
+        const Length2 segmentVertices[] = {Length2{}, segment};
+        const auto n = GetUnitVector(GetFwdPerpendicular(segment));
+        const UnitVec segmentNormals[] = {n, -n};
+        const auto segmentProxy = DistanceProxy{0_m, 2, segmentVertices, segmentNormals};
+        const auto overlap = TestOverlap(proxy, xf, segmentProxy, Transformation{p1, UnitVec::GetRight()});
+        if (abs(overlap) < 0.0001_m2)
+        {
+            continue;
+        }
+        const auto output = RayCast(proxy, RayCastInput{p1, p2, Real(1)}, xf);
+        EXPECT_EQ(output.has_value(), overlap > 0_m2);
+        hits += output.has_value()? 1: 0;
+        misses += output.has_value()? 0: 1;
+    }
+    EXPECT_GT(hits, 0);
+    EXPECT_GT(misses, 0);
+}
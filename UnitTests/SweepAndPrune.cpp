@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "UnitTests.hpp"
+
+#include <PlayRho/Collision/SweepAndPrune.hpp>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace playrho;
+using namespace playrho::d2;
+
+namespace {
+
+std::vector<SweepAndPrune::Size> QueryIds(const SweepAndPrune& sap, const AABB& aabb)
+{
+    auto ids = std::vector<SweepAndPrune::Size>{};
+    Query(sap, aabb, [&](SweepAndPrune::Size id) {
+        ids.push_back(id);
+        return DynamicTreeOpcode::Continue;
+    });
+    std::sort(begin(ids), end(ids));
+    return ids;
+}
+
+std::vector<SweepAndPrune::Size> BruteForceIds(const SweepAndPrune& sap, const AABB& aabb)
+{
+    auto ids = std::vector<SweepAndPrune::Size>{};
+    for (auto id = SweepAndPrune::Size{0}; id < sap.GetIdLimit(); ++id)
+    {
+        if (sap.IsProxy(id) && TestOverlap(sap.GetAABB(id), aabb))
+        {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+AABB GetBox(Real x, Real y, Real size)
+{
+    return AABB{Length2{x * Meter, y * Meter}, Length2{(x + size) * Meter, (y + size) * Meter}};
+}
+
+} // anonymous namespace
+
+TEST(SweepAndPrune, DefaultConstruction)
+{
+    const auto sap = SweepAndPrune{};
+    EXPECT_EQ(sap.GetProxyCount(), SweepAndPrune::Size(0));
+    EXPECT_EQ(size(sap), std::size_t(0));
+    EXPECT_EQ(sap.GetIdLimit(), SweepAndPrune::Size(0));
+    EXPECT_TRUE(sap.IsSorted());
+    EXPECT_EQ(sap.GetAxis(), std::size_t(0));
+    EXPECT_EQ(size(sap.GetEntries()), std::size_t(0));
+    EXPECT_TRUE(empty(QueryIds(sap, GetBox(-100, -100, 200))));
+}
+
+TEST(SweepAndPrune, CreateUpdateDestroy)
+{
+    auto sap = SweepAndPrune{4};
+    const auto data = DynamicTree::LeafData{nullptr, nullptr, 3};
+    const auto id0 = sap.CreateProxy(GetBox(0, 0, 1), data);
+    const auto id1 = sap.CreateProxy(GetBox(4, 0, 1), data);
+    EXPECT_NE(id0, id1);
+    EXPECT_FALSE(sap.IsSorted());
+    EXPECT_EQ(sap.GetProxyCount(), SweepAndPrune::Size(2));
+    EXPECT_TRUE(sap.IsProxy(id0));
+    EXPECT_TRUE(sap.IsProxy(id1));
+    EXPECT_EQ(sap.GetAABB(id1), GetBox(4, 0, 1));
+    EXPECT_EQ(sap.GetLeafData(id0).childIndex, ChildCounter(3));
+
+    // Queries work whether or not the proxies are sorted.
+    EXPECT_EQ(QueryIds(sap, GetBox(0.5, 0.5, 1)), std::vector<SweepAndPrune::Size>{id0});
+    sap.Sort();
+    EXPECT_TRUE(sap.IsSorted());
+    EXPECT_EQ(QueryIds(sap, GetBox(0.5, 0.5, 1)), std::vector<SweepAndPrune::Size>{id0});
+    EXPECT_EQ(sap.GetMaxExtent(), 1_m);
+
+    sap.UpdateProxy(id1, GetBox(1, 0, 1));
+    EXPECT_FALSE(sap.IsSorted());
+    EXPECT_EQ(QueryIds(sap, GetBox(0.5, 0.5, 1)), (std::vector<SweepAndPrune::Size>{id0, id1}));
+    sap.Sort();
+    EXPECT_EQ(QueryIds(sap, GetBox(0.5, 0.5, 1)), (std::vector<SweepAndPrune::Size>{id0, id1}));
+
+    sap.DestroyProxy(id0);
+    EXPECT_FALSE(sap.IsProxy(id0));
+    EXPECT_EQ(sap.GetProxyCount(), SweepAndPrune::Size(1));
+    EXPECT_EQ(QueryIds(sap, GetBox(0.5, 0.5, 1)), std::vector<SweepAndPrune::Size>{id1});
+
+    // Identifiers of destroyed proxies only get reused after sorting.
+    const auto id2 = sap.CreateProxy(GetBox(8, 0, 1), data);
+    EXPECT_NE(id2, id0);
+    sap.Sort();
+    EXPECT_EQ(size(sap.GetEntries()), std::size_t(2));
+    const auto id3 = sap.CreateProxy(GetBox(9, 0, 1), data);
+    EXPECT_EQ(id3, id0);
+    sap.Sort();
+    EXPECT_EQ(QueryIds(sap, GetBox(7.5, 0, 4)), (std::vector<SweepAndPrune::Size>{id3, id2}));
+}
+
+TEST(SweepAndPrune, SortsAlongMostSpreadOutAxis)
+{
+    auto sap = SweepAndPrune{};
+    const auto data = DynamicTree::LeafData{nullptr, nullptr, 0};
+    for (auto i = 0; i < 10; ++i)
+    {
+        sap.CreateProxy(GetBox(0, i * Real(2), 1), data);
+    }
+    sap.Sort();
+    EXPECT_EQ(sap.GetAxis(), std::size_t(1));
+    const auto entries = sap.GetEntries();
+    EXPECT_TRUE(std::is_sorted(begin(entries), end(entries), [](const SweepAndPrune::Entry& a,
+                                                                const SweepAndPrune::Entry& b) {
+        return a.min < b.min;
+    }));
+    EXPECT_EQ(entries[0].min, 0_m);
+    EXPECT_EQ(entries[9].min, 18_m);
+}
+
+TEST(SweepAndPrune, QueriesAndPairsMatchBruteForce)
+{
+    auto sap = SweepAndPrune{};
+    auto ids = std::vector<SweepAndPrune::Size>{};
+    for (auto i = 0; i < 400; ++i)
+    {
+        const auto x = Real((i * 7919) % 200) / 2;
+        const auto y = Real((i * 104729) % 40) / 4;
+        const auto s = Real(1 + (i % 3)) / 2;
+        ids.push_back(sap.CreateProxy(GetBox(x, y, s), DynamicTree::LeafData{nullptr, nullptr,
+            static_cast<ChildCounter>(i)}));
+    }
+    for (auto round = std::size_t{0}; round < 3; ++round)
+    {
+        sap.Sort();
+        for (auto i = 0; i < 40; ++i)
+        {
+            const auto aabb = GetBox(Real(i * 5) / 2, Real(i % 10), 3);
+            EXPECT_EQ(QueryIds(sap, aabb), BruteForceIds(sap, aabb));
+        }
+
+        auto pairs = std::vector<std::pair<SweepAndPrune::Size, SweepAndPrune::Size>>{};
+        QueryPairs(sap, [&](SweepAndPrune::Size a, SweepAndPrune::Size b) {
+            pairs.emplace_back(std::min(a, b), std::max(a, b));
+        });
+        std::sort(begin(pairs), end(pairs));
+        auto expected = std::vector<std::pair<SweepAndPrune::Size, SweepAndPrune::Size>>{};
+        for (auto a = SweepAndPrune::Size{0}; a < sap.GetIdLimit(); ++a)
+        {
+            for (auto b = a + 1; b < sap.GetIdLimit(); ++b)
+            {
+                if (sap.IsProxy(a) && sap.IsProxy(b) &&
+                    TestOverlap(sap.GetAABB(a), sap.GetAABB(b)))
+                {
+                    expected.emplace_back(a, b);
+                }
+            }
+        }
+        EXPECT_EQ(pairs, expected);
+
+        // Move some proxies around and destroy others before the next round.
+        for (auto i = std::size_t{0}; i < size(ids); i += 3)
+        {
+            const auto aabb = sap.GetAABB(ids[i]);
+            sap.UpdateProxy(ids[i], GetMovedAABB(aabb, Length2{-3_m, 0.5_m}));
+        }
+        // Forgets the destroyed ids since they're no longer proxies and may get reused.
+        auto kept = std::vector<SweepAndPrune::Size>{};
+        for (auto i = std::size_t{0}; i < size(ids); ++i)
+        {
+            if ((i >= round) && ((i - round) % 37 == 0))
+            {
+                sap.DestroyProxy(ids[i]);
+                continue;
+            }
+            kept.push_back(ids[i]);
+        }
+        ids = kept;
+    }
+}
+
+TEST(SweepAndPrune, RayCastMatchesDynamicTree)
+{
+    auto sap = SweepAndPrune{};
+    auto tree = DynamicTree{};
+    for (auto i = 0; i < 50; ++i)
+    {
+        const auto aabb = GetBox(Real(i * 2), Real(i % 5) - 2, 1);
+        const auto data = DynamicTree::LeafData{nullptr, nullptr, static_cast<ChildCounter>(i)};
+        sap.CreateProxy(aabb, data);
+        tree.CreateLeaf(aabb, data);
+    }
+    sap.Sort();
+
+    const auto input = RayCastInput{Length2{-1_m, 0.5_m}, Length2{120_m, 0.5_m},
+        UnitInterval<Real>{1}};
+    const auto castAll = [&](const auto& structure) {
+        auto children = std::vector<ChildCounter>{};
+        RayCast(structure, input, [&](Fixture*, ChildCounter child, const RayCastInput& in) {
+            children.push_back(child);
+            return Real{in.maxFraction};
+        });
+        std::sort(begin(children), end(children));
+        return children;
+    };
+    const auto sapChildren = castAll(sap);
+    EXPECT_FALSE(empty(sapChildren));
+    EXPECT_EQ(sapChildren, castAll(tree));
+
+    auto calls = 0;
+    EXPECT_TRUE(RayCast(sap, input, [&](Fixture*, ChildCounter, const RayCastInput&) {
+        ++calls;
+        return Real{0};
+    }));
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(SweepAndPrune, ShiftOrigin)
+{
+    auto sap = SweepAndPrune{};
+    const auto id = sap.CreateProxy(GetBox(2, 3, 1), DynamicTree::LeafData{nullptr, nullptr, 0});
+    sap.Sort();
+    sap.ShiftOrigin(Length2{1_m, 1_m});
+    EXPECT_TRUE(sap.IsSorted());
+    EXPECT_EQ(sap.GetAABB(id), GetBox(1, 2, 1));
+    EXPECT_EQ(QueryIds(sap, GetBox(1.5, 2.5, 0.1)), std::vector<SweepAndPrune::Size>{id});
+}
@@ -1264,3 +1264,24 @@ TEST(TimeOfImpact, TryOutDifferentConfs)
     }
 }
 
+
+TEST(TimeOfImpact, WarmStartsFromSimplexCache)
+{
+    const auto limits = ToiConf{}.UseTargetDepth(0.003_m).UseTolerance(0.00025_m);
+    const auto square = PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m);
+    const auto proxy = GetChild(square, 0);
+    const auto sweepA = Sweep{Position{Length2{}, 0_deg}};
+    const auto sweepB = Sweep{Position{Length2{4_m, 1_m}, 10_deg}, Position{Length2{0.5_m, 0.2_m}, 20_deg}};
+
+    auto cache = Simplex::Cache{};
+    const auto cold = GetToiViaSat(proxy, sweepA, proxy, sweepB, cache, limits);
+    EXPECT_EQ(cold.state, TOIOutput::e_touching);
+    EXPECT_NE(cache.indices, InvalidIndexPair3);
+    EXPECT_EQ(cold.time, GetToiViaSat(proxy, sweepA, proxy, sweepB, limits).time);
+
+    // Starting from the cache of the same shapes gets the same result in fewer iterations.
+    const auto warm = GetToiViaSat(proxy, sweepA, proxy, sweepB, cache, limits);
+    EXPECT_EQ(warm.state, cold.state);
+    EXPECT_NEAR(static_cast<double>(warm.time), static_cast<double>(cold.time), 0.0001);
+    EXPECT_LT(warm.stats.sum_dist_iters, cold.stats.sum_dist_iters);
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "UnitTests.hpp"
+
+#include <PlayRho/Collision/UniformGrid.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace playrho;
+using namespace playrho::d2;
+
+namespace {
+
+std::vector<UniformGrid::Size> QueryIds(const UniformGrid& grid, const AABB& aabb)
+{
+    auto ids = std::vector<UniformGrid::Size>{};
+    Query(grid, aabb, [&](UniformGrid::Size id) {
+        ids.push_back(id);
+        return DynamicTreeOpcode::Continue;
+    });
+    std::sort(begin(ids), end(ids));
+    return ids;
+}
+
+std::vector<UniformGrid::Size> BruteForceIds(const UniformGrid& grid, const AABB& aabb)
+{
+    auto ids = std::vector<UniformGrid::Size>{};
+    for (auto id = UniformGrid::Size{0}; id < grid.GetIdLimit(); ++id)
+    {
+        if (grid.IsProxy(id) && TestOverlap(grid.GetAABB(id), aabb))
+        {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+AABB GetBox(Real x, Real y, Real size)
+{
+    return AABB{Length2{x * Meter, y * Meter}, Length2{(x + size) * Meter, (y + size) * Meter}};
+}
+
+} // anonymous namespace
+
+TEST(UniformGrid, DefaultConstruction)
+{
+    const auto grid = UniformGrid{};
+    EXPECT_EQ(grid.GetCellSize(), UniformGrid::GetDefaultCellSize());
+    EXPECT_EQ(grid.GetProxyCount(), UniformGrid::Size(0));
+    EXPECT_EQ(size(grid), std::size_t(0));
+    EXPECT_EQ(grid.GetIdLimit(), UniformGrid::Size(0));
+    EXPECT_EQ(grid.GetEntryCount(), std::size_t(0));
+    EXPECT_EQ(grid.GetBucketCount(), std::size_t(0));
+    EXPECT_TRUE(empty(QueryIds(grid, GetBox(-100, -100, 200))));
+}
+
+TEST(UniformGrid, GetCells)
+{
+    const auto grid = UniformGrid{1_m};
+    EXPECT_EQ(grid.GetCell(0_m), UniformGrid::CellCoord(0));
+    EXPECT_EQ(grid.GetCell(0.5_m), UniformGrid::CellCoord(0));
+    EXPECT_EQ(grid.GetCell(1_m), UniformGrid::CellCoord(1));
+    EXPECT_EQ(grid.GetCell(-0.5_m), UniformGrid::CellCoord(-1));
+    EXPECT_EQ(grid.GetCells(GetBox(-0.5, 0.5, 1)), (UniformGrid::CellRange{-1, 0, 0, 1}));
+    EXPECT_EQ(GetCellCount(UniformGrid::CellRange{-1, 0, 0, 1}), std::uint64_t(4));
+    EXPECT_GT(grid.GetCell(std::numeric_limits<Real>::max() * Meter), UniformGrid::CellCoord(0));
+    EXPECT_LT(grid.GetCell(std::numeric_limits<Real>::lowest() * Meter), UniformGrid::CellCoord(0));
+}
+
+TEST(UniformGrid, CreateUpdateDestroy)
+{
+    auto grid = UniformGrid{1_m, 4};
+    EXPECT_GT(grid.GetBucketCount(), std::size_t(0));
+    const auto data = DynamicTree::LeafData{nullptr, nullptr, 3};
+    const auto id0 = grid.CreateProxy(GetBox(0.25, 0.25, 0.5), data);
+    const auto id1 = grid.CreateProxy(GetBox(3.5, 0.5, 1), data);
+    EXPECT_NE(id0, id1);
+    EXPECT_EQ(grid.GetProxyCount(), UniformGrid::Size(2));
+    EXPECT_EQ(grid.GetEntryCount(), std::size_t(5));
+    EXPECT_TRUE(grid.IsProxy(id0));
+    EXPECT_TRUE(grid.IsProxy(id1));
+    EXPECT_EQ(grid.GetAABB(id1), GetBox(3.5, 0.5, 1));
+    EXPECT_EQ(grid.GetLeafData(id0).childIndex, ChildCounter(3));
+    EXPECT_EQ(QueryIds(grid, GetBox(0, 0, 1)), std::vector<UniformGrid::Size>{id0});
+
+    // Moving within the same cells doesn't change the entries.
+    grid.UpdateProxy(id0, GetBox(0.1, 0.1, 0.5));
+    EXPECT_EQ(grid.GetEntryCount(), std::size_t(5));
+    grid.UpdateProxy(id1, GetBox(0.5, 0, 0.25));
+    EXPECT_EQ(grid.GetEntryCount(), std::size_t(2));
+    EXPECT_EQ(QueryIds(grid, GetBox(0, 0, 1)), (std::vector<UniformGrid::Size>{id0, id1}));
+
+    grid.DestroyProxy(id0);
+    EXPECT_FALSE(grid.IsProxy(id0));
+    EXPECT_EQ(grid.GetProxyCount(), UniformGrid::Size(1));
+    EXPECT_EQ(grid.GetEntryCount(), std::size_t(1));
+    EXPECT_EQ(QueryIds(grid, GetBox(0, 0, 1)), std::vector<UniformGrid::Size>{id1});
+
+    // Identifiers of destroyed proxies get reused.
+    EXPECT_EQ(grid.CreateProxy(GetBox(8, 0, 1), data), id0);
+}
+
+TEST(UniformGrid, QueriesMatchBruteForce)
+{
+    auto grid = UniformGrid{1_m};
+    auto ids = std::vector<UniformGrid::Size>{};
+    for (auto i = 0; i < 400; ++i)
+    {
+        const auto x = Real((i * 7919) % 200) / 2 - 50;
+        const auto y = Real((i * 104729) % 40) / 4 - 5;
+        const auto s = Real(1 + (i % 5)) / 2;
+        ids.push_back(grid.CreateProxy(GetBox(x, y, s), DynamicTree::LeafData{nullptr, nullptr,
+            static_cast<ChildCounter>(i)}));
+    }
+    EXPECT_GE(grid.GetBucketCount() * 2, grid.GetEntryCount());
+    for (auto round = 0; round < 3; ++round)
+    {
+        for (auto i = 0; i < 40; ++i)
+        {
+            const auto aabb = GetBox(Real(i * 5) / 2 - 50, Real(i % 10) - 5, Real(1 + (i % 4)));
+            EXPECT_EQ(QueryIds(grid, aabb), BruteForceIds(grid, aabb));
+        }
+
+        // A box covering more cells than there are buckets gets the same results.
+        const auto everything = GetBox(-1000, -1000, 2000);
+        EXPECT_GT(GetCellCount(grid.GetCells(everything)), grid.GetBucketCount());
+        EXPECT_EQ(QueryIds(grid, everything), BruteForceIds(grid, everything));
+
+        // Move some proxies around and destroy others before the next round.
+        for (auto i = std::size_t{0}; i < size(ids); i += 3)
+        {
+            if (grid.IsProxy(ids[i]))
+            {
+                const auto aabb = grid.GetAABB(ids[i]);
+                grid.UpdateProxy(ids[i], GetMovedAABB(aabb, Length2{-3_m, 0.5_m}));
+            }
+        }
+        for (auto i = std::size_t{static_cast<std::size_t>(round)}; i < size(ids); i += 37)
+        {
+            if (grid.IsProxy(ids[i]))
+            {
+                grid.DestroyProxy(ids[i]);
+            }
+        }
+    }
+}
+
+TEST(UniformGrid, RayCastMatchesDynamicTree)
+{
+    auto grid = UniformGrid{1_m};
+    auto tree = DynamicTree{};
+    for (auto i = 0; i < 50; ++i)
+    {
+        const auto aabb = GetBox(Real(i * 2), Real(i % 5) - 2, Real(1 + (i % 3)));
+        const auto data = DynamicTree::LeafData{nullptr, nullptr, static_cast<ChildCounter>(i)};
+        grid.CreateProxy(aabb, data);
+        tree.CreateLeaf(aabb, data);
+    }
+
+    const auto castAll = [&](const auto& structure, const RayCastInput& input) {
+        auto children = std::vector<ChildCounter>{};
+        RayCast(structure, input, [&](Fixture*, ChildCounter child, const RayCastInput& in) {
+            children.push_back(child);
+            return Real{in.maxFraction};
+        });
+        std::sort(begin(children), end(children));
+        return children;
+    };
+    for (const auto& input: {
+        RayCastInput{Length2{-1_m, 0.5_m}, Length2{120_m, 0.5_m}, UnitInterval<Real>{1}},
+        RayCastInput{Length2{120_m, 2.5_m}, Length2{-1_m, -1.5_m}, UnitInterval<Real>{1}},
+        RayCastInput{Length2{10.5_m, -10_m}, Length2{10.5_m, 10_m}, UnitInterval<Real>{1}},
+        RayCastInput{Length2{0_m, -3_m}, Length2{60_m, 3_m}, UnitInterval<Real>{0.5f}},
+    })
+    {
+        const auto gridChildren = castAll(grid, input);
+        EXPECT_FALSE(empty(gridChildren));
+        EXPECT_EQ(gridChildren, castAll(tree, input));
+    }
+
+    // A ray covering more cells than there are buckets gets the same results.
+    const auto input = RayCastInput{Length2{-2000_m, 0.5_m}, Length2{2000_m, 0.5_m},
+        UnitInterval<Real>{1}};
+    EXPECT_GT(GetCellCount(grid.GetCells(GetAABB(input))), grid.GetBucketCount());
+    EXPECT_FALSE(empty(castAll(grid, input)));
+    EXPECT_EQ(castAll(grid, input), castAll(tree, input));
+
+    auto calls = 0;
+    EXPECT_TRUE(RayCast(grid, input, [&](Fixture*, ChildCounter, const RayCastInput&) {
+        ++calls;
+        return Real{0};
+    }));
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(UniformGrid, ShiftOrigin)
+{
+    auto grid = UniformGrid{1_m};
+    const auto id = grid.CreateProxy(GetBox(2.5, 3.5, 1), DynamicTree::LeafData{nullptr, nullptr, 0});
+    grid.ShiftOrigin(Length2{1_m, 1_m});
+    EXPECT_EQ(grid.GetAABB(id), GetBox(1.5, 2.5, 1));
+    EXPECT_EQ(grid.GetCells(id), grid.GetCells(GetBox(1.5, 2.5, 1)));
+    EXPECT_EQ(grid.GetEntryCount(), std::size_t(4));
+    EXPECT_EQ(QueryIds(grid, GetBox(1.5, 2.5, 0.1)), std::vector<UniformGrid::Size>{id});
+}
+
+TEST(UniformGrid, OversizedProxy)
+{
+    auto grid = UniformGrid{1_m};
+    const auto data = DynamicTree::LeafData{nullptr, nullptr, 0};
+    const auto small = grid.CreateProxy(GetBox(0, 0, 1), data);
+    const auto entries = grid.GetEntryCount();
+
+    // A proxy spanning a huge area doesn't get an entry for every cell it overlaps.
+    const auto huge = grid.CreateProxy(GetBox(-1e6f, -1e6f, 2e6f), data);
+    EXPECT_GT(GetCellCount(grid.GetCells(huge)), grid.GetBucketCount());
+    EXPECT_EQ(grid.GetEntryCount(), entries);
+    ASSERT_EQ(grid.GetOversized().size(), std::size_t(1));
+    EXPECT_EQ(grid.GetOversized()[0], huge);
+
+    EXPECT_EQ(QueryIds(grid, GetBox(0.5, 0.5, 0.25)), (std::vector<UniformGrid::Size>{small, huge}));
+    EXPECT_EQ(QueryIds(grid, GetBox(5e5f, -5e5f, 1)), std::vector<UniformGrid::Size>{huge});
+    EXPECT_EQ(QueryIds(grid, GetBox(2e6f, 0, 1)), std::vector<UniformGrid::Size>{});
+
+    auto hits = std::vector<UniformGrid::Size>{};
+    RayCast(grid, RayCastInput{Length2{1e5_m, 5_m}, Length2{1e5_m + 10_m, 5_m}, UnitInterval<Real>{1}},
+            [&](UniformGrid::Size id, const RayCastInput& in) {
+        hits.push_back(id);
+        return Real{in.maxFraction};
+    });
+    EXPECT_EQ(hits, std::vector<UniformGrid::Size>{huge});
+
+    // Shrinking the proxy puts it into the cells and growing it takes it back out.
+    grid.UpdateProxy(huge, GetBox(4, 4, 1));
+    EXPECT_TRUE(grid.GetOversized().empty());
+    EXPECT_EQ(grid.GetEntryCount(), entries + 4);
+    EXPECT_EQ(QueryIds(grid, GetBox(4.5, 4.5, 0.1)), std::vector<UniformGrid::Size>{huge});
+    grid.UpdateProxy(huge, GetBox(-1e6f, -1e6f, 2e6f));
+    EXPECT_EQ(grid.GetEntryCount(), entries);
+    EXPECT_EQ(grid.GetOversized().size(), std::size_t(1));
+
+    grid.ShiftOrigin(Length2{1_m, 1_m});
+    EXPECT_EQ(grid.GetOversized().size(), std::size_t(1));
+    EXPECT_EQ(QueryIds(grid, GetBox(5e5f, -5e5f, 1)), std::vector<UniformGrid::Size>{huge});
+
+    grid.DestroyProxy(huge);
+    EXPECT_TRUE(grid.GetOversized().empty());
+    EXPECT_EQ(QueryIds(grid, GetBox(-1, -1, 1)), std::vector<UniformGrid::Size>{small});
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2017 Louis Langholtz https://github.com/louis-langholtz/PlayRho
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "UnitTests.hpp"
+
+#include <PlayRho/Collision/WideTree.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace playrho;
+using namespace playrho::d2;
+
+namespace {
+
+template <class T>
+std::vector<DynamicTree::Size> QueryLeaves(const T& tree, const AABB& aabb)
+{
+    auto leaves = std::vector<DynamicTree::Size>{};
+    Query(tree, aabb, [&](DynamicTree::Size index) {
+        leaves.push_back(index);
+        return DynamicTreeOpcode::Continue;
+    });
+    std::sort(begin(leaves), end(leaves));
+    return leaves;
+}
+
+template <class T>
+std::vector<ChildCounter> RayCastLeaves(const T& tree, const RayCastInput& input)
+{
+    auto leaves = std::vector<ChildCounter>{};
+    RayCast(tree, input, [&](Fixture*, ChildCounter child, const RayCastInput& in) {
+        leaves.push_back(child);
+        return Real{in.maxFraction};
+    });
+    std::sort(begin(leaves), end(leaves));
+    return leaves;
+}
+
+AABB GetBox(Real x, Real y, Real size)
+{
+    return AABB{Length2{x * Meter, y * Meter}, Length2{(x + size) * Meter, (y + size) * Meter}};
+}
+
+DynamicTree::LeafData GetLeafData(ChildCounter id)
+{
+    return DynamicTree::LeafData{nullptr, nullptr, id};
+}
+
+} // anonymous namespace
+
+TEST(WideTree, DefaultConstruction)
+{
+    const auto tree = WideTree{};
+    EXPECT_EQ(tree.GetNodeCount(), WideTree::Size(0));
+    EXPECT_EQ(tree.GetLeafCount(), WideTree::Size(0));
+    EXPECT_EQ(size(tree), std::size_t(0));
+    EXPECT_TRUE(QueryLeaves(tree, GetBox(0, 0, 1)).empty());
+    EXPECT_TRUE(RayCastLeaves(tree, RayCastInput{Length2{}, Length2{1_m, 1_m}, Real(1)}).empty());
+}
+
+TEST(WideTree, LoneLeaf)
+{
+    auto dynamicTree = DynamicTree{};
+    const auto leaf = dynamicTree.CreateLeaf(GetBox(0, 0, 1), GetLeafData(7));
+    
+    const auto tree = WideTree{dynamicTree};
+    ASSERT_EQ(tree.GetNodeCount(), WideTree::Size(1));
+    ASSERT_EQ(tree.GetLeafCount(), WideTree::Size(1));
+    EXPECT_EQ(tree.GetNode(0).count, 1u);
+    EXPECT_EQ(tree.GetNode(0).leafMask, 1u);
+    EXPECT_EQ(tree.GetLeafIndex(0), leaf);
+    EXPECT_EQ(tree.GetLeafAABB(0), GetBox(0, 0, 1));
+    EXPECT_EQ(tree.GetLeafData(0).childIndex, ChildCounter(7));
+    EXPECT_EQ(QueryLeaves(tree, GetBox(0.5, 0.5, 2)), std::vector<DynamicTree::Size>{leaf});
+    EXPECT_TRUE(QueryLeaves(tree, GetBox(2, 2, 1)).empty());
+}
+
+TEST(WideTree, CollapsesToFourWide)
+{
+    auto dynamicTree = DynamicTree{};
+    for (auto i = 0; i < 4; ++i)
+    {
+        dynamicTree.CreateLeaf(GetBox(Real(i * 4), 0, 1), GetLeafData(ChildCounter(i)));
+    }
+    ASSERT_EQ(dynamicTree.GetNodeCount(), DynamicTree::Size(7));
+    
+    const auto tree = WideTree{dynamicTree};
+    ASSERT_EQ(tree.GetNodeCount(), WideTree::Size(1));
+    EXPECT_EQ(tree.GetLeafCount(), WideTree::Size(4));
+    EXPECT_EQ(tree.GetNode(0).count, 4u);
+    EXPECT_EQ(tree.GetNode(0).leafMask, 0xFu);
+}
+
+TEST(WideTree, QueryAndRayCastSameAsDynamicTree)
+{
+    auto dynamicTree = DynamicTree{};
+    auto value = std::uint32_t{42};
+    const auto next = [&]() {
+        value = value * 1103515245u + 12345u;
+        return static_cast<Real>((value >> 16u) % 1000u) / Real{10};
+    };
+    for (auto i = 0; i < 1000; ++i)
+    {
+        dynamicTree.CreateLeaf(GetBox(next(), next(), next() / 20), GetLeafData(ChildCounter(i)));
+    }
+    
+    const auto tree = WideTree{dynamicTree};
+    EXPECT_EQ(tree.GetLeafCount(), dynamicTree.GetLeafCount());
+    EXPECT_LT(tree.GetNodeCount(), dynamicTree.GetNodeCount() / 2);
+    
+    auto totalQueried = std::size_t{0};
+    auto totalRayCast = std::size_t{0};
+    for (auto i = 0; i < 200; ++i)
+    {
+        const auto aabb = GetBox(next(), next(), next() / 10);
+        const auto expected = QueryLeaves(dynamicTree, aabb);
+        EXPECT_EQ(QueryLeaves(tree, aabb), expected);
+        totalQueried += size(expected);
+        
+        const auto p1 = Length2{next() * Meter, next() * Meter};
+        const auto p2 = Length2{next() * Meter, next() * Meter};
+        const auto input = RayCastInput{p1, p2, Real(next() / 100)};
+        const auto expectedHits = RayCastLeaves(dynamicTree, input);
+        EXPECT_EQ(RayCastLeaves(tree, input), expectedHits);
+        totalRayCast += size(expectedHits);
+    }
+    EXPECT_GT(totalQueried, std::size_t(0));
+    EXPECT_GT(totalRayCast, std::size_t(0));
+}
+
+TEST(WideTree, RayCastClipsAndTerminates)
+{
+    auto dynamicTree = DynamicTree{};
+    for (auto i = 0; i < 10; ++i)
+    {
+        dynamicTree.CreateLeaf(GetBox(Real(i * 2), 0, 1), GetLeafData(ChildCounter(i)));
+    }
+    const auto tree = WideTree{dynamicTree};
+    const auto input = RayCastInput{Length2{-1_m, 0.5_m}, Length2{30_m, 0.5_m}, Real(1)};
+    
+    // Clipping at each hit leaf's near side finds the nearest leaf.
+    auto nearest = ChildCounter{0};
+    auto nearestFraction = Real(2);
+    const auto terminated = RayCast(tree, input, [&](Fixture*, ChildCounter child,
+                                                     const RayCastInput& in) {
+        const auto fraction = (Real(child * 2) + Real(1)) / Real(31);
+        EXPECT_LE(fraction, Real{in.maxFraction});
+        if (fraction < nearestFraction)
+        {
+            nearest = child;
+            nearestFraction = fraction;
+        }
+        return fraction;
+    });
+    EXPECT_FALSE(terminated);
+    EXPECT_EQ(nearest, ChildCounter(0));
+    
+    auto ncalls = 0;
+    EXPECT_TRUE(RayCast(tree, input, [&](Fixture*, ChildCounter, const RayCastInput&) {
+        ++ncalls;
+        return Real(0);
+    }));
+    EXPECT_EQ(ncalls, 1);
+}
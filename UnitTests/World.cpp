@@ -45,7 +45,11 @@
 #include <PlayRho/Dynamics/Joints/GearJoint.hpp>
 #include <PlayRho/Common/LengthError.hpp>
 #include <PlayRho/Common/WrongState.hpp>
+#include <array>
 #include <chrono>
+#include <map>
+#include <thread>
+#include <tuple>
 #include <type_traits>
 
 using namespace playrho;
@@ -77,25 +81,25 @@ TEST(World, ByteSize)
             // Size is OS dependent.
             // Seems linux containers are bigger in size...
 #ifdef __APPLE__
-            EXPECT_EQ(sizeof(World), std::size_t(232));
+            EXPECT_EQ(sizeof(World), std::size_t(392));
 #endif
 #ifdef __linux__
-            EXPECT_EQ(sizeof(World), std::size_t(232));
+            EXPECT_EQ(sizeof(World), std::size_t(392));
 #endif
             break;
         }
         case  8:
         {
 #ifdef __APPLE__
-            EXPECT_EQ(sizeof(World), std::size_t(248));
+            EXPECT_EQ(sizeof(World), std::size_t(416));
 #endif
 #ifdef __linux__
-            EXPECT_EQ(sizeof(World), std::size_t(248));
+            EXPECT_EQ(sizeof(World), std::size_t(416));
 #endif
             break;
         }
         case 16:
-            EXPECT_EQ(sizeof(World), std::size_t(272));
+            EXPECT_EQ(sizeof(World), std::size_t(480));
             break;
         default: FAIL(); break;
     }
@@ -653,6 +657,70 @@ TEST(World, CreateDestroyContactingBodies)
     EXPECT_EQ(GetFixtureCount(world), std::size_t(0));
 }
 
+TEST(World, DestroyContactsOfMovedOrFilteredProxies)
+{
+    auto world = World{};
+    const auto shape = Shape{DiskShapeConf{1_m}.UseDensity(1_kgpm2)};
+    const auto body1 = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic));
+    const auto body2 = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic)
+                                        .UseLocation(Length2{1_m, 0_m}));
+    const auto body3 = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic)
+                                        .UseLocation(Length2{10_m, 0_m}));
+    const auto body4 = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic)
+                                        .UseLocation(Length2{11_m, 0_m}));
+    body1->CreateFixture(shape);
+    body2->CreateFixture(shape);
+    body3->CreateFixture(shape);
+    body4->CreateFixture(shape);
+    
+    auto stepConf = StepConf{};
+    stepConf.SetTime(0_s);
+    auto stats = world.Step(stepConf);
+    EXPECT_EQ(stats.pre.added, ContactCounter(2));
+    ASSERT_EQ(world.GetContacts().size(), ContactCounter(2));
+    
+    // Moving a body out of overlap destroys only its contact.
+    body4->SetTransform(Length2{20_m, 0_m}, 0_deg);
+    stats = world.Step(stepConf);
+    EXPECT_EQ(stats.pre.destroyed, ContactCounter(1));
+    ASSERT_EQ(world.GetContacts().size(), ContactCounter(1));
+    
+    // Filtering happens for contacts of bodies that haven't moved.
+    body1->UnsetAwake();
+    body2->UnsetAwake();
+    ASSERT_NE(world.CreateJoint(DistanceJointConf{body1, body2}), nullptr);
+    stats = world.Step(stepConf);
+    EXPECT_EQ(stats.pre.destroyed, ContactCounter(1));
+    EXPECT_TRUE(world.GetContacts().empty());
+}
+
+TEST(World, DestroyContactsOfRestingBodyWhoseFilterChanged)
+{
+    auto world = World{};
+    const auto ground = world.CreateBody();
+    ground->CreateFixture(Shape{PolygonShapeConf{}.SetAsBox(10_m, 1_m)});
+    const auto body = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic)
+                                       .UseLocation(Length2{0_m, 1.5_m}));
+    const auto fixture = body->CreateFixture(Shape{PolygonShapeConf{}.UseDensity(1_kgpm2)
+        .SetAsBox(0.5_m, 0.5_m)});
+    
+    auto stepConf = StepConf{};
+    stepConf.SetTime(1_s / 60);
+    for (auto i = 0; (i < 600) && body->IsAwake(); ++i)
+    {
+        world.Step(stepConf);
+    }
+    ASSERT_FALSE(body->IsAwake());
+    ASSERT_EQ(world.GetContacts().size(), ContactCounter(1));
+    
+    auto filter = fixture->GetFilterData();
+    filter.maskBits = 0;
+    fixture->SetFilterData(filter);
+    const auto stats = world.Step(stepConf);
+    EXPECT_EQ(stats.pre.destroyed, ContactCounter(1));
+    EXPECT_TRUE(world.GetContacts().empty());
+}
+
 #if 0
 TEST(World, CreateAndDestroyFixture)
 {
@@ -2455,6 +2523,1064 @@ TEST(World, CollidingDynamicBodies)
     EXPECT_EQ(GetY(GetLinearVelocity(*body_b)), 0_mps);
 }
 
+namespace {
+
+/// @brief Scene of dynamic bodies having the same shape and of an optional static ground.
+struct Scene
+{
+    Shape shape; ///< Shape of the dynamic bodies.
+    std::vector<Length2> locations; ///< Locations of the dynamic bodies.
+    LinearAcceleration2 acceleration; ///< Linear acceleration of the dynamic bodies.
+    std::vector<Shape> ground; ///< Shapes of the static ground body. No ground if empty.
+};
+
+/// @brief Pair of the locations of the bodies of a contact.
+using LocationPair = std::pair<Length2, Length2>;
+
+/// @brief Gets the locations of the given numbers of columns and rows of a grid of the
+///   given spacing that starts from the given location.
+/// @note Locations are column by column.
+std::vector<Length2> GetGridLocations(int columns, int rows, Length spacing,
+                                      Length2 start = Length2{})
+{
+    auto locations = std::vector<Length2>{};
+    for (auto i = 0; i < columns; ++i)
+    {
+        for (auto j = 0; j < rows; ++j)
+        {
+            locations.push_back(start + Length2{i * spacing, j * spacing});
+        }
+    }
+    return locations;
+}
+
+/// @brief Creates the bodies of the given scene in the given world.
+/// @return Ground body or <code>nullptr</code> if the scene has no ground.
+Body* CreateScene(World& world, const Scene& scene)
+{
+    auto ground = static_cast<Body*>(nullptr);
+    if (!empty(scene.ground))
+    {
+        ground = world.CreateBody(BodyConf{}.UseType(BodyType::Static));
+        for (const auto& shape: scene.ground)
+        {
+            ground->CreateFixture(shape);
+        }
+    }
+    for (const auto& location: scene.locations)
+    {
+        const auto body = world.CreateBody(BodyConf{}
+                                           .UseType(BodyType::Dynamic)
+                                           .UseLocation(location)
+                                           .UseLinearAcceleration(scene.acceleration));
+        body->CreateFixture(scene.shape);
+    }
+    return ground;
+}
+
+/// @brief Whether the first location is less than the second one.
+bool IsLess(Length2 lhs, Length2 rhs)
+{
+    return std::make_tuple(GetX(lhs), GetY(lhs)) < std::make_tuple(GetX(rhs), GetY(rhs));
+}
+
+/// @brief Gets the locations of the bodies of the contacts of the given world.
+/// @details Identifies the contacts of worlds made from the same scene. Pairs are in the
+///   order of the contacts and have the lesser of their locations first.
+std::vector<LocationPair> GetContactLocations(const World& world)
+{
+    auto pairs = std::vector<LocationPair>{};
+    for (auto&& c: world.GetContacts())
+    {
+        const auto contact = GetContactPtr(c);
+        auto a = contact->GetFixtureA()->GetBody()->GetLocation();
+        auto b = contact->GetFixtureB()->GetBody()->GetLocation();
+        if (IsLess(b, a))
+        {
+            std::swap(a, b);
+        }
+        pairs.emplace_back(a, b);
+    }
+    return pairs;
+}
+
+/// @brief Gets the sorted locations of the bodies of the contacts of the given world.
+/// @details For comparing the contacts of worlds regardless of the order of the contacts.
+std::vector<LocationPair> GetSortedContactLocations(const World& world)
+{
+    auto pairs = GetContactLocations(world);
+    std::sort(begin(pairs), end(pairs), [](const LocationPair& lhs, const LocationPair& rhs) {
+        return IsLess(lhs.first, rhs.first) ||
+            (!IsLess(rhs.first, lhs.first) && IsLess(lhs.second, rhs.second));
+    });
+    return pairs;
+}
+
+} // anonymous namespace
+
+TEST(World, FindNewContactsSameForAnyMaxThreads)
+{
+    const auto scene = Scene{
+        Shape(DiskShapeConf{}.UseDensity(1_kgpm2).UseRadius(0.6_m)),
+        GetGridLocations(40, 40, 1_m), EarthlyGravity, {}
+    };
+    auto serialWorld = World{};
+    auto threadedWorld = World{};
+    CreateScene(serialWorld, scene);
+    CreateScene(threadedWorld, scene);
+    
+    auto serialConf = StepConf{};
+    serialConf.maxThreads = 1;
+    auto threadedConf = StepConf{};
+    threadedConf.maxThreads = 4;
+    for (auto i = 0; i < 10; ++i)
+    {
+        const auto serialStats = serialWorld.Step(serialConf);
+        const auto threadedStats = threadedWorld.Step(threadedConf);
+        EXPECT_EQ(serialStats.pre.added, threadedStats.pre.added);
+        EXPECT_EQ(serialStats.reg.contactsAdded, threadedStats.reg.contactsAdded);
+        EXPECT_EQ(serialStats.toi.contactsAdded, threadedStats.toi.contactsAdded);
+        ASSERT_EQ(GetContactLocations(serialWorld), GetContactLocations(threadedWorld));
+    }
+    EXPECT_GT(size(serialWorld.GetContacts()), std::size_t(0));
+}
+
+TEST(World, UpdateContactsConcurrentlyCallsListenerInOrder)
+{
+    // Listener that records its events and checks that it's only called from the thread
+    // that's stepping the world.
+    struct Listener: ContactListener
+    {
+        using Event = std::tuple<char, Length2, Length2, Manifold::size_type>;
+        std::thread::id threadId = std::this_thread::get_id();
+        std::vector<Event> events;
+
+        void Record(char type, Contact& contact)
+        {
+            EXPECT_EQ(std::this_thread::get_id(), threadId);
+            events.emplace_back(type, contact.GetFixtureA()->GetBody()->GetLocation(),
+                                contact.GetFixtureB()->GetBody()->GetLocation(),
+                                contact.GetManifold().GetPointCount());
+        }
+
+        void BeginContact(Contact& contact) override
+        {
+            Record('B', contact);
+        }
+
+        void EndContact(Contact& contact) override
+        {
+            Record('E', contact);
+        }
+
+        void PreSolve(Contact& contact, const Manifold&) override
+        {
+            Record('P', contact);
+        }
+
+        void PostSolve(Contact&, const ContactImpulsesList&, iteration_type) override {}
+    };
+
+    const auto setup = [](World& world) {
+        const auto disk = Shape{DiskShapeConf{}.UseRadius(0.5_m).UseDensity(1_kgpm2)};
+        const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m).UseDensity(1_kgpm2)};
+        for (auto i = 0; i < 1600; ++i)
+        {
+            const auto body = world.CreateBody(BodyConf{}
+                .UseType(BodyType::Dynamic)
+                .UseLocation(Length2{(i % 40) * 0.95_m, (i / 40) * 0.95_m})
+                .UseLinearAcceleration(EarthlyGravity));
+            body->CreateFixture((i % 3 == 0)? box: disk, FixtureConf{}.UseIsSensor(i % 13 == 0));
+        }
+    };
+    auto serialWorld = World{};
+    auto threadedWorld = World{};
+    auto serialListener = Listener{};
+    auto threadedListener = Listener{};
+    serialWorld.SetContactListener(&serialListener);
+    threadedWorld.SetContactListener(&threadedListener);
+    setup(serialWorld);
+    setup(threadedWorld);
+
+    auto serialConf = StepConf{};
+    serialConf.maxThreads = 1;
+    auto threadedConf = StepConf{};
+    threadedConf.maxThreads = 4;
+    for (auto i = 0; i < 3; ++i)
+    {
+        const auto serialStats = serialWorld.Step(serialConf);
+        const auto threadedStats = threadedWorld.Step(threadedConf);
+        EXPECT_EQ(serialStats.pre.updated, threadedStats.pre.updated);
+        ASSERT_EQ(serialListener.events, threadedListener.events);
+    }
+    EXPECT_GT(size(serialWorld.GetContacts()), std::size_t(2048));
+    EXPECT_FALSE(empty(serialListener.events));
+}
+
+TEST(World, AabbPredictionSteps)
+{
+    EXPECT_EQ(StepConf{}.aabbPredictionSteps, Real(0));
+    
+    const auto diskShape = Shape(DiskShapeConf{}.UseDensity(1_kgpm2).UseRadius(0.5_m));
+    const auto run = [&](Real predictionSteps) {
+        auto world = World{};
+        const auto slow = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic)
+                                           .UseLocation(Length2{0_m, 10_m}));
+        slow->CreateFixture(diskShape);
+        for (auto i = 0; i < 10; ++i)
+        {
+            const auto fast = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic)
+                                               .UseLocation(Length2{0_m, i * 2_m})
+                                               .UseLinearVelocity(LinearVelocity2{
+                (i + 1) * 10_mps, 0_mps}));
+            fast->CreateFixture(diskShape);
+        }
+        auto stepConf = StepConf{};
+        stepConf.SetTime(1_s / 60);
+        stepConf.aabbPredictionSteps = predictionSteps;
+        auto moved = 0u;
+        auto kept = 0u;
+        for (auto i = 0; i < 60; ++i)
+        {
+            const auto stats = world.Step(stepConf);
+            moved += stats.reg.proxiesMoved;
+            kept += stats.reg.proxiesKept;
+        }
+        const auto slowProxy = GetRef(*begin(slow->GetFixtures())).GetProxy(0);
+        const auto slowAabb = world.GetTree().GetAABB(slowProxy.treeId);
+        return std::make_tuple(moved, kept, GetPerimeter(slowAabb));
+    };
+    const auto defaultResults = run(0);
+    const auto predictedResults = run(4);
+    EXPECT_LT(std::get<0>(predictedResults), std::get<0>(defaultResults));
+    EXPECT_GT(std::get<1>(predictedResults), std::get<1>(defaultResults));
+    EXPECT_LT(std::get<2>(predictedResults), std::get<2>(defaultResults));
+}
+
+TEST(World, QueryAndRayCastCoverStaticTree)
+{
+    for (const auto separate: {false, true})
+    {
+        auto world = World{WorldConf{}.UseSeparateStaticTree(separate)};
+        const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m)};
+        const auto ground = world.CreateBody(BodyConf{}.UseType(BodyType::Static)
+                                             .UseLocation(Length2{4_m, 0_m}));
+        const auto groundFixture = ground->CreateFixture(box);
+        const auto body = world.CreateBody(BodyConf{}.UseType(BodyType::Dynamic)
+                                           .UseLocation(Length2{2_m, 0_m}));
+        const auto bodyFixture = body->CreateFixture(box);
+        Step(world, 0_s);
+        ASSERT_EQ(world.GetStaticTree().GetLeafCount(), DynamicTree::Size(separate? 1: 0));
+        
+        auto found = std::vector<Fixture*>{};
+        Query(world, AABB{LengthInterval{0_m, 10_m}, LengthInterval{-1_m, 1_m}},
+              [&](Fixture* fixture, ChildCounter) {
+            found.push_back(fixture);
+            return true;
+        });
+        std::sort(begin(found), end(found));
+        auto expected = std::vector<Fixture*>{groundFixture, bodyFixture};
+        std::sort(begin(expected), end(expected));
+        EXPECT_EQ(found, expected);
+        
+        found.clear();
+        Query(world, AABB{LengthInterval{0_m, 10_m}, LengthInterval{-1_m, 1_m}},
+              [&](Fixture* fixture, ChildCounter) {
+            found.push_back(fixture);
+            return false;
+        });
+        EXPECT_EQ(size(found), std::size_t(1));
+        
+        // Clipping the ray to the closest hit so far leaves the nearer body as the last hit.
+        auto hits = std::vector<Fixture*>{};
+        const auto input = RayCastInput{Length2{-2_m, 0_m}, Length2{10_m, 0_m},
+            UnitInterval<Real>{1}};
+        EXPECT_FALSE(RayCast(world, input, [&](Fixture* fixture, ChildCounter, Length2, UnitVec) {
+            hits.push_back(fixture);
+            return RayCastOpcode::ClipRay;
+        }));
+        ASSERT_FALSE(empty(hits));
+        EXPECT_EQ(hits.back(), bodyFixture);
+        
+        hits.clear();
+        EXPECT_FALSE(RayCast(world, input, [&](Fixture* fixture, ChildCounter, Length2, UnitVec) {
+            hits.push_back(fixture);
+            return RayCastOpcode::ResetRay;
+        }));
+        EXPECT_EQ(size(hits), std::size_t(2));
+        
+        hits.clear();
+        EXPECT_TRUE(RayCast(world, input, [&](Fixture* fixture, ChildCounter, Length2, UnitVec) {
+            hits.push_back(fixture);
+            return RayCastOpcode::Terminate;
+        }));
+        EXPECT_EQ(size(hits), std::size_t(1));
+    }
+}
+
+TEST(World, QueryAndRayCastByCategoryBits)
+{
+    for (const auto broadPhase: {BroadPhaseType::DynamicTree, BroadPhaseType::SweepAndPrune,
+                                 BroadPhaseType::UniformGrid})
+    {
+        auto world = World{WorldConf{}.UseBroadPhase(broadPhase).UseSeparateStaticTree(true)};
+        const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m)};
+        auto fixtures = std::vector<Fixture*>{};
+        for (auto i = 0; i < 8; ++i)
+        {
+            const auto body = world.CreateBody(BodyConf{}
+                .UseType((i % 2 == 0)? BodyType::Static: BodyType::Dynamic)
+                .UseLocation(Length2{i * 2_m, 0_m}));
+            auto filter = Filter{};
+            filter.categoryBits = static_cast<Filter::bits_type>(1u << (i % 3));
+            fixtures.push_back(body->CreateFixture(box, FixtureConf{}.UseFilter(filter)));
+        }
+        Step(world, 0_s);
+        
+        const auto aabb = AABB{LengthInterval{-1_m, 20_m}, LengthInterval{-1_m, 1_m}};
+        const auto queryAll = [&](Filter::bits_type maskBits) {
+            auto found = std::vector<Fixture*>{};
+            Query(world, aabb, maskBits, [&](Fixture* fixture, ChildCounter) {
+                found.push_back(fixture);
+                return true;
+            });
+            std::sort(begin(found), end(found));
+            return found;
+        };
+        auto expected = std::vector<Fixture*>{fixtures[1], fixtures[4], fixtures[7]};
+        std::sort(begin(expected), end(expected));
+        EXPECT_EQ(queryAll(0x2), expected);
+        EXPECT_EQ(size(queryAll(0x7)), size(fixtures));
+        EXPECT_TRUE(empty(queryAll(0x8)));
+        
+        const auto input = RayCastInput{Length2{-2_m, 0_m}, Length2{20_m, 0_m},
+            UnitInterval<Real>{1}};
+        auto hits = std::vector<Fixture*>{};
+        EXPECT_FALSE(RayCast(world, input, Filter::bits_type(0x4),
+                             [&](Fixture* fixture, ChildCounter, Length2, UnitVec) {
+            hits.push_back(fixture);
+            return RayCastOpcode::ResetRay;
+        }));
+        std::sort(begin(hits), end(hits));
+        expected = std::vector<Fixture*>{fixtures[2], fixtures[5]};
+        std::sort(begin(expected), end(expected));
+        EXPECT_EQ(hits, expected);
+        
+        // Changing a fixture's filter data changes which masked queries find it.
+        auto filter = fixtures[0]->GetFilterData();
+        filter.categoryBits = 0x8;
+        fixtures[0]->SetFilterData(filter);
+        EXPECT_EQ(queryAll(0x8), std::vector<Fixture*>{fixtures[0]});
+        EXPECT_EQ(size(queryAll(0x1)), std::size_t(2));
+    }
+}
+
+TEST(World, QueryPointAndFindClosestFixtures)
+{
+    for (const auto broadPhase: {BroadPhaseType::DynamicTree, BroadPhaseType::SweepAndPrune,
+                                 BroadPhaseType::UniformGrid})
+    {
+        for (const auto separate: {false, true})
+        {
+            auto world = World{WorldConf{}.UseBroadPhase(broadPhase).UseSeparateStaticTree(separate)};
+            const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m)};
+            auto fixtures = std::vector<Fixture*>{};
+            for (auto i = 0; i < 20; ++i)
+            {
+                const auto body = world.CreateBody(BodyConf{}
+                    .UseType((i % 3 == 0)? BodyType::Static: BodyType::Dynamic)
+                    .UseLocation(Length2{(i % 5) * 3_m, (i / 5) * 3_m}));
+                fixtures.push_back(body->CreateFixture(box));
+            }
+            Step(world, 0_s);
+            
+            auto found = std::vector<Fixture*>{};
+            QueryPoint(world, Length2{6.25_m, 3.25_m}, [&](Fixture* fixture, ChildCounter) {
+                found.push_back(fixture);
+                return true;
+            });
+            EXPECT_EQ(found, std::vector<Fixture*>{fixtures[7]});
+            found.clear();
+            QueryPoint(world, Length2{7.5_m, 4.5_m}, [&](Fixture* fixture, ChildCounter) {
+                found.push_back(fixture);
+                return true;
+            });
+            EXPECT_TRUE(empty(found));
+            
+            const auto point = Length2{7.5_m, 4.5_m};
+            auto expected = std::vector<FixtureChildDistance>{};
+            for (const auto& fixture: fixtures)
+            {
+                expected.push_back(FixtureChildDistance{fixture, 0, GetDistance(*fixture, 0, point)});
+            }
+            std::stable_sort(begin(expected), end(expected), [](const FixtureChildDistance& lhs,
+                                                                const FixtureChildDistance& rhs) {
+                return lhs.distance < rhs.distance;
+            });
+            
+            const auto closest = FindClosestFixture(world, Length2{6.25_m, 3.25_m});
+            EXPECT_EQ(closest.fixture, fixtures[7]);
+            EXPECT_EQ(closest.distance, 0_m);
+            EXPECT_EQ(FindClosestFixture(world, Length2{100_m, 100_m}, 10_m).fixture, nullptr);
+            
+            auto nearest = std::vector<FixtureChildDistance>{};
+            FindClosestFixtures(world, point, 6, nearest);
+            ASSERT_EQ(size(nearest), std::size_t(6));
+            for (auto i = std::size_t{0}; i < size(nearest); ++i)
+            {
+                EXPECT_EQ(nearest[i].distance, expected[i].distance);
+            }
+            // The four fixtures around the point are equally far away from it.
+            EXPECT_EQ(nearest[0].distance, nearest[3].distance);
+            EXPECT_LT(nearest[3].distance, nearest[4].distance);
+            
+            FindClosestFixtures(world, point, 100, nearest, 3_m);
+            EXPECT_EQ(size(nearest), static_cast<std::size_t>(
+                std::count_if(begin(expected), end(expected), [](const FixtureChildDistance& e) {
+                    return e.distance <= 3_m;
+                })));
+            FindClosestFixtures(world, point, 0, nearest);
+            EXPECT_TRUE(empty(nearest));
+        }
+    }
+}
+
+TEST(World, RayCastClosest)
+{
+    for (const auto broadPhase: {BroadPhaseType::DynamicTree, BroadPhaseType::SweepAndPrune,
+                                 BroadPhaseType::UniformGrid})
+    {
+        for (const auto separate: {false, true})
+        {
+            auto world = World{WorldConf{}.UseBroadPhase(broadPhase).UseSeparateStaticTree(separate)};
+            const auto disk = Shape{DiskShapeConf{}.UseRadius(0.5_m)};
+            const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m)};
+            auto fixtures = std::vector<Fixture*>{};
+            for (auto i = 0; i < 60; ++i)
+            {
+                const auto body = world.CreateBody(BodyConf{}
+                    .UseType((i % 3 == 0)? BodyType::Static: BodyType::Dynamic)
+                    .UseLocation(Length2{(i % 10) * 2.5_m, (i / 10) * 2.5_m})
+                    .UseAngle((i % 4) * 0.3_rad));
+                fixtures.push_back(body->CreateFixture((i % 2 == 0)? disk: box));
+            }
+            Step(world, 0_s);
+
+            // Expected results come from clipping the ray at every hit through the callback API.
+            const auto getExpected = [&](const RayCastInput& input) {
+                auto expected = FixtureRayCastOutput{};
+                RayCast(world, input, [&](Fixture* fixture, ChildCounter child,
+                                          Length2 point, UnitVec normal) {
+                    const auto output = RayCast(*fixture, child, input);
+                    expected = FixtureRayCastHit{fixture, child, point, normal, output->fraction};
+                    return RayCastOpcode::ClipRay;
+                });
+                return expected;
+            };
+            for (const auto& input: {
+                RayCastInput{Length2{-5_m, 0.2_m}, Length2{30_m, 0.2_m}, UnitInterval<Real>{1}},
+                RayCastInput{Length2{30_m, 12.3_m}, Length2{-5_m, 0.1_m}, UnitInterval<Real>{1}},
+                RayCastInput{Length2{7.4_m, 20_m}, Length2{7.6_m, -5_m}, UnitInterval<Real>{1}},
+                RayCastInput{Length2{-3_m, -3_m}, Length2{30_m, 15_m}, UnitInterval<Real>{0.5f}},
+            })
+            {
+                const auto expected = getExpected(input);
+                ASSERT_TRUE(expected.has_value());
+                const auto closest = RayCastClosest(world, input);
+                ASSERT_TRUE(closest.has_value());
+                EXPECT_EQ(closest->fixture, expected->fixture);
+                EXPECT_EQ(closest->childIndex, expected->childIndex);
+                EXPECT_NEAR(static_cast<double>(Real{closest->fraction}),
+                            static_cast<double>(Real{expected->fraction}), 1e-5);
+                EXPECT_NEAR(static_cast<double>(Real{GetX(closest->point) / Meter}),
+                            static_cast<double>(Real{GetX(expected->point) / Meter}), 1e-4);
+                EXPECT_NEAR(static_cast<double>(Real{GetY(closest->point) / Meter}),
+                            static_cast<double>(Real{GetY(expected->point) / Meter}), 1e-4);
+                EXPECT_EQ(closest->normal, expected->normal);
+            }
+
+            // Rays between the shapes or clipped short of them don't hit anything.
+            EXPECT_FALSE(RayCastClosest(world, RayCastInput{Length2{-5_m, 1.25_m},
+                Length2{30_m, 1.25_m}, UnitInterval<Real>{1}}).has_value());
+            EXPECT_FALSE(RayCastClosest(world, RayCastInput{Length2{-5_m, 0_m},
+                Length2{30_m, 0_m}, UnitInterval<Real>{0.1f}}).has_value());
+        }
+    }
+}
+
+TEST(World, RayCastClosestForPacket)
+{
+    for (const auto broadPhase: {BroadPhaseType::DynamicTree, BroadPhaseType::SweepAndPrune,
+                                 BroadPhaseType::UniformGrid})
+    {
+        for (const auto separate: {false, true})
+        {
+            auto world = World{WorldConf{}.UseBroadPhase(broadPhase).UseSeparateStaticTree(separate)};
+            const auto disk = Shape{DiskShapeConf{}.UseRadius(0.5_m)};
+            const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m)};
+            for (auto i = 0; i < 100; ++i)
+            {
+                world.CreateBody(BodyConf{}
+                    .UseType((i % 3 == 0)? BodyType::Static: BodyType::Dynamic)
+                    .UseLocation(Length2{(i % 10) * 2.5_m - 12_m, (i / 10) * 2.5_m - 12_m})
+                    .UseAngle((i % 4) * 0.3_rad))->CreateFixture((i % 2 == 0)? disk: box);
+            }
+            Step(world, 0_s);
+
+            // A fan of rays from a common origin with a count that's not a multiple of four.
+            auto inputs = std::vector<RayCastInput>{};
+            for (auto i = 0; i < 63; ++i)
+            {
+                const auto angle = Real(i) * Pi * 2 / 63;
+                const auto p2 = Length2{std::cos(angle) * 30_m, std::sin(angle) * 30_m};
+                inputs.push_back(RayCastInput{Length2{0.1_m, 1.2_m}, Length2{0.1_m, 1.2_m} + p2,
+                    UnitInterval<Real>{(i % 5 == 0)? Real(0.2f): Real(1)}});
+            }
+            // Rays parallel to the axes and a ray that's a point.
+            inputs.push_back(RayCastInput{Length2{-20_m, 0_m}, Length2{20_m, 0_m}, UnitInterval<Real>{1}});
+            inputs.push_back(RayCastInput{Length2{5_m, 20_m}, Length2{5_m, -20_m}, UnitInterval<Real>{1}});
+            inputs.push_back(RayCastInput{Length2{30_m, 30_m}, Length2{30_m, 30_m}, UnitInterval<Real>{1}});
+
+            auto outputs = std::vector<FixtureRayCastOutput>(size(inputs));
+            RayCastClosest(world, inputs, outputs);
+            auto hits = 0;
+            for (auto i = std::size_t{0}; i < size(inputs); ++i)
+            {
+                const auto expected = RayCastClosest(world, inputs[i]);
+                ASSERT_EQ(outputs[i].has_value(), expected.has_value());
+                if (expected.has_value())
+                {
+                    ++hits;
+                    EXPECT_EQ(outputs[i]->fixture, expected->fixture);
+                    EXPECT_EQ(outputs[i]->childIndex, expected->childIndex);
+                    EXPECT_EQ(outputs[i]->fraction, expected->fraction);
+                    EXPECT_EQ(outputs[i]->point, expected->point);
+                    EXPECT_EQ(outputs[i]->normal, expected->normal);
+                }
+            }
+            EXPECT_GT(hits, 50);
+            EXPECT_FALSE(outputs.back().has_value());
+
+            RayCastClosest(world, Span<const RayCastInput>{}, Span<FixtureRayCastOutput>{});
+            auto tooFew = std::vector<FixtureRayCastOutput>(size(inputs) - 1);
+            EXPECT_THROW(RayCastClosest(world, inputs, tooFew), InvalidArgument);
+        }
+    }
+}
+
+TEST(World, ShapeCast)
+{
+    for (const auto broadPhase: {BroadPhaseType::DynamicTree, BroadPhaseType::SweepAndPrune,
+                                 BroadPhaseType::UniformGrid})
+    {
+        auto world = World{WorldConf{}.UseBroadPhase(broadPhase)};
+        const auto ground = world.CreateBody()->CreateFixture(
+            Shape{PolygonShapeConf{}.SetAsBox(10_m, 0.5_m)});
+        const auto wall = world.CreateBody(BodyConf{}.UseLocation(Length2{5_m, 5_m}))->CreateFixture(
+            Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 5_m)}, FixtureConf{}.UseFilter(Filter{0x2, 0xFFFF, 0}));
+        Step(world, 0_s);
+
+        const auto disk = DiskShapeConf{}.UseRadius(0.5_m);
+        const auto proxy = GetChild(disk, 0);
+        const auto tolerance = 0.01;
+        const auto skin = static_cast<double>(
+            Real{Length{PolygonShapeConf::GetDefaultVertexRadius()} / Meter});
+
+        // Dropping the disk onto the ground hits it when its center is 1m above its top.
+        auto hit = ShapeCast(world, proxy, Sweep{Position{Length2{0_m, 5_m}, 0_deg},
+                                                 Position{Length2{0_m, -5_m}, 0_deg}});
+        ASSERT_TRUE(hit.has_value());
+        EXPECT_EQ(hit->fixture, ground);
+        EXPECT_EQ(hit->childIndex, ChildCounter(0));
+        EXPECT_NEAR(static_cast<double>(hit->time), 0.4, tolerance);
+        EXPECT_NEAR(static_cast<double>(Real{GetX(hit->point) / Meter}), 0.0, tolerance);
+        EXPECT_NEAR(static_cast<double>(Real{GetY(hit->point) / Meter}), 0.5 + skin, tolerance);
+        EXPECT_NEAR(static_cast<double>(hit->normal.GetX()), 0.0, tolerance);
+        EXPECT_NEAR(static_cast<double>(hit->normal.GetY()), 1.0, tolerance);
+
+        // Moving the disk sideways hits the wall before reaching the end of the sweep.
+        const auto sideways = Sweep{Position{Length2{-3_m, 3_m}, 0_deg},
+                                    Position{Length2{10_m, 3_m}, 0_deg}};
+        hit = ShapeCast(world, proxy, sideways);
+        ASSERT_TRUE(hit.has_value());
+        EXPECT_EQ(hit->fixture, wall);
+        EXPECT_NEAR(static_cast<double>(hit->time), 7.0 / 13.0, tolerance);
+        EXPECT_NEAR(static_cast<double>(Real{GetX(hit->point) / Meter}), 4.5 - skin, tolerance);
+        EXPECT_NEAR(static_cast<double>(hit->normal.GetX()), -1.0, tolerance);
+
+        // The time max limits how far the shape gets cast.
+        EXPECT_FALSE(ShapeCast(world, proxy, sideways, Filter{},
+                               GetDefaultToiConf().UseTimeMax(Real(0.5f))).has_value());
+
+        // Fixtures that shouldn't collide with the shape don't get hit.
+        EXPECT_FALSE(ShapeCast(world, proxy, sideways, Filter{0x1, 0x1, 0}).has_value());
+        auto groupFilter = ground->GetFilterData();
+        groupFilter.groupIndex = -1;
+        ground->SetFilterData(groupFilter);
+        EXPECT_FALSE(ShapeCast(world, proxy, Sweep{Position{Length2{0_m, 5_m}, 0_deg},
+                                                    Position{Length2{0_m, -5_m}, 0_deg}},
+                               Filter{0x1, 0xFFFF, -1}).has_value());
+
+        // Fixtures in the same positive group get hit even when the mask bits exclude them.
+        groupFilter.groupIndex = 1;
+        ground->SetFilterData(groupFilter);
+        hit = ShapeCast(world, proxy, Sweep{Position{Length2{0_m, 5_m}, 0_deg},
+                                            Position{Length2{0_m, -5_m}, 0_deg}},
+                        Filter{0x4, 0x4, 1});
+        ASSERT_TRUE(hit.has_value());
+        EXPECT_EQ(hit->fixture, ground);
+        EXPECT_NEAR(static_cast<double>(hit->time), 0.4, tolerance);
+        groupFilter.groupIndex = 0;
+        ground->SetFilterData(groupFilter);
+
+        // A shape that starts out overlapping a fixture hits it right away.
+        hit = ShapeCast(world, proxy, Sweep{Position{Length2{5_m, 3_m}, 0_deg},
+                                            Position{Length2{8_m, 3_m}, 0_deg}});
+        ASSERT_TRUE(hit.has_value());
+        EXPECT_EQ(hit->fixture, wall);
+        EXPECT_EQ(hit->time, Real(0));
+
+        // A shape moving away from everything doesn't hit anything.
+        EXPECT_FALSE(ShapeCast(world, proxy, Sweep{Position{Length2{-3_m, 3_m}, 0_deg},
+                                                   Position{Length2{-3_m, 9_m}, 0_deg}}).has_value());
+
+        // A rotating shape that stays in place can still hit something.
+        const auto stick = PolygonShapeConf{}.SetAsBox(1_m, 0.1_m);
+        hit = ShapeCast(world, GetChild(stick, 0), Sweep{Position{Length2{3.8_m, 3_m}, 90_deg},
+                                                         Position{Length2{3.8_m, 3_m}, 0_deg}});
+        ASSERT_TRUE(hit.has_value());
+        EXPECT_EQ(hit->fixture, wall);
+        EXPECT_GT(hit->time, Real(0));
+        EXPECT_LT(hit->time, Real(1));
+    }
+}
+
+TEST(World, UpdateContactsInBucketsOfShapeKinds)
+{
+    // Contacts get their manifolds calculated in buckets of the same kinds of shapes. Checks
+    // that they're the manifolds of the children and that the listener still gets called in
+    // the order of the contacts.
+    struct Listener: ContactListener
+    {
+        std::vector<Contact*> begun;
+        int presolves = 0;
+
+        void BeginContact(Contact& contact) override
+        {
+            begun.push_back(&contact);
+        }
+
+        void EndContact(Contact&) override {}
+
+        void PreSolve(Contact& contact, const Manifold&) override
+        {
+            ++presolves;
+            const auto fA = contact.GetFixtureA();
+            const auto fB = contact.GetFixtureB();
+            const auto expected = CollideShapes(GetChild(fA->GetShape(), contact.GetChildIndexA()),
+                                                GetTransformation(*fA),
+                                                GetChild(fB->GetShape(), contact.GetChildIndexB()),
+                                                GetTransformation(*fB));
+            const auto& manifold = contact.GetManifold();
+            ASSERT_EQ(manifold.GetType(), expected.GetType());
+            ASSERT_EQ(manifold.GetPointCount(), expected.GetPointCount());
+            EXPECT_EQ(manifold.GetLocalPoint(), expected.GetLocalPoint());
+            for (auto i = decltype(manifold.GetPointCount()){0}; i < manifold.GetPointCount(); ++i)
+            {
+                EXPECT_EQ(manifold.GetPoint(i).localPoint, expected.GetPoint(i).localPoint);
+                EXPECT_EQ(manifold.GetContactFeature(i), expected.GetContactFeature(i));
+            }
+        }
+
+        void PostSolve(Contact&, const ContactImpulsesList&, iteration_type) override {}
+    };
+
+    auto world = World{};
+    auto listener = Listener{};
+    world.SetContactListener(&listener);
+    const auto disk = Shape{DiskShapeConf{}.UseRadius(0.5_m)};
+    const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m)};
+    const auto edge = Shape{EdgeShapeConf{Length2{-0.5_m, 0_m}, Length2{0.5_m, 0_m}}};
+    for (auto i = 0; i < 64; ++i)
+    {
+        const auto body = world.CreateBody(BodyConf{}
+            .UseType(BodyType::Dynamic)
+            .UseLocation(Length2{(i % 8) * 0.9_m, (i / 8) * 0.9_m})
+            .UseAngle((i % 5) * 0.3_rad));
+        const auto& shape = (i % 3 == 0)? box: (i % 7 == 0)? edge: disk;
+        body->CreateFixture(shape, FixtureConf{}.UseIsSensor(i % 11 == 0));
+    }
+    Step(world, Time{1_s / 100});
+    EXPECT_GT(listener.presolves, 0);
+    ASSERT_FALSE(empty(listener.begun));
+    auto it = begin(world.GetContacts());
+    for (const auto& contact: listener.begun)
+    {
+        it = std::find_if(it, end(world.GetContacts()), [&](const KeyedContactPtr& c) {
+            return GetContactPtr(c) == contact;
+        });
+        ASSERT_NE(it, end(world.GetContacts()));
+    }
+}
+
+TEST(World, SkipsUpdatingSeparatedContacts)
+{
+    // Contacts whose shapes can't have gotten close enough to touch since they were last
+    // updated don't get updated. Checks that their touching states are still those of
+    // their shapes and that their separation bounds are lower bounds.
+    auto world = World{};
+    const auto disk = Shape{DiskShapeConf{}.UseRadius(0.3_m)};
+    const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.3_m, 0.2_m)};
+    for (auto i = 0; i < 100; ++i)
+    {
+        world.CreateBody(BodyConf{}
+            .UseType(BodyType::Dynamic)
+            .UseLocation(Length2{(i % 10) * 0.8_m, (i / 10) * 0.8_m})
+            .UseAngle((i % 7) * 0.5_rad)
+            .UseLinearVelocity(LinearVelocity2{Real((i * 37) % 11 - 5) * 0.2_mps,
+                                               Real((i * 53) % 13 - 6) * 0.2_mps})
+            .UseAngularVelocity(Real((i % 5) - 2) * 1_rad / Second))
+        ->CreateFixture((i % 3 == 0)? box: disk);
+    }
+    using Key = std::tuple<const Fixture*, ChildCounter, const Fixture*, ChildCounter>;
+    const auto getKey = [](const Contact& c) {
+        return Key{c.GetFixtureA(), c.GetChildIndexA(), c.GetFixtureB(), c.GetChildIndexB()};
+    };
+    const auto isTouching = [](const Contact& c) {
+        const auto fA = c.GetFixtureA();
+        const auto fB = c.GetFixtureB();
+        return CollideShapes(GetChild(fA->GetShape(), c.GetChildIndexA()), GetTransformation(*fA),
+                             GetChild(fB->GetShape(), c.GetChildIndexB()),
+                             GetTransformation(*fB)).GetPointCount() > 0;
+    };
+    auto stepConf = StepConf{};
+    stepConf.SetTime(Time{1_s / 100});
+    auto separated = 0u;
+    auto touching = 0u;
+    for (auto step = 0; step < 100; ++step)
+    {
+        auto expected = std::map<Key, bool>{};
+        for (const auto& c: world.GetContacts())
+        {
+            expected[getKey(GetRef(GetContactPtr(c)))] = isTouching(GetRef(GetContactPtr(c)));
+        }
+        const auto stats = world.Step(stepConf);
+        separated += stats.pre.separated;
+        for (const auto& c: world.GetContacts())
+        {
+            const auto& contact = GetRef(GetContactPtr(c));
+            const auto it = expected.find(getKey(contact));
+            if (it != end(expected))
+            {
+                EXPECT_EQ(contact.IsTouching(), it->second);
+                touching += contact.IsTouching()? 1u: 0u;
+            }
+            if (contact.GetSeparationBound() > 0_m)
+            {
+                EXPECT_FALSE(contact.IsTouching());
+                EXPECT_GE(CalcSeparation(contact), contact.GetSeparationBound());
+            }
+        }
+    }
+    EXPECT_GT(separated, 0u);
+    EXPECT_GT(touching, 0u);
+}
+
+TEST(World, SepAxisCachingGetsSameResults)
+{
+    // Separating axis caching only skips calculations whose results are known in advance,
+    // so worlds stepped with and without it stay the same.
+    const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m)};
+    const auto ground = Shape{PolygonShapeConf{}.SetAsBox(20_m, 0.5_m)};
+    auto worlds = std::array<World, 2>{{World{}, World{}}};
+    for (auto& world: worlds)
+    {
+        world.CreateBody()->CreateFixture(ground);
+        for (auto i = 0; i < 40; ++i)
+        {
+            world.CreateBody(BodyConf{}
+                .UseType(BodyType::Dynamic)
+                .UseLocation(Length2{Real(i % 8) * 1.125_m - 4_m, Real(i / 8) * 1.25_m + 1_m})
+                .UseAngle(Real(i % 5) * 0.1_rad))
+            ->CreateFixture(box);
+        }
+    }
+    auto stepConf = StepConf{};
+    for (auto step = 0; step < 100; ++step)
+    {
+        stepConf.doSepAxisCaching = true;
+        const auto statsOn = worlds[0].Step(stepConf);
+        stepConf.doSepAxisCaching = false;
+        const auto statsOff = worlds[1].Step(stepConf);
+        EXPECT_EQ(statsOn.pre.added, statsOff.pre.added);
+        EXPECT_EQ(statsOn.reg.maxIncImpulse, statsOff.reg.maxIncImpulse);
+    }
+    const auto& bodiesOn = worlds[0].GetBodies();
+    const auto& bodiesOff = worlds[1].GetBodies();
+    ASSERT_EQ(size(bodiesOn), size(bodiesOff));
+    auto on = cbegin(bodiesOn);
+    auto off = cbegin(bodiesOff);
+    for (; on != cend(bodiesOn); ++on, ++off)
+    {
+        EXPECT_EQ(GetRef(*on).GetTransformation(), GetRef(*off).GetTransformation());
+    }
+    auto cached = 0;
+    for (const auto& c: worlds[0].GetContacts())
+    {
+        const auto& contact = GetRef(GetContactPtr(c));
+        cached += (contact.GetSeparatingAxis().type != SeparatingAxis::e_unset)? 1: 0;
+        if (contact.IsTouching())
+        {
+            EXPECT_NE(contact.GetSeparatingAxis().type, SeparatingAxis::e_unset);
+        }
+    }
+    EXPECT_GT(cached, 0);
+    for (const auto& c: worlds[1].GetContacts())
+    {
+        EXPECT_EQ(GetRef(GetContactPtr(c)).GetSeparatingAxis().type, SeparatingAxis::e_unset);
+    }
+}
+
+TEST(World, QueryOverlap)
+{
+    for (const auto broadPhase: {BroadPhaseType::DynamicTree, BroadPhaseType::SweepAndPrune,
+                                 BroadPhaseType::UniformGrid})
+    {
+        auto world = World{WorldConf{}.UseBroadPhase(broadPhase)};
+        const auto disk = Shape{DiskShapeConf{}.UseRadius(0.5_m)};
+        const auto box = Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m)};
+        auto fixtures = std::vector<Fixture*>{};
+        for (auto i = 0; i < 100; ++i)
+        {
+            const auto body = world.CreateBody(BodyConf{}
+                .UseLocation(Length2{(i % 10) * 1.5_m, (i / 10) * 1.5_m})
+                .UseAngle((i % 4) * 0.4_rad));
+            fixtures.push_back(body->CreateFixture((i % 2 == 0)? disk: box, FixtureConf{}
+                .UseFilter(Filter{static_cast<Filter::bits_type>((i % 3 == 0)? 0x2: 0x1), 0xFFFF, 0})));
+        }
+        Step(world, 0_s);
+
+        const auto getExpected = [&](const Shape& shape, const Transformation& xf,
+                                     Filter::bits_type maskBits) {
+            auto expected = std::vector<Fixture*>{};
+            for (const auto& fixture: fixtures)
+            {
+                if (((fixture->GetFilterData().categoryBits & maskBits) != 0) &&
+                    (TestOverlap(GetChild(fixture->GetShape(), 0), GetTransformation(*fixture),
+                                 GetChild(shape, 0), xf) >= 0_m2))
+                {
+                    expected.push_back(fixture);
+                }
+            }
+            std::sort(begin(expected), end(expected));
+            return expected;
+        };
+        for (const auto& shape: {
+            Shape{DiskShapeConf{}.UseRadius(2.6_m)},
+            Shape{PolygonShapeConf{}.SetAsBox(3.3_m, 1.1_m)},
+            Shape{PolygonShapeConf{}.Set({Length2{0_m, 0_m}, Length2{4_m, 0.3_m}, Length2{0.2_m, 5_m}})},
+        })
+        {
+            const auto xf = Transformation{Length2{6.1_m, 5.9_m}, UnitVec::Get(20_deg)};
+            auto found = std::vector<Fixture*>{};
+            QueryOverlap(world, shape, xf, [&](Fixture* fixture, ChildCounter child) {
+                EXPECT_EQ(child, ChildCounter(0));
+                found.push_back(fixture);
+                return true;
+            });
+            std::sort(begin(found), end(found));
+            EXPECT_GT(size(found), std::size_t(4));
+            EXPECT_EQ(found, getExpected(shape, xf, 0xFFFF));
+
+            found.clear();
+            QueryOverlap(world, GetChild(shape, 0), xf, Filter::bits_type(0x2),
+                         [&](Fixture* fixture, ChildCounter) {
+                found.push_back(fixture);
+                return true;
+            });
+            std::sort(begin(found), end(found));
+            EXPECT_FALSE(empty(found));
+            EXPECT_EQ(found, getExpected(shape, xf, 0x2));
+
+            auto calls = 0;
+            QueryOverlap(world, shape, xf, [&](Fixture*, ChildCounter) {
+                ++calls;
+                return false;
+            });
+            EXPECT_EQ(calls, 1);
+        }
+    }
+}
+
+TEST(World, OtherBroadPhasesFindSameContacts)
+{
+    EXPECT_EQ(WorldConf{}.broadPhase, BroadPhaseType::DynamicTree);
+    EXPECT_EQ(Length{WorldConf{}.gridCellSize}, 2_m);
+    
+    const auto scene = Scene{
+        Shape{PolygonShapeConf{}.SetAsBox(0.45_m, 0.45_m)},
+        GetGridLocations(20, 10, 0.9_m), EarthlyGravity,
+        {Shape{EdgeShapeConf{Length2{-40_m, -0.5_m}, Length2{40_m, -0.5_m}}}}
+    };
+    auto treeWorld = World{};
+    CreateScene(treeWorld, scene);
+    const auto treeStats = treeWorld.Step(StepConf{});
+    EXPECT_NE(treeWorld.GetBroadPhase().Get<TreeBroadPhase>(), nullptr);
+    EXPECT_EQ(treeWorld.GetBroadPhase().Get<SweepAndPrune>(), nullptr);
+    EXPECT_EQ(treeWorld.GetBroadPhase().Get<UniformGrid>(), nullptr);
+    EXPECT_GT(size(treeWorld.GetContacts()), std::size_t(0));
+    
+    for (const auto type: {BroadPhaseType::SweepAndPrune, BroadPhaseType::UniformGrid})
+    {
+        auto world = World{WorldConf{}.UseBroadPhase(type).UseGridCellSize(1_m)};
+        EXPECT_EQ(world.GetBroadPhaseType(), type);
+        CreateScene(world, scene);
+        
+        const auto stats = world.Step(StepConf{});
+        EXPECT_EQ(world.GetBroadPhase().Get<TreeBroadPhase>(), nullptr);
+        EXPECT_EQ(world.GetTree().GetLeafCount(), DynamicTree::Size(0));
+        if (type == BroadPhaseType::SweepAndPrune)
+        {
+            ASSERT_NE(world.GetBroadPhase().Get<SweepAndPrune>(), nullptr);
+            EXPECT_EQ(world.GetBroadPhase().Get<UniformGrid>(), nullptr);
+            EXPECT_EQ(world.GetBroadPhase().Get<SweepAndPrune>()->GetProxyCount(),
+                      SweepAndPrune::Size(201));
+        }
+        else
+        {
+            ASSERT_NE(world.GetBroadPhase().Get<UniformGrid>(), nullptr);
+            EXPECT_EQ(world.GetBroadPhase().Get<SweepAndPrune>(), nullptr);
+            EXPECT_EQ(world.GetBroadPhase().Get<UniformGrid>()->GetProxyCount(),
+                      UniformGrid::Size(201));
+        }
+        EXPECT_EQ(treeStats.pre.added, stats.pre.added);
+        EXPECT_EQ(treeStats.reg.contactsAdded, stats.reg.contactsAdded);
+        EXPECT_EQ(GetSortedContactLocations(treeWorld), GetSortedContactLocations(world));
+        
+        for (auto i = 0; i < 20; ++i)
+        {
+            world.Step(StepConf{});
+        }
+        
+        auto found = std::vector<Fixture*>{};
+        Query(world, AABB{LengthInterval{-1_m, 1_m}, LengthInterval{-1_m, 1_m}},
+              [&](Fixture* fixture, ChildCounter) {
+            found.push_back(fixture);
+            return true;
+        });
+        EXPECT_GT(size(found), std::size_t(1));
+        
+        auto hits = 0;
+        const auto input = RayCastInput{Length2{-20_m, 0_m}, Length2{40_m, 0_m},
+            UnitInterval<Real>{1}};
+        EXPECT_TRUE(RayCast(world, input, [&](Fixture*, ChildCounter, Length2, UnitVec) {
+            ++hits;
+            return RayCastOpcode::Terminate;
+        }));
+        EXPECT_EQ(hits, 1);
+    }
+}
+
+TEST(World, SeparateStaticTree)
+{
+    auto scene = Scene{
+        Shape(DiskShapeConf{}.UseDensity(1_kgpm2).UseRadius(0.5_m)),
+        GetGridLocations(20, 1, 1_m, Length2{0_m, 1_m}), EarthlyGravity, {}
+    };
+    for (auto i = 0; i < 20; ++i)
+    {
+        scene.ground.push_back(Shape{PolygonShapeConf{}.SetAsBox(0.5_m, 0.5_m,
+                                                                 Length2{i * 1_m, 0_m}, 0_deg)});
+    }
+    
+    EXPECT_FALSE(World{}.IsSeparateStaticTree());
+    
+    auto world = World{WorldConf{}.UseSeparateStaticTree(true)};
+    EXPECT_TRUE(world.IsSeparateStaticTree());
+    const auto ground = CreateScene(world, scene);
+    
+    auto stepConf = StepConf{};
+    stepConf.SetTime(1_s / 60);
+    world.Step(stepConf);
+    EXPECT_EQ(world.GetStaticTree().GetLeafCount(), DynamicTree::Size(20));
+    EXPECT_EQ(world.GetTree().GetLeafCount(), DynamicTree::Size(20));
+    {
+        const auto copy = world;
+        EXPECT_TRUE(copy.IsSeparateStaticTree());
+        EXPECT_EQ(copy.GetStaticTree().GetLeafCount(), DynamicTree::Size(20));
+        EXPECT_EQ(copy.GetTree().GetLeafCount(), DynamicTree::Size(20));
+        EXPECT_EQ(size(copy.GetContacts()), size(world.GetContacts()));
+    }
+    
+    // The first step solves no contacts so it finds the same contacts either way.
+    {
+        auto defaultWorld = World{};
+        CreateScene(defaultWorld, scene);
+        defaultWorld.Step(stepConf);
+        EXPECT_EQ(defaultWorld.GetStaticTree().GetLeafCount(), DynamicTree::Size(0));
+        EXPECT_EQ(defaultWorld.GetTree().GetLeafCount(), DynamicTree::Size(40));
+        EXPECT_EQ(GetSortedContactLocations(defaultWorld), GetSortedContactLocations(world));
+    }
+    EXPECT_GE(size(world.GetContacts()), std::size_t(20));
+    
+    for (auto i = 0; i < 120; ++i)
+    {
+        world.Step(stepConf);
+    }
+    for (auto&& b: world.GetBodies())
+    {
+        const auto& body = GetRef(b);
+        if (body.GetType() == BodyType::Dynamic)
+        {
+            // Resting on the ground.
+            EXPECT_NEAR(static_cast<double>(Real{GetY(body.GetLocation()) / Meter}), 1.0, 0.05);
+        }
+    }
+    
+    // Changing the type of a body moves its proxies to the appropriate tree.
+    ground->SetType(BodyType::Kinematic);
+    world.Step(stepConf);
+    EXPECT_EQ(world.GetStaticTree().GetLeafCount(), DynamicTree::Size(0));
+    EXPECT_EQ(world.GetTree().GetLeafCount(), DynamicTree::Size(40));
+    ground->SetType(BodyType::Static);
+    world.Step(stepConf);
+    EXPECT_EQ(world.GetStaticTree().GetLeafCount(), DynamicTree::Size(20));
+    EXPECT_EQ(world.GetTree().GetLeafCount(), DynamicTree::Size(20));
+    EXPECT_GE(size(world.GetContacts()), std::size_t(20));
+}
+
+TEST(World, RebuildsDegradedTree)
+{
+    auto scene = Scene{
+        Shape(DiskShapeConf{}.UseDensity(1_kgpm2).UseRadius(0.4_m)),
+        {}, LinearAcceleration2{}, {}
+    };
+    for (auto i = 0; i < 1000; ++i)
+    {
+        scene.locations.push_back(Length2{((i * 37) % 100) * 1_m, ((i * 53) % 97) * 1_m});
+    }
+    
+    auto stepConf = StepConf{};
+    stepConf.SetTime(1_s / 60);
+    auto world = World{};
+    CreateScene(world, scene);
+    world.Step(stepConf);
+    const auto incrementalRatio = ComputePerimeterRatio(world.GetTree());
+    
+    stepConf.maxTreeDegradation = Real(1.5);
+    stepConf.maxThreads = 2;
+    auto rebuiltWorld = World{};
+    CreateScene(rebuiltWorld, scene);
+    rebuiltWorld.Step(stepConf); // Creates the proxies.
+    rebuiltWorld.Step(stepConf); // Rebuilds the tree.
+    const auto& tree = rebuiltWorld.GetTree();
+    EXPECT_LT(ComputePerimeterRatio(tree), incrementalRatio);
+    EXPECT_TRUE(ValidateStructure(tree, tree.GetRootIndex()));
+    EXPECT_TRUE(ValidateMetrics(tree, tree.GetRootIndex()));
+    EXPECT_EQ(tree.GetLeafCount(), world.GetTree().GetLeafCount());
+    EXPECT_EQ(GetSortedContactLocations(rebuiltWorld), GetSortedContactLocations(world));
+}
+
 TEST(World_Longer, TilesComesToRest)
 {
     PLAYRHO_CONSTEXPR const auto LinearSlop = Meter / 1000;